@@ -0,0 +1,74 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+
+// Times CSV and JSON export and import of the same generated wishlist.
+// Usage: wishlist_benchmarks [itemCount] (default 200000)
+
+#include "../include/file_handler.h"
+#include "../include/logger.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace {
+    void fill(WishlistManager &manager, int itemCount) {
+        for (int i = 0; i < itemCount; ++i) {
+            auto item = std::make_unique<WishItem>("Item " + std::to_string(i), 5.0 + i % 500 * 0.25,
+                                                   static_cast<Category>(i % 6));
+            item->setNotes(i % 10 == 0 ? "Gift idea, \"urgent\"\nsecond line" : "Some notes about the item");
+            item->setLink("https://example.com/items/" + std::to_string(i));
+            manager.addItem(std::move(item));
+        }
+    }
+
+    // Runs action and prints its duration and throughput over the file's size
+    void measure(const std::string &name, const std::string &file, const std::function<bool()> &action) {
+        auto start = std::chrono::steady_clock::now();
+        bool ok = action();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        double megabytes = static_cast<double>(std::filesystem::file_size(file)) / (1024.0 * 1024.0);
+        std::cerr << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(1)
+                << std::setw(9) << seconds * 1000.0 << " ms" << std::setw(9) << megabytes / seconds << " MB/s"
+                << (ok ? "" : "  FAILED") << '\n';
+    }
+}
+
+int main(int argc, char *argv[]) {
+    int itemCount = argc > 1 ? std::atoi(argv[1]) : 200000;
+    Logger::getInstance().setLogLevel(LogLevel::NONE);
+    std::ostringstream discarded; // Export and import report to std::cout
+    std::streambuf *console = std::cout.rdbuf(discarded.rdbuf());
+
+    WishlistManager manager("Benchmark");
+    fill(manager, itemCount);
+    FileHandler handler("bench_wishlist.dat");
+    std::string csvFile = "bench_wishlist.csv";
+    std::string jsonFile = "bench_wishlist.json";
+
+    std::cerr << itemCount << " items\n";
+    measure("CSV export", csvFile, [&] { return handler.exportToCSV(manager, csvFile); });
+    measure("CSV import, 1 thread", csvFile, [&] {
+        WishlistManager imported("Benchmark");
+        return FileHandler::importFromCSV(imported, csvFile, 1);
+    });
+    measure("CSV import, all threads", csvFile, [&] {
+        WishlistManager imported("Benchmark");
+        return FileHandler::importFromCSV(imported, csvFile);
+    });
+    measure("JSON export", jsonFile, [&] { return handler.exportToJSON(manager, jsonFile); });
+    measure("JSON import", jsonFile, [&] {
+        WishlistManager imported("Benchmark");
+        return FileHandler::importFromJSON(imported, jsonFile);
+    });
+
+    std::cout.rdbuf(console);
+    std::filesystem::remove(csvFile);
+    std::filesystem::remove(jsonFile);
+    return 0;
+}
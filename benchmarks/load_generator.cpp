@@ -0,0 +1,231 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+
+// Measures requests per second and latency percentiles of the REST API.
+// Usage: wishlist_load_generator [--port=N] [--connections=N] [--seconds=N] [--writes=PERCENT] [--users=N]
+// Without --port a server with an in-memory store is started in this process.
+// Every connection is kept alive and sends its next request when the answer
+// arrived; reads are GET /users/{user}/stats, writes POST an item.
+
+#include "../include/http_server.h"
+#include "../include/wishlist_service.h"
+#include "../include/memory_store.h"
+#include "../include/persistence_queue.h"
+#include "../include/logger.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct Settings {
+        int port = -1;
+        int connections = 8;
+        int seconds = 5;
+        int writePercent = 10;
+        int users = 0; // 0 = one per connection
+    };
+
+    struct ConnectionResult {
+        std::vector<double> latenciesMs;
+        size_t errors = 0;
+    };
+
+    // Blocking keep-alive client for one connection
+    class Client {
+    private:
+        int fd = -1;
+        std::string buffer;
+
+    public:
+        ~Client() {
+            if (fd >= 0) close(fd);
+        }
+
+        bool connect(int port) {
+            fd = socket(AF_INET, SOCK_STREAM, 0);
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_port = htons(static_cast<uint16_t>(port));
+            inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+            int enable = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+            return fd >= 0 && ::connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0;
+        }
+
+        // Sends request and reads the whole response; returns its status or -1
+        int send(const std::string &request) {
+            for (size_t sent = 0; sent < request.size();) {
+                ssize_t written = ::send(fd, request.data() + sent, request.size() - sent, MSG_NOSIGNAL);
+                if (written <= 0) return -1;
+                sent += static_cast<size_t>(written);
+            }
+
+            size_t headerEnd;
+            while ((headerEnd = buffer.find("\r\n\r\n")) == std::string::npos) {
+                if (!receive()) return -1;
+            }
+            size_t lengthAt = buffer.find("Content-Length: ");
+            if (lengthAt == std::string::npos || lengthAt > headerEnd) return -1;
+            size_t total = headerEnd + 4 + std::strtoul(buffer.c_str() + lengthAt + 16, nullptr, 10);
+            while (buffer.size() < total) {
+                if (!receive()) return -1;
+            }
+            int status = std::atoi(buffer.c_str() + 9); // After "HTTP/1.1 "
+            buffer.erase(0, total);
+            return status;
+        }
+
+    private:
+        bool receive() {
+            char chunk[16384];
+            ssize_t received = recv(fd, chunk, sizeof(chunk), 0);
+            if (received <= 0) return false;
+            buffer.append(chunk, static_cast<size_t>(received));
+            return true;
+        }
+    };
+
+    std::string postItem(const std::string &user, int number) {
+        std::string body = "{\"name\":\"Item " + std::to_string(number) + "\",\"price\":" +
+                           std::to_string(5 + number % 100) + ",\"category\":\"toys\"}";
+        return "POST /users/" + user + "/items HTTP/1.1\r\nHost: 127.0.0.1\r\nContent-Type: application/json\r\n"
+               "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+    }
+
+    std::string getStats(const std::string &user) {
+        return "GET /users/" + user + "/stats HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n";
+    }
+
+    void runConnection(const Settings &settings, int index, Clock::time_point deadline, ConnectionResult &result) {
+        Client client;
+        if (!client.connect(settings.port)) {
+            result.errors++;
+            return;
+        }
+        std::string user = "load" + std::to_string(index % settings.users);
+        std::mt19937 random(static_cast<unsigned>(index));
+        std::uniform_int_distribution<int> percent(0, 99);
+
+        // Creates the user, so reads do not answer 404
+        if (client.send(postItem(user, 0)) != 201) result.errors++;
+
+        for (int number = 1; Clock::now() < deadline; ++number) {
+            std::string request = percent(random) < settings.writePercent ? postItem(user, number) : getStats(user);
+            auto start = Clock::now();
+            int status = client.send(request);
+            result.latenciesMs.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+            if (status < 200 || status >= 300) {
+                result.errors++;
+                if (status < 0) return;
+            }
+        }
+    }
+
+    double percentile(const std::vector<double> &sorted, double fraction) {
+        if (sorted.empty()) return 0.0;
+        size_t index = static_cast<size_t>(fraction * static_cast<double>(sorted.size() - 1) + 0.5);
+        return sorted[std::min(index, sorted.size() - 1)];
+    }
+
+    bool parseSettings(int argc, char *argv[], Settings &settings) {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            size_t equals = arg.find('=');
+            if (equals == std::string::npos) return false;
+            std::string name = arg.substr(0, equals);
+            int value = std::atoi(arg.c_str() + equals + 1);
+            if (name == "--port") settings.port = value;
+            else if (name == "--connections") settings.connections = std::max(1, value);
+            else if (name == "--seconds") settings.seconds = std::max(1, value);
+            else if (name == "--writes") settings.writePercent = std::clamp(value, 0, 100);
+            else if (name == "--users") settings.users = std::max(0, value);
+            else return false;
+        }
+        if (settings.users == 0) settings.users = settings.connections;
+        return true;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    Settings settings;
+    if (!parseSettings(argc, argv, settings)) {
+        std::cerr << "Usage: " << argv[0]
+                << " [--port=N] [--connections=N] [--seconds=N] [--writes=PERCENT] [--users=N]\n";
+        return 1;
+    }
+    Logger::getInstance().setLogLevel(LogLevel::NONE);
+
+    // In-process server unless one is already running
+    MemoryStore store;
+    std::unique_ptr<PersistenceQueue> queue;
+    std::unique_ptr<WishlistService> service;
+    std::unique_ptr<HttpServer> server;
+    if (settings.port < 0) {
+        store.initialize();
+        queue = std::make_unique<PersistenceQueue>(store);
+        service = std::make_unique<WishlistService>(store, *queue);
+        HttpServer::Options options;
+        options.port = 0;
+        server = std::make_unique<HttpServer>([&](const HttpRequest &request) { return service->handle(request); },
+                                              options);
+        if (!server->start()) {
+            std::cerr << "Could not start the server\n";
+            return 1;
+        }
+        settings.port = server->getPort();
+    }
+
+    std::cerr << settings.connections << " connection(s), " << settings.users << " user(s), "
+            << settings.writePercent << "% writes, " << settings.seconds << " s against port " << settings.port
+            << '\n';
+
+    auto start = Clock::now();
+    auto deadline = start + std::chrono::seconds(settings.seconds);
+    std::vector<ConnectionResult> results(settings.connections);
+    std::vector<std::thread> clients;
+    for (int i = 0; i < settings.connections; ++i) {
+        clients.emplace_back(runConnection, std::cref(settings), i, deadline, std::ref(results[i]));
+    }
+    for (auto &client: clients) {
+        client.join();
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<double> latencies;
+    size_t errors = 0;
+    for (const auto &result: results) {
+        latencies.insert(latencies.end(), result.latenciesMs.begin(), result.latenciesMs.end());
+        errors += result.errors;
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    std::cerr << std::fixed << std::setprecision(3)
+            << "requests:    " << latencies.size() << " (" << errors << " failed)\n"
+            << "throughput:  " << std::setprecision(0) << static_cast<double>(latencies.size()) / seconds
+            << " requests/s\n" << std::setprecision(3)
+            << "latency p50: " << percentile(latencies, 0.50) << " ms\n"
+            << "latency p90: " << percentile(latencies, 0.90) << " ms\n"
+            << "latency p99: " << percentile(latencies, 0.99) << " ms\n"
+            << "latency max: " << (latencies.empty() ? 0.0 : latencies.back()) << " ms\n";
+
+    if (server) server->stop();
+    return errors == 0 ? 0 : 1;
+}
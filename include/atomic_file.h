@@ -0,0 +1,22 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+
+#ifndef CHISTMAS_WISHLIST_ATOMIC_FILE_H
+#define CHISTMAS_WISHLIST_ATOMIC_FILE_H
+
+#include <string>
+#include <string_view>
+
+// Crash-safe file replacement. After a crash or a failed write, path holds
+// either the complete old or the complete new content, never a mix.
+namespace AtomicFile {
+    // Writes content to a temporary file next to path in one write, fsyncs it,
+    // renames it over path and fsyncs the directory. With keepBackup the
+    // previous content stays available as path + ".bak".
+    bool write(const std::string &path, std::string_view content, bool keepBackup = false);
+
+    std::string backupPath(const std::string &path);
+}
+
+#endif //CHISTMAS_WISHLIST_ATOMIC_FILE_H
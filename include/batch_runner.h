@@ -0,0 +1,105 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+
+#ifndef CHISTMAS_WISHLIST_BATCH_RUNNER_H
+#define CHISTMAS_WISHLIST_BATCH_RUNNER_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <istream>
+#include <ostream>
+
+#include "wishlist_manager.h"
+
+class IWishlistStore;
+class JsonWriter;
+
+struct BatchCommand {
+    std::string name; // Without leading dashes, e.g. "add"
+    std::vector<std::string> args;
+};
+
+// Runs wishlist commands without prompts, for scripts and timed runs.
+//
+// Commands:
+//   user NAME                                         switch to (and create) a user
+//   add NAME PRICE [CATEGORY [PRIORITY [NOTES [LINK]]]]
+//   remove ID | purchase ID | budget AMOUNT
+//   import FILE [csv|json]  export FILE [csv|json|dat]   "-" is stdin/stdout
+//   list | search QUERY | stats | save
+//   script FILE                                       one command per line, # comments
+//
+// Every command prints one JSON object on its own line, e.g.
+//   {"command":"add","id":7,"ok":true,"ms":0.04}
+// with "error" instead of the command's results when it fails.
+class BatchRunner {
+public:
+    struct Options {
+        bool stopOnError = true;
+        int maxScriptDepth = 8; // Scripts may run scripts, but not endlessly
+    };
+
+private:
+    IWishlistStore &store;
+    PersistenceQueue *queue;
+    std::ostream &out;
+    Options options;
+    std::unique_ptr<WishlistManager> manager;
+    int scriptDepth = 0;
+    size_t commandsRun = 0;
+    size_t failures = 0;
+
+    // Writes the command's results into result; returns false and sets error on failure
+    bool execute(const BatchCommand &command, JsonWriter &result, std::string &error);
+
+    bool switchUser(const std::string &name, JsonWriter &result, std::string &error);
+
+    bool addItem(const std::vector<std::string> &args, JsonWriter &result, std::string &error);
+
+    bool importFile(const std::vector<std::string> &args, JsonWriter &result, std::string &error);
+
+    bool exportFile(const std::vector<std::string> &args, JsonWriter &result, std::string &error);
+
+    bool runScriptFile(const std::string &file, JsonWriter &result, std::string &error);
+
+    // A failure outside any command, e.g. an unparsable script line
+    void reportFailure(const std::string &name, const std::string &error);
+
+public:
+    // queue may be null; then every change is written to the store right away
+    BatchRunner(IWishlistStore &store, PersistenceQueue *queue, std::ostream &out, Options options);
+
+    BatchRunner(IWishlistStore &store, PersistenceQueue *queue, std::ostream &out);
+
+    ~BatchRunner();
+
+    bool run(const BatchCommand &command);
+
+    // Stops at the first failing command unless options.stopOnError is off
+    bool run(const std::vector<BatchCommand> &commands);
+
+    bool runScript(std::istream &in);
+
+    // Writes queued changes; false if any could not be written
+    bool finish();
+
+    // Commands that failed so far, including those inside scripts
+    size_t getFailureCount() const { return failures; }
+
+    static bool isCommand(const std::string &name);
+
+    // Splits a script line at whitespace. "double quotes" group words, a
+    // backslash escapes the next character and # starts a comment.
+    // Returns false on an unterminated quote.
+    static bool tokenize(const std::string &line, std::vector<std::string> &tokens);
+
+    // Groups command line arguments: "--add Lego 49.99 toys" or "--user=Bob"
+    // starts a command, the following arguments without "--" are its own.
+    // Returns false and sets error for an argument that is no command.
+    static bool parseArguments(const std::vector<std::string> &args, std::vector<BatchCommand> &commands,
+                               std::string &error);
+};
+
+#endif //CHISTMAS_WISHLIST_BATCH_RUNNER_H
@@ -0,0 +1,79 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+
+#ifndef CHISTMAS_WISHLIST_BULK_IMPORTER_H
+#define CHISTMAS_WISHLIST_BULK_IMPORTER_H
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <mutex>
+
+#include "wishlist_store.h"
+
+class WishlistManager;
+
+// Outcome of importing one file
+struct ImportFileReport {
+    std::string path;
+    std::string owner;
+    size_t bytes = 0;
+    size_t items = 0;
+    double parseSeconds = 0.0;
+    double writeSeconds = 0.0;
+    bool success = false;
+    std::string error;
+
+    double megabytesPerSecond() const;
+};
+
+struct BulkImportReport {
+    std::vector<ImportFileReport> files; // In file name order
+    size_t totalItems = 0;
+    size_t failedFiles = 0;
+    double seconds = 0.0;
+
+    // One line per file, then the totals
+    void print(std::ostream &out) const;
+};
+
+// Imports every wishlist_<name>.dat and .csv file of a directory into a store.
+//
+// Files are parsed in parallel on a pool of worker threads, largest first so
+// one big file does not finish last. Writes are serialized: each file's items
+// are saved with new IDs in one transaction for its owner, so a failing file
+// leaves nothing behind and the remaining files are still imported.
+//
+// The owner is <name> for files named wishlist_<name>.dat or .csv. Otherwise
+// it is the owner line of a .dat file, or the file name without extension.
+class BulkImporter {
+public:
+    struct Options {
+        unsigned threads = 0; // 0 = one per hardware thread
+    };
+
+private:
+    IWishlistStore &store;
+    Options options;
+    std::mutex storeMutex;
+
+    void importFile(ImportFileReport &report);
+
+    bool writeItems(ImportFileReport &report, WishlistManager &manager, bool withBudget);
+
+public:
+    explicit BulkImporter(IWishlistStore &store, Options options);
+
+    explicit BulkImporter(IWishlistStore &store);
+
+    BulkImportReport importDirectory(const std::string &directory);
+
+    // The .dat and .csv files of directory, sorted by name; not recursive
+    static std::vector<std::string> findImportFiles(const std::string &directory);
+
+    // <name> of wishlist_<name>.ext, empty for other file names
+    static std::string ownerFromFileName(const std::string &path);
+};
+
+#endif //CHISTMAS_WISHLIST_BULK_IMPORTER_H
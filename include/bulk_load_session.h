@@ -0,0 +1,86 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+
+#ifndef CHISTMAS_WISHLIST_BULK_LOAD_SESSION_H
+#define CHISTMAS_WISHLIST_BULK_LOAD_SESSION_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <sqlite3.h>
+
+#include "wishlist.h"
+
+class DatabaseHandler;
+
+// Loads large numbers of items with far less overhead than per-row saveItem.
+//
+// Rows are first staged in a separate database file attached as "bulk", with
+// relaxed durability (synchronous=OFF, journal_mode=MEMORY) and no indexes.
+// commit() then moves them into the main database in one transaction with the
+// item indexes and per-row triggers dropped, rebuilds them and runs ANALYZE.
+// A crash at any point leaves the main database as it was before the session.
+//
+// Queued writes (PersistenceQueue) must be flushed before a session starts.
+class BulkLoadSession {
+public:
+    struct Options {
+        size_t rowsPerStatement = 100; // Rows per reused multi-row INSERT
+        bool keepIds = false; // Keep the items' IDs instead of letting the DB assign new ones
+    };
+
+private:
+    struct StagedRow {
+        std::string owner;
+        WishItem item{};
+    };
+
+    DatabaseHandler &dbHandler;
+    Options options;
+    std::string stagingPath;
+    sqlite3_stmt *batchInsert = nullptr;
+    std::vector<StagedRow> buffer;
+    size_t stagedCount = 0;
+    bool active = false;
+
+    // The connection's writer, held for the whole session: the staging
+    // transaction spans the connection, so other threads' writes must wait
+    std::unique_lock<std::recursive_timed_mutex> writer;
+
+    bool writeBuffer();
+
+    bool bindRow(sqlite3_stmt *stmt, int firstParam, const StagedRow &row);
+
+    bool moveIntoMain();
+
+    void cleanup();
+
+public:
+    explicit BulkLoadSession(DatabaseHandler &handler, Options options);
+
+    explicit BulkLoadSession(DatabaseHandler &handler);
+
+    ~BulkLoadSession();
+
+    BulkLoadSession(const BulkLoadSession &) = delete;
+
+    BulkLoadSession &operator=(const BulkLoadSession &) = delete;
+
+    // Attaches and prepares the staging database
+    bool begin();
+
+    bool addItem(const WishItem &item, const std::string &owner);
+
+    // Moves all staged rows into the main database; false leaves it untouched
+    bool commit();
+
+    // Discards all staged rows
+    void abort();
+
+    bool isActive() const { return active; }
+
+    size_t getStagedCount() const { return stagedCount; }
+};
+
+#endif //CHISTMAS_WISHLIST_BULK_LOAD_SESSION_H
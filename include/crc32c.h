@@ -0,0 +1,21 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+
+#ifndef CHISTMAS_WISHLIST_CRC32C_H
+#define CHISTMAS_WISHLIST_CRC32C_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string_view>
+
+// CRC-32C (Castagnoli), as used by iSCSI, ext4 and LevelDB. Uses the SSE4.2
+// crc32 instruction when the CPU has it and a lookup table otherwise.
+// Pass the previous result as crc to checksum data in several pieces.
+uint32_t crc32c(uint32_t crc, const void *data, size_t length);
+
+inline uint32_t crc32c(std::string_view data, uint32_t crc = 0) {
+    return crc32c(crc, data.data(), data.size());
+}
+
+#endif //CHISTMAS_WISHLIST_CRC32C_H
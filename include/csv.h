@@ -0,0 +1,102 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+
+#ifndef CHISTMAS_WISHLIST_CSV_H
+#define CHISTMAS_WISHLIST_CSV_H
+
+#include <array>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <ostream>
+#include <cstddef>
+
+struct CsvOptions {
+    char delimiter = ',';
+    bool writeBom = false; // Lets spreadsheet programs detect UTF-8
+    bool crlf = true;      // Line break written after each record; RFC 4180 asks for CRLF
+};
+
+// RFC 4180 CSV. Fields containing the delimiter, a quote or a line break are
+// enclosed in quotes with inner quotes doubled. The scans for those
+// characters use AVX2 or SSE2 when available and a byte loop otherwise.
+namespace Csv {
+    constexpr std::string_view BOM{"\xEF\xBB\xBF"};
+
+    // Index of the first byte of text equal to any of needles, or text.size()
+    size_t findFirstOf(std::string_view text, const std::array<char, 4> &needles);
+
+    // Same result as findFirstOf, one byte at a time
+    size_t findFirstOfScalar(std::string_view text, const std::array<char, 4> &needles);
+
+    // "avx2", "sse2" or "scalar"
+    const char *scanImplementation();
+
+    // Like ParallelParser::splitChunks, but only cuts at line breaks outside
+    // quoted fields, so every chunk holds whole records as CsvReader reads them
+    std::vector<std::string_view> splitRecords(std::string_view text, unsigned maxChunks, size_t minChunkBytes,
+                                               char delimiter = ',');
+}
+
+// Reads records from text in memory (typically a MappedFile). A leading BOM
+// is skipped; records may end in LF, CRLF or CR. Malformed input is read
+// leniently: a quote inside an unquoted field is kept as is, and an
+// unterminated quoted field runs to the end of the text.
+class CsvReader {
+private:
+    std::string_view text;
+    size_t position = 0;
+    char delimiter;
+    size_t records = 0;
+
+    size_t readQuoted(std::string &field);
+
+public:
+    explicit CsvReader(std::string_view text, char delimiter = ',');
+
+    // Replaces fields with the next record's fields. The strings are reused,
+    // so a loop over one vector allocates only while fields still grow.
+    // Returns false at the end of the text.
+    bool next(std::vector<std::string> &fields);
+
+    // Text not read yet, starting at a record boundary
+    std::string_view rest() const { return text.substr(position); }
+
+    size_t getRecordCount() const { return records; }
+};
+
+// Writes records to a stream through an internal buffer. Call field() for
+// each value and endRecord() after each record; flush() or destruction
+// writes out what is buffered.
+class CsvWriter {
+private:
+    std::ostream &out;
+    CsvOptions options;
+    std::string buffer;
+    bool recordStarted = false;
+
+    void separate();
+
+public:
+    explicit CsvWriter(std::ostream &out, CsvOptions options = CsvOptions());
+
+    ~CsvWriter();
+
+    CsvWriter(const CsvWriter &) = delete;
+
+    CsvWriter &operator=(const CsvWriter &) = delete;
+
+    CsvWriter &field(std::string_view value);
+
+    CsvWriter &field(double value);
+
+    CsvWriter &field(int value);
+
+    void endRecord();
+
+    // False if the stream failed
+    bool flush();
+};
+
+#endif //CHISTMAS_WISHLIST_CSV_H
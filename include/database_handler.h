@@ -6,66 +6,346 @@
 #define CHISTMAS_WISHLIST_DATABASE_HANDLER_H
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
+#include <functional>
+#include <iterator>
+#include <ctime>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <atomic>
 #include <sqlite3.h>
 #include "../include/wishlist.h"
 #include "../include/wishlist_manager.h"
+#include "../include/item_query.h"
+#include "../include/wishlist_store.h"
 
-class DatabaseHandler {
+struct PriceSummary {
+    int samples = 0;
+    double minPrice = 0.0;
+    double maxPrice = 0.0;
+    double latestPrice = 0.0;
+    std::time_t latestTime = 0;
+};
+
+// One downsampled interval of a price series
+struct PriceBucket {
+    std::time_t start;
+    double minPrice;
+    double maxPrice;
+    double avgPrice;
+    double lastPrice;
+    int samples;
+};
+
+struct PriceDrop {
+    int itemId = 0;
+    std::string name;
+    double peakPrice = 0.0; // Highest recorded price in the window
+    double currentPrice = 0.0;
+    double dropPercent = 0.0;
+};
+
+// Items of one price_bucket() interval
+struct PriceHistogramBin {
+    double lowerBound; // Bin covers [lowerBound, lowerBound + width)
+    int count;
+    double totalValue;
+    int purchasedCount;
+};
+
+// A user_stats or user_category_stats field that differs from the value
+// recomputed from items
+struct StatsDrift {
+    std::string username;
+    std::string field;
+    double stored;
+    double actual;
+    std::string category; // Empty for the user's overall totals
+};
+
+// Called after every backup/restore step with the pages still to copy and the
+// total page count. Returning false cancels the operation.
+using BackupProgress = std::function<bool(int remaining, int total)>;
+
+using WalListener = std::function<void(int walPages)>;
+
+// One row written on the connection, as reported by sqlite3_update_hook
+struct RowChange {
+    enum class Operation { INSERTED, UPDATED, DELETED };
+
+    Operation operation;
+    std::string table;
+    int64_t rowId;
+};
+
+// Receives the row changes of each committed transaction. Called on the
+// committing thread while SQLite finishes the commit, so it must not use the
+// connection; record what changed and re-read later.
+using ChangeListener = std::function<void(const std::vector<RowChange> &changes)>;
+
+// Forward-only cursor over the rows of a query. Rows are fetched from SQLite
+// one at a time, so memory stays constant regardless of the result size.
+// Must not outlive the DatabaseHandler that created it.
+class ItemCursor {
+private:
+    sqlite3_stmt *stmt;
+    ItemRowView current;
+
+public:
+    explicit ItemCursor(sqlite3_stmt *stmt = nullptr);
+
+    ~ItemCursor();
+
+    ItemCursor(const ItemCursor &) = delete;
+
+    ItemCursor &operator=(const ItemCursor &) = delete;
+
+    ItemCursor(ItemCursor &&other) noexcept;
+
+    ItemCursor &operator=(ItemCursor &&other) noexcept;
+
+    bool isValid() const { return stmt != nullptr; }
+
+    // Advances to the next row; returns false when no rows are left
+    bool step();
+
+    // View of the current row, valid until the next step()
+    const ItemRowView &row() const { return current; }
+
+    // Fills item with the next row; returns false when no rows are left
+    bool next(WishItem &item);
+
+    // Single-pass input range: for (const ItemRowView &row : cursor)
+    class Iterator {
+    private:
+        ItemCursor *cursor;
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = ItemRowView;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const ItemRowView *;
+        using reference = const ItemRowView &;
+
+        explicit Iterator(ItemCursor *cursor) : cursor(cursor) {
+            if (cursor && !cursor->step()) this->cursor = nullptr;
+        }
+
+        reference operator*() const { return cursor->row(); }
+        pointer operator->() const { return &cursor->row(); }
+
+        Iterator &operator++() {
+            if (!cursor->step()) cursor = nullptr;
+            return *this;
+        }
+
+        bool operator==(const Iterator &other) const { return cursor == other.cursor; }
+        bool operator!=(const Iterator &other) const { return cursor != other.cursor; }
+    };
+
+    Iterator begin() { return Iterator(stmt ? this : nullptr); }
+    Iterator end() { return Iterator(nullptr); }
+};
+
+class DatabaseHandler : public IWishlistStore {
 private:
     sqlite3 *db;
     std::string dbPath;
+    bool ftsAvailable;
+    WalListener walListener;
+
+    // Changes of the open transaction; only touched by hooks, which run under the connection mutex
+    std::vector<RowChange> uncommittedChanges;
+    std::vector<std::pair<int, ChangeListener> > changeListeners;
+    std::atomic<bool> hasChangeListeners{false};
+    int nextListenerId = 1;
+    std::mutex listenerMutex;
+
+    // Held by the thread writing on the connection. A transaction keeps it from
+    // begin until commit or rollback, so other threads' writes wait for it instead
+    // of landing in it; recursive, as the transaction's own writes take it again.
+    std::recursive_timed_mutex writerMutex;
+    std::atomic<std::thread::id> transactionThread{};
+
+    // Takes writerMutex; the lock is not owned if WRITER_TIMEOUT passed first
+    std::unique_lock<std::recursive_timed_mutex> lockWriter();
+
+    // Runs COMMIT or ROLLBACK for the calling thread's transaction and releases the writer
+    bool endTransaction(const char *sql);
+
+    static int walHook(void *handler, sqlite3 *db, const char *schema, int walPages);
+
+    static void updateHook(void *handler, int operation, const char *schema, const char *table, sqlite3_int64 rowId);
+
+    static int commitHook(void *handler);
+
+    static void rollbackHook(void *handler);
 
     bool executeSQL(const std::string &sql);
 
+    bool createFullTextIndex();
+
+    bool createUserStats();
+
     bool prepareStatement(const std::string &sql, sqlite3_stmt **stmt);
 
+    friend class BulkLoadSession;
+
 public:
+    static constexpr std::chrono::seconds WRITER_TIMEOUT{5}; // Like the busy timeout
+
     DatabaseHandler(const std::string &dbPath = "wishlist.db");
 
-    ~DatabaseHandler();
+    ~DatabaseHandler() override;
 
     //Database initialization
-    bool initialize();
+    bool initialize() override;
+
+    std::string getName() const override { return "sqlite"; }
 
     bool createTables();
 
     //User operations
-    bool createUser(const std::string &username);
+    bool createUser(const std::string &username) override;
 
     int getUserId(const std::string &username);
 
-    bool userExists(const std::string &username);
+    bool userExists(const std::string &username) override;
 
-    std::vector<std::string> getAllUsers();
+    std::vector<std::string> getAllUsers() override;
 
     // Item operations
-    bool saveItem(const WishItem &item, const std::string &owner);
+    bool saveItem(const WishItem &item, const std::string &owner) override;
 
     bool updateItem(const WishItem &item, const std::string &owner);
 
-    bool deleteItem(int itemId, const std::string &owner);
+    bool deleteItem(int itemId, const std::string &owner) override;
+
+    std::vector<std::unique_ptr<WishItem> > loadItems(const std::string &owner) override;
+
+    // Loads a single item by ID together with its owner's name
+    bool loadItem(int itemId, WishItem &item, std::string &owner);
+
+    // Ranked full-text search over name and notes. Words match as prefixes,
+    // "quoted text" matches as a phrase.
+    std::vector<std::unique_ptr<WishItem> > searchItems(const std::string &owner, const std::string &query,
+                                                        int limit = 50) override;
 
-    std::vector<std::unique_ptr<WishItem> > loadItems(const std::string &owner);
+    // Items whose name is similar to text by trigram_sim(), most similar first.
+    // Tolerates typos and word order, unlike searchItems.
+    std::vector<std::unique_ptr<WishItem> > fuzzySearchItems(const std::string &owner, const std::string &text,
+                                                             double minSimilarity = 0.3, int limit = 50);
+
+    // Streams the owner's items in ID order; return false from the callback to stop early.
+    // Returns the number of rows visited.
+    size_t forEachItem(const std::string &owner, const std::function<bool(const ItemRowView &)> &callback) override;
+
+    //Price history (recorded by triggers whenever an item's price changes)
+    bool recordPrice(int itemId, double price, std::time_t recordedAt);
+
+    static constexpr std::time_t END_OF_TIME = 253402300799; // 9999-12-31 23:59:59 UTC
+
+    PriceSummary getPriceSummary(int itemId, std::time_t from = 0, std::time_t to = END_OF_TIME);
+
+    // Prices in [from, to) grouped into buckets of bucketSeconds, oldest first
+    std::vector<PriceBucket> getPriceSeries(int itemId, std::time_t from, std::time_t to, int bucketSeconds);
+
+    // Items whose current price is at least minDropPercent below their peak since 'since'
+    std::vector<PriceDrop> findPriceDrops(const std::string &owner, std::time_t since, double minDropPercent);
+
+    // Downsamples rows older than olderThan to one per item and bucket; returns rows removed or -1
+    int compactPriceHistory(std::time_t olderThan, int bucketSeconds);
 
     //Budget operations
-    bool saveBudget(const Budget &budget, const std::string &owner);
+    bool saveBudget(const Budget &budget, const std::string &owner) override;
+
+    Budget loadBudget(const std::string &owner) override;
+
+    //Queries evaluated inside SQLite
+    ItemCursor queryItems(const std::string &owner, const ItemQuery &query);
+
+    size_t queryItems(const std::string &owner, const ItemQuery &query,
+                      const std::function<bool(const ItemRowView &)> &callback) override;
 
-    Budget loadBudget(const std::string &owner);
+    std::vector<std::unique_ptr<WishItem> > findItems(const std::string &owner, const ItemQuery &query) override;
+
+    ItemStats queryStats(const std::string &owner, const ItemQuery &query = ItemQuery()) override;
+
+    //Statistics (materialized in user_stats by triggers)
+    ItemStats getUserStats(const std::string &owner);
 
-    //Statistics
     int getTotalItemsCount(const std::string &owner);
 
+    // Item counts per price interval of bucketWidth, cheapest first; empty intervals are left out
+    std::vector<PriceHistogramBin> getPriceHistogram(const std::string &owner, double bucketWidth);
+
     double getTotalValue(const std::string &owner);
 
+    bool rebuildUserStats();
+
+    // Recomputes every user's totals, overall and per category, from items and
+    // reports fields that drifted
+    std::vector<StatsDrift> checkStatsConsistency(double tolerance = 1e-6);
+
+    //Change notification. Changes made through other connections are not reported.
+    int addChangeListener(ChangeListener listener);
+
+    void removeChangeListener(int listenerId);
+
+    //Transactions. A transaction belongs to the thread that began it; writes of
+    //other threads wait until it ends, failing after WRITER_TIMEOUT. Their reads
+    //share the connection and see its uncommitted changes.
+    bool beginTransaction() override;
+
+    bool commitTransaction() override;
+
+    bool rollbackTransaction() override;
+
     //Utility
-    bool clearAllData(const std::string &owner);
+    bool clearAllData(const std::string &owner) override;
 
-    bool vacuum(); //Optimize database
+    bool vacuum(); //Full rebuild; also converts older files to incremental auto-vacuum
     std::string getLastError() const;
 
-    int getGlobalMaxItemId();
+    const std::string &getPath() const { return dbPath; }
+
+    // Rows changed through this connection since it was opened
+    int64_t getChangeCount() const;
+
+    // Replaces SQLite's auto-checkpoint with a callback receiving the WAL size in
+    // pages after each commit. Runs on the committing thread and must not use the
+    // connection. An empty listener restores the default auto-checkpoint.
+    void setWalListener(WalListener listener);
+
+    //Online backup. Copies pagesPerStep pages at a time and sleeps for pause in
+    //between, so the source is only locked for one short step at a time. The copy
+    //is written next to path and renamed into place once complete.
+    bool backupTo(const std::string &path, int pagesPerStep = 256, const BackupProgress &progress = nullptr,
+                  std::chrono::milliseconds pause = std::chrono::milliseconds(10));
+
+    //Replaces the whole database with the backup at path and upgrades its schema
+    bool restoreFrom(const std::string &path, int pagesPerStep = 256, const BackupProgress &progress = nullptr,
+                     std::chrono::milliseconds pause = std::chrono::milliseconds(0));
+
+    int getGlobalMaxItemId() override;
+
+    //Query plan inspection
+    static std::string buildItemQuerySql(const ItemQuery &query);
+
+    static std::string buildStatsSql(const ItemQuery &query);
+
+    static std::string buildFtsQuery(const std::string &text);
+
+    bool isFullTextSearchAvailable() const { return ftsAvailable; }
+
+    // Name and SQL of every statement this class runs, with representative dynamic queries
+    static std::vector<std::pair<std::string, std::string> > statementCatalog();
+
+    // Detail column of EXPLAIN QUERY PLAN for sql (empty for statements that read no table)
+    bool explainQueryPlan(const std::string &sql, std::vector<std::string> &plan);
 };
 
 #endif //CHISTMAS_WISHLIST_DATABASE_HANDLER_H
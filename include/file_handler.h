@@ -6,22 +6,101 @@
 #define CHISTMAS_WISHLIST_FILE_HANDLER_H
 
 #include <string>
+#include <string_view>
+#include <istream>
+#include <ostream>
 #include "wishlist_manager.h"
+#include "csv.h"
 
+enum class FileFormat {
+    TEXT, // Pipe-delimited lines
+    BINARY // Snapshot with checksums, see snapshot.h
+};
+
+// Every operation exists for a file name and for a stream. The stream
+// versions allow pipes and in-memory buffers; for the import and export
+// functions the file name "-" (STANDARD_STREAM) means stdin or stdout.
 class FileHandler {
 private:
     std::string filename;
+    unsigned parseThreads = 0;
+    FileFormat format = FileFormat::TEXT;
+    bool keepBackup = false;
+
+    std::string encode(const WishlistManager &manager) const;
+
+    // Parses either format; source names the input in messages. Returns the
+    // number of items read, or -1 for a corrupt snapshot or, if strict, for
+    // text lines that do not parse.
+    int decode(std::string_view data, WishlistManager &manager, const std::string &source, bool strict) const;
+
+    // Returns the number of items added
+    static int importCsvText(WishlistManager &manager, std::string_view text, unsigned threads,
+                             const CsvOptions &options);
+
+    // Returns the number of items added, or -1 on invalid JSON
+    static int importJsonStream(WishlistManager &manager, std::istream &in);
 
 public:
+    static constexpr const char *STANDARD_STREAM = "-";
+
     explicit FileHandler(const std::string &filename = "wishlist.dat");
 
+    // Writes in the format set with setFormat. The file is replaced atomically,
+    // so a crash or a full disk during the save leaves the previous version.
     bool save(const WishlistManager &manager);
 
+    bool save(const WishlistManager &manager, std::ostream &out);
+
+    // Reads either format, detected from the file's first bytes
     bool load(WishlistManager &manager);
 
-    bool exportToCSV(const WishlistManager &manager, const std::string &csvFile);
+    // Reads the rest of the stream, then parses it like a file
+    bool load(WishlistManager &manager, std::istream &in);
+
+    // Like load, but tells an intact file without items (0) from one that is
+    // missing or damaged (-1): a snapshot failing its checks, or text lines
+    // that do not parse, which load skips
+    int loadStrict(WishlistManager &manager);
+
+    void setFormat(FileFormat newFormat) { format = newFormat; }
+
+    FileFormat getFormat() const { return format; }
+
+    // Keep the version replaced by each save as <filename>.bak
+    void setKeepBackup(bool keep) { keepBackup = keep; }
+
+    // Threads parsing the items of large files; 0 (the default) uses all hardware
+    // threads. Files below ParallelParser::MIN_CHUNK_BYTES are always read by one.
+    void setParseThreads(unsigned threads) { parseThreads = threads; }
+
+    // RFC 4180 CSV with a header record; fields are quoted where needed
+    bool exportToCSV(const WishlistManager &manager, const std::string &csvFile,
+                     const CsvOptions &options = CsvOptions());
+
+    bool exportToCSV(const WishlistManager &manager, std::ostream &out, const CsvOptions &options = CsvOptions());
+
+    // Reads what exportToCSV writes, including quoted delimiters and line breaks.
+    // options.delimiter must match the file's.
+    static bool importFromCSV(WishlistManager &manager, const std::string &csvFile, unsigned threads = 0,
+                              const CsvOptions &options = CsvOptions());
+
+    // Records may span lines, so the stream is read to its end before parsing
+    static bool importFromCSV(WishlistManager &manager, std::istream &in, unsigned threads = 0,
+                              const CsvOptions &options = CsvOptions());
+
+    // {"owner": ..., "budget": {...}, "items": [{"id": ..., "name": ..., ...}]},
+    // written as it goes without building a document in memory
+    bool exportToJSON(const WishlistManager &manager, const std::string &jsonFile);
+
+    bool exportToJSON(const WishlistManager &manager, std::ostream &out);
+
+    // Adds the items of a file written by exportToJSON with new IDs, like
+    // importFromCSV; owner and budget are left alone. The input is parsed in
+    // fixed-size chunks, so memory does not grow with the number of items.
+    static bool importFromJSON(WishlistManager &manager, const std::string &jsonFile);
 
-    static bool importFromCSV(WishlistManager &manager, const std::string &csvFile);
+    static bool importFromJSON(WishlistManager &manager, std::istream &in);
 };
 
 #endif //CHISTMAS_WISHLIST_FILE_HANDLER_H
@@ -0,0 +1,93 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+
+#ifndef CHISTMAS_WISHLIST_FILE_STORE_H
+#define CHISTMAS_WISHLIST_FILE_STORE_H
+
+#include <string>
+#include <deque>
+#include <thread>
+#include <condition_variable>
+#include <atomic>
+
+#include "memory_store.h"
+
+class WishlistManager;
+
+// Store backed by the flat files FileHandler reads and writes, one
+// wishlist_<owner>.dat per owner in a directory. All files are loaded on
+// initialize(); queries run in memory and every committed change rewrites
+// the affected owner's file.
+//
+// In journal mode a commit instead appends the items and budget it touched to
+// wishlist_<owner>.journal, so its cost follows the size of the change rather
+// than of the list. initialize() replays the journal over the .dat snapshot;
+// a background thread folds the journal into a fresh binary snapshot once it
+// outgrows compactRatio times the snapshot.
+class FileStore : public MemoryStore {
+public:
+    struct JournalOptions {
+        bool enabled = false;
+        double compactRatio = 1.0;           // Journal size relative to the snapshot that triggers compaction
+        size_t minCompactBytes = 64 * 1024;  // Journals below this size are never compacted
+    };
+
+private:
+    std::string directory;
+    JournalOptions journal;
+
+    // Per owner, guarded by the store mutex
+    std::map<std::string, size_t> journalBytes;
+    std::map<std::string, size_t> snapshotBytes;
+
+    std::thread compactor;
+    std::mutex compactorMutex;
+    std::condition_variable compactorWakeup;
+    std::deque<std::string> compactQueue;
+    bool stopping = false;
+    std::mutex compactionMutex; // One compaction at a time
+    std::atomic<int> compactions{0};
+
+    bool persistOwner(const std::string &owner) override;
+
+    bool persistChanges(const std::string &owner, const OwnerChanges &changes) override;
+
+    // Owner's data as a manager, the form FileHandler writes
+    void fillManager(const std::string &owner, WishlistManager &manager) const;
+
+    // Applies the intact part of owner's journal and cuts off a torn tail
+    bool replayJournal(const std::string &owner);
+
+    void scheduleCompaction(const std::string &owner);
+
+    void compactorLoop();
+
+public:
+    explicit FileStore(const std::string &directory, JournalOptions journal);
+
+    explicit FileStore(const std::string &directory = ".");
+
+    ~FileStore() override;
+
+    FileStore(const FileStore &) = delete;
+
+    FileStore &operator=(const FileStore &) = delete;
+
+    bool initialize() override;
+
+    std::string getName() const override { return "file"; }
+
+    std::string pathFor(const std::string &owner) const;
+
+    std::string journalPathFor(const std::string &owner) const;
+
+    bool isJournaling() const { return journal.enabled; }
+
+    // Writes owner's snapshot and drops the journal records it contains
+    bool compact(const std::string &owner);
+
+    int getCompactionCount() const { return compactions.load(); }
+};
+
+#endif //CHISTMAS_WISHLIST_FILE_STORE_H
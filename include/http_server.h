@@ -0,0 +1,157 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+
+#ifndef CHISTMAS_WISHLIST_HTTP_SERVER_H
+#define CHISTMAS_WISHLIST_HTTP_SERVER_H
+
+#include <string>
+#include <string_view>
+#include <map>
+#include <unordered_map>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+struct HttpRequest {
+    std::string method;
+    std::string path; // Percent-decoded, without the query
+    std::map<std::string, std::string> query; // Percent-decoded
+    std::map<std::string, std::string> headers; // Names in lower case
+    std::string body;
+    bool keepAlive = true;
+
+    // Empty if the header is missing; name in lower case
+    std::string header(const std::string &name) const;
+};
+
+struct HttpResponse {
+    int status = 200;
+    std::string contentType = "application/json";
+    std::string body;
+
+    // {"error": message} with the given status
+    static HttpResponse error(int status, const std::string &message);
+
+    static const char *reason(int status);
+};
+
+enum class HttpParseResult {
+    COMPLETE,
+    INCOMPLETE, // Needs more bytes
+    INVALID,
+    TOO_LARGE,
+    LENGTH_REQUIRED // Chunked transfer encoding, which is not supported
+};
+
+// Minimal HTTP/1.1 server for the loopback interface.
+//
+// One thread waits in epoll for new connections and readable sockets. A ready
+// connection is handed to the worker pool, registered with EPOLLONESHOT so only
+// one worker owns it at a time. The worker reads what is there, answers every
+// complete request (pipelined ones in order) and re-arms the connection, which
+// stays open until the client closes it, sends "Connection: close" or sends
+// nothing for Options::idleTimeout. A worker reads at most one request's worth
+// (MAX_HEADER_BYTES + maxBodyBytes) at a time; larger requests get 413.
+// Bodies need a Content-Length; chunked requests are answered with 411.
+class HttpServer {
+public:
+    using Handler = std::function<HttpResponse(const HttpRequest &)>;
+
+    struct Options {
+        std::string address = "127.0.0.1";
+        uint16_t port = 8080; // 0 picks a free port, see getPort()
+        unsigned threads = 0; // Workers; 0 = one per hardware thread
+        size_t maxBodyBytes = 1 << 20;
+        std::chrono::milliseconds idleTimeout{30000}; // Closes keep-alive connections idle this long; 0 = never
+    };
+
+    static constexpr size_t MAX_HEADER_BYTES = 16 * 1024;
+
+private:
+    struct Connection {
+        int fd;
+        std::string input;
+        std::string output;
+        // Guarded by connectionMutex
+        bool busy = false; // Handed to a worker, not waiting in epoll
+        std::chrono::steady_clock::time_point lastActive;
+    };
+
+    Handler handler;
+    Options options;
+    int listenFd = -1;
+    int epollFd = -1;
+    int wakeFd = -1; // eventfd that ends the acceptor's wait on stop()
+    uint16_t boundPort = 0;
+
+    std::thread acceptor;
+    std::vector<std::thread> workers;
+
+    std::mutex connectionMutex;
+    std::unordered_map<int, std::unique_ptr<Connection> > connections;
+
+    std::mutex queueMutex;
+    std::condition_variable queueCondition;
+    std::deque<Connection *> ready;
+    bool stopping = false;
+
+    std::atomic<uint64_t> requestCount{0};
+
+    void acceptLoop();
+
+    void acceptConnections();
+
+    // Closes connections that waited in epoll for longer than idleTimeout
+    void closeIdleConnections();
+
+    void workerLoop();
+
+    // Reads, answers and re-arms; closes the connection when it is done
+    void serve(Connection &connection);
+
+    bool sendAll(Connection &connection);
+
+    void closeConnection(Connection &connection);
+
+    void closeDescriptors();
+
+public:
+    explicit HttpServer(Handler handler, Options options);
+
+    explicit HttpServer(Handler handler);
+
+    ~HttpServer();
+
+    HttpServer(const HttpServer &) = delete;
+
+    HttpServer &operator=(const HttpServer &) = delete;
+
+    // Binds, listens and starts the threads; false if the address is taken
+    bool start();
+
+    // Stops accepting, lets the workers finish and closes all connections
+    void stop();
+
+    uint16_t getPort() const { return boundPort; }
+
+    uint64_t getRequestCount() const { return requestCount.load(); }
+
+    // Parses one request from the front of data; consumed is set on COMPLETE
+    static HttpParseResult parseRequest(std::string_view data, size_t maxBodyBytes, HttpRequest &request,
+                                        size_t &consumed);
+
+    static std::string formatResponse(const HttpResponse &response, bool keepAlive);
+
+    // %XX escapes; plusAsSpace for query strings
+    static std::string percentDecode(std::string_view text, bool plusAsSpace = false);
+};
+
+#endif //CHISTMAS_WISHLIST_HTTP_SERVER_H
@@ -0,0 +1,91 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+
+#ifndef CHISTMAS_WISHLIST_ITEM_CACHE_H
+#define CHISTMAS_WISHLIST_ITEM_CACHE_H
+
+#include <string>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <mutex>
+#include <functional>
+#include <cstdint>
+
+#include "wishlist.h"
+#include "item_query.h"
+
+class DatabaseHandler;
+struct RowChange;
+
+// In-process cache of items and their aggregates per owner that stays
+// coherent with every write made through the DatabaseHandler's connection,
+// whichever code path made it.
+//
+// Committed row changes arrive through a change listener and only mark item
+// IDs as stale. The next read re-fetches just those rows and patches the
+// cached items and stats incrementally instead of reloading the owner.
+class ItemCache {
+public:
+    struct Counters {
+        size_t loads = 0; // Full owner loads
+        size_t patchedRows = 0; // Rows re-fetched after a change
+        size_t invalidations = 0; // Owners dropped because the users table changed
+    };
+
+private:
+    struct OwnerEntry {
+        std::map<int, WishItem> items; // By ID
+        ItemStats stats;
+    };
+
+    DatabaseHandler &dbHandler;
+    int listenerId = 0;
+
+    // Filled by the listener on the committing thread; never held during DB calls
+    std::mutex eventMutex;
+    std::set<int64_t> staleItems;
+    bool usersChanged = false;
+
+    // Cache state; may be held during DB calls
+    mutable std::mutex cacheMutex;
+    std::unordered_map<std::string, OwnerEntry> owners;
+    std::unordered_map<int, std::string> ownerOfItem;
+    Counters counters;
+
+    void onChanges(const std::vector<RowChange> &changes);
+
+    // Applies pending change events; cacheMutex must be held
+    void applyPendingChanges();
+
+    OwnerEntry &load(const std::string &owner);
+
+    void removeCachedItem(int itemId);
+
+public:
+    explicit ItemCache(DatabaseHandler &handler);
+
+    ~ItemCache();
+
+    ItemCache(const ItemCache &) = delete;
+
+    ItemCache &operator=(const ItemCache &) = delete;
+
+    // Visits the owner's items in ID order, loading them on first use.
+    // Returns the number of items visited.
+    size_t forEachItem(const std::string &owner, const std::function<bool(const WishItem &)> &callback);
+
+    bool getItem(int itemId, WishItem &item);
+
+    ItemStats getStats(const std::string &owner);
+
+    bool isCached(const std::string &owner) const;
+
+    // Drops all cached owners
+    void clear();
+
+    Counters getCounters() const;
+};
+
+#endif //CHISTMAS_WISHLIST_ITEM_CACHE_H
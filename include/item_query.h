@@ -0,0 +1,74 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+
+#ifndef CHISTMAS_WISHLIST_ITEM_QUERY_H
+#define CHISTMAS_WISHLIST_ITEM_QUERY_H
+
+#include <string>
+#include <string_view>
+#include <map>
+#include <optional>
+
+#include "wishlist.h"
+#include "wishlist_manager.h"
+
+// Filter that is evaluated inside the database instead of in memory.
+// Unset fields match everything.
+struct ItemQuery {
+    std::optional<Category> category;
+    std::optional<bool> purchased;
+    std::optional<double> minPrice;
+    std::optional<double> maxPrice;
+    std::string nameContains; // Case-insensitive substring (SQL LIKE)
+    SortOrder order = SortOrder::BY_ID;
+    int limit = -1; // -1 = no limit
+    int offset = 0;
+
+    // Filters evaluated in memory, for stores without a query engine
+    bool matches(const WishItem &item) const;
+
+    // Strict weak ordering matching the SQL ORDER BY for 'order'
+    bool comesBefore(const WishItem &a, const WishItem &b) const;
+};
+
+struct CategoryStats {
+    int count = 0;
+    double totalValue = 0.0;
+    double purchasedValue = 0.0;
+};
+
+// Aggregates over the items matching an ItemQuery
+struct ItemStats {
+    int count = 0;
+    double totalValue = 0.0;
+    int purchasedCount = 0;
+    double purchasedValue = 0.0;
+    std::map<Category, CategoryStats> byCategory;
+
+    void add(const WishItem &item);
+
+    // Reverses add(); categories without items are dropped
+    void remove(const WishItem &item);
+};
+
+// Lightweight view of one item row. The text fields borrow the storage of the
+// row (SQLite's column buffers or a stored WishItem) and are only valid until
+// the cursor advances or the callback returns.
+struct ItemRowView {
+    int id = 0;
+    std::string_view name;
+    double price = 0.0;
+    bool purchased = false;
+    Category category = Category::OTHER;
+    Priority priority = Priority::MEDIUM;
+    std::string_view notes;
+    std::string_view link;
+
+    static ItemRowView of(const WishItem &item);
+
+    // Copies the row into an owning WishItem (each string is copied once)
+    void copyTo(WishItem &item) const;
+};
+
+#endif //CHISTMAS_WISHLIST_ITEM_QUERY_H
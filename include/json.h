@@ -0,0 +1,133 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+
+#ifndef CHISTMAS_WISHLIST_JSON_H
+#define CHISTMAS_WISHLIST_JSON_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <ostream>
+#include <cstdint>
+
+// Writes JSON to a stream through an internal buffer, without building a
+// document first. Commas and nesting are tracked by the writer; the caller
+// emits keys and values in order. flush() or destruction writes out what is
+// buffered.
+class JsonWriter {
+private:
+    std::ostream &out;
+    std::string buffer;
+    std::vector<bool> firstInScope; // One entry per open object or array
+    bool afterKey = false;
+
+    void beforeValue();
+
+    void writeString(std::string_view text);
+
+public:
+    explicit JsonWriter(std::ostream &out);
+
+    ~JsonWriter();
+
+    JsonWriter(const JsonWriter &) = delete;
+
+    JsonWriter &operator=(const JsonWriter &) = delete;
+
+    JsonWriter &beginObject();
+
+    JsonWriter &endObject();
+
+    JsonWriter &beginArray();
+
+    JsonWriter &endArray();
+
+    JsonWriter &key(std::string_view name);
+
+    JsonWriter &value(std::string_view text);
+
+    JsonWriter &value(const char *text) { return value(std::string_view(text)); }
+
+    JsonWriter &value(double number);
+
+    JsonWriter &value(int number);
+
+    JsonWriter &value(bool flag);
+
+    JsonWriter &null();
+
+    // False if the stream failed
+    bool flush();
+};
+
+// Receives the events of JsonParser in document order. Strings passed in are
+// only valid during the call. Returning false stops the parse.
+class JsonHandler {
+public:
+    virtual ~JsonHandler() = default;
+
+    virtual bool startObject() { return true; }
+
+    virtual bool endObject() { return true; }
+
+    virtual bool startArray() { return true; }
+
+    virtual bool endArray() { return true; }
+
+    virtual bool key(std::string_view) { return true; }
+
+    virtual bool string(std::string_view) { return true; }
+
+    virtual bool number(double) { return true; }
+
+    virtual bool boolean(bool) { return true; }
+
+    virtual bool null() { return true; }
+};
+
+// Incremental SAX-style JSON parser. Input can be fed in chunks of any size,
+// split anywhere; the parser keeps only the nesting and the token cut off at
+// the end of a chunk, so memory does not grow with the document.
+class JsonParser {
+private:
+    enum class Expect { VALUE, FIRST_VALUE_OR_END, KEY, FIRST_KEY_OR_END, COLON, COMMA_OR_END, DONE };
+
+    JsonHandler &handler;
+    std::vector<char> nesting; // '{' or '['
+    Expect expect = Expect::VALUE;
+    std::string pending; // Start of a token cut off at the end of the last chunk
+    std::string scratch; // Unescaped string
+    std::string errorMessage;
+    uint64_t offset = 0; // Bytes consumed, for error messages
+
+    // Parses one token at the front of text; returns bytes consumed, 0 if the
+    // token may continue in the next chunk, or npos on error
+    size_t parseToken(std::string_view text, bool last);
+
+    size_t parseString(std::string_view text, bool last, bool isKey);
+
+    size_t parseNumber(std::string_view text, bool last);
+
+    size_t parseLiteral(std::string_view text, bool last);
+
+    void afterValue();
+
+    bool consume(std::string_view data, bool last);
+
+    size_t fail(const std::string &message);
+
+public:
+    explicit JsonParser(JsonHandler &handler);
+
+    // Parses as much of data as possible. Returns false on a syntax error or
+    // when the handler stopped the parse.
+    bool feed(std::string_view data);
+
+    // Ends the input; false unless exactly one complete value was read
+    bool finish();
+
+    const std::string &getError() const { return errorMessage; }
+};
+
+#endif //CHISTMAS_WISHLIST_JSON_H
@@ -42,6 +42,10 @@ public:
 
     void setLogLevel(LogLevel level);
 
+    bool isEnabled(LogLevel level) const {
+        return level >= currentLevel && level != LogLevel::NONE;
+    }
+
     void enableConsoleOutput(bool enable);
 
     void setLogFile(const std::string &filename);
@@ -58,21 +62,25 @@ public:
 
     template<typename... Args>
     void debug(Args... args) {
+        if (!isEnabled(LogLevel::DEBUG)) return; // Skip formatting for filtered messages
         log(LogLevel::DEBUG, concatenate(args...));
     }
 
     template<typename... Args>
     void info(Args... args) {
+        if (!isEnabled(LogLevel::INFO)) return; // Skip formatting for filtered messages
         log(LogLevel::INFO, concatenate(args...));
     }
 
     template<typename... Args>
     void warning(Args... args) {
+        if (!isEnabled(LogLevel::WARNING)) return; // Skip formatting for filtered messages
         log(LogLevel::WARNING, concatenate(args...));
     }
 
     template<typename... Args>
     void error(Args... args) {
+        if (!isEnabled(LogLevel::ERROR)) return; // Skip formatting for filtered messages
         log(LogLevel::ERROR, concatenate(args...));
     }
 
@@ -0,0 +1,108 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+
+#ifndef CHISTMAS_WISHLIST_MAINTENANCE_SCHEDULER_H
+#define CHISTMAS_WISHLIST_MAINTENANCE_SCHEDULER_H
+
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+#include <atomic>
+#include <sqlite3.h>
+
+class DatabaseHandler;
+
+// Counters of the work done so far
+struct MaintenanceStats {
+    int vacuumSlices = 0;
+    int pagesReclaimed = 0;
+    int analyzeRuns = 0;
+    int checkpoints = 0;
+    int skippedBusy = 0; // Tasks skipped because another connection held the lock
+};
+
+// Keeps the database compact and its statistics current in the background.
+//
+// Runs on its own thread and its own connection, so every task is a short
+// transaction of its own and never joins one open on the application's
+// connection. Activity is measured through DatabaseHandler::getChangeCount():
+// - incremental_vacuum in small slices once no writes happened for idleAfter
+// - ANALYZE (bounded by analysis_limit) after analyzeAfterChanges row changes
+// - wal_checkpoint(PASSIVE) once the WAL exceeds checkpointPages; this replaces
+//   the auto-checkpoint that would otherwise run on the committing thread
+class MaintenanceScheduler {
+public:
+    struct Options {
+        std::chrono::milliseconds pollInterval{1000};
+        std::chrono::milliseconds idleAfter{2000}; // Quiet time before vacuuming
+        int vacuumPagesPerSlice = 64;
+        int maxSlicesPerRun = 16;
+        int64_t analyzeAfterChanges = 1000;
+        int analysisLimit = 400; // Rows sampled per index by ANALYZE
+        int checkpointPages = 1000;
+        int busyTimeoutMs = 50; // Give up on a task rather than wait for a lock
+    };
+
+private:
+    DatabaseHandler &dbHandler;
+    Options options;
+    sqlite3 *conn = nullptr;
+
+    int64_t lastSeenChanges = 0;
+    int64_t changesAtLastAnalyze = 0;
+    std::chrono::steady_clock::time_point lastActivity;
+    std::atomic<int> walPages{0}; // Reported by the application connection's WAL listener
+    MaintenanceStats stats;
+
+    bool running = false;
+    bool stopping = false;
+    mutable std::mutex mutex; // Guards stats and the thread state
+    std::mutex taskMutex; // Serializes runOnce() callers on conn
+    std::condition_variable wakeCv;
+    std::thread worker;
+
+    void workerLoop();
+
+    int queryInt(const char *sql);
+
+    bool execute(const char *sql);
+
+    void vacuumSlices();
+
+    void analyze();
+
+    void checkpoint();
+
+public:
+    explicit MaintenanceScheduler(DatabaseHandler &handler, Options options);
+
+    explicit MaintenanceScheduler(DatabaseHandler &handler);
+
+    ~MaintenanceScheduler();
+
+    MaintenanceScheduler(const MaintenanceScheduler &) = delete;
+
+    MaintenanceScheduler &operator=(const MaintenanceScheduler &) = delete;
+
+    // Starts the background thread
+    bool start();
+
+    // Stops the thread. The destructor also restores the application's auto-checkpoint.
+    void stop();
+
+    // Runs one round of due tasks on the calling thread
+    void runOnce();
+
+    int getFreePageCount();
+
+    // WAL size in pages as of the application's last commit
+    int getWalPageCount() const { return walPages; }
+
+    MaintenanceStats getStats() const;
+};
+
+#endif //CHISTMAS_WISHLIST_MAINTENANCE_SCHEDULER_H
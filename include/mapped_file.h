@@ -0,0 +1,68 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+
+#ifndef CHISTMAS_WISHLIST_MAPPED_FILE_H
+#define CHISTMAS_WISHLIST_MAPPED_FILE_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+
+// Read-only view of a whole file. The file is memory-mapped and advised for
+// sequential access, so parsers can work on string_views into the page cache
+// without copying lines first. Where mapping is not possible (pipes, special
+// files) the content is read into a buffer instead; the interface is the same.
+class MappedFile {
+private:
+    const char *mapping = nullptr;
+    size_t length = 0;
+    std::vector<char> buffer; // Fallback when mmap is unavailable
+
+    void release();
+
+public:
+    MappedFile() = default;
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    MappedFile(MappedFile &&other) noexcept;
+
+    MappedFile &operator=(MappedFile &&other) noexcept;
+
+    // Maps path, replacing any file mapped before. Empty files open successfully.
+    bool open(const std::string &path);
+
+    const char *data() const { return mapping ? mapping : buffer.data(); }
+
+    size_t size() const { return length; }
+
+    bool empty() const { return length == 0; }
+
+    std::string_view view() const { return {data(), length}; }
+
+    bool isMapped() const { return mapping != nullptr; }
+};
+
+// Iterates the lines of a buffer, scanning for '\n' with memchr. Lines are
+// views without the line break; a trailing '\r' is dropped as well.
+class LineReader {
+private:
+    std::string_view remaining;
+
+public:
+    explicit LineReader(std::string_view text) : remaining(text) {}
+
+    // Returns false once all lines were read
+    bool next(std::string_view &line);
+
+    // The text after the lines read so far
+    std::string_view rest() const { return remaining; }
+};
+
+#endif //CHISTMAS_WISHLIST_MAPPED_FILE_H
@@ -0,0 +1,122 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+
+#ifndef CHISTMAS_WISHLIST_MEMORY_STORE_H
+#define CHISTMAS_WISHLIST_MEMORY_STORE_H
+
+#include <map>
+#include <set>
+#include <mutex>
+#include <chrono>
+#include <optional>
+
+#include "wishlist_store.h"
+
+// Store that keeps everything in process memory. Nothing survives the
+// process; meant for tests, benchmarks and as the cache behind FileStore.
+// Transactions are supported through an undo log. A transaction keeps the
+// store locked for the thread that began it, so other threads wait until it
+// ends instead of seeing or joining its changes.
+class MemoryStore : public IWishlistStore {
+public:
+    static constexpr std::chrono::seconds WRITER_TIMEOUT{5}; // Longest beginTransaction waits for another one
+
+protected:
+    struct UserData {
+        std::map<int, WishItem> items; // By ID
+        Budget budget;
+    };
+
+    // What one or more changes to an owner touched
+    struct OwnerChanges {
+        std::set<int> itemIds; // Items saved or deleted
+        bool budget = false;
+
+        void merge(const OwnerChanges &other);
+    };
+
+    std::map<std::string, UserData> users;
+    mutable std::recursive_timed_mutex mutex;
+
+    // Called with the owner of every committed change; FileStore writes it out
+    virtual bool persistOwner(const std::string &owner);
+
+    // Called with every committed change. By default the whole owner is written
+    // through persistOwner; FileStore's journal writes only what changed.
+    virtual bool persistChanges(const std::string &owner, const OwnerChanges &changes);
+
+    // Records a change to owner: persisted now, or at commit inside a transaction
+    bool changed(const std::string &owner, const OwnerChanges &changes);
+
+    bool changed(const std::string &owner);
+
+    UserData &userData(const std::string &owner);
+
+    // True while the calling thread's transaction has uncommitted changes in users
+    bool transactionOpen() const { return inTransaction; }
+
+private:
+    struct UndoEntry {
+        std::string owner;
+        int itemId = 0; // 0 = budget or user entry
+        std::optional<WishItem> previousItem{};
+        std::optional<Budget> previousBudget{};
+        bool createdUser = false;
+    };
+
+    bool inTransaction = false;
+    std::vector<UndoEntry> undoLog;
+    std::map<std::string, OwnerChanges> touchedOwners;
+
+    void recordItem(const std::string &owner, int itemId);
+
+    int maxItemId() const;
+
+public:
+    MemoryStore() = default;
+
+    bool initialize() override { return true; }
+
+    std::string getName() const override { return "memory"; }
+
+    bool createUser(const std::string &username) override;
+
+    bool userExists(const std::string &username) override;
+
+    std::vector<std::string> getAllUsers() override;
+
+    bool saveItem(const WishItem &item, const std::string &owner) override;
+
+    bool deleteItem(int itemId, const std::string &owner) override;
+
+    std::vector<std::unique_ptr<WishItem> > loadItems(const std::string &owner) override;
+
+    size_t forEachItem(const std::string &owner, const std::function<bool(const ItemRowView &)> &callback) override;
+
+    bool clearAllData(const std::string &owner) override;
+
+    int getGlobalMaxItemId() override;
+
+    size_t queryItems(const std::string &owner, const ItemQuery &query,
+                      const std::function<bool(const ItemRowView &)> &callback) override;
+
+    std::vector<std::unique_ptr<WishItem> > findItems(const std::string &owner, const ItemQuery &query) override;
+
+    ItemStats queryStats(const std::string &owner, const ItemQuery &query = ItemQuery()) override;
+
+    std::vector<std::unique_ptr<WishItem> > searchItems(const std::string &owner, const std::string &query,
+                                                        int limit = 50) override;
+
+    bool saveBudget(const Budget &budget, const std::string &owner) override;
+
+    Budget loadBudget(const std::string &owner) override;
+
+    bool beginTransaction() override;
+
+    bool commitTransaction() override;
+
+    bool rollbackTransaction() override;
+};
+
+#endif //CHISTMAS_WISHLIST_MEMORY_STORE_H
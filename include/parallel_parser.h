@@ -0,0 +1,56 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+
+#ifndef CHISTMAS_WISHLIST_PARALLEL_PARSER_H
+#define CHISTMAS_WISHLIST_PARALLEL_PARSER_H
+
+#include <string_view>
+#include <vector>
+#include <thread>
+#include <cstddef>
+
+// Parses line-based text on several threads. The text is cut into chunks at
+// line breaks, each chunk is parsed into its own batch by one thread, and the
+// batches come back in input order so the caller can merge them sequentially.
+namespace ParallelParser {
+    // Smallest chunk worth a thread of its own
+    constexpr size_t MIN_CHUNK_BYTES = 1 << 20;
+
+    // 0 means one thread per hardware thread
+    unsigned resolveThreads(unsigned requested);
+
+    // Splits text into at most maxChunks pieces of roughly equal size, each ending
+    // after a '\n' (except the last) and none smaller than minChunkBytes
+    std::vector<std::string_view> splitChunks(std::string_view text, unsigned maxChunks,
+                                              size_t minChunkBytes = MIN_CHUNK_BYTES);
+
+    // Calls parseChunk(std::string_view) -> Batch for every chunk, concurrently
+    // when there is more than one, and returns the batches in chunk order.
+    // parseChunk must not throw and must not touch shared state unsynchronized.
+    template<typename Batch, typename ParseChunk>
+    std::vector<Batch> parseChunks(const std::vector<std::string_view> &chunks, ParseChunk parseChunk) {
+        std::vector<Batch> batches(chunks.size());
+
+        std::vector<std::thread> workers;
+        for (size_t i = 1; i < chunks.size(); ++i) {
+            workers.emplace_back([&batches, &chunks, &parseChunk, i] { batches[i] = parseChunk(chunks[i]); });
+        }
+        if (!chunks.empty()) {
+            batches[0] = parseChunk(chunks[0]); // The calling thread takes the first chunk
+        }
+        for (auto &worker: workers) {
+            worker.join();
+        }
+        return batches;
+    }
+
+    // Splits text with splitChunks and parses the chunks as above
+    template<typename Batch, typename ParseChunk>
+    std::vector<Batch> parseChunks(std::string_view text, unsigned threads, ParseChunk parseChunk,
+                                   size_t minChunkBytes = MIN_CHUNK_BYTES) {
+        return parseChunks<Batch>(splitChunks(text, resolveThreads(threads), minChunkBytes), parseChunk);
+    }
+}
+
+#endif //CHISTMAS_WISHLIST_PARALLEL_PARSER_H
@@ -0,0 +1,110 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+
+#ifndef CHISTMAS_WISHLIST_PERSISTENCE_QUEUE_H
+#define CHISTMAS_WISHLIST_PERSISTENCE_QUEUE_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+
+#include "wishlist.h"
+#include "budget.h"
+
+class IWishlistStore;
+
+enum class ChangeType {
+    SAVE_ITEM,
+    DELETE_ITEM,
+    SAVE_BUDGET
+};
+
+// Write-behind queue: mutations are recorded in memory and committed by a
+// background writer thread in grouped transactions.
+class PersistenceQueue {
+public:
+    struct Options {
+        size_t maxPending = 1024; // Enqueue blocks once this many distinct records are waiting
+        size_t batchSize = 64; // Wake the writer as soon as this many records are waiting
+        std::chrono::milliseconds flushInterval{200}; // Otherwise commit at least this often
+        int commitAttempts = 3; // A batch whose transaction fails is retried this often before it is dropped
+        std::chrono::milliseconds retryDelay{50}; // Wait before the second attempt, doubled for each further one
+    };
+
+private:
+    struct ChangeRecord {
+        ChangeType type;
+        std::string owner;
+        int itemId = 0;
+        WishItem item{};
+        Budget budget{};
+    };
+
+    IWishlistStore &store;
+    Options options;
+
+    std::vector<ChangeRecord> pending;
+    std::unordered_map<std::string, size_t> pendingIndex; // Coalescing key -> position in pending
+
+    uint64_t enqueuedSeq = 0;
+    uint64_t committedSeq = 0;
+    size_t failedWrites = 0;
+    bool flushRequested = false;
+    bool stopping = false;
+
+    mutable std::mutex queueMutex;
+    std::condition_variable writerCv; // Signals the writer: work, flush or stop
+    std::condition_variable spaceCv; // Signals producers: room in the queue
+    std::condition_variable doneCv; // Signals flush() callers: a batch was committed
+    std::thread writer;
+
+    // An empty key never coalesces
+    void enqueue(ChangeRecord record, const std::string &key);
+
+    void writerLoop();
+
+    bool commitBatch(std::vector<ChangeRecord> &batch);
+
+    // One transaction over the batch; counts the records that failed, or all of
+    // them if the transaction could not be opened or committed
+    bool tryCommitBatch(std::vector<ChangeRecord> &batch, size_t &failures);
+
+    bool applyRecord(const ChangeRecord &record);
+
+    static std::string itemKey(const std::string &owner, int itemId);
+
+public:
+    explicit PersistenceQueue(IWishlistStore &store, Options options);
+
+    explicit PersistenceQueue(IWishlistStore &store);
+
+    ~PersistenceQueue();
+
+    PersistenceQueue(const PersistenceQueue &) = delete;
+
+    PersistenceQueue &operator=(const PersistenceQueue &) = delete;
+
+    void enqueueSaveItem(const WishItem &item, const std::string &owner);
+
+    void enqueueDeleteItem(int itemId, const std::string &owner);
+
+    void enqueueSaveBudget(const Budget &budget, const std::string &owner);
+
+    // Barrier: blocks until every change enqueued before the call is committed.
+    // Returns false if any write failed since the last flush, including the
+    // changes of a batch dropped after all its commit attempts failed.
+    bool flush();
+
+    // Flushes and stops the writer thread. Called by the destructor.
+    void stop();
+
+    size_t pendingCount() const;
+};
+
+#endif //CHISTMAS_WISHLIST_PERSISTENCE_QUEUE_H
@@ -0,0 +1,139 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+
+#ifndef CHISTMAS_WISHLIST_SHARDED_STORE_H
+#define CHISTMAS_WISHLIST_SHARDED_STORE_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <functional>
+#include <atomic>
+#include <sqlite3.h>
+
+#include "wishlist_store.h"
+
+class DatabaseHandler;
+
+// SQLite store split into N database files. Each owner lives entirely in the
+// shard picked by a stable hash of the username, and every shard has its own
+// connection and write lock, so writers of different owners run in parallel.
+//
+// Cross-owner reads (getAllUsers, getGlobalMaxItemId) go through a separate
+// coordinator connection that ATTACHes all shards and answers them in one
+// query. Item IDs stay globally unique: new items get their ID from a
+// process-wide counter instead of the shard's rowid, and saving an item under
+// an ID another shard holds fails.
+//
+// The shard count is recorded in each file and cannot change afterwards.
+// A transaction belongs to the thread that began it. It spans all shards that
+// thread writes in it but commits shard by shard, so it is atomic per owner,
+// not across owners. Each shard has one writer at a time: a transaction keeps
+// the shards it wrote to until it ends, and other threads' writes to them wait
+// for that, failing after WRITER_TIMEOUT.
+class ShardedStore : public IWishlistStore {
+public:
+    static constexpr int MAX_SHARDS = 10; // SQLite's default ATTACH limit
+    static constexpr std::chrono::seconds WRITER_TIMEOUT{5}; // Like the connections' busy timeout
+
+private:
+    std::string basePath;
+    std::vector<std::unique_ptr<DatabaseHandler> > shards;
+    sqlite3 *coordinator = nullptr;
+    std::mutex coordinatorMutex;
+    std::atomic<int> nextItemId{1};
+
+    // Held by the thread writing to the shard; recursive, as a transaction
+    // keeps it while its own writes take it again
+    std::vector<std::unique_ptr<std::recursive_timed_mutex> > writers;
+
+    // Shards joined by each thread's open transaction
+    std::mutex transactionMutex;
+    std::map<std::thread::id, std::vector<bool> > transactions;
+
+    DatabaseHandler &shardFor(const std::string &owner);
+
+    // Runs write on shard 'index' as its writer, within the calling thread's
+    // transaction if it has one open
+    bool writeShard(size_t index, const std::function<bool(DatabaseHandler &)> &write);
+
+    // Whether itemId is taken in a shard other than ownShard
+    bool ownedElsewhere(int itemId, const DatabaseHandler *ownShard);
+
+    // Joins shard 'index' to the calling thread's open transaction; called as its writer
+    bool enlist(size_t index);
+
+    // Commits or rolls back the calling thread's transaction and releases its shards
+    bool endTransaction(bool commit);
+
+    bool attachShards();
+
+    std::string shardUnion(const std::string &selectFromShard) const;
+
+public:
+    explicit ShardedStore(const std::string &basePath, int shardCount);
+
+    ~ShardedStore() override;
+
+    ShardedStore(const ShardedStore &) = delete;
+
+    ShardedStore &operator=(const ShardedStore &) = delete;
+
+    bool initialize() override;
+
+    std::string getName() const override { return "sharded"; }
+
+    // Stable FNV-1a hash of the username, independent of platform and run
+    static size_t shardIndex(const std::string &owner, size_t shardCount);
+
+    std::string shardPath(size_t index) const;
+
+    size_t getShardCount() const { return shards.size(); }
+
+    DatabaseHandler &getShard(size_t index) { return *shards[index]; }
+
+    bool createUser(const std::string &username) override;
+
+    bool userExists(const std::string &username) override;
+
+    std::vector<std::string> getAllUsers() override;
+
+    bool saveItem(const WishItem &item, const std::string &owner) override;
+
+    bool deleteItem(int itemId, const std::string &owner) override;
+
+    std::vector<std::unique_ptr<WishItem> > loadItems(const std::string &owner) override;
+
+    size_t forEachItem(const std::string &owner, const std::function<bool(const ItemRowView &)> &callback) override;
+
+    bool clearAllData(const std::string &owner) override;
+
+    int getGlobalMaxItemId() override;
+
+    size_t queryItems(const std::string &owner, const ItemQuery &query,
+                      const std::function<bool(const ItemRowView &)> &callback) override;
+
+    std::vector<std::unique_ptr<WishItem> > findItems(const std::string &owner, const ItemQuery &query) override;
+
+    ItemStats queryStats(const std::string &owner, const ItemQuery &query = ItemQuery()) override;
+
+    std::vector<std::unique_ptr<WishItem> > searchItems(const std::string &owner, const std::string &query,
+                                                        int limit = 50) override;
+
+    bool saveBudget(const Budget &budget, const std::string &owner) override;
+
+    Budget loadBudget(const std::string &owner) override;
+
+    bool beginTransaction() override;
+
+    bool commitTransaction() override;
+
+    bool rollbackTransaction() override;
+};
+
+#endif //CHISTMAS_WISHLIST_SHARDED_STORE_H
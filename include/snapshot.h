@@ -0,0 +1,41 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+
+#ifndef CHISTMAS_WISHLIST_SNAPSHOT_H
+#define CHISTMAS_WISHLIST_SNAPSHOT_H
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+
+#include "wishlist_manager.h"
+
+// Binary wishlist snapshot. Unlike the text .dat format it stores any name or
+// note (including '|' and line breaks) and loads without parsing text.
+//
+// All integers are little-endian. Layout, each section followed by the
+// CRC-32C of its bytes:
+//
+//   header   magic "WSHSNAP\x1A", u16 version, u16 reserved, u32 itemCount,
+//            f64 maxBudget, f64 spentAmount, u8 budgetEnabled, u8[3] reserved,
+//            u64 columnsSize, u64 blobSize, u32 ownerLength, owner bytes
+//   columns  itemCount entries per column, in this order:
+//            i32 id, f64 price, u8 purchased, u8 category, u8 priority,
+//            u32 nameLength, u32 notesLength, u32 linkLength
+//   blob     every item's name, notes and link back to back, in item order
+namespace Snapshot {
+    constexpr std::string_view MAGIC{"WSHSNAP\x1A", 8};
+    constexpr uint16_t VERSION = 1;
+
+    bool isSnapshot(std::string_view data);
+
+    std::string encode(const WishlistManager &manager);
+
+    // Replaces owner and budget and adds the snapshot's items to manager.
+    // Returns the number of items, or -1 if data is truncated, corrupt or of an
+    // unknown version; manager is left untouched in that case.
+    int decode(std::string_view data, WishlistManager &manager);
+}
+
+#endif //CHISTMAS_WISHLIST_SNAPSHOT_H
@@ -0,0 +1,32 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+
+#ifndef CHISTMAS_WISHLIST_SQL_FUNCTIONS_H
+#define CHISTMAS_WISHLIST_SQL_FUNCTIONS_H
+
+#include <string>
+#include <string_view>
+#include <sqlite3.h>
+
+// C++ scalar functions registered on SQLite connections, so filters that
+// need them run inside SQLite instead of on rows copied out of it:
+//
+//   category_name(category)   "Toys", "Books", ... as WishItem::categoryToString
+//   fold_case(text)           lower case, including Latin-1 letters in UTF-8
+//   trigram_sim(a, b)         0..1 similarity of the case-folded trigram sets
+//   price_bucket(price, width) lower bound of price's bucket, NULL for width <= 0
+//
+// All are deterministic, so they may also be used in indexes on expressions.
+// Every connection that writes a table with such an index must register them.
+namespace SqlFunctions {
+    bool registerAll(sqlite3 *db);
+
+    std::string foldCase(std::string_view text);
+
+    double trigramSimilarity(std::string_view a, std::string_view b);
+
+    double priceBucket(double price, double width);
+}
+
+#endif //CHISTMAS_WISHLIST_SQL_FUNCTIONS_H
@@ -6,7 +6,9 @@
 #define CHISTMAS_WISHLIST_WISHLIST_H
 
 #include <string>
+#include <string_view>
 #include <memory>
+#include <atomic>
 
 enum class Priority {
     LOW,
@@ -26,7 +28,7 @@ enum class Category {
 
 class WishItem {
 private:
-    static int nextId;
+    static std::atomic<int> nextId; // Atomic, as files are loaded on several threads
     int id;
     std::string name;
     double price;
@@ -58,22 +60,22 @@ public:
 
     // Getters
     int getId() const { return id; }
-    std::string getName() const { return name; }
+    const std::string &getName() const { return name; }
     double getPrice() const { return price; }
     bool isPurchased() const { return purchased; }
     Category getCategory() const { return category; }
     Priority getPriority() const { return priority; }
-    std::string getNotes() const { return notes; }
-    std::string getLink() const { return link; }
+    const std::string &getNotes() const { return notes; }
+    const std::string &getLink() const { return link; }
 
     // Setters
-    void setName(const std::string& name);
+    void setName(std::string name);
     void setPrice(double price);
     void setPurchased(bool purchased);
     void setCategory(Category cat);
     void setPriority(Priority prio);
-    void setNotes(const std::string& notes);
-    void setLink(const std::string& link);
+    void setNotes(std::string notes);
+    void setLink(std::string link);
     void setId(int newId) { id = newId; }
 
     // Operators
@@ -84,15 +86,22 @@ public:
     // Utility
     std::string toString() const;
     std::string serialize() const;
-    static std::unique_ptr<WishItem> deserialize(const std::string& data);
+    // Parses a serialize() line; only the text fields are copied out of data
+    static std::unique_ptr<WishItem> deserialize(std::string_view data);
+    // Same as deserialize but leaves nextId alone, so it is safe to call from several threads
+    static bool parse(std::string_view data, WishItem &item);
 
     // Static helper
     static std::string categoryToString(Category cat);
     static std::string priorityToString(Priority prio);
     static Category stringToCategory(const std::string& str);
     static Priority stringToPriority(const std::string& str);
-    static void setNextId(int newId) { nextId = newId; }
-    static int getNextId() { return nextId; }
+    static void setNextId(int newId) { nextId.store(newId); }
+    static int getNextId() { return nextId.load(); }
+    // Hands out the next ID
+    static int takeNextId() { return nextId++; }
+    // Raises the counter above usedId unless it already is; safe from several threads
+    static void reserveId(int usedId);
 };
 
 #endif //CHISTMAS_WISHLIST_WISHLIST_H
\ No newline at end of file
@@ -8,10 +8,14 @@
 #include <vector>
 #include <memory>
 #include <functional>
+#include <optional>
 
 #include "wishlist.h"
 #include "budget.h"
-class DatabaseHandler;
+class IWishlistStore;
+class PersistenceQueue;
+struct ItemQuery;
+struct ItemStats;
 
 enum class SortOrder {
     BY_PRIORITY,
@@ -27,10 +31,16 @@ private:
     std::vector<std::unique_ptr<WishItem>> items;
     std::string owner;
     Budget budget;
-    DatabaseHandler* dbHandler = nullptr;
+    IWishlistStore* store = nullptr;
+    PersistenceQueue* persistenceQueue = nullptr;
 
     void updateBudgetFromItems();
 
+    //Route writes through the persistence queue if one is set, else write synchronously
+    void persistItem(const WishItem &item);
+    void persistDelete(int id);
+    void persistBudget();
+
 public:
     explicit WishlistManager(const std::string &owner = "Default");
     ~WishlistManager();
@@ -38,6 +48,9 @@ public:
     //Add & Remove
     void addItem(std::unique_ptr<WishItem> item);
     bool removeItem(int id);
+    bool markAsPurchased(int id);
+    //Applies change to the item and persists it; false if there is no such item
+    bool updateItem(int id, const std::function<void(WishItem&)> &change);
 
     // Search
     WishItem* findById(int id);
@@ -45,6 +58,8 @@ public:
     std::vector<WishItem*> findByCategory(Category cat);
     std::vector<WishItem*> findByPriceRange(double min, double max);
     std::vector<WishItem*> filter(std::function<bool(const WishItem&)> predicate);
+    //Answered by the store when one is set (after flushing queued writes), else from the items in memory
+    std::vector<std::unique_ptr<WishItem>> findItems(const ItemQuery &query);
 
     //Bulk operations
     void markAllPurchased();
@@ -57,13 +72,16 @@ public:
     double getTotalValue() const;
     double getPurchasedValue() const;
     double getRemainingValue() const;
+    //Aggregated by the store when one is set, like findItems
+    ItemStats getStats();
+    ItemStats getStats(const ItemQuery &query);
 
     //Display
     void displayAll() const;
-    void displayPending() const;
-    void displayPurchased() const;
+    void displayPending();
+    void displayPurchased();
     void displayByCategory() const;
-    void displayStatistics() const;
+    void displayStatistics();
 
     //Getters
     const std::vector<std::unique_ptr<WishItem>>& getItems() const {
@@ -84,17 +102,27 @@ public:
     void enableBudget();
     void disableBudget();
     void resetBudget();
+    // Changes the given settings, leaves the others and persists the budget once
+    void configureBudget(std::optional<double> maxBudget, std::optional<bool> enabled);
     void displayBudgetStatus() const;
     bool checkBudgetBevorAdd(double price) const;
     void syncBudgetWithPurchases();
 
-    //Database methods
-    void setDatabaseHandler(DatabaseHandler *handler);
-    bool saveToDatabase();
-    bool loadFromDatabase();
+    //Storage backend (SQLite, flat file or in-memory)
+    void setStore(IWishlistStore *store);
+    bool saveToStore();
+    bool loadFromStore();
+
+    IWishlistStore* getStore() const {
+        return store;
+    }
+
+    //Asynchronous persistence
+    void setPersistenceQueue(PersistenceQueue *queue);
+    bool flushPendingWrites();
 
-    DatabaseHandler* getDatabaseHandler() const {
-        return dbHandler;
+    PersistenceQueue* getPersistenceQueue() const {
+        return persistenceQueue;
     }
 };
 
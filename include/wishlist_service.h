@@ -0,0 +1,86 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+
+#ifndef CHISTMAS_WISHLIST_WISHLIST_SERVICE_H
+#define CHISTMAS_WISHLIST_WISHLIST_SERVICE_H
+
+#include <string>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include "http_server.h"
+#include "wishlist_manager.h"
+
+class IWishlistStore;
+class PersistenceQueue;
+class ItemCache;
+
+// REST API over the wishlists of a store, for HttpServer:
+//
+//   GET    /users                          all user names
+//   GET    /users/{user}/items             list
+//   POST   /users/{user}/items             add; {"name", "price", optional "category",
+//                                          "priority", "notes", "link", "purchased"}
+//   GET    /users/{user}/items/{id}
+//   PUT    /users/{user}/items/{id}        update; any of the fields above
+//   DELETE /users/{user}/items/{id}
+//   GET    /users/{user}/search?q=text
+//   GET    /users/{user}/stats
+//   GET    /users/{user}/budget
+//   PUT    /users/{user}/budget            {"maxBudget", "enabled"}, both optional
+//
+// A user is created by adding their first item; other requests for unknown
+// users are answered with 404. Each user's WishlistManager is loaded on first
+// use and kept. Requests for
+// the same user are serialized by that user's lock; different users proceed
+// in parallel. Changes are written behind through the persistence queue.
+//
+// With an ItemCache over the store's connection, item lists and stats are
+// answered from the cache once the user's queued changes are committed.
+class WishlistService {
+private:
+    struct UserSession {
+        std::mutex mutex;
+        std::unique_ptr<WishlistManager> manager; // Null until loaded
+    };
+
+    IWishlistStore &store;
+    PersistenceQueue &queue;
+    ItemCache *cache; // Optional
+
+    std::mutex sessionsMutex;
+    std::map<std::string, std::shared_ptr<UserSession> > sessions;
+
+    // WishItem's ID counter is global: loads reset it and adds take from it,
+    // so both hold this lock whichever user they are for
+    std::mutex idMutex;
+
+    // Null if the user does not exist and create is false
+    std::shared_ptr<UserSession> findSession(const std::string &user, bool create);
+
+    // Called with the session's lock held
+    void load(const std::string &user, UserSession &session);
+
+    HttpResponse listItems(WishlistManager &manager);
+
+    HttpResponse addItem(WishlistManager &manager, const HttpRequest &request);
+
+    HttpResponse updateItem(WishlistManager &manager, int id, const HttpRequest &request);
+
+    HttpResponse budget(WishlistManager &manager, const HttpRequest &request);
+
+    HttpResponse stats(WishlistManager &manager);
+
+public:
+    WishlistService(IWishlistStore &store, PersistenceQueue &queue, ItemCache *cache = nullptr);
+
+    // Thread-safe; meant to be the HttpServer handler
+    HttpResponse handle(const HttpRequest &request);
+
+    // Writes all queued changes; false if any could not be written
+    bool flush();
+};
+
+#endif //CHISTMAS_WISHLIST_WISHLIST_SERVICE_H
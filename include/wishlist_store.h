@@ -0,0 +1,85 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+
+#ifndef CHISTMAS_WISHLIST_WISHLIST_STORE_H
+#define CHISTMAS_WISHLIST_WISHLIST_STORE_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+
+#include "wishlist.h"
+#include "budget.h"
+#include "item_query.h"
+
+// Storage backend for wishlists. Implemented by DatabaseHandler (SQLite),
+// ShardedStore (owners spread over N SQLite files), FileStore (one flat file
+// per owner) and MemoryStore (no persistence), so
+// the same workload can run against any of them.
+class IWishlistStore {
+public:
+    virtual ~IWishlistStore() = default;
+
+    virtual bool initialize() = 0;
+
+    // Short backend name ("sqlite", "file", "memory")
+    virtual std::string getName() const = 0;
+
+    //User operations
+    virtual bool createUser(const std::string &username) = 0;
+
+    virtual bool userExists(const std::string &username) = 0;
+
+    virtual std::vector<std::string> getAllUsers() = 0;
+
+    //Item operations. saveItem inserts items with ID 0, setting the ID it assigns
+    //on the item, and upserts all others.
+    virtual bool saveItem(const WishItem &item, const std::string &owner) = 0;
+
+    virtual bool deleteItem(int itemId, const std::string &owner) = 0;
+
+    virtual std::vector<std::unique_ptr<WishItem> > loadItems(const std::string &owner) = 0;
+
+    // Visits the owner's items in ID order; return false from the callback to stop early.
+    // Returns the number of rows visited.
+    virtual size_t forEachItem(const std::string &owner, const std::function<bool(const ItemRowView &)> &callback) = 0;
+
+    virtual bool clearAllData(const std::string &owner) = 0;
+
+    virtual int getGlobalMaxItemId() = 0;
+
+    //Queries
+    // Visits the owner's items matching query, in its order and page; return false
+    // from the callback to stop early. Returns the number of rows visited.
+    virtual size_t queryItems(const std::string &owner, const ItemQuery &query,
+                              const std::function<bool(const ItemRowView &)> &callback) = 0;
+
+    virtual std::vector<std::unique_ptr<WishItem> > findItems(const std::string &owner, const ItemQuery &query) = 0;
+
+    virtual ItemStats queryStats(const std::string &owner, const ItemQuery &query = ItemQuery()) = 0;
+
+    // Words match as prefixes of words in name or notes, name matches rank first
+    virtual std::vector<std::unique_ptr<WishItem> > searchItems(const std::string &owner, const std::string &query,
+                                                                int limit = 50) = 0;
+
+    //Budget operations
+    virtual bool saveBudget(const Budget &budget, const std::string &owner) = 0;
+
+    virtual Budget loadBudget(const std::string &owner) = 0;
+
+    //Transactions
+    virtual bool beginTransaction() = 0;
+
+    virtual bool commitTransaction() = 0;
+
+    virtual bool rollbackTransaction() = 0;
+
+    // Creates the backend named by kind ("sqlite", "file", "file:journal", "memory" or
+    // "sharded[:N]", default 4 shards); location is the database file, the base name of the shard files or the
+    // directory for flat files. Returns nullptr for unknown kinds.
+    static std::unique_ptr<IWishlistStore> create(const std::string &kind, const std::string &location);
+};
+
+#endif //CHISTMAS_WISHLIST_WISHLIST_STORE_H
@@ -0,0 +1,96 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+
+#include "../include/atomic_file.h"
+#include "../include/logger.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    bool writeAll(int fd, std::string_view content) {
+        while (!content.empty()) {
+            ssize_t written = ::write(fd, content.data(), content.size());
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            content.remove_prefix(static_cast<size_t>(written));
+        }
+        return true;
+    }
+
+    // Makes the rename itself durable
+    void syncDirectory(const std::filesystem::path &directory) {
+        int fd = ::open(directory.empty() ? "." : directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd < 0) return;
+        if (fsync(fd) != 0) {
+            LOG_WARNING("AtomicFile: Failed to sync directory ", directory.string(), ": ", std::strerror(errno));
+        }
+        ::close(fd);
+    }
+
+    // Hard link when possible, so the backup costs no copy
+    bool makeBackup(const std::string &path, const std::string &backup) {
+        ::unlink(backup.c_str());
+        if (::link(path.c_str(), backup.c_str()) == 0) return true;
+
+        std::error_code error;
+        std::filesystem::copy_file(path, backup, std::filesystem::copy_options::overwrite_existing, error);
+        if (error) {
+            LOG_WARNING("AtomicFile: Could not keep backup ", backup, ": ", error.message());
+            return false;
+        }
+        return true;
+    }
+}
+
+std::string AtomicFile::backupPath(const std::string &path) {
+    return path + ".bak";
+}
+
+bool AtomicFile::write(const std::string &path, std::string_view content, bool keepBackup) {
+    // Same directory as the target, so the rename never crosses file systems.
+    // mkostemp picks a name no other thread or process is writing to.
+    std::string temporary = path + ".tmp.XXXXXX";
+    int fd = mkostemp(temporary.data(), O_CLOEXEC);
+    if (fd < 0) {
+        LOG_ERROR("AtomicFile: Cannot create ", temporary, ": ", std::strerror(errno));
+        return false;
+    }
+
+    struct stat existing{};
+    bool targetExists = ::stat(path.c_str(), &existing) == 0;
+    // Keep the permissions of the file being replaced; mkostemp creates it 0600
+    fchmod(fd, targetExists ? existing.st_mode & 07777 : 0644);
+
+    bool written = writeAll(fd, content) && fsync(fd) == 0;
+    int savedErrno = errno;
+    if (::close(fd) != 0 && written) {
+        written = false;
+        savedErrno = errno;
+    }
+    if (!written) {
+        LOG_ERROR("AtomicFile: Failed to write ", temporary, ": ", std::strerror(savedErrno));
+        ::unlink(temporary.c_str());
+        return false;
+    }
+
+    if (keepBackup && targetExists) {
+        makeBackup(path, backupPath(path));
+    }
+
+    if (::rename(temporary.c_str(), path.c_str()) != 0) {
+        LOG_ERROR("AtomicFile: Failed to replace ", path, ": ", std::strerror(errno));
+        ::unlink(temporary.c_str());
+        return false;
+    }
+    syncDirectory(std::filesystem::path(path).parent_path());
+    return true;
+}
@@ -0,0 +1,192 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+
+#include "../include/bulk_importer.h"
+#include "../include/file_handler.h"
+#include "../include/parallel_parser.h"
+#include "../include/logger.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <thread>
+
+namespace {
+    constexpr const char *FILE_PREFIX = "wishlist_";
+
+    using Clock = std::chrono::steady_clock;
+
+    double secondsSince(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    std::string extensionOf(const std::string &path) {
+        std::string extension = std::filesystem::path(path).extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return extension;
+    }
+}
+
+double ImportFileReport::megabytesPerSecond() const {
+    return parseSeconds > 0.0 ? static_cast<double>(bytes) / (1024.0 * 1024.0) / parseSeconds : 0.0;
+}
+
+void BulkImportReport::print(std::ostream &out) const {
+    for (const auto &file: files) {
+        out << std::left << std::setw(32) << std::filesystem::path(file.path).filename().string() << ' ';
+        if (!file.success) {
+            out << "FAILED: " << file.error << '\n';
+            continue;
+        }
+        out << std::setw(16) << file.owner << std::right << std::setw(8) << file.items << " items "
+                << std::fixed << std::setprecision(1) << std::setw(8) << file.megabytesPerSecond() << " MB/s parse "
+                << std::setw(8) << file.writeSeconds * 1000.0 << " ms write\n";
+    }
+    out << files.size() << " file(s), " << totalItems << " item(s) imported, " << failedFiles << " failed, "
+            << std::fixed << std::setprecision(2) << seconds << " s\n";
+}
+
+BulkImporter::BulkImporter(IWishlistStore &store, Options options) : store(store), options(options) {
+}
+
+BulkImporter::BulkImporter(IWishlistStore &store) : BulkImporter(store, Options()) {
+}
+
+std::string BulkImporter::ownerFromFileName(const std::string &path) {
+    std::string stem = std::filesystem::path(path).stem().string();
+    std::string prefix = FILE_PREFIX;
+    if (stem.size() <= prefix.size() || stem.compare(0, prefix.size(), prefix) != 0) return "";
+    return stem.substr(prefix.size());
+}
+
+std::vector<std::string> BulkImporter::findImportFiles(const std::string &directory) {
+    std::vector<std::string> files;
+    std::error_code error;
+    for (const auto &entry: std::filesystem::directory_iterator(directory, error)) {
+        std::string extension = extensionOf(entry.path().string());
+        if (entry.is_regular_file() && (extension == ".dat" || extension == ".csv")) {
+            files.push_back(entry.path().string());
+        }
+    }
+    if (error) {
+        LOG_ERROR("BulkImporter: Cannot read directory ", directory, ": ", error.message());
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+BulkImportReport BulkImporter::importDirectory(const std::string &directory) {
+    auto start = Clock::now();
+    BulkImportReport report;
+    for (const auto &path: findImportFiles(directory)) {
+        ImportFileReport file;
+        file.path = path;
+        std::error_code error;
+        file.bytes = static_cast<size_t>(std::filesystem::file_size(path, error));
+        report.files.push_back(std::move(file));
+    }
+
+    // Largest files are handed out first, so the pool finishes together
+    std::vector<size_t> order(report.files.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&report](size_t a, size_t b) {
+        return report.files[a].bytes > report.files[b].bytes;
+    });
+
+    std::atomic<size_t> next{0};
+    auto work = [this, &report, &order, &next] {
+        for (size_t i = next++; i < order.size(); i = next++) {
+            importFile(report.files[order[i]]);
+        }
+    };
+    unsigned threads = std::min<size_t>(ParallelParser::resolveThreads(options.threads), order.size());
+    std::vector<std::thread> workers;
+    for (unsigned i = 1; i < threads; ++i) {
+        workers.emplace_back(work);
+    }
+    work();
+    for (auto &worker: workers) {
+        worker.join();
+    }
+
+    for (const auto &file: report.files) {
+        if (file.success) {
+            report.totalItems += file.items;
+        } else {
+            report.failedFiles++;
+        }
+    }
+    report.seconds = secondsSince(start);
+    LOG_INFO("BulkImporter: Imported ", report.totalItems, " items from ", report.files.size() - report.failedFiles,
+             " of ", report.files.size(), " file(s) in ", directory);
+    return report;
+}
+
+void BulkImporter::importFile(ImportFileReport &report) {
+    std::string fileOwner = ownerFromFileName(report.path);
+    bool isCsv = extensionOf(report.path) == ".csv";
+    std::string fallbackOwner = std::filesystem::path(report.path).stem().string();
+    WishlistManager manager(fileOwner.empty() ? fallbackOwner : fileOwner);
+
+    // One thread per file; the pool already keeps the cores busy. Loads raise
+    // WishItem's ID counter, which is atomic for this.
+    auto parseStart = Clock::now();
+    bool parsed;
+    if (isCsv) {
+        std::ifstream in(report.path, std::ios::binary);
+        parsed = in.is_open() && FileHandler::importFromCSV(manager, in, 1);
+    } else {
+        FileHandler handler(report.path);
+        handler.setParseThreads(1);
+        parsed = handler.load(manager);
+    }
+    report.parseSeconds = secondsSince(parseStart);
+
+    // A .dat file's owner line names the owner unless the file name does
+    report.owner = fileOwner.empty() ? manager.getOwner() : fileOwner;
+    if (!parsed || report.owner.empty()) {
+        report.error = parsed ? "No owner" : "Unreadable, corrupt or without items";
+        LOG_WARNING("BulkImporter: Skipping ", report.path, ": ", report.error);
+        return;
+    }
+
+    auto writeStart = Clock::now();
+    report.success = writeItems(report, manager, !isCsv);
+    report.writeSeconds = secondsSince(writeStart);
+}
+
+bool BulkImporter::writeItems(ImportFileReport &report, WishlistManager &manager, bool withBudget) {
+    std::lock_guard<std::mutex> lock(storeMutex);
+    if (!store.createUser(report.owner) || !store.beginTransaction()) {
+        report.error = "Could not start a transaction for " + report.owner;
+        return false;
+    }
+
+    for (const auto &item: manager.getItems()) {
+        item->setId(0); // IDs are global, the store assigns new ones
+        if (!store.saveItem(*item, report.owner)) {
+            store.rollbackTransaction();
+            report.error = "Saving '" + item->getName() + "' failed, nothing of this file was kept";
+            return false;
+        }
+    }
+    const Budget &budget = manager.getBudget();
+    if (withBudget && (budget.isEnabled() || budget.getMaxBudget() > 0.0) && !store.saveBudget(budget, report.owner)) {
+        store.rollbackTransaction();
+        report.error = "Saving the budget failed, nothing of this file was kept";
+        return false;
+    }
+    if (!store.commitTransaction()) {
+        store.rollbackTransaction();
+        report.error = "Commit failed";
+        return false;
+    }
+
+    report.items = manager.getItems().size();
+    return true;
+}
@@ -0,0 +1,258 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+
+#include "../include/bulk_load_session.h"
+#include "../include/database_handler.h"
+#include "../include/logger.h"
+
+#include <filesystem>
+#include <utility>
+
+namespace {
+    constexpr int COLUMNS_PER_ROW = 9;
+
+    std::string multiRowInsertSql(size_t rows) {
+        std::string sql = "INSERT INTO bulk.staged_items "
+                "(owner, id, name, price, purchased, category, priority, notes, link) VALUES ";
+        for (size_t i = 0; i < rows; ++i) {
+            sql += (i == 0) ? "(?, ?, ?, ?, ?, ?, ?, ?, ?)" : ", (?, ?, ?, ?, ?, ?, ?, ?, ?)";
+        }
+        return sql + ";";
+    }
+}
+
+BulkLoadSession::BulkLoadSession(DatabaseHandler &handler, Options options)
+    : dbHandler(handler), options(options) {
+    if (this->options.rowsPerStatement == 0) this->options.rowsPerStatement = 1;
+}
+
+BulkLoadSession::BulkLoadSession(DatabaseHandler &handler) : BulkLoadSession(handler, Options()) {
+}
+
+BulkLoadSession::~BulkLoadSession() {
+    if (active) {
+        LOG_WARNING("BulkLoadSession: Destroyed without commit, discarding ", stagedCount + buffer.size(), " rows");
+        abort();
+    }
+}
+
+bool BulkLoadSession::begin() {
+    if (active) return true;
+
+    writer = dbHandler.lockWriter();
+    if (!writer) return false;
+
+    stagingPath = dbHandler.dbPath + ".bulk";
+    std::filesystem::remove(stagingPath); // Leftover from an interrupted session
+
+    sqlite3_stmt *stmt;
+    if (!dbHandler.prepareStatement("ATTACH DATABASE ? AS bulk;", &stmt)) {
+        writer.unlock();
+        return false;
+    }
+    sqlite3_bind_text(stmt, 1, stagingPath.c_str(), -1, SQLITE_TRANSIENT);
+    int result = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    if (result != SQLITE_DONE) {
+        LOG_ERROR("BulkLoadSession: Failed to attach staging database: ", dbHandler.getLastError());
+        writer.unlock();
+        return false;
+    }
+
+    // Only the staging file runs without durability; the main database is untouched until commit
+    const char *prepareStaging = R"(
+        PRAGMA bulk.journal_mode = MEMORY;
+        PRAGMA bulk.synchronous = OFF;
+        CREATE TABLE bulk.staged_items (
+            owner TEXT NOT NULL,
+            id INTEGER,
+            name TEXT NOT NULL,
+            price REAL NOT NULL,
+            purchased INTEGER,
+            category INTEGER,
+            priority INTEGER,
+            notes TEXT,
+            link TEXT
+        );
+        BEGIN;
+    )";
+
+    if (!dbHandler.executeSQL(prepareStaging) ||
+        !dbHandler.prepareStatement(multiRowInsertSql(options.rowsPerStatement), &batchInsert)) {
+        cleanup();
+        return false;
+    }
+
+    active = true;
+    stagedCount = 0;
+    buffer.reserve(options.rowsPerStatement);
+    LOG_INFO("BulkLoadSession: Started, staging in ", stagingPath);
+    return true;
+}
+
+bool BulkLoadSession::addItem(const WishItem &item, const std::string &owner) {
+    if (!active) {
+        LOG_ERROR("BulkLoadSession: addItem called without an active session");
+        return false;
+    }
+
+    StagedRow row{owner};
+    row.item = item;
+    buffer.push_back(std::move(row));
+
+    return buffer.size() < options.rowsPerStatement || writeBuffer();
+}
+
+bool BulkLoadSession::bindRow(sqlite3_stmt *stmt, int firstParam, const StagedRow &row) {
+    const WishItem &item = row.item;
+    int p = firstParam;
+
+    sqlite3_bind_text(stmt, p++, row.owner.c_str(), -1, SQLITE_TRANSIENT);
+    if (options.keepIds && item.getId() != 0) {
+        sqlite3_bind_int(stmt, p++, item.getId());
+    } else {
+        sqlite3_bind_null(stmt, p++);
+    }
+    sqlite3_bind_text(stmt, p++, item.getName().c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_double(stmt, p++, item.getPrice());
+    sqlite3_bind_int(stmt, p++, item.isPurchased() ? 1 : 0);
+    sqlite3_bind_int(stmt, p++, static_cast<int>(item.getCategory()));
+    sqlite3_bind_int(stmt, p++, static_cast<int>(item.getPriority()));
+    sqlite3_bind_text(stmt, p++, item.getNotes().c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt, p, item.getLink().c_str(), -1, SQLITE_TRANSIENT);
+    return true;
+}
+
+bool BulkLoadSession::writeBuffer() {
+    if (buffer.empty()) return true;
+
+    // Full batches reuse the prepared statement; only the final partial batch prepares its own
+    sqlite3_stmt *stmt = batchInsert;
+    bool ownStatement = buffer.size() != options.rowsPerStatement;
+    if (ownStatement && !dbHandler.prepareStatement(multiRowInsertSql(buffer.size()), &stmt)) {
+        return false;
+    }
+
+    for (size_t i = 0; i < buffer.size(); ++i) {
+        bindRow(stmt, static_cast<int>(i) * COLUMNS_PER_ROW + 1, buffer[i]);
+    }
+
+    int result = sqlite3_step(stmt);
+    if (ownStatement) {
+        sqlite3_finalize(stmt);
+    } else {
+        sqlite3_reset(stmt);
+        sqlite3_clear_bindings(stmt);
+    }
+
+    if (result != SQLITE_DONE) {
+        LOG_ERROR("BulkLoadSession: Failed to stage rows: ", dbHandler.getLastError());
+        return false;
+    }
+
+    stagedCount += buffer.size();
+    buffer.clear();
+    return true;
+}
+
+bool BulkLoadSession::commit() {
+    if (!active) {
+        LOG_ERROR("BulkLoadSession: commit called without an active session");
+        return false;
+    }
+
+    if (!writeBuffer() || !dbHandler.executeSQL("COMMIT;")) {
+        abort();
+        return false;
+    }
+    sqlite3_finalize(batchInsert);
+    batchInsert = nullptr;
+
+    bool success = moveIntoMain();
+    if (success) {
+        dbHandler.executeSQL("ANALYZE main;");
+        LOG_INFO("BulkLoadSession: Committed ", stagedCount, " rows");
+    }
+
+    cleanup();
+    return success;
+}
+
+bool BulkLoadSession::moveIntoMain() {
+    // Indexes and per-row triggers on items are dropped for the copy and
+    // recreated from their stored definitions afterwards. DDL is transactional,
+    // so a failure or crash rolls all of it back.
+    std::vector<std::string> recreate;
+    std::vector<std::string> drop;
+
+    sqlite3_stmt *stmt;
+    const char *schemaSql =
+            "SELECT type, name, sql FROM main.sqlite_master WHERE tbl_name = 'items' AND sql IS NOT NULL AND ("
+            "type = 'index' OR (type = 'trigger' AND (name LIKE 'trg_items_fts_%' OR name LIKE 'trg_items_stats_%')));";
+
+    if (!dbHandler.beginTransaction()) {
+        return false;
+    }
+    if (!dbHandler.prepareStatement(schemaSql, &stmt)) {
+        dbHandler.rollbackTransaction();
+        return false;
+    }
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        std::string type = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 0));
+        std::string name = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 1));
+        drop.push_back((type == "index" ? "DROP INDEX main." : "DROP TRIGGER main.") + name + ";");
+        recreate.push_back(std::string(reinterpret_cast<const char *>(sqlite3_column_text(stmt, 2))) + ";");
+    }
+    sqlite3_finalize(stmt);
+
+    const char *copyRows = R"(
+        INSERT OR IGNORE INTO main.users (username) SELECT DISTINCT owner FROM bulk.staged_items;
+        INSERT INTO main.items (id, user_id, name, price, purchased, category, priority, notes, link)
+        SELECT s.id, u.id, s.name, s.price, s.purchased, s.category, s.priority, s.notes, s.link
+        FROM bulk.staged_items s JOIN main.users u ON u.username = s.owner
+        ORDER BY s.rowid;
+    )";
+
+    bool success = true;
+    for (const auto &sql: drop) success = success && dbHandler.executeSQL(sql);
+    success = success && dbHandler.executeSQL(copyRows);
+    for (const auto &sql: recreate) success = success && dbHandler.executeSQL(sql);
+
+    // Derived data the dropped triggers would have maintained
+    if (success && dbHandler.isFullTextSearchAvailable()) {
+        success = dbHandler.executeSQL("INSERT INTO items_fts(items_fts) VALUES('rebuild');");
+    }
+    success = success && dbHandler.rebuildUserStats();
+
+    if (!success || !dbHandler.commitTransaction()) {
+        LOG_ERROR("BulkLoadSession: Moving rows into the main database failed, rolling back");
+        dbHandler.rollbackTransaction();
+        return false;
+    }
+    return true;
+}
+
+void BulkLoadSession::abort() {
+    if (batchInsert) {
+        sqlite3_finalize(batchInsert);
+        batchInsert = nullptr;
+    }
+    if (active) {
+        dbHandler.executeSQL("ROLLBACK;");
+    }
+    buffer.clear();
+    cleanup();
+    LOG_INFO("BulkLoadSession: Aborted");
+}
+
+void BulkLoadSession::cleanup() {
+    if (batchInsert) {
+        sqlite3_finalize(batchInsert);
+        batchInsert = nullptr;
+    }
+    dbHandler.executeSQL("DETACH DATABASE bulk;");
+    std::filesystem::remove(stagingPath);
+    active = false;
+    if (writer) writer.unlock();
+}
@@ -0,0 +1,72 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+
+#include "../include/crc32c.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <nmmintrin.h>
+#define WISHLIST_CRC32C_SSE42 1
+#endif
+
+namespace {
+    constexpr uint32_t POLYNOMIAL = 0x82F63B78; // Reversed Castagnoli polynomial
+
+    constexpr std::array<uint32_t, 256> makeTable() {
+        std::array<uint32_t, 256> table{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc >> 1) ^ (crc & 1 ? POLYNOMIAL : 0);
+            }
+            table[i] = crc;
+        }
+        return table;
+    }
+
+    constexpr std::array<uint32_t, 256> TABLE = makeTable();
+
+    uint32_t crc32cTable(const unsigned char *data, size_t length, uint32_t crc) {
+        for (size_t i = 0; i < length; ++i) {
+            crc = TABLE[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        }
+        return crc;
+    }
+
+#ifdef WISHLIST_CRC32C_SSE42
+    __attribute__((target("sse4.2")))
+    uint32_t crc32cHardware(const unsigned char *data, size_t length, uint32_t crc) {
+        uint64_t crc64 = crc;
+        for (; length >= 8; data += 8, length -= 8) {
+            uint64_t word;
+            std::memcpy(&word, data, sizeof(word));
+            crc64 = _mm_crc32_u64(crc64, word);
+        }
+        uint32_t crc32 = static_cast<uint32_t>(crc64);
+        for (; length > 0; ++data, --length) {
+            crc32 = _mm_crc32_u8(crc32, *data);
+        }
+        return crc32;
+    }
+
+    // Static initializers may run before libgcc detected the CPU, hence the explicit init
+    const bool hasSse42 = [] {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("sse4.2") != 0;
+    }();
+#endif
+}
+
+uint32_t crc32c(uint32_t crc, const void *data, size_t length) {
+    const auto *bytes = static_cast<const unsigned char *>(data);
+    crc = ~crc;
+#ifdef WISHLIST_CRC32C_SSE42
+    if (hasSse42) {
+        return ~crc32cHardware(bytes, length, crc);
+    }
+#endif
+    return ~crc32cTable(bytes, length, crc);
+}
@@ -0,0 +1,285 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+
+#include "../include/csv.h"
+#include "../include/logger.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define WISHLIST_CSV_X86 1
+#endif
+
+namespace {
+    constexpr size_t WRITE_BUFFER_BYTES = 1 << 16;
+
+    size_t scanScalar(const char *data, size_t length, const std::array<char, 4> &needles) {
+        for (size_t i = 0; i < length; ++i) {
+            char c = data[i];
+            if (c == needles[0] || c == needles[1] || c == needles[2] || c == needles[3]) return i;
+        }
+        return length;
+    }
+
+#ifdef WISHLIST_CSV_X86
+    __attribute__((target("sse2")))
+    size_t scanSse2(const char *data, size_t length, const std::array<char, 4> &needles) {
+        const __m128i n0 = _mm_set1_epi8(needles[0]);
+        const __m128i n1 = _mm_set1_epi8(needles[1]);
+        const __m128i n2 = _mm_set1_epi8(needles[2]);
+        const __m128i n3 = _mm_set1_epi8(needles[3]);
+        size_t i = 0;
+        for (; i + 16 <= length; i += 16) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+            __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, n0), _mm_cmpeq_epi8(block, n1)),
+                                        _mm_or_si128(_mm_cmpeq_epi8(block, n2), _mm_cmpeq_epi8(block, n3)));
+            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hits));
+            if (mask != 0) return i + __builtin_ctz(mask);
+        }
+        return i + scanScalar(data + i, length - i, needles);
+    }
+
+    __attribute__((target("avx2")))
+    size_t scanAvx2(const char *data, size_t length, const std::array<char, 4> &needles) {
+        const __m256i n0 = _mm256_set1_epi8(needles[0]);
+        const __m256i n1 = _mm256_set1_epi8(needles[1]);
+        const __m256i n2 = _mm256_set1_epi8(needles[2]);
+        const __m256i n3 = _mm256_set1_epi8(needles[3]);
+        size_t i = 0;
+        for (; i + 32 <= length; i += 32) {
+            __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+            __m256i hits = _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(block, n0), _mm256_cmpeq_epi8(block, n1)),
+                _mm256_or_si256(_mm256_cmpeq_epi8(block, n2), _mm256_cmpeq_epi8(block, n3)));
+            unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(hits));
+            if (mask != 0) return i + __builtin_ctz(mask);
+        }
+        // Short fields end here; 128-bit AVX rather than the SSE2 function, whose
+        // legacy encoding would pay the AVX-SSE transition penalty
+        if (i + 16 <= length) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+            __m128i hits = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(block, _mm256_castsi256_si128(n0)),
+                             _mm_cmpeq_epi8(block, _mm256_castsi256_si128(n1))),
+                _mm_or_si128(_mm_cmpeq_epi8(block, _mm256_castsi256_si128(n2)),
+                             _mm_cmpeq_epi8(block, _mm256_castsi256_si128(n3))));
+            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hits));
+            if (mask != 0) return i + __builtin_ctz(mask);
+            i += 16;
+        }
+        _mm256_zeroupper();
+        return i + scanScalar(data + i, length - i, needles);
+    }
+
+    // Static initializers may run before libgcc detected the CPU, hence the explicit init
+    const int x86Level = [] {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) return 2;
+        return __builtin_cpu_supports("sse2") ? 1 : 0;
+    }();
+#endif
+
+    size_t scan(const char *data, size_t length, const std::array<char, 4> &needles) {
+#ifdef WISHLIST_CSV_X86
+        if (x86Level == 2) return scanAvx2(data, length, needles);
+        if (x86Level == 1) return scanSse2(data, length, needles);
+#endif
+        return scanScalar(data, length, needles);
+    }
+
+    bool isLineBreak(char c) {
+        return c == '\n' || c == '\r';
+    }
+}
+
+size_t Csv::findFirstOf(std::string_view text, const std::array<char, 4> &needles) {
+    return scan(text.data(), text.size(), needles);
+}
+
+size_t Csv::findFirstOfScalar(std::string_view text, const std::array<char, 4> &needles) {
+    return scanScalar(text.data(), text.size(), needles);
+}
+
+const char *Csv::scanImplementation() {
+#ifdef WISHLIST_CSV_X86
+    if (x86Level == 2) return "avx2";
+    if (x86Level == 1) return "sse2";
+#endif
+    return "scalar";
+}
+
+std::vector<std::string_view> Csv::splitRecords(std::string_view text, unsigned maxChunks, size_t minChunkBytes,
+                                                char delimiter) {
+    std::vector<std::string_view> chunks;
+    if (text.empty()) return chunks;
+
+    size_t chunkCount = std::max<size_t>(1, maxChunks);
+    size_t byCount = (text.size() + chunkCount - 1) / chunkCount;
+    size_t target = std::max<size_t>({byCount, minChunkBytes, 1});
+    const std::array<char, 4> needles{'"', '\n', '\r', delimiter};
+
+    // Follows the reader: a quote opens a quoted field only as the field's
+    // first character; elsewhere it is plain text, as in 24" monitor
+    size_t pos = 0;
+    size_t fieldStart = 0;
+    size_t start = 0;
+    while (start < text.size()) {
+        if (text.size() - start <= target) {
+            chunks.push_back(text.substr(start));
+            break;
+        }
+        size_t end = text.size();
+        while (pos < text.size()) {
+            pos += scan(text.data() + pos, text.size() - pos, needles);
+            if (pos == text.size()) break;
+            char c = text[pos++];
+            if (c == '"') {
+                if (pos - 1 != fieldStart) continue;
+                // Skip to the closing quote; "" is an escaped quote
+                while (true) {
+                    const void *quote = std::memchr(text.data() + pos, '"', text.size() - pos);
+                    pos = quote ? static_cast<const char *>(quote) - text.data() + 1 : text.size();
+                    if (pos >= text.size() || text[pos] != '"') break;
+                    pos++;
+                }
+                continue;
+            }
+            fieldStart = pos;
+            // CRLF ends at the LF
+            bool recordEnd = c == '\n' || (c == '\r' && (pos == text.size() || text[pos] != '\n'));
+            if (recordEnd && pos >= start + target) {
+                end = pos;
+                break;
+            }
+        }
+        chunks.push_back(text.substr(start, end - start));
+        start = end;
+    }
+    return chunks;
+}
+
+CsvReader::CsvReader(std::string_view text, char delimiter) : text(text), delimiter(delimiter) {
+    if (text.substr(0, Csv::BOM.size()) == Csv::BOM) {
+        position = Csv::BOM.size();
+    }
+}
+
+size_t CsvReader::readQuoted(std::string &field) {
+    size_t pos = position + 1; // Past the opening quote
+    while (true) {
+        const void *quote = std::memchr(text.data() + pos, '"', text.size() - pos);
+        if (quote == nullptr) {
+            LOG_WARNING("CsvReader: Unterminated quoted field in record ", records + 1);
+            field.append(text.data() + pos, text.size() - pos);
+            return text.size();
+        }
+        size_t at = static_cast<const char *>(quote) - text.data();
+        field.append(text.data() + pos, at - pos);
+        if (at + 1 < text.size() && text[at + 1] == '"') {
+            field.push_back('"');
+            pos = at + 2;
+            continue;
+        }
+        return at + 1;
+    }
+}
+
+bool CsvReader::next(std::vector<std::string> &fields) {
+    if (position >= text.size()) return false;
+
+    const std::array<char, 4> needles{delimiter, '\n', '\r', delimiter};
+    size_t count = 0;
+    while (true) {
+        if (count == fields.size()) fields.emplace_back();
+        std::string &field = fields[count++];
+        field.clear();
+
+        if (position < text.size() && text[position] == '"') {
+            position = readQuoted(field);
+        }
+        // Unquoted text, or stray characters after a closing quote
+        size_t length = scan(text.data() + position, text.size() - position, needles);
+        field.append(text.data() + position, length);
+        position += length;
+
+        if (position < text.size() && text[position] == delimiter) {
+            position++;
+            continue;
+        }
+        if (position < text.size() && isLineBreak(text[position])) {
+            if (text[position] == '\r' && position + 1 < text.size() && text[position + 1] == '\n') position++;
+            position++;
+        }
+        break;
+    }
+    fields.resize(count);
+    records++;
+    return true;
+}
+
+CsvWriter::CsvWriter(std::ostream &out, CsvOptions options) : out(out), options(options) {
+    buffer.reserve(WRITE_BUFFER_BYTES);
+    if (options.writeBom) buffer += Csv::BOM;
+}
+
+CsvWriter::~CsvWriter() {
+    flush();
+}
+
+void CsvWriter::separate() {
+    if (recordStarted) buffer.push_back(options.delimiter);
+    recordStarted = true;
+}
+
+CsvWriter &CsvWriter::field(std::string_view value) {
+    separate();
+    const std::array<char, 4> needles{options.delimiter, '"', '\n', '\r'};
+    size_t special = scan(value.data(), value.size(), needles);
+    if (special == value.size()) {
+        buffer += value;
+        return *this;
+    }
+
+    buffer.push_back('"');
+    buffer.append(value.data(), special);
+    for (size_t i = special; i < value.size(); ++i) {
+        if (value[i] == '"') buffer.push_back('"');
+        buffer.push_back(value[i]);
+    }
+    buffer.push_back('"');
+    return *this;
+}
+
+CsvWriter &CsvWriter::field(double value) {
+    separate();
+    char text[32];
+    auto result = std::to_chars(text, text + sizeof(text), value);
+    buffer.append(text, result.ptr);
+    return *this;
+}
+
+CsvWriter &CsvWriter::field(int value) {
+    separate();
+    char text[16];
+    auto result = std::to_chars(text, text + sizeof(text), value);
+    buffer.append(text, result.ptr);
+    return *this;
+}
+
+void CsvWriter::endRecord() {
+    buffer += options.crlf ? "\r\n" : "\n";
+    recordStarted = false;
+    if (buffer.size() >= WRITE_BUFFER_BYTES) flush();
+}
+
+bool CsvWriter::flush() {
+    if (!buffer.empty()) {
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        buffer.clear();
+    }
+    return static_cast<bool>(out);
+}
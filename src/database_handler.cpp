@@ -4,10 +4,360 @@
 
 #include "include/database_handler.h"
 #include "include/logger.h"
+#include "include/sql_functions.h"
 #include <iostream>
 #include <sstream>
+#include <cctype>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <thread>
+
+namespace {
+    // Every statement DatabaseHandler runs, so they can be checked with EXPLAIN QUERY PLAN
+    namespace Sql {
+        constexpr const char *INSERT_USER = "INSERT INTO users (username) VALUES (?);";
+        constexpr const char *SELECT_USER_ID = "SELECT id FROM users WHERE username = ?;";
+        constexpr const char *SELECT_ALL_USERS = "SELECT username FROM users ORDER BY username;";
+        constexpr const char *INSERT_ITEM =
+            "INSERT INTO items (user_id, name, price, purchased, category, priority, notes, link) "
+            "VALUES (?, ?, ?, ?, ?, ?, ?, ?);";
+        constexpr const char *UPSERT_ITEM =
+            "INSERT INTO items (id, user_id, name, price, purchased, category, priority, notes, link) "
+            "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?) "
+            "ON CONFLICT(id) DO UPDATE SET name=excluded.name, price=excluded.price, purchased=excluded.purchased, "
+            "category=excluded.category, priority=excluded.priority, notes=excluded.notes, link=excluded.link, "
+            "updated_at=CURRENT_TIMESTAMP "
+            "WHERE items.user_id=excluded.user_id;";
+        constexpr const char *DELETE_ITEM = "DELETE FROM items WHERE id = ? AND user_id = ?;";
+        constexpr const char *DELETE_USER_ITEMS = "DELETE FROM items WHERE user_id = ?;";
+        constexpr const char *SAVE_BUDGET =
+            "INSERT OR REPLACE INTO budgets (user_id, max_budget, enabled, updated_at) "
+            "VALUES (?, ?, ?, CURRENT_TIMESTAMP);";
+        // The spent amount is the purchased total that the stats triggers keep current
+        constexpr const char *SELECT_BUDGET =
+            "SELECT b.max_budget, COALESCE(s.purchased_value, 0), b.enabled FROM budgets b "
+            "LEFT JOIN user_stats s ON s.user_id = b.user_id WHERE b.user_id = ?;";
+        constexpr const char *COUNT_ITEMS = "SELECT COUNT(*) FROM items WHERE user_id = ?;";
+        constexpr const char *SUM_ITEMS = "SELECT SUM(price) FROM items WHERE user_id = ?;";
+        constexpr const char *SELECT_MAX_ITEM_ID = "SELECT MAX(id) FROM items;";
+        constexpr const char *SELECT_ITEM_WITH_OWNER =
+            "SELECT i.id, i.name, i.price, i.purchased, i.category, i.priority, i.notes, i.link, u.username "
+            "FROM items i JOIN users u ON u.id = i.user_id WHERE i.id = ?;";
+        constexpr const char *INSERT_PRICE =
+            "INSERT INTO price_history (item_id, price, recorded_at) VALUES (?, ?, datetime(?, 'unixepoch'));";
+        constexpr const char *PRICE_SUMMARY =
+            "SELECT COUNT(*), MIN(price), MAX(price) FROM price_history "
+            "WHERE item_id = ? AND recorded_at >= datetime(?, 'unixepoch') AND recorded_at < datetime(?, 'unixepoch');";
+        constexpr const char *LATEST_PRICE =
+            "SELECT price, CAST(strftime('%s', recorded_at) AS INTEGER) FROM price_history "
+            "WHERE item_id = ? AND recorded_at >= datetime(?, 'unixepoch') AND recorded_at < datetime(?, 'unixepoch') "
+            "ORDER BY recorded_at DESC, id DESC LIMIT 1;";
+        constexpr const char *PRICE_SERIES =
+            "SELECT CAST(strftime('%s', recorded_at) AS INTEGER), price FROM price_history "
+            "WHERE item_id = ? AND recorded_at >= datetime(?, 'unixepoch') AND recorded_at < datetime(?, 'unixepoch') "
+            "ORDER BY recorded_at, id;";
+        constexpr const char *PRICE_DROPS =
+            "SELECT i.id, i.name, MAX(h.price) AS peak, i.price FROM items i "
+            "JOIN price_history h ON h.item_id = i.id AND h.recorded_at >= datetime(?, 'unixepoch') "
+            "WHERE i.user_id = ? GROUP BY i.id "
+            "HAVING peak > 0 AND (peak - i.price) * 100.0 / peak >= ? "
+            "ORDER BY (peak - i.price) / peak DESC;";
+        // Keeps the newest row per item and time bucket among rows older than the cutoff
+        constexpr const char *COMPACT_PRICE_HISTORY =
+            "DELETE FROM price_history WHERE id IN ("
+            "SELECT id FROM (SELECT id, ROW_NUMBER() OVER ("
+            "PARTITION BY item_id, CAST(strftime('%s', recorded_at) AS INTEGER) / ? "
+            "ORDER BY recorded_at DESC, id DESC) AS rn "
+            "FROM price_history WHERE recorded_at < datetime(?, 'unixepoch')) WHERE rn > 1);";
+        constexpr const char *SELECT_USER_STATS =
+            "SELECT item_count, total_value, purchased_count, purchased_value FROM user_stats WHERE user_id = ?;";
+        constexpr const char *SELECT_CATEGORY_STATS =
+            "SELECT category, item_count, total_value, purchased_value FROM user_category_stats "
+            "WHERE user_id = ? AND item_count > 0;";
+        constexpr const char *REBUILD_USER_STATS =
+            "DELETE FROM user_stats; DELETE FROM user_category_stats; "
+            "INSERT INTO user_stats (user_id, item_count, total_value, purchased_count, purchased_value) "
+            "SELECT user_id, COUNT(*), TOTAL(price), SUM(purchased != 0), "
+            "TOTAL(CASE WHEN purchased != 0 THEN price ELSE 0 END) FROM items GROUP BY user_id; "
+            "INSERT INTO user_category_stats (user_id, category, item_count, total_value, purchased_value) "
+            "SELECT user_id, category, COUNT(*), TOTAL(price), "
+            "TOTAL(CASE WHEN purchased != 0 THEN price ELSE 0 END) FROM items GROUP BY user_id, category;";
+        // Stored totals next to totals recomputed from items, for every user
+        constexpr const char *CHECK_USER_STATS =
+            "SELECT u.username, COALESCE(s.item_count, 0), COALESCE(s.total_value, 0), "
+            "COALESCE(s.purchased_count, 0), COALESCE(s.purchased_value, 0), "
+            "COUNT(i.id), TOTAL(i.price), COALESCE(SUM(i.purchased != 0), 0), "
+            "TOTAL(CASE WHEN i.purchased != 0 THEN i.price ELSE 0 END) "
+            "FROM users u LEFT JOIN user_stats s ON s.user_id = u.id LEFT JOIN items i ON i.user_id = u.id "
+            "GROUP BY u.id;";
+        // Same per category; a row missing on either side counts as zeros
+        constexpr const char *CHECK_CATEGORY_STATS =
+            "WITH actual AS (SELECT user_id, category, COUNT(*) AS item_count, TOTAL(price) AS total_value, "
+            "TOTAL(CASE WHEN purchased != 0 THEN price ELSE 0 END) AS purchased_value "
+            "FROM items GROUP BY user_id, category), "
+            "keys AS (SELECT user_id, category FROM actual UNION SELECT user_id, category FROM user_category_stats) "
+            "SELECT u.username, k.category, COALESCE(s.item_count, 0), COALESCE(s.total_value, 0), "
+            "COALESCE(s.purchased_value, 0), COALESCE(a.item_count, 0), COALESCE(a.total_value, 0), "
+            "COALESCE(a.purchased_value, 0) "
+            "FROM keys k JOIN users u ON u.id = k.user_id "
+            "LEFT JOIN user_category_stats s ON s.user_id = k.user_id AND s.category = k.category "
+            "LEFT JOIN actual a ON a.user_id = k.user_id AND a.category = k.category;";
+        constexpr const char *SEARCH_ITEMS =
+            "SELECT i.id, i.name, i.price, i.purchased, i.category, i.priority, i.notes, i.link "
+            "FROM items_fts JOIN items i ON i.id = items_fts.rowid "
+            "WHERE items_fts MATCH ? AND i.user_id = ? "
+            "ORDER BY bm25(items_fts, 10.0, 1.0) LIMIT ?;";
+        constexpr const char *SEARCH_ITEMS_LIKE =
+            "SELECT id, name, price, purchased, category, priority, notes, link FROM items "
+            "WHERE user_id = ? AND (name LIKE ? ESCAPE '\\' OR notes LIKE ? ESCAPE '\\') ORDER BY id LIMIT ?;";
+        // trigram_sim and price_bucket are registered by SqlFunctions
+        constexpr const char *FUZZY_SEARCH_ITEMS =
+            "SELECT id, name, price, purchased, category, priority, notes, link, trigram_sim(name, ?) AS score "
+            "FROM items WHERE user_id = ? AND score >= ? ORDER BY score DESC, id LIMIT ?;";
+        constexpr const char *PRICE_HISTOGRAM =
+            "SELECT price_bucket(price, ?) AS bucket, COUNT(*), TOTAL(price), SUM(purchased != 0) FROM items "
+            "WHERE user_id = ? GROUP BY bucket ORDER BY bucket;";
+    }
+
+    const char *orderByClause(SortOrder order) {
+        switch (order) {
+            case SortOrder::BY_PRIORITY: return " ORDER BY priority DESC, price DESC";
+            case SortOrder::BY_PRICE_ASC: return " ORDER BY price ASC";
+            case SortOrder::BY_PRICE_DESC: return " ORDER BY price DESC";
+            case SortOrder::BY_NAME: return " ORDER BY name";
+            case SortOrder::BY_CATEGORY: return " ORDER BY category, id";
+            case SortOrder::BY_ID: return " ORDER BY id";
+        }
+        return " ORDER BY id";
+    }
+
+    std::string escapeLike(const std::string &text) {
+        std::string escaped;
+        for (char c: text) {
+            if (c == '%' || c == '_' || c == '\\') escaped += '\\';
+            escaped += c;
+        }
+        return escaped;
+    }
+
+    // WHERE clause for an ItemQuery; parameter 1 is always the user id
+    std::string buildWhereClause(const ItemQuery &query) {
+        std::string where = " WHERE user_id = ?";
+        if (query.purchased) where += " AND purchased = ?";
+        if (query.category) where += " AND category = ?";
+        if (query.minPrice) where += " AND price >= ?";
+        if (query.maxPrice) where += " AND price <= ?";
+        if (!query.nameContains.empty()) where += " AND name LIKE ? ESCAPE '\\'";
+        return where;
+    }
+
+    // Binds parameters in the same order as buildWhereClause
+    int bindQueryParameters(sqlite3_stmt *stmt, int userId, const ItemQuery &query) {
+        int index = 1;
+        sqlite3_bind_int(stmt, index++, userId);
+        if (query.purchased) sqlite3_bind_int(stmt, index++, *query.purchased ? 1 : 0);
+        if (query.category) sqlite3_bind_int(stmt, index++, static_cast<int>(*query.category));
+        if (query.minPrice) sqlite3_bind_double(stmt, index++, *query.minPrice);
+        if (query.maxPrice) sqlite3_bind_double(stmt, index++, *query.maxPrice);
+        if (!query.nameContains.empty()) {
+            std::string pattern = "%" + escapeLike(query.nameContains) + "%";
+            sqlite3_bind_text(stmt, index++, pattern.c_str(), -1, SQLITE_TRANSIENT);
+        }
+        return index;
+    }
+
+    std::string_view columnView(sqlite3_stmt *stmt, int column) {
+        const char *text = reinterpret_cast<const char *>(sqlite3_column_text(stmt, column));
+        if (!text) return {};
+        return {text, static_cast<size_t>(sqlite3_column_bytes(stmt, column))};
+    }
+
+    // Incremental sqlite3_backup copy of src's main database into dest. Locks on
+    // the source are only held inside a single step.
+    bool copyDatabase(sqlite3 *dest, sqlite3 *src, int pagesPerStep, const BackupProgress &progress,
+                      std::chrono::milliseconds pause) {
+        sqlite3_backup *backup = sqlite3_backup_init(dest, "main", src, "main");
+        if (!backup) {
+            LOG_ERROR("DatabaseHandler: Failed to start backup: ", sqlite3_errmsg(dest));
+            return false;
+        }
+        if (pagesPerStep <= 0) pagesPerStep = -1; // -1 copies everything in one step
+
+        int result;
+        bool cancelled = false;
+        do {
+            result = sqlite3_backup_step(backup, pagesPerStep);
+
+            if (progress && !progress(sqlite3_backup_remaining(backup), sqlite3_backup_pagecount(backup))) {
+                cancelled = true;
+                break;
+            }
+            // BUSY/LOCKED: another connection holds a conflicting lock, retry after the pause
+            if ((result == SQLITE_OK || result == SQLITE_BUSY || result == SQLITE_LOCKED) && pause.count() > 0) {
+                std::this_thread::sleep_for(pause);
+            }
+        } while (result == SQLITE_OK || result == SQLITE_BUSY || result == SQLITE_LOCKED);
+
+        sqlite3_backup_finish(backup);
+
+        if (cancelled) {
+            LOG_WARNING("DatabaseHandler: Backup cancelled");
+            return false;
+        }
+        if (result != SQLITE_DONE) {
+            LOG_ERROR("DatabaseHandler: Backup failed: ", sqlite3_errstr(result));
+            return false;
+        }
+        return true;
+    }
+}
+
+std::string DatabaseHandler::buildItemQuerySql(const ItemQuery &query) {
+    std::string sql = "SELECT id, name, price, purchased, category, priority, notes, link FROM items" +
+                      buildWhereClause(query) + orderByClause(query.order);
+    if (query.limit >= 0 || query.offset > 0) {
+        sql += " LIMIT " + std::to_string(query.limit) + " OFFSET " + std::to_string(query.offset);
+    }
+    return sql + ";";
+}
+
+std::string DatabaseHandler::buildStatsSql(const ItemQuery &query) {
+    // One grouped pass yields the per-category sums; the totals are summed from those
+    return "SELECT category, COUNT(*), TOTAL(price), SUM(purchased != 0), "
+           "TOTAL(CASE WHEN purchased != 0 THEN price ELSE 0 END) FROM items" +
+           buildWhereClause(query) + " GROUP BY category;";
+}
+
+std::vector<std::pair<std::string, std::string> > DatabaseHandler::statementCatalog() {
+    std::vector<std::pair<std::string, std::string> > catalog = {
+        {"INSERT_USER", Sql::INSERT_USER},
+        {"SELECT_USER_ID", Sql::SELECT_USER_ID},
+        {"SELECT_ALL_USERS", Sql::SELECT_ALL_USERS},
+        {"INSERT_ITEM", Sql::INSERT_ITEM},
+        {"UPSERT_ITEM", Sql::UPSERT_ITEM},
+        {"DELETE_ITEM", Sql::DELETE_ITEM},
+        {"DELETE_USER_ITEMS", Sql::DELETE_USER_ITEMS},
+        {"SAVE_BUDGET", Sql::SAVE_BUDGET},
+        {"SELECT_BUDGET", Sql::SELECT_BUDGET},
+        {"COUNT_ITEMS", Sql::COUNT_ITEMS},
+        {"SUM_ITEMS", Sql::SUM_ITEMS},
+        {"SELECT_MAX_ITEM_ID", Sql::SELECT_MAX_ITEM_ID},
+        {"SELECT_ITEM_WITH_OWNER", Sql::SELECT_ITEM_WITH_OWNER},
+        {"INSERT_PRICE", Sql::INSERT_PRICE},
+        {"PRICE_SUMMARY", Sql::PRICE_SUMMARY},
+        {"LATEST_PRICE", Sql::LATEST_PRICE},
+        {"PRICE_SERIES", Sql::PRICE_SERIES},
+        {"PRICE_DROPS", Sql::PRICE_DROPS},
+        {"COMPACT_PRICE_HISTORY", Sql::COMPACT_PRICE_HISTORY},
+        {"SELECT_USER_STATS", Sql::SELECT_USER_STATS},
+        {"SELECT_CATEGORY_STATS", Sql::SELECT_CATEGORY_STATS},
+        {"CHECK_USER_STATS", Sql::CHECK_USER_STATS},
+        {"CHECK_CATEGORY_STATS", Sql::CHECK_CATEGORY_STATS},
+        {"SEARCH_ITEMS", Sql::SEARCH_ITEMS},
+        {"SEARCH_ITEMS_LIKE", Sql::SEARCH_ITEMS_LIKE},
+        {"FUZZY_SEARCH_ITEMS", Sql::FUZZY_SEARCH_ITEMS},
+        {"PRICE_HISTOGRAM", Sql::PRICE_HISTOGRAM},
+    };
+
+    // Dynamic queries: one representative per filter, plus all filters combined
+    std::vector<std::pair<std::string, ItemQuery> > queries(6);
+    queries[0].first = "QUERY_ALL";
+    queries[1].first = "QUERY_PURCHASED";
+    queries[1].second.purchased = true;
+    queries[2].first = "QUERY_CATEGORY";
+    queries[2].second.category = Category::BOOKS;
+    queries[3].first = "QUERY_PRICE_RANGE";
+    queries[3].second.minPrice = 10.0;
+    queries[3].second.maxPrice = 20.0;
+    queries[3].second.order = SortOrder::BY_PRICE_ASC;
+    queries[4].first = "QUERY_NAME";
+    queries[4].second.nameContains = "x";
+    queries[4].second.order = SortOrder::BY_NAME;
+    queries[5].first = "QUERY_COMBINED";
+    queries[5].second.purchased = false;
+    queries[5].second.category = Category::TOYS;
+    queries[5].second.maxPrice = 50.0;
+    queries[5].second.limit = 10;
+    queries[5].second.order = SortOrder::BY_PRIORITY;
+
+    for (const auto &[name, query]: queries) {
+        catalog.emplace_back(name, buildItemQuerySql(query));
+        catalog.emplace_back(name + "_STATS", buildStatsSql(query));
+    }
+    return catalog;
+}
+
+bool DatabaseHandler::explainQueryPlan(const std::string &sql, std::vector<std::string> &plan) {
+    plan.clear();
+    sqlite3_stmt *stmt;
+
+    if (!prepareStatement("EXPLAIN QUERY PLAN " + sql, &stmt)) {
+        return false;
+    }
+
+    // Columns: id, parent, notused, detail
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        plan.emplace_back(reinterpret_cast<const char *>(sqlite3_column_text(stmt, 3)));
+    }
+
+    sqlite3_finalize(stmt);
+    return true;
+}
+
+ItemCursor::ItemCursor(sqlite3_stmt *stmt) : stmt(stmt) {
+}
+
+ItemCursor::~ItemCursor() {
+    if (stmt) {
+        sqlite3_finalize(stmt);
+    }
+}
+
+ItemCursor::ItemCursor(ItemCursor &&other) noexcept : stmt(other.stmt), current(other.current) {
+    other.stmt = nullptr;
+}
 
-DatabaseHandler::DatabaseHandler(const std::string &dbPath) : db(nullptr), dbPath(dbPath) {
+ItemCursor &ItemCursor::operator=(ItemCursor &&other) noexcept {
+    if (this != &other) {
+        if (stmt) sqlite3_finalize(stmt);
+        stmt = other.stmt;
+        current = other.current;
+        other.stmt = nullptr;
+    }
+    return *this;
+}
+
+bool ItemCursor::step() {
+    if (!stmt) return false;
+
+    if (sqlite3_step(stmt) != SQLITE_ROW) {
+        sqlite3_finalize(stmt);
+        stmt = nullptr;
+        current = ItemRowView();
+        return false;
+    }
+
+    current.id = sqlite3_column_int(stmt, 0);
+    current.name = columnView(stmt, 1);
+    current.price = sqlite3_column_double(stmt, 2);
+    current.purchased = sqlite3_column_int(stmt, 3) != 0;
+    current.category = static_cast<Category>(sqlite3_column_int(stmt, 4));
+    current.priority = static_cast<Priority>(sqlite3_column_int(stmt, 5));
+    current.notes = columnView(stmt, 6);
+    current.link = columnView(stmt, 7);
+    return true;
+}
+
+bool ItemCursor::next(WishItem &item) {
+    if (!step()) return false;
+    current.copyTo(item);
+    return true;
+}
+
+DatabaseHandler::DatabaseHandler(const std::string &dbPath) : db(nullptr), dbPath(dbPath), ftsAvailable(false) {
     LOG_INFO("DatabaseHandler: Created with path: ", dbPath);
 }
 
@@ -19,14 +369,29 @@ DatabaseHandler::~DatabaseHandler() {
 }
 
 bool DatabaseHandler::initialize() {
-    int result = sqlite3_open(dbPath.c_str(), &db);
+    // Serialized mode: the connection may be shared with the PersistenceQueue writer thread
+    int result = sqlite3_open_v2(dbPath.c_str(), &db, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_FULLMUTEX,
+                                 nullptr);
 
     if (result != SQLITE_OK) {
         LOG_ERROR("DatabaseHandler: Failed to open database: ", sqlite3_errmsg(db));
         return false;
     }
     LOG_INFO("DatabaseHandler: Database opened successfully");
+    sqlite3_busy_timeout(db, 5000);
+    sqlite3_update_hook(db, &DatabaseHandler::updateHook, this);
+    sqlite3_commit_hook(db, &DatabaseHandler::commitHook, this);
+    sqlite3_rollback_hook(db, &DatabaseHandler::rollbackHook, this);
+    if (!SqlFunctions::registerAll(db)) {
+        return false;
+    }
     executeSQL("PRAGMA foreign_keys = ON;");
+
+    // auto_vacuum only takes effect before the first table is created; WAL lets the
+    // MaintenanceScheduler checkpoint and vacuum without blocking readers
+    executeSQL("PRAGMA auto_vacuum = INCREMENTAL;");
+    executeSQL("PRAGMA journal_mode = WAL;");
+    executeSQL("PRAGMA synchronous = NORMAL;");
     return createTables();
 }
 
@@ -61,7 +426,7 @@ bool DatabaseHandler::createTables() {
             id INTEGER PRIMARY KEY AUTOINCREMENT,
             user_id INTEGER UNIQUE NOT NULL,
             max_budget REAL DEFAULT 0.0,
-            spent_amount REAL DEFAULT 0.0,
+            spent_amount REAL DEFAULT 0.0, -- No longer written; the spent amount comes from user_stats
             enabled INTEGER DEFAULT 0,
             updated_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
             FOREIGN KEY(user_id) REFERENCES users(id) ON DELETE CASCADE
@@ -78,22 +443,188 @@ bool DatabaseHandler::createTables() {
         );
     )";
 
-    // Create indexes for better performance
+    // Indexes match the access paths: every item query filters by user_id first.
+    // idx_items_user_id keeps per-user scans in ID order without a sort,
+    // idx_items_user_category covers the statistics aggregates.
+    // The old single-column purchased/category indexes only cost write throughput.
+    // idx_price_history_item_time serves the ON DELETE CASCADE from items.
     const char *createIndexes = R"(
         CREATE INDEX IF NOT EXISTS idx_items_user_id ON items(user_id);
-        CREATE INDEX IF NOT EXISTS idx_items_purchased ON items(purchased);
-        CREATE INDEX IF NOT EXISTS idx_items_category ON items(category);
+        CREATE INDEX IF NOT EXISTS idx_items_user_purchased_price ON items(user_id, purchased, price);
+        CREATE INDEX IF NOT EXISTS idx_items_user_category ON items(user_id, category, purchased, price);
+        DROP INDEX IF EXISTS idx_items_purchased;
+        DROP INDEX IF EXISTS idx_items_category;
+        CREATE INDEX IF NOT EXISTS idx_price_history_item_time ON price_history(item_id, recorded_at);
+    )";
+
+    // Every price an item had is recorded, both on insert and when saveItem changes it
+    const char *createPriceTriggers = R"(
+        CREATE TRIGGER IF NOT EXISTS trg_items_price_insert AFTER INSERT ON items BEGIN
+            INSERT INTO price_history(item_id, price) VALUES (new.id, new.price);
+        END;
+        CREATE TRIGGER IF NOT EXISTS trg_items_price_update AFTER UPDATE OF price ON items
+        WHEN old.price IS NOT new.price BEGIN
+            INSERT INTO price_history(item_id, price) VALUES (new.id, new.price);
+        END;
     )";
 
     bool success = executeSQL(createUsersTable) && executeSQL(createItemsTable) && executeSQL(createBudgetTable) &&
-                   executeSQL(createPriceHistoryTable) && executeSQL(createIndexes);
+                   executeSQL(createPriceHistoryTable) && executeSQL(createIndexes) && executeSQL(createPriceTriggers);
     if (success) {
         LOG_INFO("DatabaseHandler: All tables created successfully");
     } else {
         LOG_ERROR("DatabaseHandler: Failed to create tables");
+        return false;
     }
 
-    return success;
+    ftsAvailable = createFullTextIndex();
+    return createUserStats();
+}
+
+bool DatabaseHandler::createUserStats() {
+    // Per-user aggregates kept current by triggers, so totals are single-row reads
+    const char *createStatsTables = R"(
+        CREATE TABLE IF NOT EXISTS user_stats (
+            user_id INTEGER PRIMARY KEY,
+            item_count INTEGER NOT NULL DEFAULT 0,
+            total_value REAL NOT NULL DEFAULT 0.0,
+            purchased_count INTEGER NOT NULL DEFAULT 0,
+            purchased_value REAL NOT NULL DEFAULT 0.0,
+            FOREIGN KEY(user_id) REFERENCES users(id) ON DELETE CASCADE
+        );
+        CREATE TABLE IF NOT EXISTS user_category_stats (
+            user_id INTEGER NOT NULL,
+            category INTEGER NOT NULL,
+            item_count INTEGER NOT NULL DEFAULT 0,
+            total_value REAL NOT NULL DEFAULT 0.0,
+            purchased_value REAL NOT NULL DEFAULT 0.0,
+            PRIMARY KEY(user_id, category),
+            FOREIGN KEY(user_id) REFERENCES users(id) ON DELETE CASCADE
+        ) WITHOUT ROWID;
+    )";
+
+    // Updates are applied as "remove old row, add new row" so moves between
+    // users or categories stay correct
+    const char *createStatsTriggers = R"(
+        CREATE TRIGGER IF NOT EXISTS trg_items_stats_insert AFTER INSERT ON items BEGIN
+            INSERT INTO user_stats (user_id, item_count, total_value, purchased_count, purchased_value)
+            VALUES (new.user_id, 1, new.price, new.purchased != 0, CASE WHEN new.purchased != 0 THEN new.price ELSE 0 END)
+            ON CONFLICT(user_id) DO UPDATE SET
+                item_count = item_count + 1,
+                total_value = total_value + excluded.total_value,
+                purchased_count = purchased_count + excluded.purchased_count,
+                purchased_value = purchased_value + excluded.purchased_value;
+            INSERT INTO user_category_stats (user_id, category, item_count, total_value, purchased_value)
+            VALUES (new.user_id, new.category, 1, new.price, CASE WHEN new.purchased != 0 THEN new.price ELSE 0 END)
+            ON CONFLICT(user_id, category) DO UPDATE SET
+                item_count = item_count + 1,
+                total_value = total_value + excluded.total_value,
+                purchased_value = purchased_value + excluded.purchased_value;
+        END;
+
+        CREATE TRIGGER IF NOT EXISTS trg_items_stats_delete AFTER DELETE ON items BEGIN
+            UPDATE user_stats SET
+                item_count = item_count - 1,
+                total_value = total_value - old.price,
+                purchased_count = purchased_count - (old.purchased != 0),
+                purchased_value = purchased_value - CASE WHEN old.purchased != 0 THEN old.price ELSE 0 END
+            WHERE user_id = old.user_id;
+            UPDATE user_category_stats SET
+                item_count = item_count - 1,
+                total_value = total_value - old.price,
+                purchased_value = purchased_value - CASE WHEN old.purchased != 0 THEN old.price ELSE 0 END
+            WHERE user_id = old.user_id AND category = old.category;
+        END;
+
+        CREATE TRIGGER IF NOT EXISTS trg_items_stats_update AFTER UPDATE OF user_id, price, purchased, category ON items
+        BEGIN
+            UPDATE user_stats SET
+                item_count = item_count - 1,
+                total_value = total_value - old.price,
+                purchased_count = purchased_count - (old.purchased != 0),
+                purchased_value = purchased_value - CASE WHEN old.purchased != 0 THEN old.price ELSE 0 END
+            WHERE user_id = old.user_id;
+            UPDATE user_category_stats SET
+                item_count = item_count - 1,
+                total_value = total_value - old.price,
+                purchased_value = purchased_value - CASE WHEN old.purchased != 0 THEN old.price ELSE 0 END
+            WHERE user_id = old.user_id AND category = old.category;
+            INSERT INTO user_stats (user_id, item_count, total_value, purchased_count, purchased_value)
+            VALUES (new.user_id, 1, new.price, new.purchased != 0, CASE WHEN new.purchased != 0 THEN new.price ELSE 0 END)
+            ON CONFLICT(user_id) DO UPDATE SET
+                item_count = item_count + 1,
+                total_value = total_value + excluded.total_value,
+                purchased_count = purchased_count + excluded.purchased_count,
+                purchased_value = purchased_value + excluded.purchased_value;
+            INSERT INTO user_category_stats (user_id, category, item_count, total_value, purchased_value)
+            VALUES (new.user_id, new.category, 1, new.price, CASE WHEN new.purchased != 0 THEN new.price ELSE 0 END)
+            ON CONFLICT(user_id, category) DO UPDATE SET
+                item_count = item_count + 1,
+                total_value = total_value + excluded.total_value,
+                purchased_value = purchased_value + excluded.purchased_value;
+        END;
+    )";
+
+    bool existed = false;
+    sqlite3_stmt *stmt;
+    if (prepareStatement("SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = 'user_stats';", &stmt)) {
+        existed = sqlite3_step(stmt) == SQLITE_ROW;
+        sqlite3_finalize(stmt);
+    }
+
+    if (!executeSQL(createStatsTables) || !executeSQL(createStatsTriggers)) {
+        LOG_ERROR("DatabaseHandler: Failed to create user statistics");
+        return false;
+    }
+
+    // Databases created before the statistics existed are backfilled once
+    return existed || rebuildUserStats();
+}
+
+bool DatabaseHandler::createFullTextIndex() {
+    // External-content FTS5 index over items, kept in sync by triggers
+    const char *createFtsTable = R"(
+        CREATE VIRTUAL TABLE IF NOT EXISTS items_fts USING fts5(
+            name, notes,
+            content='items', content_rowid='id',
+            tokenize='unicode61 remove_diacritics 2',
+            prefix='2 3'
+        );
+    )";
+
+    const char *createFtsTriggers = R"(
+        CREATE TRIGGER IF NOT EXISTS trg_items_fts_insert AFTER INSERT ON items BEGIN
+            INSERT INTO items_fts(rowid, name, notes) VALUES (new.id, new.name, new.notes);
+        END;
+        CREATE TRIGGER IF NOT EXISTS trg_items_fts_delete AFTER DELETE ON items BEGIN
+            INSERT INTO items_fts(items_fts, rowid, name, notes) VALUES ('delete', old.id, old.name, old.notes);
+        END;
+        CREATE TRIGGER IF NOT EXISTS trg_items_fts_update AFTER UPDATE OF name, notes ON items BEGIN
+            INSERT INTO items_fts(items_fts, rowid, name, notes) VALUES ('delete', old.id, old.name, old.notes);
+            INSERT INTO items_fts(rowid, name, notes) VALUES (new.id, new.name, new.notes);
+        END;
+    )";
+
+    bool existed = false;
+    sqlite3_stmt *stmt;
+    if (prepareStatement("SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = 'items_fts';", &stmt)) {
+        existed = sqlite3_step(stmt) == SQLITE_ROW;
+        sqlite3_finalize(stmt);
+    }
+
+    if (!executeSQL(createFtsTable)) {
+        LOG_WARNING("DatabaseHandler: FTS5 not available, search falls back to LIKE");
+        return false;
+    }
+    if (!executeSQL(createFtsTriggers)) {
+        return false;
+    }
+
+    // Databases created before the index existed need a one-time backfill
+    if (!existed && !executeSQL("INSERT INTO items_fts(items_fts) VALUES('rebuild');")) {
+        return false;
+    }
+    return true;
 }
 
 bool DatabaseHandler::executeSQL(const std::string &sql) {
@@ -119,12 +650,15 @@ bool DatabaseHandler::prepareStatement(const std::string &sql, sqlite3_stmt **st
 }
 
 bool DatabaseHandler::createUser(const std::string &username) {
+    auto writer = lockWriter();
+    if (!writer) return false;
+
     if (userExists(username)) {
         LOG_DEBUG("DatabaseHandler: User already exists: ", username);
         return true;
     }
 
-    const char *sql = "INSERT INTO users (username) VALUES (?);";
+    const char *sql = Sql::INSERT_USER;
     sqlite3_stmt *stmt;
 
     if (!prepareStatement(sql, &stmt)) {
@@ -136,7 +670,7 @@ bool DatabaseHandler::createUser(const std::string &username) {
     int result = sqlite3_step(stmt);
     sqlite3_finalize(stmt);
 
-    if (result != SQLITE_OK) {
+    if (result != SQLITE_DONE) {
         LOG_ERROR("DatabaseHandler: Failed to create user: ", sqlite3_errmsg(db));
         return false;
     }
@@ -146,7 +680,7 @@ bool DatabaseHandler::createUser(const std::string &username) {
 }
 
 int DatabaseHandler::getUserId(const std::string &username) {
-    const char *sql = "SELECT id FROM users WHERE username = ?;";
+    const char *sql = Sql::SELECT_USER_ID;
     sqlite3_stmt *stmt;
 
     if (!prepareStatement(sql, &stmt)) {
@@ -169,7 +703,7 @@ bool DatabaseHandler::userExists(const std::string &username) {
 
 std::vector<std::string> DatabaseHandler::getAllUsers() {
     std::vector<std::string> users;
-    const char *sql = "SELECT username FROM users ORDER BY username;";
+    const char *sql = Sql::SELECT_ALL_USERS;
     sqlite3_stmt *stmt;
 
     if (!prepareStatement(sql, &stmt)) {
@@ -186,6 +720,9 @@ std::vector<std::string> DatabaseHandler::getAllUsers() {
 }
 
 bool DatabaseHandler::saveItem(const WishItem &item, const std::string &owner) {
+    auto writer = lockWriter();
+    if (!writer) return false;
+
     // Ensure user exists
     if (!createUser(owner)) return false;
     int userId = getUserId(owner);
@@ -195,9 +732,7 @@ bool DatabaseHandler::saveItem(const WishItem &item, const std::string &owner) {
 
     if (item.getId() == 0) {
         // ITEM HAS NO ID → INSERT NEW
-        const char* sql =
-            "INSERT INTO items (user_id, name, price, purchased, category, priority, notes, link) "
-            "VALUES (?, ?, ?, ?, ?, ?, ?, ?);";
+        const char* sql = Sql::INSERT_ITEM;
 
         if (!prepareStatement(sql, &stmt)) return false;
 
@@ -212,35 +747,40 @@ bool DatabaseHandler::saveItem(const WishItem &item, const std::string &owner) {
 
         int result = sqlite3_step(stmt);
         sqlite3_finalize(stmt);
-        if (sqlite3_changes(db) == 0) {
-            LOG_ERROR("UPDATE did not modify any row!");
-        }
         if (result != SQLITE_DONE) return false;
 
         int newId = sqlite3_last_insert_rowid(db);
         const_cast<WishItem&>(item).setId(newId);
         return true;
     } else {
-        // ITEM EXISTS → UPDATE
-        const char* sql =
-            "UPDATE items SET name=?, price=?, purchased=?, category=?, priority=?, notes=?, link=?, updated_at=CURRENT_TIMESTAMP "
-            "WHERE id=? AND user_id=?;";
+        // ITEM HAS AN ID → UPSERT (items created in memory already carry their final ID)
+        const char* sql = Sql::UPSERT_ITEM;
 
         if (!prepareStatement(sql, &stmt)) return false;
 
-        sqlite3_bind_text(stmt, 1, item.getName().c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_double(stmt, 2, item.getPrice());
-        sqlite3_bind_int(stmt, 3, item.isPurchased());
-        sqlite3_bind_int(stmt, 4, (int)item.getCategory());
-        sqlite3_bind_int(stmt, 5, (int)item.getPriority());
-        sqlite3_bind_text(stmt, 6, item.getNotes().c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_text(stmt, 7, item.getLink().c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_int(stmt, 8, item.getId());
-        sqlite3_bind_int(stmt, 9, userId);
+        sqlite3_bind_int(stmt, 1, item.getId());
+        sqlite3_bind_int(stmt, 2, userId);
+        sqlite3_bind_text(stmt, 3, item.getName().c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_double(stmt, 4, item.getPrice());
+        sqlite3_bind_int(stmt, 5, item.isPurchased());
+        sqlite3_bind_int(stmt, 6, (int)item.getCategory());
+        sqlite3_bind_int(stmt, 7, (int)item.getPriority());
+        sqlite3_bind_text(stmt, 8, item.getNotes().c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 9, item.getLink().c_str(), -1, SQLITE_TRANSIENT);
 
         int result = sqlite3_step(stmt);
+        int changed = sqlite3_changes(db);
         sqlite3_finalize(stmt);
-        return result == SQLITE_DONE;
+        if (result != SQLITE_DONE) {
+            LOG_ERROR("DatabaseHandler: Failed to save item: ", sqlite3_errmsg(db));
+            return false;
+        }
+        if (changed == 0) {
+            // The upsert skips rows of other users, IDs are global
+            LOG_ERROR("DatabaseHandler: Item ID ", item.getId(), " belongs to another user");
+            return false;
+        }
+        return true;
     }
 
 }
@@ -250,12 +790,15 @@ bool DatabaseHandler::updateItem(const WishItem &item, const std::string &owner)
 }
 
 bool DatabaseHandler::deleteItem(int itemId, const std::string &owner) {
+    auto writer = lockWriter();
+    if (!writer) return false;
+
     int userId = getUserId(owner);
     if (userId == -1) {
         return false;
     }
 
-    const char *sql = "DELETE FROM items WHERE id = ? AND user_id = ?;";
+    const char *sql = Sql::DELETE_ITEM;
     sqlite3_stmt *stmt;
 
     if (!prepareStatement(sql, &stmt)) {
@@ -277,61 +820,310 @@ bool DatabaseHandler::deleteItem(int itemId, const std::string &owner) {
     return true;
 }
 
+bool DatabaseHandler::loadItem(int itemId, WishItem &item, std::string &owner) {
+    sqlite3_stmt *stmt;
+    if (!prepareStatement(Sql::SELECT_ITEM_WITH_OWNER, &stmt)) {
+        return false;
+    }
+    sqlite3_bind_int(stmt, 1, itemId);
+
+    bool found = sqlite3_step(stmt) == SQLITE_ROW;
+    if (found) {
+        ItemRowView row;
+        row.id = sqlite3_column_int(stmt, 0);
+        row.name = columnView(stmt, 1);
+        row.price = sqlite3_column_double(stmt, 2);
+        row.purchased = sqlite3_column_int(stmt, 3) != 0;
+        row.category = static_cast<Category>(sqlite3_column_int(stmt, 4));
+        row.priority = static_cast<Priority>(sqlite3_column_int(stmt, 5));
+        row.notes = columnView(stmt, 6);
+        row.link = columnView(stmt, 7);
+        row.copyTo(item);
+        owner = std::string(columnView(stmt, 8));
+    }
+    sqlite3_finalize(stmt);
+    return found;
+}
+
+size_t DatabaseHandler::forEachItem(const std::string &owner,
+                                    const std::function<bool(const ItemRowView &)> &callback) {
+    return queryItems(owner, ItemQuery(), callback);
+}
+
 std::vector<std::unique_ptr<WishItem> > DatabaseHandler::loadItems(const std::string &owner) {
     std::vector<std::unique_ptr<WishItem> > items;
 
-    int userId = getUserId(owner);
-    if (userId == -1) {
+    if (getUserId(owner) == -1) {
         LOG_ERROR("DatabaseHandler: User not found: ", owner);
         return items;
     }
 
-    const char *sql = R"(
-        SELECT id, name, price, purchased, category, priority, notes, link
-        FROM items
-        WHERE user_id = ?
-        ORDER BY id;
-    )";
+    forEachItem(owner, [&items](const ItemRowView &row) {
+        auto item = std::make_unique<WishItem>();
+        row.copyTo(*item);
+        items.push_back(std::move(item));
+        return true;
+    });
+
+    LOG_INFO("DatabaseHandler: Loaded ", items.size(), " items for user: ", owner);
+    return items;
+}
+
+std::string DatabaseHandler::buildFtsQuery(const std::string &text) {
+    // Quoted input becomes a phrase, every other word a prefix term; quoting
+    // each term keeps FTS5 operators in user input from being interpreted.
+    std::string result;
+    size_t pos = 0;
+
+    auto append = [&result](const std::string &term, bool prefix) {
+        if (term.empty()) return;
+        if (!result.empty()) result += ' ';
+        result += '"' + term + '"';
+        if (prefix) result += '*';
+    };
+
+    while (pos < text.size()) {
+        if (std::isspace(static_cast<unsigned char>(text[pos]))) {
+            pos++;
+        } else if (text[pos] == '"') {
+            size_t close = text.find('"', pos + 1);
+            if (close == std::string::npos) close = text.size();
+            append(text.substr(pos + 1, close - pos - 1), false);
+            pos = close + 1;
+        } else {
+            size_t end = pos;
+            while (end < text.size() && !std::isspace(static_cast<unsigned char>(text[end])) && text[end] != '"') {
+                end++;
+            }
+            std::string word = text.substr(pos, end - pos);
+            while (!word.empty() && word.back() == '*') word.pop_back();
+            append(word, true);
+            pos = end;
+        }
+    }
+    return result;
+}
+
+std::vector<std::unique_ptr<WishItem> > DatabaseHandler::searchItems(const std::string &owner, const std::string &query,
+                                                                     int limit) {
+    std::vector<std::unique_ptr<WishItem> > results;
+
+    int userId = getUserId(owner);
+    if (userId == -1) {
+        return results;
+    }
 
     sqlite3_stmt *stmt;
-    if (!prepareStatement(sql, &stmt)) {
-        return items;
+    if (ftsAvailable) {
+        std::string match = buildFtsQuery(query);
+        if (match.empty() || !prepareStatement(Sql::SEARCH_ITEMS, &stmt)) {
+            return results;
+        }
+        sqlite3_bind_text(stmt, 1, match.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(stmt, 2, userId);
+        sqlite3_bind_int(stmt, 3, limit);
+    } else {
+        if (!prepareStatement(Sql::SEARCH_ITEMS_LIKE, &stmt)) {
+            return results;
+        }
+        std::string pattern = "%" + escapeLike(query) + "%";
+        sqlite3_bind_int(stmt, 1, userId);
+        sqlite3_bind_text(stmt, 2, pattern.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 3, pattern.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(stmt, 4, limit);
     }
 
-    sqlite3_bind_int(stmt, 1, userId);
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
+    ItemCursor cursor(stmt);
+    for (const ItemRowView &row: cursor) {
         auto item = std::make_unique<WishItem>();
-        item->setId(sqlite3_column_int(stmt, 0));
-        // For now, we'll create items and they'll get new IDs
-        // In production, you'd want to add a setId() method or use a factory
-        std::string name = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 1));
-        double price = sqlite3_column_double(stmt, 2);
-        bool purchased = sqlite3_column_int(stmt, 3) != 0;
-        Category category = static_cast<Category>(sqlite3_column_int(stmt, 4));
-        Priority priority = static_cast<Priority>(sqlite3_column_int(stmt, 5));
-
-        const char *notesPtr = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 6));
-        const char *linkPtr = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 7));
-
-        std::string notes = notesPtr ? notesPtr : "";
-        std::string link = linkPtr ? linkPtr : "";
-        item->setName(name);
-        item->setPrice(price);
-        item->setPurchased(purchased);
-        item->setCategory(category);
-        item->setPriority(priority);
-        item->setNotes(notes);
-        item->setLink(link);
+        row.copyTo(*item);
+        results.push_back(std::move(item));
+    }
 
-        items.push_back(std::move(item));
+    LOG_DEBUG("DatabaseHandler: Search '", query, "' found ", results.size(), " items for user: ", owner);
+    return results;
+}
+
+std::vector<std::unique_ptr<WishItem> > DatabaseHandler::fuzzySearchItems(const std::string &owner,
+                                                                         const std::string &text,
+                                                                         double minSimilarity, int limit) {
+    std::vector<std::unique_ptr<WishItem> > results;
+
+    int userId = getUserId(owner);
+    if (userId == -1) {
+        return results;
+    }
+
+    sqlite3_stmt *stmt;
+    if (!prepareStatement(Sql::FUZZY_SEARCH_ITEMS, &stmt)) {
+        return results;
+    }
+    sqlite3_bind_text(stmt, 1, text.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int(stmt, 2, userId);
+    sqlite3_bind_double(stmt, 3, minSimilarity);
+    sqlite3_bind_int(stmt, 4, limit);
+
+    ItemCursor cursor(stmt);
+    for (const ItemRowView &row: cursor) {
+        auto item = std::make_unique<WishItem>();
+        row.copyTo(*item);
+        results.push_back(std::move(item));
+    }
+
+    LOG_DEBUG("DatabaseHandler: Fuzzy search '", text, "' found ", results.size(), " items for user: ", owner);
+    return results;
+}
+
+bool DatabaseHandler::recordPrice(int itemId, double price, std::time_t recordedAt) {
+    auto writer = lockWriter();
+    if (!writer) return false;
+
+    sqlite3_stmt *stmt;
+    if (!prepareStatement(Sql::INSERT_PRICE, &stmt)) {
+        return false;
     }
 
+    sqlite3_bind_int(stmt, 1, itemId);
+    sqlite3_bind_double(stmt, 2, price);
+    sqlite3_bind_int64(stmt, 3, recordedAt);
+
+    int result = sqlite3_step(stmt);
     sqlite3_finalize(stmt);
-    LOG_INFO("DatabaseHandler: Loaded ", items.size(), " items for user: ", owner);
-    return items;
+
+    if (result != SQLITE_DONE) {
+        LOG_ERROR("DatabaseHandler: Failed to record price: ", sqlite3_errmsg(db));
+        return false;
+    }
+    return true;
+}
+
+PriceSummary DatabaseHandler::getPriceSummary(int itemId, std::time_t from, std::time_t to) {
+    PriceSummary summary;
+    sqlite3_stmt *stmt;
+
+    if (!prepareStatement(Sql::PRICE_SUMMARY, &stmt)) {
+        return summary;
+    }
+    sqlite3_bind_int(stmt, 1, itemId);
+    sqlite3_bind_int64(stmt, 2, from);
+    sqlite3_bind_int64(stmt, 3, to);
+
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        summary.samples = sqlite3_column_int(stmt, 0);
+        summary.minPrice = sqlite3_column_double(stmt, 1);
+        summary.maxPrice = sqlite3_column_double(stmt, 2);
+    }
+    sqlite3_finalize(stmt);
+
+    if (summary.samples == 0 || !prepareStatement(Sql::LATEST_PRICE, &stmt)) {
+        return summary;
+    }
+    sqlite3_bind_int(stmt, 1, itemId);
+    sqlite3_bind_int64(stmt, 2, from);
+    sqlite3_bind_int64(stmt, 3, to);
+
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        summary.latestPrice = sqlite3_column_double(stmt, 0);
+        summary.latestTime = sqlite3_column_int64(stmt, 1);
+    }
+    sqlite3_finalize(stmt);
+    return summary;
+}
+
+std::vector<PriceBucket> DatabaseHandler::getPriceSeries(int itemId, std::time_t from, std::time_t to,
+                                                         int bucketSeconds) {
+    std::vector<PriceBucket> series;
+    if (bucketSeconds <= 0) bucketSeconds = 1;
+
+    sqlite3_stmt *stmt;
+    if (!prepareStatement(Sql::PRICE_SERIES, &stmt)) {
+        return series;
+    }
+    sqlite3_bind_int(stmt, 1, itemId);
+    sqlite3_bind_int64(stmt, 2, from);
+    sqlite3_bind_int64(stmt, 3, to);
+
+    // Rows arrive in time order, so buckets are filled in a single pass
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        std::time_t time = sqlite3_column_int64(stmt, 0);
+        double price = sqlite3_column_double(stmt, 1);
+        std::time_t start = time - ((time - from) % bucketSeconds);
+
+        if (series.empty() || series.back().start != start) {
+            series.push_back(PriceBucket{start, price, price, 0.0, price, 0});
+        }
+        PriceBucket &bucket = series.back();
+        bucket.minPrice = std::min(bucket.minPrice, price);
+        bucket.maxPrice = std::max(bucket.maxPrice, price);
+        bucket.avgPrice += (price - bucket.avgPrice) / ++bucket.samples;
+        bucket.lastPrice = price;
+    }
+
+    sqlite3_finalize(stmt);
+    return series;
+}
+
+std::vector<PriceDrop> DatabaseHandler::findPriceDrops(const std::string &owner, std::time_t since,
+                                                       double minDropPercent) {
+    std::vector<PriceDrop> drops;
+
+    int userId = getUserId(owner);
+    if (userId == -1) {
+        return drops;
+    }
+
+    sqlite3_stmt *stmt;
+    if (!prepareStatement(Sql::PRICE_DROPS, &stmt)) {
+        return drops;
+    }
+    sqlite3_bind_int64(stmt, 1, since);
+    sqlite3_bind_int(stmt, 2, userId);
+    sqlite3_bind_double(stmt, 3, minDropPercent);
+
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        PriceDrop drop;
+        drop.itemId = sqlite3_column_int(stmt, 0);
+        drop.name = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 1));
+        drop.peakPrice = sqlite3_column_double(stmt, 2);
+        drop.currentPrice = sqlite3_column_double(stmt, 3);
+        drop.dropPercent = (drop.peakPrice - drop.currentPrice) * 100.0 / drop.peakPrice;
+        drops.push_back(std::move(drop));
+    }
+
+    sqlite3_finalize(stmt);
+    return drops;
+}
+
+int DatabaseHandler::compactPriceHistory(std::time_t olderThan, int bucketSeconds) {
+    auto writer = lockWriter();
+    if (!writer) return -1;
+
+    sqlite3_stmt *stmt;
+    if (!prepareStatement(Sql::COMPACT_PRICE_HISTORY, &stmt)) {
+        return -1;
+    }
+
+    // A non-positive bucket folds all old rows of an item into its newest one
+    sqlite3_bind_int64(stmt, 1, bucketSeconds > 0 ? bucketSeconds : std::numeric_limits<int64_t>::max());
+    sqlite3_bind_int64(stmt, 2, olderThan);
+
+    int result = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+
+    if (result != SQLITE_DONE) {
+        LOG_ERROR("DatabaseHandler: Failed to compact price history: ", sqlite3_errmsg(db));
+        return -1;
+    }
+
+    int removed = sqlite3_changes(db);
+    LOG_INFO("DatabaseHandler: Compacted price history, removed ", removed, " rows");
+    return removed;
 }
 
 bool DatabaseHandler::saveBudget(const Budget &budget, const std::string &owner) {
+    auto writer = lockWriter();
+    if (!writer) return false;
+
     if (!createUser(owner)) {
         return false;
     }
@@ -341,11 +1133,7 @@ bool DatabaseHandler::saveBudget(const Budget &budget, const std::string &owner)
         return false;
     }
 
-    const char *sql = R"(
-        INSERT OR REPLACE INTO budgets
-        (user_id, max_budget, spent_amount, enabled, updated_at)
-        VALUES (?, ?, ?, ?, CURRENT_TIMESTAMP);
-    )";
+    const char *sql = Sql::SAVE_BUDGET;
 
     sqlite3_stmt *stmt;
     if (!prepareStatement(sql, &stmt)) {
@@ -354,8 +1142,7 @@ bool DatabaseHandler::saveBudget(const Budget &budget, const std::string &owner)
 
     sqlite3_bind_int(stmt, 1, userId);
     sqlite3_bind_double(stmt, 2, budget.getMaxBudget());
-    sqlite3_bind_double(stmt, 3, budget.getSpentAmount());
-    sqlite3_bind_int(stmt, 4, budget.isEnabled() ? 1 : 0);
+    sqlite3_bind_int(stmt, 3, budget.isEnabled() ? 1 : 0);
 
     int result = sqlite3_step(stmt);
     sqlite3_finalize(stmt);
@@ -377,7 +1164,7 @@ Budget DatabaseHandler::loadBudget(const std::string &owner) {
         return budget;
     }
 
-    const char *sql = "SELECT max_budget, spent_amount, enabled FROM budgets WHERE user_id = ?;";
+    const char *sql = Sql::SELECT_BUDGET;
     sqlite3_stmt *stmt;
 
     if (!prepareStatement(sql, &stmt)) {
@@ -406,58 +1193,225 @@ Budget DatabaseHandler::loadBudget(const std::string &owner) {
     return budget;
 }
 
-int DatabaseHandler::getTotalItemsCount(const std::string &owner) {
+ItemCursor DatabaseHandler::queryItems(const std::string &owner, const ItemQuery &query) {
     int userId = getUserId(owner);
     if (userId == -1) {
-        return 0;
+        return ItemCursor();
     }
 
-    const char *sql = "SELECT COUNT(*) FROM items WHERE user_id = ?;";
+    std::string sql = buildItemQuerySql(query);
+
     sqlite3_stmt *stmt;
+    if (!prepareStatement(sql, &stmt)) {
+        return ItemCursor();
+    }
+    bindQueryParameters(stmt, userId, query);
+    return ItemCursor(stmt);
+}
+
+size_t DatabaseHandler::queryItems(const std::string &owner, const ItemQuery &query,
+                                   const std::function<bool(const ItemRowView &)> &callback) {
+    size_t visited = 0;
+    ItemCursor cursor = queryItems(owner, query);
+
+    for (const ItemRowView &row: cursor) {
+        visited++;
+        if (!callback(row)) break;
+    }
+    return visited;
+}
 
+std::vector<std::unique_ptr<WishItem> > DatabaseHandler::findItems(const std::string &owner, const ItemQuery &query) {
+    std::vector<std::unique_ptr<WishItem> > items;
+    ItemCursor cursor = queryItems(owner, query);
+
+    auto item = std::make_unique<WishItem>();
+    while (cursor.next(*item)) {
+        items.push_back(std::move(item));
+        item = std::make_unique<WishItem>();
+    }
+    return items;
+}
+
+ItemStats DatabaseHandler::queryStats(const std::string &owner, const ItemQuery &query) {
+    ItemStats stats;
+
+    if (!query.category && !query.purchased && !query.minPrice && !query.maxPrice && query.nameContains.empty()) {
+        return getUserStats(owner);
+    }
+
+    int userId = getUserId(owner);
+    if (userId == -1) {
+        return stats;
+    }
+
+    std::string sql = buildStatsSql(query);
+
+    sqlite3_stmt *stmt;
     if (!prepareStatement(sql, &stmt)) {
-        return 0;
+        return stats;
+    }
+    bindQueryParameters(stmt, userId, query);
+
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        CategoryStats categoryStats;
+        categoryStats.count = sqlite3_column_int(stmt, 1);
+        categoryStats.totalValue = sqlite3_column_double(stmt, 2);
+        categoryStats.purchasedValue = sqlite3_column_double(stmt, 4);
+
+        stats.count += categoryStats.count;
+        stats.totalValue += categoryStats.totalValue;
+        stats.purchasedCount += sqlite3_column_int(stmt, 3);
+        stats.purchasedValue += categoryStats.purchasedValue;
+        stats.byCategory[static_cast<Category>(sqlite3_column_int(stmt, 0))] = categoryStats;
+    }
+
+    sqlite3_finalize(stmt);
+    return stats;
+}
+
+ItemStats DatabaseHandler::getUserStats(const std::string &owner) {
+    ItemStats stats;
+
+    int userId = getUserId(owner);
+    if (userId == -1) {
+        return stats;
+    }
+
+    sqlite3_stmt *stmt;
+    if (!prepareStatement(Sql::SELECT_USER_STATS, &stmt)) {
+        return stats;
     }
     sqlite3_bind_int(stmt, 1, userId);
-    int count = 0;
     if (sqlite3_step(stmt) == SQLITE_ROW) {
-        count = sqlite3_column_int(stmt, 0);
+        stats.count = sqlite3_column_int(stmt, 0);
+        stats.totalValue = sqlite3_column_double(stmt, 1);
+        stats.purchasedCount = sqlite3_column_int(stmt, 2);
+        stats.purchasedValue = sqlite3_column_double(stmt, 3);
     }
     sqlite3_finalize(stmt);
-    return count;
+
+    if (!prepareStatement(Sql::SELECT_CATEGORY_STATS, &stmt)) {
+        return stats;
+    }
+    sqlite3_bind_int(stmt, 1, userId);
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        CategoryStats &categoryStats = stats.byCategory[static_cast<Category>(sqlite3_column_int(stmt, 0))];
+        categoryStats.count = sqlite3_column_int(stmt, 1);
+        categoryStats.totalValue = sqlite3_column_double(stmt, 2);
+        categoryStats.purchasedValue = sqlite3_column_double(stmt, 3);
+    }
+    sqlite3_finalize(stmt);
+    return stats;
+}
+
+int DatabaseHandler::getTotalItemsCount(const std::string &owner) {
+    return getUserStats(owner).count;
 }
 
 double DatabaseHandler::getTotalValue(const std::string &owner) {
+    return getUserStats(owner).totalValue;
+}
+
+std::vector<PriceHistogramBin> DatabaseHandler::getPriceHistogram(const std::string &owner, double bucketWidth) {
+    std::vector<PriceHistogramBin> bins;
+    if (bucketWidth <= 0.0) {
+        LOG_ERROR("DatabaseHandler: Histogram bucket width must be positive");
+        return bins;
+    }
+
     int userId = getUserId(owner);
     if (userId == -1) {
-        return 0.0;
+        return bins;
     }
 
-    const char *sql = "SELECT SUM(price) FROM items WHERE user_id = ?;";
     sqlite3_stmt *stmt;
+    if (!prepareStatement(Sql::PRICE_HISTOGRAM, &stmt)) {
+        return bins;
+    }
+    sqlite3_bind_double(stmt, 1, bucketWidth);
+    sqlite3_bind_int(stmt, 2, userId);
 
-    if (!prepareStatement(sql, &stmt)) {
-        return 0.0;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        PriceHistogramBin bin;
+        bin.lowerBound = sqlite3_column_double(stmt, 0);
+        bin.count = sqlite3_column_int(stmt, 1);
+        bin.totalValue = sqlite3_column_double(stmt, 2);
+        bin.purchasedCount = sqlite3_column_int(stmt, 3);
+        bins.push_back(bin);
     }
 
-    sqlite3_bind_int(stmt, 1, userId);
+    sqlite3_finalize(stmt);
+    return bins;
+}
 
-    double total = 0.0;
-    if (sqlite3_step(stmt) == SQLITE_ROW) {
-        total = sqlite3_column_double(stmt, 0);
+bool DatabaseHandler::rebuildUserStats() {
+    auto writer = lockWriter();
+    if (!writer) return false;
+
+    if (!executeSQL(Sql::REBUILD_USER_STATS)) {
+        LOG_ERROR("DatabaseHandler: Failed to rebuild user statistics");
+        return false;
+    }
+    LOG_INFO("DatabaseHandler: Rebuilt user statistics");
+    return true;
+}
+
+std::vector<StatsDrift> DatabaseHandler::checkStatsConsistency(double tolerance) {
+    std::vector<StatsDrift> drifts;
+    sqlite3_stmt *stmt;
+
+    if (!prepareStatement(Sql::CHECK_USER_STATS, &stmt)) {
+        return drifts;
+    }
+
+    const char *fields[] = {"item_count", "total_value", "purchased_count", "purchased_value"};
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        std::string username = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 0));
+        for (int field = 0; field < 4; ++field) {
+            double stored = sqlite3_column_double(stmt, 1 + field);
+            double actual = sqlite3_column_double(stmt, 5 + field);
+            if (std::abs(stored - actual) > tolerance) {
+                drifts.push_back(StatsDrift{username, fields[field], stored, actual, ""});
+            }
+        }
     }
 
     sqlite3_finalize(stmt);
-    return total;
+
+    if (!prepareStatement(Sql::CHECK_CATEGORY_STATS, &stmt)) {
+        return drifts;
+    }
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        std::string username = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 0));
+        std::string category = WishItem::categoryToString(static_cast<Category>(sqlite3_column_int(stmt, 1)));
+        for (int field = 0; field < 3; ++field) {
+            double stored = sqlite3_column_double(stmt, 2 + field);
+            double actual = sqlite3_column_double(stmt, 5 + field);
+            if (std::abs(stored - actual) > tolerance) {
+                // user_category_stats has no purchased_count
+                drifts.push_back(StatsDrift{username, fields[field == 2 ? 3 : field], stored, actual, category});
+            }
+        }
+    }
+
+    sqlite3_finalize(stmt);
+    if (!drifts.empty()) {
+        LOG_WARNING("DatabaseHandler: User statistics drifted in ", drifts.size(), " fields");
+    }
+    return drifts;
 }
 
 bool DatabaseHandler::clearAllData(const std::string &owner) {
+    auto writer = lockWriter();
+    if (!writer) return false;
+
     int userId = getUserId(owner);
     if (userId == -1) {
         return false;
     }
 
-    const char* sql = "DELETE FROM items WHERE user_id = ?;";
+    const char* sql = Sql::DELETE_USER_ITEMS;
     sqlite3_stmt* stmt;
 
     if (!prepareStatement(sql, &stmt)) {
@@ -477,9 +1431,121 @@ bool DatabaseHandler::clearAllData(const std::string &owner) {
     return true;
 }
 
+std::unique_lock<std::recursive_timed_mutex> DatabaseHandler::lockWriter() {
+    std::unique_lock<std::recursive_timed_mutex> writer(writerMutex, std::defer_lock);
+    if (!writer.try_lock_for(WRITER_TIMEOUT)) {
+        LOG_ERROR("DatabaseHandler: Timed out waiting for another thread's transaction");
+    }
+    return writer;
+}
+
+bool DatabaseHandler::beginTransaction() {
+    auto writer = lockWriter();
+    if (!writer || !executeSQL("BEGIN IMMEDIATE;")) return false;
+    writer.release(); // Kept until the transaction ends
+    transactionThread = std::this_thread::get_id();
+    return true;
+}
+
+bool DatabaseHandler::commitTransaction() {
+    return endTransaction("COMMIT;");
+}
+
+bool DatabaseHandler::rollbackTransaction() {
+    return endTransaction("ROLLBACK;");
+}
+
+bool DatabaseHandler::endTransaction(const char *sql) {
+    if (transactionThread != std::this_thread::get_id()) {
+        LOG_ERROR("DatabaseHandler: No transaction open on this thread");
+        return false;
+    }
+    bool success = executeSQL(sql);
+    // A failed COMMIT stays open for the rollback, unless SQLite already rolled it back
+    if (sqlite3_get_autocommit(db)) {
+        transactionThread = std::thread::id();
+        writerMutex.unlock();
+    }
+    return success;
+}
+
 bool DatabaseHandler::vacuum() {
+    auto writer = lockWriter();
+    if (!writer) return false;
+
     LOG_INFO("DatabaseHandler: Running VACUUM to optimize database");
-    return executeSQL("VACUUM;");
+    return executeSQL("PRAGMA auto_vacuum = INCREMENTAL; VACUUM;");
+}
+
+int64_t DatabaseHandler::getChangeCount() const {
+    return db ? sqlite3_total_changes64(db) : 0;
+}
+
+int DatabaseHandler::walHook(void *handler, sqlite3 *, const char *, int walPages) {
+    static_cast<DatabaseHandler *>(handler)->walListener(walPages);
+    return SQLITE_OK;
+}
+
+void DatabaseHandler::updateHook(void *handler, int operation, const char *schema, const char *table,
+                                 sqlite3_int64 rowId) {
+    auto *self = static_cast<DatabaseHandler *>(handler);
+    // Attached databases (e.g. bulk staging) are not part of the published state
+    if (!self->hasChangeListeners || std::strcmp(schema, "main") != 0) return;
+
+    RowChange::Operation op = operation == SQLITE_INSERT
+                                  ? RowChange::Operation::INSERTED
+                                  : operation == SQLITE_DELETE
+                                        ? RowChange::Operation::DELETED
+                                        : RowChange::Operation::UPDATED;
+    self->uncommittedChanges.push_back(RowChange{op, table, rowId});
+}
+
+int DatabaseHandler::commitHook(void *handler) {
+    auto *self = static_cast<DatabaseHandler *>(handler);
+    if (self->uncommittedChanges.empty()) return 0;
+
+    std::vector<RowChange> changes;
+    changes.swap(self->uncommittedChanges);
+
+    std::lock_guard<std::mutex> lock(self->listenerMutex);
+    for (const auto &[id, listener]: self->changeListeners) {
+        listener(changes);
+    }
+    return 0; // Non-zero would turn the commit into a rollback
+}
+
+void DatabaseHandler::rollbackHook(void *handler) {
+    static_cast<DatabaseHandler *>(handler)->uncommittedChanges.clear();
+}
+
+int DatabaseHandler::addChangeListener(ChangeListener listener) {
+    std::lock_guard<std::mutex> lock(listenerMutex);
+    int id = nextListenerId++;
+    changeListeners.emplace_back(id, std::move(listener));
+    hasChangeListeners = true;
+    return id;
+}
+
+void DatabaseHandler::removeChangeListener(int listenerId) {
+    std::lock_guard<std::mutex> lock(listenerMutex);
+    changeListeners.erase(std::remove_if(changeListeners.begin(), changeListeners.end(),
+                                         [listenerId](const auto &entry) { return entry.first == listenerId; }),
+                          changeListeners.end());
+    hasChangeListeners = !changeListeners.empty();
+}
+
+void DatabaseHandler::setWalListener(WalListener listener) {
+    if (!db) return;
+    // The hook runs under the connection mutex, so swapping it first means no
+    // callback can still be using the old listener
+    if (listener) {
+        sqlite3_wal_autocheckpoint(db, 0);
+        walListener = std::move(listener);
+        sqlite3_wal_hook(db, &DatabaseHandler::walHook, this);
+    } else {
+        sqlite3_wal_autocheckpoint(db, 1000); // Reinstalls SQLite's default hook
+        walListener = nullptr;
+    }
 }
 
 std::string DatabaseHandler::getLastError() const {
@@ -489,8 +1555,83 @@ std::string DatabaseHandler::getLastError() const {
     return "Database not initialized";
 }
 
+bool DatabaseHandler::backupTo(const std::string &path, int pagesPerStep, const BackupProgress &progress,
+                               std::chrono::milliseconds pause) {
+    if (!db) {
+        LOG_ERROR("DatabaseHandler: Cannot back up, database not initialized");
+        return false;
+    }
+
+    // Never leave a half-written backup under the final name
+    std::string tempPath = path + ".partial";
+    std::filesystem::remove(tempPath);
+
+    sqlite3 *dest = nullptr;
+    if (sqlite3_open_v2(tempPath.c_str(), &dest, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, nullptr) != SQLITE_OK) {
+        LOG_ERROR("DatabaseHandler: Failed to open backup file: ", sqlite3_errmsg(dest));
+        sqlite3_close(dest);
+        return false;
+    }
+
+    LOG_INFO("DatabaseHandler: Backing up to ", path, " (", pagesPerStep, " pages per step)");
+    bool success = copyDatabase(dest, db, pagesPerStep, progress, pause);
+    sqlite3_close(dest);
+
+    std::error_code error;
+    if (success) {
+        std::filesystem::rename(tempPath, path, error);
+        if (error) {
+            LOG_ERROR("DatabaseHandler: Failed to move backup into place: ", error.message());
+            success = false;
+        }
+    }
+    if (!success) {
+        std::filesystem::remove(tempPath, error);
+        return false;
+    }
+
+    LOG_INFO("DatabaseHandler: Backup completed");
+    return true;
+}
+
+bool DatabaseHandler::restoreFrom(const std::string &path, int pagesPerStep, const BackupProgress &progress,
+                                  std::chrono::milliseconds pause) {
+    if (!db) {
+        LOG_ERROR("DatabaseHandler: Cannot restore, database not initialized");
+        return false;
+    }
+    if (!std::filesystem::exists(path)) {
+        LOG_ERROR("DatabaseHandler: Backup file not found: ", path);
+        return false;
+    }
+
+    auto writer = lockWriter();
+    if (!writer) return false;
+
+    sqlite3 *src = nullptr;
+    if (sqlite3_open_v2(path.c_str(), &src, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK) {
+        LOG_ERROR("DatabaseHandler: Failed to open backup file: ", sqlite3_errmsg(src));
+        sqlite3_close(src);
+        return false;
+    }
+
+    // The destination stays locked for the whole restore; a cancelled or failed
+    // restore leaves the current database unchanged
+    LOG_INFO("DatabaseHandler: Restoring from ", path);
+    bool success = copyDatabase(db, src, pagesPerStep, progress, pause);
+    sqlite3_close(src);
+
+    if (!success) {
+        return false;
+    }
+
+    // The backup may predate newer tables, indexes or triggers
+    LOG_INFO("DatabaseHandler: Restore completed");
+    return createTables();
+}
+
 int DatabaseHandler::getGlobalMaxItemId() {
-    const char *sql = "SELECT MAX(id) FROM items;";
+    const char *sql = Sql::SELECT_MAX_ITEM_ID;
     sqlite3_stmt *stmt;
 
     if (!prepareStatement(sql, &stmt)) {
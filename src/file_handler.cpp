@@ -4,78 +4,323 @@
 
 #include "../include/file_handler.h"
 #include "../include/logger.h"
+#include "../include/mapped_file.h"
+#include "../include/parallel_parser.h"
+#include "../include/snapshot.h"
+#include "../include/atomic_file.h"
+#include "../include/csv.h"
+#include "../include/json.h"
 #include <fstream>
 #include <iostream>
-#include <sstream>
 #include <algorithm>
 #include <stdexcept>
+#include <charconv>
+
+namespace {
+    // Items parsed from one chunk of a file, in file order
+    struct ItemBatch {
+        std::vector<std::unique_ptr<WishItem> > items;
+        int maxId = 0;
+        int skipped = 0; // Lines that did not parse
+    };
+
+    ItemBatch parseItemLines(std::string_view chunk) {
+        ItemBatch batch;
+        LineReader lines(chunk);
+        std::string_view line;
+        while (lines.next(line)) {
+            if (line.empty()) continue;
+
+            auto item = std::make_unique<WishItem>();
+            if (WishItem::parse(line, *item)) {
+                batch.maxId = std::max(batch.maxId, item->getId());
+                batch.items.push_back(std::move(item));
+            } else {
+                batch.skipped++;
+            }
+        }
+        return batch;
+    }
+
+    // CSV format: ID,Name,Price,Purchased,Category,Priority,Notes,Link
+    std::unique_ptr<WishItem> parseCsvRecord(const std::vector<std::string> &fields) {
+        if (fields.size() < 4) {
+            if (fields.size() > 1 || !fields[0].empty()) { // Blank lines are skipped silently
+                LOG_WARNING("Warning: Skipping invalid CSV record starting with: ", fields[0]);
+                std::cerr << "Warning: Skipping invalid CSV record starting with: " << fields[0] << std::endl;
+            }
+            return nullptr;
+        }
+
+        // Parse fields (skip ID - let it auto-generate)
+        const std::string &priceText = fields[2];
+        double price = 0.0;
+        auto [end, error] = std::from_chars(priceText.data(), priceText.data() + priceText.size(), price);
+        if (error != std::errc() || end != priceText.data() + priceText.size()) {
+            LOG_WARNING("Warning: Invalid price '", priceText, "' for ", fields[1]);
+            std::cerr << "Warning: Invalid price '" << priceText << "' for " << fields[1] << std::endl;
+            return nullptr;
+        }
+
+        auto item = std::make_unique<WishItem>();
+        item->setName(fields[1]);
+        item->setPrice(price);
+
+        // Purchased status
+        std::string purchasedStr = fields[3];
+        std::transform(purchasedStr.begin(), purchasedStr.end(),
+                       purchasedStr.begin(), ::tolower);
+        item->setPurchased(purchasedStr == "yes" || purchasedStr == "1" || purchasedStr == "true");
+
+        if (fields.size() > 4) {
+            item->setCategory(WishItem::stringToCategory(fields[4]));
+        }
+        if (fields.size() > 5) {
+            item->setPriority(WishItem::stringToPriority(fields[5]));
+        }
+        if (fields.size() > 6) {
+            item->setNotes(fields[6]);
+        }
+        if (fields.size() > 7) {
+            item->setLink(fields[7]);
+        }
+        return item;
+    }
+
+    ItemBatch parseCsvRecords(std::string_view chunk, char delimiter) {
+        ItemBatch batch;
+        CsvReader reader(chunk, delimiter);
+        std::vector<std::string> fields;
+        while (reader.next(fields)) {
+            auto item = parseCsvRecord(fields);
+            if (item) {
+                batch.items.push_back(std::move(item));
+            }
+        }
+        return batch;
+    }
+
+    // Collects the objects of the top-level "items" array into the manager as
+    // they complete, so only one item is held at a time
+    class ItemJsonHandler : public JsonHandler {
+        static constexpr int ITEM_DEPTH = 3; // Document object, items array, item object
+
+        WishlistManager &manager;
+        int depth = 0;
+        bool inItems = false;
+        std::string topKey;
+        std::string field;
+        std::unique_ptr<WishItem> item;
+
+        bool inItem() const { return item && depth == ITEM_DEPTH; }
+
+    public:
+        int count = 0;
+
+        explicit ItemJsonHandler(WishlistManager &manager) : manager(manager) {
+        }
+
+        bool startObject() override {
+            depth++;
+            if (inItems && depth == ITEM_DEPTH) {
+                item = std::make_unique<WishItem>();
+                field.clear();
+            }
+            return true;
+        }
+
+        bool endObject() override {
+            if (inItem()) {
+                manager.addItem(std::move(item));
+                count++;
+            }
+            depth--;
+            return true;
+        }
+
+        bool startArray() override {
+            depth++;
+            if (depth == 2 && topKey == "items") inItems = true;
+            return true;
+        }
+
+        bool endArray() override {
+            if (depth == 2) inItems = false;
+            depth--;
+            return true;
+        }
+
+        bool key(std::string_view name) override {
+            if (depth == 1) topKey = name;
+            if (inItem()) field = name;
+            return true;
+        }
+
+        bool string(std::string_view value) override {
+            if (!inItem()) return true;
+            if (field == "name") {
+                item->setName(std::string(value));
+            } else if (field == "category") {
+                item->setCategory(WishItem::stringToCategory(std::string(value)));
+            } else if (field == "priority") {
+                item->setPriority(WishItem::stringToPriority(std::string(value)));
+            } else if (field == "notes") {
+                item->setNotes(std::string(value));
+            } else if (field == "link") {
+                item->setLink(std::string(value));
+            }
+            return true;
+        }
+
+        bool number(double value) override {
+            if (inItem() && field == "price") item->setPrice(value);
+            return true;
+        }
+
+        bool boolean(bool value) override {
+            if (inItem() && field == "purchased") item->setPurchased(value);
+            return true;
+        }
+    };
+
+    // Reads everything left in the stream; false if the stream failed
+    bool readStream(std::istream &in, std::string &data) {
+        char buffer[1 << 16];
+        while (in.read(buffer, sizeof(buffer)) || in.gcount() > 0) {
+            data.append(buffer, static_cast<size_t>(in.gcount()));
+        }
+        return !in.bad();
+    }
+
+    // Adds the batches' items in file order; returns the number added
+    int mergeBatches(WishlistManager &manager, std::vector<ItemBatch> &batches) {
+        int count = 0;
+        for (auto &batch: batches) {
+            // Workers parse without touching WishItem's ID counter; it is raised here once per batch
+            WishItem::reserveId(batch.maxId);
+            for (auto &item: batch.items) {
+                manager.addItem(std::move(item));
+                count++;
+            }
+        }
+        return count;
+    }
+}
 
 FileHandler::FileHandler(const std::string &filename) : filename(filename) {
     LOG_INFO("[FileHandler]: Initialized with filename ", filename);
 }
 
+std::string FileHandler::encode(const WishlistManager &manager) const {
+    if (format == FileFormat::BINARY) {
+        return Snapshot::encode(manager);
+    }
+
+    std::string content;
+    content.reserve(64 * (manager.getItems().size() + 2));
+    content += manager.getOwner();
+    content += "\nBUDGET:";
+    content += manager.getBudget().serialize();
+    content += "\n";
+    for (const auto &item: manager.getItems()) {
+        content += item->serialize();
+        content += "\n";
+    }
+    return content;
+}
+
 bool FileHandler::save(const WishlistManager &manager) {
-    std::ofstream file(filename);
-    if (!file.is_open()) {
-        LOG_ERROR("[FileHandler]: Could not open file for writing: ", filename);
+    // The old file stays intact until the new one is completely on disk
+    if (!AtomicFile::write(filename, encode(manager), keepBackup)) {
+        LOG_ERROR("[FileHandler]: Could not write file: ", filename);
         std::cerr << "Error: Could not open file for writing: " << filename << std::endl;
         return false;
     }
 
-    file << manager.getOwner() << "\n";
-
-    file << "BUDGET:" << manager.getBudget().serialize() << "\n";
+    LOG_INFO("FileHandler: Successfully saved ", manager.getTotalItems(), " items");
+    return true;
+}
 
-    for (const auto &item: manager.getItems()) {
-        file << item->serialize() << "\n";
+bool FileHandler::save(const WishlistManager &manager, std::ostream &out) {
+    std::string content = encode(manager);
+    out.write(content.data(), static_cast<std::streamsize>(content.size()));
+    out.flush();
+    if (!out) {
+        LOG_ERROR("[FileHandler]: Could not write wishlist to stream");
+        return false;
     }
 
-    file.close();
-    LOG_INFO("FileHandler: Successfully saved ", manager.getTotalItems(), " items");
-    std::cout << "Wishlist saved successfully!\n";
+    LOG_INFO("FileHandler: Successfully saved ", manager.getTotalItems(), " items to stream");
     return true;
 }
 
 bool FileHandler::load(WishlistManager &manager) {
     LOG_INFO("FileHandler: Attempting to load from '", filename, "'");
 
-    std::ifstream file(filename);
-    if (!file.is_open()) {
+    // Lines are parsed as views into the mapping; strings are copied once into their items
+    MappedFile file;
+    if (!file.open(filename)) {
         LOG_WARNING("FileHandler: File '", filename, "' not found or could not be opened");
         std::cerr << "Warning: Could not open file for reading: " << filename << std::endl;
         return false;
     }
+    return decode(file.view(), manager, filename, false) > 0;
+}
 
-    // Check if file is empty
-    file.seekg(0, std::ios::end);
-    if (file.tellg() == 0) {
-        LOG_INFO("FileHandler: File is empty, starting fresh");
-        std::cout << "✓ Starting fresh wishlist!\n";
-        file.close();
+int FileHandler::loadStrict(WishlistManager &manager) {
+    MappedFile file;
+    if (!file.open(filename)) {
+        LOG_ERROR("FileHandler: File '", filename, "' could not be opened");
+        return -1;
+    }
+    return decode(file.view(), manager, filename, true);
+}
+
+bool FileHandler::load(WishlistManager &manager, std::istream &in) {
+    std::string data;
+    if (!readStream(in, data)) {
+        LOG_ERROR("FileHandler: Could not read wishlist from stream");
         return false;
     }
-    file.seekg(0, std::ios::beg);
+    return decode(data, manager, "<stream>", false) > 0;
+}
 
-    std::string firstLine;
-    std::getline(file, firstLine);
+int FileHandler::decode(std::string_view data, WishlistManager &manager, const std::string &source,
+                        bool strict) const {
+    if (data.empty()) {
+        LOG_INFO("FileHandler: File is empty, starting fresh");
+        return 0;
+    }
 
-    LOG_DEBUG("FileHandler: First line read - '", firstLine, "'");
+    if (Snapshot::isSnapshot(data)) {
+        int count = Snapshot::decode(data, manager);
+        if (count < 0) {
+            LOG_ERROR("FileHandler: Snapshot '", source, "' is corrupt");
+            std::cerr << "Error: Wishlist file is corrupt: " << source << std::endl;
+            return -1;
+        }
+        manager.syncBudgetWithPurchases();
+        LOG_INFO("FileHandler: Successfully loaded ", count, " items from snapshot for owner '", manager.getOwner(), "'");
+        return count;
+    }
 
-    int count = 0;
+    LineReader lines(data);
+    std::string_view firstLine;
 
     // Skip empty lines at the beginning
-    while (firstLine.empty() && std::getline(file, firstLine)) {
-        LOG_DEBUG("FileHandler: Skipping empty line");
+    while (lines.next(firstLine) && firstLine.empty()) {
     }
 
     if (firstLine.empty()) {
         LOG_WARNING("FileHandler: File contains only empty lines");
-        file.close();
-        return false;
+        return 0;
     }
 
+    int count = 0;
+    int skipped = 0;
+
     // Check if first line is owner or item (old format)
-    if (firstLine.find('|') != std::string::npos) {
+    if (firstLine.find('|') != std::string_view::npos) {
         // Old format: First line is an item
         LOG_INFO("FileHandler: Old format detected (no owner line), keeping current owner");
 
@@ -83,172 +328,224 @@ bool FileHandler::load(WishlistManager &manager) {
         if (item) {
             manager.addItem(std::move(item));
             count++;
+        } else {
+            skipped++;
         }
     } else {
         // New format: First line is owner
-        if (!firstLine.empty()) {
-            LOG_INFO("FileHandler: Setting owner from file - '", firstLine, "'");
-            manager.setOwner(firstLine);
-        }
+        LOG_INFO("FileHandler: Setting owner from file - '", firstLine, "'");
+        manager.setOwner(std::string(firstLine));
     }
 
     // Read second line - could be BUDGET: or an item
-    std::string secondLine;
-    std::getline(file, secondLine);
+    std::string_view secondLine;
+    lines.next(secondLine);
 
-    if (secondLine.find("BUDGET:") == 0) {
+    if (secondLine.rfind("BUDGET:", 0) == 0) {
         // Budget line found
-        std::string budgetData = secondLine.substr(7); // Remove "BUDGET:" prefix
+        std::string budgetData(secondLine.substr(7)); // Remove "BUDGET:" prefix
         Budget loadedBudget = Budget::deserialize(budgetData);
         manager.getBudget() = loadedBudget;
         LOG_INFO("FileHandler: Loaded budget data");
-    } else {
+    } else if (!secondLine.empty()) {
         // No budget line, this is an item
-        if (!secondLine.empty() && secondLine.find('|') != std::string::npos) {
-            auto item = WishItem::deserialize(secondLine);
-            if (item) {
-                manager.addItem(std::move(item));
-                count++;
-            }
-        }
-    }
-
-    // Read remaining lines (all items)
-    std::string line;
-    while (std::getline(file, line)) {
-        if (line.empty()) continue;
-
-        LOG_DEBUG("FileHandler: Processing line - '", line, "'");
-
-        auto item = WishItem::deserialize(line);
+        auto item = secondLine.find('|') != std::string_view::npos ? WishItem::deserialize(secondLine) : nullptr;
         if (item) {
             manager.addItem(std::move(item));
             count++;
+        } else {
+            skipped++;
         }
     }
 
-    file.close();
+    // Remaining lines are all items and are parsed in parallel
+    auto batches = ParallelParser::parseChunks<ItemBatch>(lines.rest(), parseThreads, parseItemLines);
+    count += mergeBatches(manager, batches);
+    for (const auto &batch: batches) {
+        skipped += batch.skipped;
+    }
+    if (strict && skipped > 0) {
+        LOG_ERROR("FileHandler: ", skipped, " line(s) of '", source, "' could not be read");
+        return -1;
+    }
 
     // Sync budget with loaded purchases
     manager.syncBudgetWithPurchases();
 
     LOG_INFO("FileHandler: Successfully loaded ", count, " items for owner '", manager.getOwner(), "'");
-    std::cout << "Loaded " << count << " item(s) from wishlist\n";
-    return count > 0;
+    return count;
 }
 
-bool FileHandler::exportToCSV(const WishlistManager &manager, const std::string &csvFile) {
-    std::ofstream file(csvFile);
+bool FileHandler::exportToCSV(const WishlistManager &manager, const std::string &csvFile, const CsvOptions &options) {
+    if (csvFile == STANDARD_STREAM) {
+        return exportToCSV(manager, std::cout, options);
+    }
+    std::ofstream file(csvFile, std::ios::binary);
     if (!file.is_open()) {
         LOG_ERROR("Error: Could not open file for writing: ", csvFile);
         return false;
     }
-
-    file << "ID,Name,Price,Purchased,Category,Priority,Notes,Link\n";
-
-    for (const auto &item: manager.getItems()) {
-        file << item->getId() << ","
-                << item->getName() << ","
-                << item->getPrice() << ","
-                << (item->isPurchased() ? "Yes" : "No") << ","
-                << WishItem::categoryToString(item->getCategory()) << ","
-                << WishItem::priorityToString(item->getPriority()) << ","
-                << item->getNotes() << ","
-                << item->getLink() << "\n";
+    if (!exportToCSV(manager, file, options)) {
+        LOG_ERROR("Error: Failed to write CSV file: ", csvFile);
+        return false;
     }
-
-    file.close();
     LOG_DEBUG("[FileHandler] Exported to CSV", csvFile);
     std::cout << "Wishlist exported to CSV successfully!\n";
     return true;
 }
 
-bool FileHandler::importFromCSV(WishlistManager &manager, const std::string &csvFile) {
-    std::ifstream file(csvFile);
+bool FileHandler::exportToCSV(const WishlistManager &manager, std::ostream &out, const CsvOptions &options) {
+    CsvWriter writer(out, options);
+    for (const char *column: {"ID", "Name", "Price", "Purchased", "Category", "Priority", "Notes", "Link"}) {
+        writer.field(column);
+    }
+    writer.endRecord();
 
-    if (!file.is_open()) {
+    for (const auto &item: manager.getItems()) {
+        writer.field(item->getId())
+                .field(item->getName())
+                .field(item->getPrice())
+                .field(item->isPurchased() ? "Yes" : "No")
+                .field(WishItem::categoryToString(item->getCategory()))
+                .field(WishItem::priorityToString(item->getPriority()))
+                .field(item->getNotes())
+                .field(item->getLink());
+        writer.endRecord();
+    }
+    return writer.flush() && out.flush();
+}
+
+bool FileHandler::importFromCSV(WishlistManager &manager, const std::string &csvFile, unsigned threads,
+                                const CsvOptions &options) {
+    if (csvFile == STANDARD_STREAM) {
+        return importFromCSV(manager, std::cin, threads, options);
+    }
+    MappedFile file;
+    if (!file.open(csvFile)) {
         LOG_ERROR("Error: Could not open CSV file: ", csvFile);
         return false;
     }
 
-    std::string line;
-    int count = 0;
-    bool isFirstLine = true;
-
-    // Read file line by line
-    while (std::getline(file, line)) {
-        // Skip header line
-        if (isFirstLine) {
-            isFirstLine = false;
-            continue;
-        }
-
-        // Skip empty lines
-        if (line.empty()) continue;
-
-        // Parse CSV line
-        std::vector<std::string> tokens;
-        std::stringstream ss(line);
-        std::string token;
-
-        while (std::getline(ss, token, ',')) {
-            tokens.push_back(token);
-        }
-
-        if (tokens.size() < 4) {
-            LOG_WARNING("Warning: Skipping invalid line: ", line);
-            std::cerr << "Warning: Skipping invalid line: " << line << std::endl;
-            continue;
-        }
-
-        try {
-            // Create new item
-            auto item = std::make_unique<WishItem>();
-
-            // Parse fields (skip ID - let it auto-generate)
-            // CSV format: ID,Name,Price,Purchased,Category,Priority,Notes,Link
-            item->setName(tokens[1]); // Name
-            item->setPrice(std::stod(tokens[2])); // Price
-
-            // Purchased status
-            std::string purchasedStr = tokens[3];
-            std::transform(purchasedStr.begin(), purchasedStr.end(),
-                           purchasedStr.begin(), ::tolower);
-            item->setPurchased(purchasedStr == "yes" || purchasedStr == "1" || purchasedStr == "true");
+    int count = importCsvText(manager, file.view(), threads, options);
+    LOG_INFO("[FileHandler] Imported ", count, " items from CSV: ", csvFile);
+    std::cout << "Imported " << count << " item(s) from CSV successfully!\n";
+    return count > 0;
+}
 
-            // Category
-            if (tokens.size() > 4) {
-                item->setCategory(WishItem::stringToCategory(tokens[4]));
-            }
+bool FileHandler::importFromCSV(WishlistManager &manager, std::istream &in, unsigned threads,
+                                const CsvOptions &options) {
+    // Records may span lines, so the text is collected before the parallel parse
+    std::string text;
+    if (!readStream(in, text)) {
+        LOG_ERROR("Error: Could not read CSV from stream");
+        return false;
+    }
+    int count = importCsvText(manager, text, threads, options);
+    LOG_INFO("[FileHandler] Imported ", count, " items from CSV stream");
+    return count > 0;
+}
 
-            // Priority
-            if (tokens.size() > 5) {
-                item->setPriority(WishItem::stringToPriority(tokens[5]));
-            }
+int FileHandler::importCsvText(WishlistManager &manager, std::string_view text, unsigned threads,
+                               const CsvOptions &options) {
+    // Skip header record
+    CsvReader reader(text, options.delimiter);
+    std::vector<std::string> header;
+    reader.next(header);
+
+    // Chunks end at record boundaries, so quoted line breaks stay in one chunk
+    auto chunks = Csv::splitRecords(reader.rest(), ParallelParser::resolveThreads(threads),
+                                    ParallelParser::MIN_CHUNK_BYTES, options.delimiter);
+    auto batches = ParallelParser::parseChunks<ItemBatch>(chunks, [&options](std::string_view chunk) {
+        return parseCsvRecords(chunk, options.delimiter);
+    });
+    return mergeBatches(manager, batches);
+}
 
-            // Notes
-            if (tokens.size() > 6 && !tokens[6].empty()) {
-                item->setNotes(tokens[6]);
-            }
+bool FileHandler::exportToJSON(const WishlistManager &manager, const std::string &jsonFile) {
+    if (jsonFile == STANDARD_STREAM) {
+        return exportToJSON(manager, std::cout);
+    }
+    std::ofstream file(jsonFile, std::ios::binary);
+    if (!file.is_open()) {
+        LOG_ERROR("Error: Could not open file for writing: ", jsonFile);
+        return false;
+    }
+    if (!exportToJSON(manager, file)) {
+        LOG_ERROR("Error: Failed to write JSON file: ", jsonFile);
+        return false;
+    }
+    LOG_DEBUG("[FileHandler] Exported to JSON ", jsonFile);
+    std::cout << "Wishlist exported to JSON successfully!\n";
+    return true;
+}
 
-            // Link
-            if (tokens.size() > 7 && !tokens[7].empty()) {
-                item->setLink(tokens[7]);
-            }
+bool FileHandler::exportToJSON(const WishlistManager &manager, std::ostream &out) {
+    const Budget &budget = manager.getBudget();
+    JsonWriter writer(out);
+    writer.beginObject();
+    writer.key("owner").value(manager.getOwner());
+    writer.key("budget").beginObject()
+            .key("maxBudget").value(budget.getMaxBudget())
+            .key("spentAmount").value(budget.getSpentAmount())
+            .key("enabled").value(budget.isEnabled())
+            .endObject();
+    writer.key("items").beginArray();
+    for (const auto &item: manager.getItems()) {
+        writer.beginObject()
+                .key("id").value(item->getId())
+                .key("name").value(item->getName())
+                .key("price").value(item->getPrice())
+                .key("purchased").value(item->isPurchased())
+                .key("category").value(WishItem::categoryToString(item->getCategory()))
+                .key("priority").value(WishItem::priorityToString(item->getPriority()))
+                .key("notes").value(item->getNotes())
+                .key("link").value(item->getLink())
+                .endObject();
+    }
+    writer.endArray();
+    writer.endObject();
+    return writer.flush() && out.flush();
+}
 
-            // Add to manager
-            manager.addItem(std::move(item));
-            count++;
-        } catch (const std::exception &e) {
-            LOG_WARNING("Warning: Error parsing line: ", line, " (", e.what(), ")");
-            std::cerr << "Warning: Error parsing line: " << line << " (" << e.what() << ")" << std::endl;
-            continue;
-        }
+bool FileHandler::importFromJSON(WishlistManager &manager, const std::string &jsonFile) {
+    if (jsonFile == STANDARD_STREAM) {
+        return importFromJSON(manager, std::cin);
+    }
+    std::ifstream file(jsonFile, std::ios::binary);
+    if (!file.is_open()) {
+        LOG_ERROR("Error: Could not open JSON file: ", jsonFile);
+        return false;
     }
 
-    file.close();
-    LOG_INFO("[FileHandler] Imported ", count, " items from CSV: ", csvFile);
-    std::cout << "Imported " << count << " item(s) from CSV successfully!\n";
+    int count = importJsonStream(manager, file);
+    if (count < 0) return false;
+    LOG_INFO("[FileHandler] Imported ", count, " items from JSON: ", jsonFile);
+    std::cout << "Imported " << count << " item(s) from JSON successfully!\n";
+    return count > 0;
+}
 
+bool FileHandler::importFromJSON(WishlistManager &manager, std::istream &in) {
+    int count = importJsonStream(manager, in);
+    LOG_INFO("[FileHandler] Imported ", count, " items from JSON stream");
     return count > 0;
 }
+
+int FileHandler::importJsonStream(WishlistManager &manager, std::istream &in) {
+    // Read in fixed chunks, so memory stays the same however large the input is
+    ItemJsonHandler handler(manager);
+    JsonParser parser(handler);
+    std::vector<char> chunk(1 << 16);
+    bool parsed = true;
+    while (parsed && in) {
+        in.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+        parsed = parser.feed(std::string_view(chunk.data(), static_cast<size_t>(in.gcount())));
+    }
+    parsed = parsed && !in.bad() && parser.finish();
+    if (!parsed) {
+        // Items before the error stay imported, like valid rows of a broken CSV
+        LOG_ERROR("Error: Invalid JSON input: ", parser.getError());
+        std::cerr << "Error: Invalid JSON input: " << parser.getError() << std::endl;
+        return -1;
+    }
+    return handler.count;
+}
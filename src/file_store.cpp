@@ -0,0 +1,470 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+
+#include "../include/file_store.h"
+#include "../include/file_handler.h"
+#include "../include/wishlist_manager.h"
+#include "../include/atomic_file.h"
+#include "../include/mapped_file.h"
+#include "../include/crc32c.h"
+#include "../include/logger.h"
+
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+    constexpr const char *FILE_PREFIX = "wishlist_";
+    constexpr const char *FILE_SUFFIX = ".dat";
+    constexpr const char *JOURNAL_SUFFIX = ".journal";
+
+    // Journal layout: frames of [u32 payloadLength][u32 crc32c(payload)][payload],
+    // one per commit, so a commit is replayed completely or not at all. The
+    // payload is a sequence of records, each the final state of what it names:
+    enum RecordType : uint8_t {
+        UPSERT_ITEM = 1, // i32 id, f64 price, u8 purchased, u8 category, u8 priority, name, notes, link
+        DELETE_ITEM = 2, // i32 id
+        SET_BUDGET = 3   // f64 maxBudget, f64 spentAmount, u8 enabled
+    };
+    constexpr size_t FRAME_HEADER_BYTES = 8;
+
+    // Little-endian, like the snapshot format
+    void putUint(std::string &out, uint64_t value, int bytes) {
+        for (int i = 0; i < bytes; ++i) {
+            out.push_back(static_cast<char>(value >> (8 * i) & 0xFF));
+        }
+    }
+
+    void putString(std::string &out, const std::string &text) {
+        putUint(out, text.size(), 4);
+        out += text;
+    }
+
+    // Reads from the front of a payload; every take fails once the data runs out
+    class RecordReader {
+        std::string_view data;
+
+    public:
+        explicit RecordReader(std::string_view data) : data(data) {
+        }
+
+        bool done() const { return data.empty(); }
+
+        bool takeUint(uint64_t &value, int bytes) {
+            if (data.size() < static_cast<size_t>(bytes)) return false;
+            value = 0;
+            for (int i = 0; i < bytes; ++i) {
+                value |= static_cast<uint64_t>(static_cast<unsigned char>(data[i])) << (8 * i);
+            }
+            data.remove_prefix(bytes);
+            return true;
+        }
+
+        bool takeDouble(double &value) {
+            uint64_t bits;
+            if (!takeUint(bits, 8)) return false;
+            value = std::bit_cast<double>(bits);
+            return true;
+        }
+
+        bool takeString(std::string &text) {
+            uint64_t length;
+            if (!takeUint(length, 4) || data.size() < length) return false;
+            text.assign(data.substr(0, length));
+            data.remove_prefix(length);
+            return true;
+        }
+    };
+
+    bool writeAll(int fd, std::string_view content) {
+        while (!content.empty()) {
+            ssize_t written = ::write(fd, content.data(), content.size());
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            content.remove_prefix(static_cast<size_t>(written));
+        }
+        return true;
+    }
+
+    // Appends one frame and syncs it; a failed append is cut off again so
+    // later frames do not end up behind a torn one
+    bool appendFrame(const std::string &path, size_t currentSize, std::string_view frame) {
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            LOG_ERROR("FileStore: Cannot open journal ", path, ": ", std::strerror(errno));
+            return false;
+        }
+        bool written = writeAll(fd, frame) && fsync(fd) == 0;
+        if (!written) {
+            LOG_ERROR("FileStore: Failed to append to journal ", path, ": ", std::strerror(errno));
+            if (ftruncate(fd, static_cast<off_t>(currentSize)) != 0) {
+                LOG_WARNING("FileStore: Could not cut failed append off ", path);
+            }
+        }
+        ::close(fd);
+        return written;
+    }
+
+    bool applyRecords(std::string_view payload, std::map<int, WishItem> &items, Budget &budget) {
+        RecordReader reader(payload);
+        while (!reader.done()) {
+            uint64_t type;
+            uint64_t id;
+            if (!reader.takeUint(type, 1)) return false;
+            if (type == SET_BUDGET) {
+                double maxBudget;
+                double spentAmount;
+                uint64_t enabled;
+                if (!reader.takeDouble(maxBudget) || !reader.takeDouble(spentAmount) ||
+                    !reader.takeUint(enabled, 1)) {
+                    return false;
+                }
+                budget.setMaxBudget(maxBudget);
+                budget.setSpentAmount(spentAmount);
+                enabled ? budget.enable() : budget.disable();
+                continue;
+            }
+            if (!reader.takeUint(id, 4)) return false;
+            int itemId = static_cast<int32_t>(id);
+            if (type == DELETE_ITEM) {
+                items.erase(itemId);
+                continue;
+            }
+            if (type != UPSERT_ITEM) return false;
+
+            double price;
+            uint64_t purchased;
+            uint64_t category;
+            uint64_t priority;
+            std::string name;
+            std::string notes;
+            std::string link;
+            if (!reader.takeDouble(price) || !reader.takeUint(purchased, 1) || !reader.takeUint(category, 1) ||
+                !reader.takeUint(priority, 1) || !reader.takeString(name) || !reader.takeString(notes) ||
+                !reader.takeString(link)) {
+                return false;
+            }
+            WishItem &item = items[itemId];
+            item.setId(itemId);
+            item.setPrice(price);
+            item.setPurchased(purchased != 0);
+            item.setCategory(static_cast<Category>(category));
+            item.setPriority(static_cast<Priority>(priority));
+            item.setName(name);
+            item.setNotes(notes);
+            item.setLink(link);
+            WishItem::reserveId(itemId);
+        }
+        return true;
+    }
+
+    size_t fileSize(const std::string &path) {
+        std::error_code error;
+        auto size = std::filesystem::file_size(path, error);
+        return error ? 0 : static_cast<size_t>(size);
+    }
+}
+
+FileStore::FileStore(const std::string &directory, JournalOptions journal) : directory(directory), journal(journal) {
+    if (journal.enabled) {
+        compactor = std::thread(&FileStore::compactorLoop, this);
+    }
+}
+
+FileStore::FileStore(const std::string &directory) : FileStore(directory, JournalOptions()) {
+}
+
+FileStore::~FileStore() {
+    {
+        std::lock_guard<std::mutex> lock(compactorMutex);
+        stopping = true;
+    }
+    compactorWakeup.notify_all();
+    if (compactor.joinable()) {
+        compactor.join();
+    }
+}
+
+std::string FileStore::pathFor(const std::string &owner) const {
+    return (std::filesystem::path(directory) / (FILE_PREFIX + owner + FILE_SUFFIX)).string();
+}
+
+std::string FileStore::journalPathFor(const std::string &owner) const {
+    return (std::filesystem::path(directory) / (FILE_PREFIX + owner + JOURNAL_SUFFIX)).string();
+}
+
+bool FileStore::initialize() {
+    std::lock_guard<std::recursive_timed_mutex> lock(mutex);
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error) {
+        LOG_ERROR("FileStore: Cannot create directory ", directory, ": ", error.message());
+        return false;
+    }
+
+    // An owner can have a snapshot, a journal or both
+    std::set<std::string> owners;
+    std::string prefix = FILE_PREFIX;
+    for (const auto &entry: std::filesystem::directory_iterator(directory)) {
+        std::string fileName = entry.path().filename().string();
+        if (!entry.is_regular_file() || fileName.compare(0, prefix.size(), prefix) != 0) {
+            continue;
+        }
+        for (std::string suffix: {FILE_SUFFIX, JOURNAL_SUFFIX}) {
+            if (fileName.size() > prefix.size() + suffix.size() &&
+                fileName.compare(fileName.size() - suffix.size(), suffix.size(), suffix) == 0) {
+                owners.insert(fileName.substr(prefix.size(), fileName.size() - prefix.size() - suffix.size()));
+            }
+        }
+    }
+
+    for (const auto &owner: owners) {
+        // The owner comes from the file name; the owner line inside is informational
+        UserData &user = userData(owner);
+        std::string path = pathFor(owner);
+        if (std::filesystem::exists(path)) {
+            // A damaged file must not load as a shorter list, as the next
+            // commit would then overwrite it
+            WishlistManager manager(owner);
+            if (FileHandler(path).loadStrict(manager) < 0) {
+                LOG_ERROR("FileStore: Wishlist file ", path, " is damaged; repair or remove it");
+                return false;
+            }
+            for (const auto &item: manager.getItems()) {
+                user.items[item->getId()] = *item;
+            }
+            user.budget = manager.getBudget();
+        }
+        snapshotBytes[owner] = fileSize(path);
+
+        if (!replayJournal(owner)) return false;
+        if (!journal.enabled && journalBytes[owner] > 0) {
+            // Without journal mode every change rewrites the .dat file, so the
+            // journal is folded in once and removed
+            if (!persistOwner(owner)) return false;
+            std::filesystem::remove(journalPathFor(owner), error);
+            journalBytes[owner] = 0;
+        }
+    }
+
+    LOG_INFO("FileStore: Loaded ", users.size(), " wishlist(s) from ", directory);
+    return true;
+}
+
+bool FileStore::replayJournal(const std::string &owner) {
+    std::string path = journalPathFor(owner);
+    journalBytes[owner] = 0;
+    if (!std::filesystem::exists(path)) return true;
+
+    MappedFile file;
+    if (!file.open(path)) {
+        LOG_ERROR("FileStore: Cannot read journal ", path);
+        return false;
+    }
+
+    UserData &user = userData(owner);
+    std::string_view data = file.view();
+    size_t valid = 0;
+    int frames = 0;
+    while (data.size() - valid >= FRAME_HEADER_BYTES) {
+        RecordReader header(data.substr(valid, FRAME_HEADER_BYTES));
+        uint64_t length;
+        uint64_t checksum;
+        header.takeUint(length, 4);
+        header.takeUint(checksum, 4);
+        if (data.size() - valid - FRAME_HEADER_BYTES < length) break;
+
+        std::string_view payload = data.substr(valid + FRAME_HEADER_BYTES, length);
+        if (crc32c(payload) != checksum) break;
+
+        // A dry run on scratch state first, so a malformed frame changes nothing
+        std::map<int, WishItem> scratchItems;
+        Budget scratchBudget;
+        if (!applyRecords(payload, scratchItems, scratchBudget)) break;
+        applyRecords(payload, user.items, user.budget);
+        valid += FRAME_HEADER_BYTES + length;
+        frames++;
+    }
+
+    if (valid < data.size()) {
+        // Left behind by a crash during an append
+        LOG_WARNING("FileStore: Dropping ", data.size() - valid, " torn byte(s) at the end of ", path);
+        file = MappedFile();
+        if (truncate(path.c_str(), static_cast<off_t>(valid)) != 0) {
+            LOG_ERROR("FileStore: Cannot truncate journal ", path, ": ", std::strerror(errno));
+            return false;
+        }
+    }
+    journalBytes[owner] = valid;
+    LOG_DEBUG("FileStore: Replayed ", frames, " journal frame(s) for ", owner);
+    return true;
+}
+
+void FileStore::fillManager(const std::string &owner, WishlistManager &manager) const {
+    auto user = users.find(owner);
+    if (user == users.end()) return;
+
+    for (const auto &[id, item]: user->second.items) {
+        auto copy = std::make_unique<WishItem>();
+        *copy = item;
+        manager.addItem(std::move(copy));
+    }
+    manager.getBudget() = user->second.budget;
+}
+
+bool FileStore::persistOwner(const std::string &owner) {
+    WishlistManager manager(owner);
+    fillManager(owner, manager);
+
+    FileHandler handler(pathFor(owner));
+    if (journal.enabled) {
+        handler.setFormat(FileFormat::BINARY);
+    }
+    if (!handler.save(manager)) {
+        LOG_ERROR("FileStore: Failed to write wishlist of ", owner);
+        return false;
+    }
+    snapshotBytes[owner] = fileSize(pathFor(owner));
+    return true;
+}
+
+bool FileStore::persistChanges(const std::string &owner, const OwnerChanges &changes) {
+    if (!journal.enabled) {
+        return persistOwner(owner);
+    }
+
+    // A new owner starts with a snapshot; a stale journal must not be replayed over it
+    if (!std::filesystem::exists(pathFor(owner))) {
+        std::error_code error;
+        std::filesystem::remove(journalPathFor(owner), error);
+        journalBytes[owner] = 0;
+        return persistOwner(owner);
+    }
+
+    auto user = users.find(owner);
+    if (user == users.end()) return false;
+
+    std::string frame(FRAME_HEADER_BYTES, '\0');
+    for (int id: changes.itemIds) {
+        auto item = user->second.items.find(id);
+        if (item == user->second.items.end()) {
+            putUint(frame, DELETE_ITEM, 1);
+            putUint(frame, static_cast<uint32_t>(id), 4);
+            continue;
+        }
+        const WishItem &stored = item->second;
+        putUint(frame, UPSERT_ITEM, 1);
+        putUint(frame, static_cast<uint32_t>(id), 4);
+        putUint(frame, std::bit_cast<uint64_t>(stored.getPrice()), 8);
+        putUint(frame, stored.isPurchased(), 1);
+        putUint(frame, static_cast<uint8_t>(stored.getCategory()), 1);
+        putUint(frame, static_cast<uint8_t>(stored.getPriority()), 1);
+        putString(frame, stored.getName());
+        putString(frame, stored.getNotes());
+        putString(frame, stored.getLink());
+    }
+    if (changes.budget) {
+        const Budget &budget = user->second.budget;
+        putUint(frame, SET_BUDGET, 1);
+        putUint(frame, std::bit_cast<uint64_t>(budget.getMaxBudget()), 8);
+        putUint(frame, std::bit_cast<uint64_t>(budget.getSpentAmount()), 8);
+        putUint(frame, budget.isEnabled(), 1);
+    }
+    if (frame.size() == FRAME_HEADER_BYTES) return true;
+
+    std::string_view payload = std::string_view(frame).substr(FRAME_HEADER_BYTES);
+    std::string header;
+    putUint(header, payload.size(), 4);
+    putUint(header, crc32c(payload), 4);
+    frame.replace(0, FRAME_HEADER_BYTES, header);
+
+    size_t &size = journalBytes[owner];
+    if (!appendFrame(journalPathFor(owner), size, frame)) return false;
+    size += frame.size();
+
+    auto threshold = std::max<size_t>(journal.minCompactBytes,
+                                      static_cast<size_t>(journal.compactRatio * snapshotBytes[owner]));
+    if (size > threshold) {
+        scheduleCompaction(owner);
+    }
+    return true;
+}
+
+bool FileStore::compact(const std::string &owner) {
+    std::lock_guard<std::mutex> compactionLock(compactionMutex);
+
+    WishlistManager manager(owner);
+    size_t folded;
+    {
+        std::lock_guard<std::recursive_timed_mutex> lock(mutex);
+        // An open transaction's changes are not committed yet; the next append
+        // after the commit schedules the compaction again
+        if (!users.count(owner) || transactionOpen()) return false;
+        fillManager(owner, manager);
+        folded = journalBytes[owner];
+    }
+
+    // The expensive part runs without blocking writers; frames appended
+    // meanwhile lie beyond folded and survive the rewrite below
+    FileHandler handler(pathFor(owner));
+    handler.setFormat(FileFormat::BINARY);
+    if (!handler.save(manager)) {
+        LOG_ERROR("FileStore: Compaction of ", owner, " failed to write the snapshot");
+        return false;
+    }
+
+    std::lock_guard<std::recursive_timed_mutex> lock(mutex);
+    std::string path = journalPathFor(owner);
+    std::string tail;
+    {
+        MappedFile file;
+        if (journalBytes[owner] > folded && file.open(path)) {
+            tail.assign(file.view().substr(std::min(folded, file.size())));
+        }
+    }
+    // A crash before this point replays the whole journal over the new
+    // snapshot, which is harmless: every record holds a final state
+    if (tail.empty()) {
+        std::error_code error;
+        std::filesystem::remove(path, error);
+    } else if (!AtomicFile::write(path, tail)) {
+        LOG_ERROR("FileStore: Compaction of ", owner, " failed to rewrite the journal");
+        return false;
+    }
+
+    journalBytes[owner] = tail.size();
+    snapshotBytes[owner] = fileSize(pathFor(owner));
+    compactions++;
+    LOG_DEBUG("FileStore: Compacted ", folded, " journal byte(s) of ", owner);
+    return true;
+}
+
+void FileStore::scheduleCompaction(const std::string &owner) {
+    {
+        std::lock_guard<std::mutex> lock(compactorMutex);
+        if (std::find(compactQueue.begin(), compactQueue.end(), owner) != compactQueue.end()) return;
+        compactQueue.push_back(owner);
+    }
+    compactorWakeup.notify_one();
+}
+
+void FileStore::compactorLoop() {
+    std::unique_lock<std::mutex> lock(compactorMutex);
+    while (true) {
+        compactorWakeup.wait(lock, [this] { return stopping || !compactQueue.empty(); });
+        if (stopping) return; // The journal is durable; compaction can wait for the next run
+
+        std::string owner = std::move(compactQueue.front());
+        compactQueue.pop_front();
+        lock.unlock();
+        compact(owner);
+        lock.lock();
+    }
+}
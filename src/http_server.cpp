@@ -0,0 +1,504 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+
+#include "../include/http_server.h"
+#include "../include/json.h"
+#include "../include/parallel_parser.h"
+#include "../include/logger.h"
+
+#include <algorithm>
+#include <charconv>
+#include <sstream>
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+namespace {
+    constexpr int MAX_EVENTS = 64;
+    constexpr int SEND_TIMEOUT_MS = 5000;
+    constexpr size_t READ_CHUNK_BYTES = 16 * 1024;
+    constexpr int64_t SWEEP_INTERVAL_MS = 1000; // Longest wait between idle connection sweeps
+
+    std::string lowerCase(std::string_view text) {
+        std::string lower(text);
+        std::transform(lower.begin(), lower.end(), lower.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return lower;
+    }
+
+    std::string_view trim(std::string_view text) {
+        while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) text.remove_prefix(1);
+        while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) text.remove_suffix(1);
+        return text;
+    }
+
+    int hexValue(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    void parseQuery(std::string_view text, std::map<std::string, std::string> &query) {
+        while (!text.empty()) {
+            size_t end = text.find('&');
+            std::string_view pair = text.substr(0, end);
+            size_t equals = pair.find('=');
+            std::string name = HttpServer::percentDecode(pair.substr(0, equals), true);
+            if (!name.empty()) {
+                query[name] = equals == std::string_view::npos
+                                  ? ""
+                                  : HttpServer::percentDecode(pair.substr(equals + 1), true);
+            }
+            if (end == std::string_view::npos) break;
+            text.remove_prefix(end + 1);
+        }
+    }
+}
+
+std::string HttpRequest::header(const std::string &name) const {
+    auto it = headers.find(name);
+    return it == headers.end() ? "" : it->second;
+}
+
+HttpResponse HttpResponse::error(int status, const std::string &message) {
+    std::ostringstream body;
+    {
+        JsonWriter json(body);
+        json.beginObject().key("error").value(message).endObject();
+    }
+    return {status, "application/json", body.str()};
+}
+
+const char *HttpResponse::reason(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 201: return "Created";
+        case 204: return "No Content";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 411: return "Length Required";
+        case 413: return "Payload Too Large";
+        case 431: return "Request Header Fields Too Large";
+        case 500: return "Internal Server Error";
+        default: return "Unknown";
+    }
+}
+
+std::string HttpServer::percentDecode(std::string_view text, bool plusAsSpace) {
+    std::string decoded;
+    decoded.reserve(text.size());
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == '%' && i + 2 < text.size() && hexValue(text[i + 1]) >= 0 && hexValue(text[i + 2]) >= 0) {
+            decoded.push_back(static_cast<char>(hexValue(text[i + 1]) * 16 + hexValue(text[i + 2])));
+            i += 2;
+        } else if (plusAsSpace && text[i] == '+') {
+            decoded.push_back(' ');
+        } else {
+            decoded.push_back(text[i]);
+        }
+    }
+    return decoded;
+}
+
+HttpParseResult HttpServer::parseRequest(std::string_view data, size_t maxBodyBytes, HttpRequest &request,
+                                         size_t &consumed) {
+    size_t headerEnd = data.find("\r\n\r\n");
+    if (headerEnd == std::string_view::npos) {
+        return data.size() > MAX_HEADER_BYTES ? HttpParseResult::TOO_LARGE : HttpParseResult::INCOMPLETE;
+    }
+    if (headerEnd > MAX_HEADER_BYTES) return HttpParseResult::TOO_LARGE;
+
+    // Request line: METHOD target HTTP/1.x
+    std::string_view head = data.substr(0, headerEnd);
+    size_t lineEnd = head.find("\r\n");
+    std::string_view requestLine = head.substr(0, lineEnd);
+    size_t firstSpace = requestLine.find(' ');
+    size_t lastSpace = requestLine.rfind(' ');
+    if (firstSpace == std::string_view::npos || firstSpace == lastSpace) return HttpParseResult::INVALID;
+    std::string_view version = requestLine.substr(lastSpace + 1);
+    if (version != "HTTP/1.1" && version != "HTTP/1.0") return HttpParseResult::INVALID;
+    std::string_view target = requestLine.substr(firstSpace + 1, lastSpace - firstSpace - 1);
+    if (target.empty() || target.front() != '/') return HttpParseResult::INVALID;
+
+    request = HttpRequest();
+    request.method = std::string(requestLine.substr(0, firstSpace));
+    size_t question = target.find('?');
+    request.path = percentDecode(target.substr(0, question));
+    if (question != std::string_view::npos) parseQuery(target.substr(question + 1), request.query);
+
+    while (lineEnd != std::string_view::npos) {
+        head.remove_prefix(lineEnd + 2);
+        lineEnd = head.find("\r\n");
+        std::string_view line = head.substr(0, lineEnd);
+        size_t colon = line.find(':');
+        if (colon == std::string_view::npos || colon == 0) return HttpParseResult::INVALID;
+        request.headers[lowerCase(line.substr(0, colon))] = std::string(trim(line.substr(colon + 1)));
+    }
+
+    std::string connection = lowerCase(request.header("connection"));
+    request.keepAlive = version == "HTTP/1.1" ? connection != "close" : connection == "keep-alive";
+
+    if (!request.header("transfer-encoding").empty()) return HttpParseResult::LENGTH_REQUIRED;
+    size_t bodyLength = 0;
+    std::string length = request.header("content-length");
+    if (!length.empty()) {
+        auto [end, error] = std::from_chars(length.data(), length.data() + length.size(), bodyLength);
+        if (error != std::errc() || end != length.data() + length.size()) return HttpParseResult::INVALID;
+        if (bodyLength > maxBodyBytes) return HttpParseResult::TOO_LARGE;
+    }
+
+    size_t bodyStart = headerEnd + 4;
+    if (data.size() - bodyStart < bodyLength) return HttpParseResult::INCOMPLETE;
+    request.body = std::string(data.substr(bodyStart, bodyLength));
+    consumed = bodyStart + bodyLength;
+    return HttpParseResult::COMPLETE;
+}
+
+std::string HttpServer::formatResponse(const HttpResponse &response, bool keepAlive) {
+    std::string text;
+    text.reserve(128 + response.body.size());
+    text += "HTTP/1.1 ";
+    text += std::to_string(response.status);
+    text += ' ';
+    text += HttpResponse::reason(response.status);
+    text += "\r\nContent-Type: ";
+    text += response.contentType;
+    text += "\r\nContent-Length: ";
+    text += std::to_string(response.body.size());
+    text += keepAlive ? "\r\nConnection: keep-alive\r\n\r\n" : "\r\nConnection: close\r\n\r\n";
+    text += response.body;
+    return text;
+}
+
+HttpServer::HttpServer(Handler handler, Options options) : handler(std::move(handler)), options(std::move(options)) {
+}
+
+HttpServer::HttpServer(Handler handler) : HttpServer(std::move(handler), Options()) {
+}
+
+HttpServer::~HttpServer() {
+    stop();
+}
+
+#ifdef __linux__
+
+bool HttpServer::start() {
+    if (listenFd >= 0) return true;
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(options.port);
+    if (inet_pton(AF_INET, options.address.c_str(), &address.sin_addr) != 1) {
+        LOG_ERROR("HttpServer: Invalid address ", options.address);
+        return false;
+    }
+
+    listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    int enable = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+    socklen_t length = sizeof(address);
+    if (listenFd < 0 || bind(listenFd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 ||
+        listen(listenFd, SOMAXCONN) != 0 ||
+        getsockname(listenFd, reinterpret_cast<sockaddr *>(&address), &length) != 0) {
+        LOG_ERROR("HttpServer: Cannot listen on ", options.address, ":", options.port, ": ", std::strerror(errno));
+        closeDescriptors();
+        return false;
+    }
+    boundPort = ntohs(address.sin_port);
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    epoll_event listenEvent{};
+    listenEvent.events = EPOLLIN;
+    listenEvent.data.ptr = nullptr;
+    epoll_event wakeEvent{};
+    wakeEvent.events = EPOLLIN;
+    wakeEvent.data.ptr = &wakeFd;
+    if (epollFd < 0 || wakeFd < 0 || epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &listenEvent) != 0 ||
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &wakeEvent) != 0) {
+        LOG_ERROR("HttpServer: Cannot set up epoll: ", std::strerror(errno));
+        closeDescriptors();
+        return false;
+    }
+
+    stopping = false;
+    unsigned threads = ParallelParser::resolveThreads(options.threads);
+    for (unsigned i = 0; i < threads; ++i) {
+        workers.emplace_back(&HttpServer::workerLoop, this);
+    }
+    acceptor = std::thread(&HttpServer::acceptLoop, this);
+    LOG_INFO("HttpServer: Listening on ", options.address, ":", boundPort, " with ", threads, " worker(s)");
+    return true;
+}
+
+void HttpServer::stop() {
+    if (!acceptor.joinable()) {
+        closeDescriptors();
+        return;
+    }
+
+    uint64_t one = 1;
+    (void) !write(wakeFd, &one, sizeof(one));
+    acceptor.join();
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+        ready.clear();
+    }
+    queueCondition.notify_all();
+    for (auto &worker: workers) {
+        worker.join();
+    }
+    workers.clear();
+
+    std::lock_guard<std::mutex> lock(connectionMutex);
+    for (auto &[fd, connection]: connections) {
+        close(fd);
+    }
+    connections.clear();
+    closeDescriptors();
+    LOG_INFO("HttpServer: Stopped after ", requestCount.load(), " request(s)");
+}
+
+void HttpServer::closeDescriptors() {
+    for (int *fd: {&listenFd, &epollFd, &wakeFd}) {
+        if (*fd >= 0) close(*fd);
+        *fd = -1;
+    }
+}
+
+void HttpServer::acceptLoop() {
+    epoll_event events[MAX_EVENTS];
+    int sweepMs = options.idleTimeout.count() > 0
+                      ? static_cast<int>(std::min<int64_t>(options.idleTimeout.count(), SWEEP_INTERVAL_MS))
+                      : -1;
+    auto nextSweep = std::chrono::steady_clock::now() + std::chrono::milliseconds(sweepMs);
+    while (true) {
+        int count = epoll_wait(epollFd, events, MAX_EVENTS, sweepMs);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            LOG_ERROR("HttpServer: epoll_wait failed: ", std::strerror(errno));
+            return;
+        }
+
+        bool handedOut = false;
+        for (int i = 0; i < count; ++i) {
+            void *source = events[i].data.ptr;
+            if (source == &wakeFd) return;
+            if (source == nullptr) {
+                acceptConnections();
+                continue;
+            }
+            auto *connection = static_cast<Connection *>(source);
+            {
+                std::lock_guard<std::mutex> lock(connectionMutex);
+                connection->busy = true;
+            }
+            std::lock_guard<std::mutex> lock(queueMutex);
+            ready.push_back(connection);
+            handedOut = true;
+        }
+        if (handedOut) queueCondition.notify_all();
+
+        auto now = std::chrono::steady_clock::now();
+        if (sweepMs >= 0 && now >= nextSweep) {
+            closeIdleConnections();
+            nextSweep = now + std::chrono::milliseconds(sweepMs);
+        }
+    }
+}
+
+void HttpServer::closeIdleConnections() {
+    auto idleSince = std::chrono::steady_clock::now() - options.idleTimeout;
+    size_t closed = 0;
+    std::lock_guard<std::mutex> lock(connectionMutex);
+    for (auto it = connections.begin(); it != connections.end();) {
+        Connection &connection = *it->second;
+        if (connection.busy || connection.lastActive > idleSince) {
+            ++it;
+            continue;
+        }
+        // Also drops an event that arrived since the last wait, so no worker gets it
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, connection.fd, nullptr);
+        close(connection.fd);
+        it = connections.erase(it);
+        closed++;
+    }
+    if (closed > 0) {
+        LOG_DEBUG("HttpServer: Closed ", closed, " idle connection(s)");
+    }
+}
+
+void HttpServer::acceptConnections() {
+    while (true) {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                LOG_WARNING("HttpServer: accept failed: ", std::strerror(errno));
+            }
+            if (errno == EINTR) continue;
+            return;
+        }
+        // Responses are written whole, so Nagle would only add latency
+        int enable = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+        auto connection = std::make_unique<Connection>();
+        connection->fd = fd;
+        connection->lastActive = std::chrono::steady_clock::now();
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+        event.data.ptr = connection.get();
+        std::lock_guard<std::mutex> lock(connectionMutex);
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            close(fd);
+            continue;
+        }
+        connections.emplace(fd, std::move(connection));
+    }
+}
+
+void HttpServer::workerLoop() {
+    while (true) {
+        Connection *connection;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueCondition.wait(lock, [this] { return stopping || !ready.empty(); });
+            if (stopping) return;
+            connection = ready.front();
+            ready.pop_front();
+        }
+        serve(*connection);
+    }
+}
+
+void HttpServer::serve(Connection &connection) {
+    bool peerClosed = false;
+    char chunk[READ_CHUNK_BYTES];
+    // Anything beyond one maximal request is left in the socket: if the front
+    // request is that large the parser answers 413, otherwise the rest is read
+    // on the next wakeup once the complete requests are answered
+    while (connection.input.size() <= MAX_HEADER_BYTES + options.maxBodyBytes) {
+        ssize_t received = recv(connection.fd, chunk, sizeof(chunk), 0);
+        if (received > 0) {
+            connection.input.append(chunk, static_cast<size_t>(received));
+            continue;
+        }
+        if (received < 0 && errno == EINTR) continue;
+        peerClosed = received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK);
+        break;
+    }
+
+    // Requests sent before a half-close are still answered
+    bool keepAlive = true;
+    size_t offset = 0;
+    while (keepAlive) {
+        HttpRequest request;
+        size_t consumed = 0;
+        HttpParseResult result = parseRequest(std::string_view(connection.input).substr(offset),
+                                              options.maxBodyBytes, request, consumed);
+        if (result == HttpParseResult::INCOMPLETE) break;
+
+        HttpResponse response;
+        if (result == HttpParseResult::COMPLETE) {
+            offset += consumed;
+            keepAlive = request.keepAlive;
+            requestCount++;
+            try {
+                response = handler(request);
+            } catch (const std::exception &e) {
+                LOG_ERROR("HttpServer: Handler failed for ", request.method, " ", request.path, ": ", e.what());
+                response = HttpResponse::error(500, "Internal error");
+            }
+        } else {
+            // The rest of the stream cannot be framed, so the connection ends here
+            keepAlive = false;
+            if (result == HttpParseResult::TOO_LARGE) {
+                response = HttpResponse::error(413, "Request too large");
+            } else if (result == HttpParseResult::LENGTH_REQUIRED) {
+                response = HttpResponse::error(411, "Content-Length required");
+            } else {
+                response = HttpResponse::error(400, "Malformed request");
+            }
+        }
+        connection.output += formatResponse(response, keepAlive);
+    }
+    connection.input.erase(0, offset);
+
+    if (!sendAll(connection) || !keepAlive || peerClosed) {
+        closeConnection(connection);
+        return;
+    }
+
+    {
+        // Re-armed under the lock, so the acceptor neither hands the connection
+        // out nor sweeps it before it is marked idle
+        std::lock_guard<std::mutex> lock(connectionMutex);
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+        event.data.ptr = &connection;
+        if (epoll_ctl(epollFd, EPOLL_CTL_MOD, connection.fd, &event) == 0) {
+            connection.busy = false;
+            connection.lastActive = std::chrono::steady_clock::now();
+            return;
+        }
+    }
+    closeConnection(connection);
+}
+
+bool HttpServer::sendAll(Connection &connection) {
+    size_t sent = 0;
+    while (sent < connection.output.size()) {
+        ssize_t written = send(connection.fd, connection.output.data() + sent, connection.output.size() - sent,
+                               MSG_NOSIGNAL);
+        if (written > 0) {
+            sent += static_cast<size_t>(written);
+            continue;
+        }
+        if (written < 0 && errno == EINTR) continue;
+        if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            // A slow reader holds this worker, but only up to the timeout
+            pollfd waitFor{connection.fd, POLLOUT, 0};
+            if (poll(&waitFor, 1, SEND_TIMEOUT_MS) > 0) continue;
+        }
+        return false;
+    }
+    connection.output.clear();
+    return true;
+}
+
+void HttpServer::closeConnection(Connection &connection) {
+    int fd = connection.fd;
+    std::lock_guard<std::mutex> lock(connectionMutex);
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    connections.erase(fd); // Destroys connection
+}
+
+#else
+
+bool HttpServer::start() {
+    LOG_ERROR("HttpServer: Serving needs epoll, which only Linux provides");
+    return false;
+}
+
+void HttpServer::stop() {
+}
+
+void HttpServer::closeDescriptors() {
+}
+
+#endif
@@ -0,0 +1,149 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+
+#include "../include/item_cache.h"
+#include "../include/database_handler.h"
+#include "../include/logger.h"
+
+ItemCache::ItemCache(DatabaseHandler &handler) : dbHandler(handler) {
+    listenerId = dbHandler.addChangeListener([this](const std::vector<RowChange> &changes) { onChanges(changes); });
+}
+
+ItemCache::~ItemCache() {
+    dbHandler.removeChangeListener(listenerId);
+}
+
+void ItemCache::onChanges(const std::vector<RowChange> &changes) {
+    std::lock_guard<std::mutex> lock(eventMutex);
+    for (const auto &change: changes) {
+        if (change.table == "items") {
+            staleItems.insert(change.rowId);
+        } else if (change.table == "users" && change.operation != RowChange::Operation::INSERTED) {
+            usersChanged = true; // Renamed or deleted owners invalidate the name-keyed entries
+        }
+    }
+}
+
+void ItemCache::applyPendingChanges() {
+    std::set<int64_t> stale;
+    bool invalidateAll;
+    {
+        std::lock_guard<std::mutex> lock(eventMutex);
+        stale.swap(staleItems);
+        invalidateAll = usersChanged;
+        usersChanged = false;
+    }
+
+    if (invalidateAll) {
+        owners.clear();
+        ownerOfItem.clear();
+        counters.invalidations++;
+        LOG_DEBUG("ItemCache: Users changed, dropped all cached owners");
+        return;
+    }
+    if (owners.empty()) return;
+
+    for (int64_t rowId: stale) {
+        int itemId = static_cast<int>(rowId);
+        WishItem item;
+        std::string owner;
+        bool exists = dbHandler.loadItem(itemId, item, owner);
+        bool wasCached = ownerOfItem.count(itemId) > 0;
+
+        removeCachedItem(itemId);
+
+        auto entry = exists ? owners.find(owner) : owners.end();
+        if (entry != owners.end()) {
+            entry->second.items[itemId] = item;
+            entry->second.stats.add(item);
+            ownerOfItem[itemId] = owner;
+        }
+        if (wasCached || entry != owners.end()) {
+            counters.patchedRows++;
+        }
+    }
+}
+
+ItemCache::OwnerEntry &ItemCache::load(const std::string &owner) {
+    auto existing = owners.find(owner);
+    if (existing != owners.end()) {
+        return existing->second;
+    }
+
+    OwnerEntry &entry = owners[owner];
+    dbHandler.forEachItem(owner, [this, &entry, &owner](const ItemRowView &row) {
+        WishItem &item = entry.items[row.id];
+        row.copyTo(item);
+        entry.stats.add(item);
+        ownerOfItem[row.id] = owner;
+        return true;
+    });
+    counters.loads++;
+    LOG_DEBUG("ItemCache: Loaded ", entry.items.size(), " items for ", owner);
+    return entry;
+}
+
+void ItemCache::removeCachedItem(int itemId) {
+    auto owner = ownerOfItem.find(itemId);
+    if (owner == ownerOfItem.end()) return;
+
+    auto entry = owners.find(owner->second);
+    if (entry != owners.end()) {
+        auto item = entry->second.items.find(itemId);
+        if (item != entry->second.items.end()) {
+            entry->second.stats.remove(item->second);
+            entry->second.items.erase(item);
+        }
+    }
+    ownerOfItem.erase(owner);
+}
+
+size_t ItemCache::forEachItem(const std::string &owner, const std::function<bool(const WishItem &)> &callback) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    applyPendingChanges();
+
+    size_t visited = 0;
+    for (const auto &[id, item]: load(owner).items) {
+        visited++;
+        if (!callback(item)) break;
+    }
+    return visited;
+}
+
+bool ItemCache::getItem(int itemId, WishItem &item) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    applyPendingChanges();
+
+    auto owner = ownerOfItem.find(itemId);
+    if (owner != ownerOfItem.end()) {
+        item = owners[owner->second].items[itemId];
+        return true;
+    }
+
+    // Not cached: read through without loading the whole owner
+    std::string ownerName;
+    return dbHandler.loadItem(itemId, item, ownerName);
+}
+
+ItemStats ItemCache::getStats(const std::string &owner) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    applyPendingChanges();
+    return load(owner).stats;
+}
+
+bool ItemCache::isCached(const std::string &owner) const {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    return owners.count(owner) > 0;
+}
+
+void ItemCache::clear() {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    owners.clear();
+    ownerOfItem.clear();
+}
+
+ItemCache::Counters ItemCache::getCounters() const {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    return counters;
+}
@@ -0,0 +1,100 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+
+#include "../include/item_query.h"
+
+#include <algorithm>
+#include <cctype>
+
+namespace {
+    // ASCII case-insensitive substring test, like SQLite's LIKE
+    bool containsIgnoreCase(const std::string &text, const std::string &needle) {
+        auto it = std::search(text.begin(), text.end(), needle.begin(), needle.end(), [](char a, char b) {
+            return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
+        });
+        return it != text.end();
+    }
+}
+
+bool ItemQuery::matches(const WishItem &item) const {
+    if (purchased && item.isPurchased() != *purchased) return false;
+    if (category && item.getCategory() != *category) return false;
+    if (minPrice && item.getPrice() < *minPrice) return false;
+    if (maxPrice && item.getPrice() > *maxPrice) return false;
+    if (!nameContains.empty() && !containsIgnoreCase(item.getName(), nameContains)) return false;
+    return true;
+}
+
+bool ItemQuery::comesBefore(const WishItem &a, const WishItem &b) const {
+    switch (order) {
+        case SortOrder::BY_PRIORITY:
+            if (a.getPriority() != b.getPriority()) return a.getPriority() > b.getPriority();
+            return a.getPrice() > b.getPrice();
+        case SortOrder::BY_PRICE_ASC: return a.getPrice() < b.getPrice();
+        case SortOrder::BY_PRICE_DESC: return a.getPrice() > b.getPrice();
+        case SortOrder::BY_NAME: return a.getName() < b.getName();
+        case SortOrder::BY_CATEGORY:
+            if (a.getCategory() != b.getCategory()) return a.getCategory() < b.getCategory();
+            return a.getId() < b.getId();
+        case SortOrder::BY_ID: return a.getId() < b.getId();
+    }
+    return a.getId() < b.getId();
+}
+
+void ItemStats::add(const WishItem &item) {
+    CategoryStats &categoryStats = byCategory[item.getCategory()];
+    count++;
+    categoryStats.count++;
+    totalValue += item.getPrice();
+    categoryStats.totalValue += item.getPrice();
+    if (item.isPurchased()) {
+        purchasedCount++;
+        purchasedValue += item.getPrice();
+        categoryStats.purchasedValue += item.getPrice();
+    }
+}
+
+void ItemStats::remove(const WishItem &item) {
+    auto categoryStats = byCategory.find(item.getCategory());
+    count--;
+    totalValue -= item.getPrice();
+    if (item.isPurchased()) {
+        purchasedCount--;
+        purchasedValue -= item.getPrice();
+    }
+    if (categoryStats == byCategory.end()) return;
+
+    if (--categoryStats->second.count <= 0) {
+        byCategory.erase(categoryStats);
+        return;
+    }
+    categoryStats->second.totalValue -= item.getPrice();
+    if (item.isPurchased()) {
+        categoryStats->second.purchasedValue -= item.getPrice();
+    }
+}
+
+ItemRowView ItemRowView::of(const WishItem &item) {
+    ItemRowView row;
+    row.id = item.getId();
+    row.name = item.getName();
+    row.price = item.getPrice();
+    row.purchased = item.isPurchased();
+    row.category = item.getCategory();
+    row.priority = item.getPriority();
+    row.notes = item.getNotes();
+    row.link = item.getLink();
+    return row;
+}
+
+void ItemRowView::copyTo(WishItem &item) const {
+    item.setId(id);
+    item.setName(std::string(name));
+    item.setPrice(price);
+    item.setPurchased(purchased);
+    item.setCategory(category);
+    item.setPriority(priority);
+    item.setNotes(std::string(notes));
+    item.setLink(std::string(link));
+}
@@ -0,0 +1,403 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+
+#include "../include/json.h"
+
+#include <charconv>
+#include <cmath>
+
+namespace {
+    constexpr size_t WRITE_BUFFER_BYTES = 1 << 16;
+
+    bool isWhitespace(char c) {
+        return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+    }
+
+    bool isNumberChar(char c) {
+        return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+    }
+
+    int hexValue(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    // Reads the four hex digits of a \u escape; -1 if malformed
+    long readHex4(std::string_view digits) {
+        long value = 0;
+        for (char c: digits) {
+            int digit = hexValue(c);
+            if (digit < 0) return -1;
+            value = value * 16 + digit;
+        }
+        return value;
+    }
+
+    void appendUtf8(std::string &out, uint32_t codePoint) {
+        if (codePoint < 0x80) {
+            out.push_back(static_cast<char>(codePoint));
+        } else if (codePoint < 0x800) {
+            out.push_back(static_cast<char>(0xC0 | codePoint >> 6));
+            out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        } else if (codePoint < 0x10000) {
+            out.push_back(static_cast<char>(0xE0 | codePoint >> 12));
+            out.push_back(static_cast<char>(0x80 | (codePoint >> 6 & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        } else {
+            out.push_back(static_cast<char>(0xF0 | codePoint >> 18));
+            out.push_back(static_cast<char>(0x80 | (codePoint >> 12 & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (codePoint >> 6 & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        }
+    }
+}
+
+// ==================== JsonWriter ====================
+
+JsonWriter::JsonWriter(std::ostream &out) : out(out) {
+    buffer.reserve(WRITE_BUFFER_BYTES);
+}
+
+JsonWriter::~JsonWriter() {
+    flush();
+}
+
+void JsonWriter::beforeValue() {
+    if (buffer.size() >= WRITE_BUFFER_BYTES) flush();
+    if (afterKey) {
+        afterKey = false;
+        return;
+    }
+    if (!firstInScope.empty()) {
+        if (!firstInScope.back()) buffer.push_back(',');
+        firstInScope.back() = false;
+    }
+}
+
+void JsonWriter::writeString(std::string_view text) {
+    static const char HEX[] = "0123456789abcdef";
+    buffer.push_back('"');
+    size_t runStart = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+        auto c = static_cast<unsigned char>(text[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+
+        buffer.append(text.data() + runStart, i - runStart);
+        runStart = i + 1;
+        switch (c) {
+            case '"': buffer += "\\\"";
+                break;
+            case '\\': buffer += "\\\\";
+                break;
+            case '\n': buffer += "\\n";
+                break;
+            case '\r': buffer += "\\r";
+                break;
+            case '\t': buffer += "\\t";
+                break;
+            default:
+                buffer += "\\u00";
+                buffer.push_back(HEX[c >> 4]);
+                buffer.push_back(HEX[c & 0xF]);
+        }
+    }
+    buffer.append(text.data() + runStart, text.size() - runStart);
+    buffer.push_back('"');
+}
+
+JsonWriter &JsonWriter::beginObject() {
+    beforeValue();
+    buffer.push_back('{');
+    firstInScope.push_back(true);
+    return *this;
+}
+
+JsonWriter &JsonWriter::endObject() {
+    firstInScope.pop_back();
+    buffer.push_back('}');
+    return *this;
+}
+
+JsonWriter &JsonWriter::beginArray() {
+    beforeValue();
+    buffer.push_back('[');
+    firstInScope.push_back(true);
+    return *this;
+}
+
+JsonWriter &JsonWriter::endArray() {
+    firstInScope.pop_back();
+    buffer.push_back(']');
+    return *this;
+}
+
+JsonWriter &JsonWriter::key(std::string_view name) {
+    beforeValue();
+    writeString(name);
+    buffer.push_back(':');
+    afterKey = true;
+    return *this;
+}
+
+JsonWriter &JsonWriter::value(std::string_view text) {
+    beforeValue();
+    writeString(text);
+    return *this;
+}
+
+JsonWriter &JsonWriter::value(double number) {
+    if (!std::isfinite(number)) return null(); // JSON has no NaN or infinity
+    beforeValue();
+    char text[32];
+    auto result = std::to_chars(text, text + sizeof(text), number);
+    buffer.append(text, result.ptr);
+    return *this;
+}
+
+JsonWriter &JsonWriter::value(int number) {
+    beforeValue();
+    char text[16];
+    auto result = std::to_chars(text, text + sizeof(text), number);
+    buffer.append(text, result.ptr);
+    return *this;
+}
+
+JsonWriter &JsonWriter::value(bool flag) {
+    beforeValue();
+    buffer += flag ? "true" : "false";
+    return *this;
+}
+
+JsonWriter &JsonWriter::null() {
+    beforeValue();
+    buffer += "null";
+    return *this;
+}
+
+bool JsonWriter::flush() {
+    if (!buffer.empty()) {
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        buffer.clear();
+    }
+    return static_cast<bool>(out);
+}
+
+// ==================== JsonParser ====================
+
+JsonParser::JsonParser(JsonHandler &handler) : handler(handler) {
+}
+
+size_t JsonParser::fail(const std::string &message) {
+    if (errorMessage.empty()) {
+        errorMessage = message + " at byte " + std::to_string(offset);
+    }
+    return std::string_view::npos;
+}
+
+void JsonParser::afterValue() {
+    expect = nesting.empty() ? Expect::DONE : Expect::COMMA_OR_END;
+}
+
+size_t JsonParser::parseString(std::string_view text, bool last, bool isKey) {
+    // Fast path: no escapes, the handler gets a view into the input
+    size_t end = 1;
+    while (end < text.size() && text[end] != '"' && text[end] != '\\') {
+        if (static_cast<unsigned char>(text[end]) < 0x20) return fail("Control character in string");
+        end++;
+    }
+    std::string_view content;
+    if (end < text.size() && text[end] == '"') {
+        content = text.substr(1, end - 1);
+    } else {
+        scratch.assign(text.data() + 1, end - 1);
+        while (true) {
+            if (end >= text.size()) {
+                return last ? fail("Unterminated string") : 0;
+            }
+            char c = text[end];
+            if (c == '"') break;
+            if (static_cast<unsigned char>(c) < 0x20) return fail("Control character in string");
+            if (c != '\\') {
+                scratch.push_back(c);
+                end++;
+                continue;
+            }
+
+            if (end + 1 >= text.size()) return last ? fail("Unterminated string") : 0;
+            char escaped = text[end + 1];
+            end += 2;
+            switch (escaped) {
+                case '"': scratch.push_back('"');
+                    break;
+                case '\\': scratch.push_back('\\');
+                    break;
+                case '/': scratch.push_back('/');
+                    break;
+                case 'b': scratch.push_back('\b');
+                    break;
+                case 'f': scratch.push_back('\f');
+                    break;
+                case 'n': scratch.push_back('\n');
+                    break;
+                case 'r': scratch.push_back('\r');
+                    break;
+                case 't': scratch.push_back('\t');
+                    break;
+                case 'u': {
+                    if (end + 4 > text.size()) return last ? fail("Unterminated string") : 0;
+                    long codePoint = readHex4(text.substr(end, 4));
+                    if (codePoint < 0) return fail("Invalid \\u escape");
+                    end += 4;
+                    if (codePoint >= 0xD800 && codePoint < 0xDC00) {
+                        // High surrogate, the low one must follow
+                        if (end + 6 > text.size()) return last ? fail("Unterminated string") : 0;
+                        long low = text[end] == '\\' && text[end + 1] == 'u' ? readHex4(text.substr(end + 2, 4)) : -1;
+                        if (low < 0xDC00 || low > 0xDFFF) return fail("Invalid surrogate pair");
+                        codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                        end += 6;
+                    }
+                    appendUtf8(scratch, static_cast<uint32_t>(codePoint));
+                    break;
+                }
+                default:
+                    return fail("Invalid escape");
+            }
+        }
+        content = scratch;
+    }
+
+    bool accepted = isKey ? handler.key(content) : handler.string(content);
+    if (!accepted) return fail("Parse stopped by handler");
+    if (isKey) {
+        expect = Expect::COLON;
+    } else {
+        afterValue();
+    }
+    return end + 1;
+}
+
+size_t JsonParser::parseNumber(std::string_view text, bool last) {
+    size_t end = 0;
+    while (end < text.size() && isNumberChar(text[end])) end++;
+    if (end == text.size() && !last) return 0; // More digits may follow
+
+    double number = 0.0;
+    auto [ptr, error] = std::from_chars(text.data(), text.data() + end, number);
+    if (error != std::errc() || ptr != text.data() + end) return fail("Invalid number");
+    if (!handler.number(number)) return fail("Parse stopped by handler");
+    afterValue();
+    return end;
+}
+
+size_t JsonParser::parseLiteral(std::string_view text, bool last) {
+    for (std::string_view literal: {"true", "false", "null"}) {
+        if (literal[0] != text[0]) continue;
+        if (text.size() < literal.size()) {
+            if (!last && literal.substr(0, text.size()) == text) return 0;
+            return fail("Invalid literal");
+        }
+        if (text.substr(0, literal.size()) != literal) return fail("Invalid literal");
+
+        bool accepted = literal == "null" ? handler.null() : handler.boolean(literal == "true");
+        if (!accepted) return fail("Parse stopped by handler");
+        afterValue();
+        return literal.size();
+    }
+    return fail("Unexpected character");
+}
+
+size_t JsonParser::parseToken(std::string_view text, bool last) {
+    char c = text[0];
+    switch (expect) {
+        case Expect::DONE:
+            return fail("Unexpected data after the document");
+        case Expect::COLON:
+            if (c != ':') return fail("Expected ':'");
+            expect = Expect::VALUE;
+            return 1;
+        case Expect::COMMA_OR_END:
+            if (c == ',') {
+                expect = nesting.back() == '{' ? Expect::KEY : Expect::VALUE;
+                return 1;
+            }
+            if ((c == '}' && nesting.back() == '{') || (c == ']' && nesting.back() == '[')) break;
+            return fail("Expected ',' or the end of the object or array");
+        case Expect::FIRST_KEY_OR_END:
+            if (c == '}') break;
+            [[fallthrough]];
+        case Expect::KEY:
+            if (c != '"') return fail("Expected a key");
+            return parseString(text, last, true);
+        case Expect::FIRST_VALUE_OR_END:
+            if (c == ']') break;
+            [[fallthrough]];
+        case Expect::VALUE:
+            if (c == '{' || c == '[') {
+                bool accepted = c == '{' ? handler.startObject() : handler.startArray();
+                if (!accepted) return fail("Parse stopped by handler");
+                nesting.push_back(c);
+                expect = c == '{' ? Expect::FIRST_KEY_OR_END : Expect::FIRST_VALUE_OR_END;
+                return 1;
+            }
+            if (c == '"') return parseString(text, last, false);
+            if (c == '-' || (c >= '0' && c <= '9')) return parseNumber(text, last);
+            return parseLiteral(text, last);
+    }
+
+    // Closing the innermost object or array
+    bool accepted = c == '}' ? handler.endObject() : handler.endArray();
+    if (!accepted) return fail("Parse stopped by handler");
+    nesting.pop_back();
+    afterValue();
+    return 1;
+}
+
+bool JsonParser::consume(std::string_view data, bool last) {
+    if (!errorMessage.empty()) return false;
+
+    std::string_view text = data;
+    if (!pending.empty()) {
+        pending.append(data);
+        text = pending;
+    }
+
+    size_t position = 0;
+    while (true) {
+        while (position < text.size() && isWhitespace(text[position])) {
+            position++;
+            offset++;
+        }
+        if (position == text.size()) break;
+
+        size_t consumed = parseToken(text.substr(position), last);
+        if (consumed == std::string_view::npos) return false;
+        if (consumed == 0) break; // Token continues in the next chunk
+        position += consumed;
+        offset += consumed;
+    }
+
+    // Keep the incomplete token; assign from a copy since text may view pending
+    std::string rest(text.substr(position));
+    pending = std::move(rest);
+    return true;
+}
+
+bool JsonParser::feed(std::string_view data) {
+    return consume(data, false);
+}
+
+bool JsonParser::finish() {
+    if (!consume(std::string_view(), true)) return false;
+    if (!pending.empty()) {
+        fail("Unexpected end of input");
+        return false;
+    }
+    if (expect != Expect::DONE) {
+        fail("Unexpected end of input");
+        return false;
+    }
+    return true;
+}
@@ -8,6 +8,25 @@
 
 #include "../include/logger.h"
 #include "../include/database_handler.h"
+#include "../include/persistence_queue.h"
+#include "../include/maintenance_scheduler.h"
+#include "../include/item_cache.h"
+#include "../include/bulk_importer.h"
+#include "../include/batch_runner.h"
+#include "../include/wishlist_service.h"
+
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <thread>
+
+namespace {
+    volatile std::sig_atomic_t stopRequested = 0;
+
+    void requestStop(int) {
+        stopRequested = 1;
+    }
+}
 
 
 void displayMenu() {
@@ -128,10 +147,21 @@ void addItemInteractive(WishlistManager &manager) {
 
 void searchByName(WishlistManager &manager) {
     std::string query = Utils::getStringInput("Search for: ");
-    auto results = manager.findByName(query);
+
+    // Search runs inside the store (full-text index for SQLite) when one is attached
+    std::vector<std::unique_ptr<WishItem> > matches;
+    std::vector<const WishItem *> results;
+    if (IWishlistStore *store = manager.getStore()) {
+        manager.flushPendingWrites();
+        matches = store->searchItems(manager.getOwner(), query);
+        for (const auto &match: matches) results.push_back(match.get());
+    } else {
+        for (const auto *item: manager.findByName(query)) results.push_back(item);
+    }
 
     if (results.empty()) {
-        std::cout << "No items found matching " << query;
+        std::cout << "No items found matching " << query << "\n";
+        return;
     }
     std::cout << "\n=== SEARCH RESULTS ===\n";
     std::cout << "Found " << results.size() << " item(s):\n\n";
@@ -152,17 +182,12 @@ void markAsPurchased(WishlistManager &manager) {
     if (manager.getTotalItems() == 0) return;
 
     int id = Utils::getIntInput("\nEnter item ID to mark as purchased: ", 1);
-    WishItem *item = manager.findById(id);
 
-    if (item) {
-        item->setPurchased(true);
-        manager.syncBudgetWithPurchases();
-        std::cout << "✓ Item '" << item->getName() << "' marked as purchased!\n";
+    if (manager.markAsPurchased(id)) {
+        std::cout << "✓ Item '" << manager.findById(id)->getName() << "' marked as purchased!\n";
     } else {
         std::cout << "Error: Item with ID " << id << " not found!\n";
     }
-    if (manager.getDatabaseHandler())
-        manager.getDatabaseHandler()->updateItem(*item, manager.getOwner());
 }
 
 void removeItem(WishlistManager &manager) {
@@ -211,14 +236,15 @@ void sortMenu(WishlistManager &manager) {
     manager.displayAll();
 }
 
-void switchUser(WishlistManager * &manager, FileHandler * &fileHandler, std::string &currentOwner, DatabaseHandler *dbHandler) {
+void switchUser(WishlistManager * &manager, FileHandler * &fileHandler, std::string &currentOwner, IWishlistStore *store,
+                PersistenceQueue *queue) {
     std::cout << "=== SWITCH USER ===" << std::endl;
 
     if (manager) {
         if (!Utils::confirm("Save current wishlist before switching??")) {
-            if (manager->saveToDatabase()){
+            if (manager->saveToStore()){
                 std::cout << "Saved wishlist for "<< currentOwner << " to DB." << std::endl;
-                LOG_INFO("Wishlist saved to database for user: ", currentOwner);
+                LOG_INFO("Wishlist saved to store for user: ", currentOwner);
             } else {
                 std::cout << "Failed to save wishlist for " << currentOwner << " to DB." << std::endl;
                 LOG_ERROR("Failed to save wishlist for user: ", currentOwner);
@@ -245,12 +271,13 @@ void switchUser(WishlistManager * &manager, FileHandler * &fileHandler, std::str
     currentOwner = newOwner;
 
     manager = new WishlistManager(newOwner);
-    manager->setDatabaseHandler(dbHandler);
+    manager->setStore(store);
+    manager->setPersistenceQueue(queue);
 
-    //Ensure user exists in database
-    dbHandler->createUser(newOwner);
+    //Ensure user exists in the store
+    store->createUser(newOwner);
 
-    bool loaded = manager->loadFromDatabase();
+    bool loaded = manager->loadFromStore();
 
     if (loaded) {
         std::cout << "Loaded wishlist for " << newOwner << "\n";
@@ -261,9 +288,51 @@ void switchUser(WishlistManager * &manager, FileHandler * &fileHandler, std::str
 
     std::string filename = "wishlist_" + newOwner + ".dat";
     fileHandler = new FileHandler(filename);
+    fileHandler->setKeepBackup(true);
 }
 
-int main() {
+int main(int argc, char *argv[]) {
+    //Storage backend: --store=sqlite|sharded[:N]|file[:journal]|memory, --data=<database file or directory>
+    //--bulk-import=<directory> imports all wishlist files of a directory and exits
+    //--serve[=port] answers the REST API of wishlist_service.h on 127.0.0.1 (default port 8080) until Ctrl+C
+    //Any other option is a batch command (see batch_runner.h); with one, no menu is shown
+    std::string storeKind = "sqlite";
+    std::string storeLocation;
+    std::string bulkImportDirectory;
+    std::vector<std::string> batchArgs;
+    int servePort = -1;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--store=", 0) == 0) {
+            storeKind = arg.substr(8);
+        } else if (arg.rfind("--data=", 0) == 0) {
+            storeLocation = arg.substr(7);
+        } else if (arg.rfind("--bulk-import=", 0) == 0) {
+            bulkImportDirectory = arg.substr(14);
+        } else if (arg == "--serve") {
+            servePort = 8080;
+        } else if (arg.rfind("--serve=", 0) == 0) {
+            servePort = std::atoi(arg.c_str() + 8);
+        } else {
+            batchArgs.push_back(arg);
+        }
+    }
+    std::vector<BatchCommand> batchCommands;
+    std::string argumentError;
+    if (!BatchRunner::parseArguments(batchArgs, batchCommands, argumentError)) {
+        std::cerr << argumentError << "\n";
+        std::cerr << "Usage: " << argv[0] << " [--store=sqlite|sharded[:N]|file[:journal]|memory] [--data=<path>]"
+                << " [--bulk-import=<directory>] [--serve[=port]]\n"
+                << "       [--user NAME] [--add NAME PRICE [CATEGORY [PRIORITY [NOTES [LINK]]]]]"
+                << " [--remove ID] [--purchase ID]\n"
+                << "       [--budget AMOUNT] [--import FILE] [--export FILE] [--list] [--search QUERY]"
+                << " [--stats] [--save] [--script FILE]\n";
+        return 1;
+    }
+    if (storeLocation.empty()) {
+        storeLocation = storeKind == "sqlite" || storeKind.rfind("sharded", 0) == 0 ? "wishlist.db" : ".";
+    }
+
     //Config Logger
     Logger &logger = Logger::getInstance();
     logger.setLogLevel(LogLevel::DEBUG);
@@ -274,15 +343,73 @@ int main() {
     LOG_INFO("Application started");
     LOG_INFO("========================================");
 
+    //Initialize storage
+    std::unique_ptr<IWishlistStore> store = IWishlistStore::create(storeKind, storeLocation);
+    if (!store || !store->initialize()) {
+        std::cerr << "Failed to initialize " << storeKind << " store!\n";
+        return 1;
+    }
+    LOG_INFO("Using ", store->getName(), " store at ", storeLocation);
+
+    if (!bulkImportDirectory.empty()) {
+        std::cout << "Importing wishlists from " << bulkImportDirectory << "...\n";
+        BulkImportReport report = BulkImporter(*store).importDirectory(bulkImportDirectory);
+        report.print(std::cout);
+        return report.failedFiles == 0 ? 0 : 1;
+    }
+
+    //Edits are written behind by a background thread
+    PersistenceQueue persistenceQueue(*store);
+
+    if (servePort >= 0) {
+        //Per-request logging would serialize the workers on the log file
+        logger.setLogLevel(LogLevel::WARNING);
+        //SQLite keeps hot lists and stats in a cache patched from its row changes
+        std::unique_ptr<ItemCache> cache;
+        if (auto *dbHandler = dynamic_cast<DatabaseHandler *>(store.get())) {
+            cache = std::make_unique<ItemCache>(*dbHandler);
+        }
+        WishlistService service(*store, persistenceQueue, cache.get());
+        HttpServer::Options serverOptions;
+        serverOptions.port = static_cast<uint16_t>(servePort);
+        HttpServer server([&service](const HttpRequest &request) { return service.handle(request); }, serverOptions);
+        if (!server.start()) {
+            std::cerr << "Could not listen on 127.0.0.1:" << servePort << "\n";
+            return 1;
+        }
+        std::signal(SIGINT, requestStop);
+        std::signal(SIGTERM, requestStop);
+        std::cout << "Serving wishlists on http://127.0.0.1:" << server.getPort() << "/users (Ctrl+C to stop)\n";
+        while (!stopRequested) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        }
+        server.stop();
+        std::cout << "Stopped after " << server.getRequestCount() << " request(s)\n";
+        return service.flush() ? 0 : 1;
+    }
+
+    //Batch mode prints one JSON line per command and nothing else on stdout
+    if (!batchCommands.empty()) {
+        BatchRunner runner(*store, &persistenceQueue, std::cout);
+        bool succeeded = runner.run(batchCommands);
+        if (!runner.finish()) {
+            std::cerr << "Warning: Some changes could not be written to the database!\n";
+            succeeded = false;
+        }
+        LOG_INFO("Batch mode finished, ", runner.getFailureCount(), " command(s) failed");
+        return succeeded ? 0 : 1;
+    }
+
     std::cout << "╔══════════════════════════════════════╗\n";
     std::cout << "║  Welcome to Christmas Wishlist App  ║\n";
     std::cout << "╚══════════════════════════════════════╝\n\n";
 
-    //Initialize database
-    DatabaseHandler dbHandler("wishlist.db");
-    if (!dbHandler.initialize()) {
-        std::cerr << "Failed to initialize database!\n";
-        return 1;
+
+    //Vacuum, ANALYZE and checkpoints run in the background while the app is idle
+    std::unique_ptr<MaintenanceScheduler> maintenance;
+    if (auto *dbHandler = dynamic_cast<DatabaseHandler *>(store.get())) {
+        maintenance = std::make_unique<MaintenanceScheduler>(*dbHandler);
+        maintenance->start();
     }
 
     std::string ownerName = Utils::getStringInput("Enter your name: ");
@@ -291,10 +418,11 @@ int main() {
             " (if file operations used).\n"; // Text angepasst
 
     WishlistManager *manager = new WishlistManager(ownerName);
-    manager->setDatabaseHandler(&dbHandler); // DB-Handler setzen
+    manager->setStore(store.get()); // Store setzen
+    manager->setPersistenceQueue(&persistenceQueue);
 
     std::cout << "\nChecking for existing wishlist in Database...\n";
-    bool loaded = manager->loadFromDatabase(); // Lade Items und Budget aus DB
+    bool loaded = manager->loadFromStore(); // Lade Items und Budget aus dem Store
 
     if (loaded) {
         std::cout << "Welcome back, " << ownerName << "!" << std::endl;
@@ -304,6 +432,7 @@ int main() {
     }
 
     FileHandler *fileHandler = new FileHandler(filename);
+    fileHandler->setKeepBackup(true);
 
 
     int choice;
@@ -365,7 +494,7 @@ int main() {
                 break;
 
             case 11:
-                if (manager->saveToDatabase()) {
+                if (manager->saveToStore()) {
                     std::cout << "✓ Saved to database!\n";
                 } else {
                     std::cout << "✗ Failed to save database!\n";
@@ -374,7 +503,7 @@ int main() {
                 break;
 
             case 12:
-                if (manager->loadFromDatabase()) {
+                if (manager->loadFromStore()) {
                     std::cout << "✓ Loaded from database!\n";
                 } else {
                     std::cout << "✗ Could not load from database!\n";
@@ -382,8 +511,9 @@ int main() {
                 Utils::pause();
                 break;
             case 13:
-                switchUser(manager, fileHandler, ownerName, &dbHandler);
-                manager->setDatabaseHandler(&dbHandler); // DB-Handler für den NEUEN Manager setzen!
+                switchUser(manager, fileHandler, ownerName, store.get(), &persistenceQueue);
+                manager->setStore(store.get()); // Store für den NEUEN Manager setzen!
+                manager->setPersistenceQueue(&persistenceQueue);
                 Utils::pause();
                 break;
             case 14:
@@ -392,7 +522,7 @@ int main() {
 
             case 0:
                 if (Utils::confirm("Save to database before exiting?")) {
-                    manager->saveToDatabase();
+                    manager->saveToStore();
                 }
                 std::cout << "\n🎄 Merry Christmas! Goodbye! 🎅\n";
                 running = false;
@@ -407,6 +537,10 @@ int main() {
     delete manager;
     delete fileHandler;
 
+    if (!persistenceQueue.flush()) {
+        std::cerr << "Warning: Some changes could not be written to the database!\n";
+    }
+
     LOG_INFO("========================================");
     LOG_INFO("Application exiting normally");
     LOG_INFO("========================================");
@@ -0,0 +1,184 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+
+#include "../include/maintenance_scheduler.h"
+#include "../include/database_handler.h"
+#include "../include/logger.h"
+
+MaintenanceScheduler::MaintenanceScheduler(DatabaseHandler &handler, Options options)
+    : dbHandler(handler), options(options) {
+    if (this->options.vacuumPagesPerSlice <= 0) this->options.vacuumPagesPerSlice = 1;
+
+    if (sqlite3_open_v2(dbHandler.getPath().c_str(), &conn, SQLITE_OPEN_READWRITE | SQLITE_OPEN_FULLMUTEX,
+                        nullptr) != SQLITE_OK) {
+        LOG_ERROR("MaintenanceScheduler: Failed to open maintenance connection: ", sqlite3_errmsg(conn));
+        sqlite3_close(conn);
+        conn = nullptr;
+        return;
+    }
+    sqlite3_busy_timeout(conn, this->options.busyTimeoutMs);
+    execute(("PRAGMA analysis_limit = " + std::to_string(this->options.analysisLimit) + ";").c_str());
+
+    if (queryInt("PRAGMA auto_vacuum;") != 2) {
+        LOG_WARNING("MaintenanceScheduler: auto_vacuum is not INCREMENTAL, run a full vacuum once to convert");
+    }
+
+    lastSeenChanges = changesAtLastAnalyze = dbHandler.getChangeCount();
+    lastActivity = std::chrono::steady_clock::now();
+    dbHandler.setWalListener([this](int pages) { walPages = pages; });
+}
+
+MaintenanceScheduler::MaintenanceScheduler(DatabaseHandler &handler) : MaintenanceScheduler(handler, Options()) {
+}
+
+MaintenanceScheduler::~MaintenanceScheduler() {
+    stop();
+    if (conn) {
+        dbHandler.setWalListener(nullptr);
+        sqlite3_close(conn);
+    }
+}
+
+bool MaintenanceScheduler::start() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!conn) return false;
+    if (running) return true;
+
+    stopping = false;
+    running = true;
+    worker = std::thread(&MaintenanceScheduler::workerLoop, this);
+    LOG_INFO("MaintenanceScheduler: Started (poll interval: ", options.pollInterval.count(), " ms)");
+    return true;
+}
+
+void MaintenanceScheduler::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running) return;
+        stopping = true;
+    }
+    wakeCv.notify_one();
+
+    if (worker.joinable()) {
+        worker.join();
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    running = false;
+    LOG_INFO("MaintenanceScheduler: Stopped");
+}
+
+void MaintenanceScheduler::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (!stopping) {
+        wakeCv.wait_for(lock, options.pollInterval, [this] { return stopping; });
+        if (stopping) break;
+
+        lock.unlock();
+        runOnce();
+        lock.lock();
+    }
+}
+
+void MaintenanceScheduler::runOnce() {
+    std::lock_guard<std::mutex> taskLock(taskMutex);
+    if (!conn) return;
+
+    auto now = std::chrono::steady_clock::now();
+    int64_t changes = dbHandler.getChangeCount();
+    bool quiet = changes == lastSeenChanges;
+    if (!quiet) {
+        lastSeenChanges = changes;
+        lastActivity = now;
+    }
+
+    if (walPages >= options.checkpointPages) {
+        checkpoint();
+    }
+    // Wait for a write burst to end before refreshing statistics
+    if (quiet && changes - changesAtLastAnalyze >= options.analyzeAfterChanges) {
+        analyze();
+    }
+    if (now - lastActivity >= options.idleAfter) {
+        vacuumSlices();
+    }
+}
+
+int MaintenanceScheduler::getFreePageCount() {
+    std::lock_guard<std::mutex> taskLock(taskMutex);
+    return conn ? queryInt("PRAGMA freelist_count;") : -1;
+}
+
+MaintenanceStats MaintenanceScheduler::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+int MaintenanceScheduler::queryInt(const char *sql) {
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(conn, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        return -1;
+    }
+    int value = sqlite3_step(stmt) == SQLITE_ROW ? sqlite3_column_int(stmt, 0) : -1;
+    sqlite3_finalize(stmt);
+    return value;
+}
+
+bool MaintenanceScheduler::execute(const char *sql) {
+    int result = sqlite3_exec(conn, sql, nullptr, nullptr, nullptr);
+    if (result == SQLITE_BUSY || result == SQLITE_LOCKED) {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.skippedBusy++;
+        LOG_DEBUG("MaintenanceScheduler: Database busy, skipping: ", sql);
+        return false;
+    }
+    if (result != SQLITE_OK) {
+        LOG_ERROR("MaintenanceScheduler: ", sqlite3_errmsg(conn));
+        return false;
+    }
+    return true;
+}
+
+void MaintenanceScheduler::vacuumSlices() {
+    std::string slice = "PRAGMA incremental_vacuum(" + std::to_string(options.vacuumPagesPerSlice) + ");";
+
+    // Each slice is its own short write transaction; stop as soon as the application writes again
+    for (int i = 0; i < options.maxSlicesPerRun; ++i) {
+        int freeBefore = queryInt("PRAGMA freelist_count;");
+        if (freeBefore <= 0 || dbHandler.getChangeCount() != lastSeenChanges) break;
+        if (!execute(slice.c_str())) break;
+
+        int freeAfter = queryInt("PRAGMA freelist_count;");
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.vacuumSlices++;
+        stats.pagesReclaimed += freeBefore - freeAfter;
+        if (freeAfter >= freeBefore) break; // Not in incremental mode
+    }
+}
+
+void MaintenanceScheduler::analyze() {
+    int64_t changes = dbHandler.getChangeCount();
+    if (!execute("ANALYZE;")) return;
+
+    changesAtLastAnalyze = changes;
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.analyzeRuns++;
+    LOG_DEBUG("MaintenanceScheduler: Statistics refreshed");
+}
+
+void MaintenanceScheduler::checkpoint() {
+    int logPages = 0;
+    int checkpointedPages = 0;
+    int result = sqlite3_wal_checkpoint_v2(conn, "main", SQLITE_CHECKPOINT_PASSIVE, &logPages, &checkpointedPages);
+    if (result != SQLITE_OK) {
+        LOG_WARNING("MaintenanceScheduler: Checkpoint failed: ", sqlite3_errmsg(conn));
+        return;
+    }
+
+    // Pages still held back by active readers; retried on the next round
+    walPages = logPages - checkpointedPages;
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.checkpoints++;
+    LOG_DEBUG("MaintenanceScheduler: Checkpointed ", checkpointedPages, " of ", logPages, " WAL pages");
+}
@@ -0,0 +1,105 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+
+#include "../include/mapped_file.h"
+#include "../include/logger.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::~MappedFile() {
+    release();
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : mapping(other.mapping), length(other.length), buffer(std::move(other.buffer)) {
+    other.mapping = nullptr;
+    other.length = 0;
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+    if (this != &other) {
+        release();
+        mapping = other.mapping;
+        length = other.length;
+        buffer = std::move(other.buffer);
+        other.mapping = nullptr;
+        other.length = 0;
+    }
+    return *this;
+}
+
+void MappedFile::release() {
+    if (mapping) {
+        munmap(const_cast<char *>(mapping), length);
+        mapping = nullptr;
+    }
+    buffer.clear();
+    length = 0;
+}
+
+bool MappedFile::open(const std::string &path) {
+    release();
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        LOG_WARNING("MappedFile: Cannot open '", path, "': ", std::strerror(errno));
+        return false;
+    }
+
+    struct stat info{};
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode)) {
+        length = static_cast<size_t>(info.st_size);
+        if (length == 0) {
+            ::close(fd);
+            return true; // mmap rejects empty ranges
+        }
+
+        void *address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address != MAP_FAILED) {
+            // Read-ahead aggressively and drop pages behind the reader
+            madvise(address, length, MADV_SEQUENTIAL);
+            mapping = static_cast<const char *>(address);
+            ::close(fd);
+            return true;
+        }
+        LOG_DEBUG("MappedFile: mmap failed for '", path, "', reading instead: ", std::strerror(errno));
+        length = 0;
+    }
+
+    char chunk[64 * 1024];
+    ssize_t bytesRead;
+    while ((bytesRead = ::read(fd, chunk, sizeof(chunk))) != 0) {
+        if (bytesRead < 0) {
+            if (errno == EINTR) continue;
+            LOG_ERROR("MappedFile: Failed to read '", path, "': ", std::strerror(errno));
+            ::close(fd);
+            buffer.clear();
+            return false;
+        }
+        buffer.insert(buffer.end(), chunk, chunk + bytesRead);
+    }
+    length = buffer.size();
+    ::close(fd);
+    return true;
+}
+
+bool LineReader::next(std::string_view &line) {
+    if (remaining.empty()) return false;
+
+    const char *start = remaining.data();
+    const void *newline = std::memchr(start, '\n', remaining.size());
+    size_t lineLength = newline ? static_cast<const char *>(newline) - start : remaining.size();
+
+    line = remaining.substr(0, lineLength);
+    remaining.remove_prefix(newline ? lineLength + 1 : lineLength);
+    if (!line.empty() && line.back() == '\r') {
+        line.remove_suffix(1);
+    }
+    return true;
+}
@@ -0,0 +1,377 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+
+#include "../include/memory_store.h"
+#include "../include/logger.h"
+
+#include <algorithm>
+#include <cctype>
+
+namespace {
+    std::string toLower(std::string text) {
+        std::transform(text.begin(), text.end(), text.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return text;
+    }
+
+    // Splits a search query into lowercase terms; "quoted text" stays one phrase
+    std::vector<std::string> searchTerms(const std::string &query) {
+        std::vector<std::string> terms;
+        std::string current;
+        bool inQuotes = false;
+        for (char c: query) {
+            if (c == '"') {
+                inQuotes = !inQuotes;
+            } else if (!inQuotes && std::isspace(static_cast<unsigned char>(c))) {
+                if (!current.empty()) terms.push_back(toLower(current));
+                current.clear();
+                continue;
+            } else {
+                current += c;
+                continue;
+            }
+            if (!current.empty()) terms.push_back(toLower(current));
+            current.clear();
+        }
+        if (!current.empty()) terms.push_back(toLower(current));
+        return terms;
+    }
+
+    // True if term starts at a word boundary in text (text already lowercase)
+    bool matchesWordPrefix(const std::string &text, const std::string &term) {
+        for (size_t pos = text.find(term); pos != std::string::npos; pos = text.find(term, pos + 1)) {
+            if (pos == 0 || !std::isalnum(static_cast<unsigned char>(text[pos - 1]))) return true;
+        }
+        return false;
+    }
+
+    std::unique_ptr<WishItem> copyItem(const WishItem &item) {
+        auto copy = std::make_unique<WishItem>();
+        *copy = item; // Copy assignment keeps the ID
+        return copy;
+    }
+}
+
+MemoryStore::UserData &MemoryStore::userData(const std::string &owner) {
+    auto it = users.find(owner);
+    if (it == users.end()) {
+        if (inTransaction) {
+            UndoEntry entry{owner};
+            entry.createdUser = true;
+            undoLog.push_back(std::move(entry));
+        }
+        it = users.emplace(owner, UserData()).first;
+    }
+    return it->second;
+}
+
+void MemoryStore::OwnerChanges::merge(const OwnerChanges &other) {
+    itemIds.insert(other.itemIds.begin(), other.itemIds.end());
+    budget = budget || other.budget;
+}
+
+bool MemoryStore::persistOwner(const std::string &) {
+    return true;
+}
+
+bool MemoryStore::persistChanges(const std::string &owner, const OwnerChanges &) {
+    return persistOwner(owner);
+}
+
+bool MemoryStore::changed(const std::string &owner, const OwnerChanges &changes) {
+    if (inTransaction) {
+        touchedOwners[owner].merge(changes);
+        return true;
+    }
+    return persistChanges(owner, changes);
+}
+
+bool MemoryStore::changed(const std::string &owner) {
+    return changed(owner, OwnerChanges());
+}
+
+void MemoryStore::recordItem(const std::string &owner, int itemId) {
+    if (!inTransaction) return;
+
+    UndoEntry entry{owner, itemId};
+    auto user = users.find(owner);
+    if (user != users.end()) {
+        auto existing = user->second.items.find(itemId);
+        if (existing != user->second.items.end()) {
+            entry.previousItem.emplace();
+            *entry.previousItem = existing->second;
+        }
+    }
+    undoLog.push_back(std::move(entry));
+}
+
+int MemoryStore::maxItemId() const {
+    int maxId = 0;
+    for (const auto &[name, user]: users) {
+        if (!user.items.empty()) {
+            maxId = std::max(maxId, user.items.rbegin()->first);
+        }
+    }
+    return maxId;
+}
+
+bool MemoryStore::createUser(const std::string &username) {
+    std::lock_guard<std::recursive_timed_mutex> lock(mutex);
+    if (users.count(username)) return true;
+    userData(username);
+    return changed(username);
+}
+
+bool MemoryStore::userExists(const std::string &username) {
+    std::lock_guard<std::recursive_timed_mutex> lock(mutex);
+    return users.count(username) > 0;
+}
+
+std::vector<std::string> MemoryStore::getAllUsers() {
+    std::lock_guard<std::recursive_timed_mutex> lock(mutex);
+    std::vector<std::string> names;
+    for (const auto &[name, user]: users) {
+        names.push_back(name);
+    }
+    return names;
+}
+
+bool MemoryStore::saveItem(const WishItem &item, const std::string &owner) {
+    std::lock_guard<std::recursive_timed_mutex> lock(mutex);
+
+    int id = item.getId();
+    if (id == 0) {
+        // Reported back through the item, like the SQLite stores do
+        id = maxItemId() + 1;
+        const_cast<WishItem &>(item).setId(id);
+    } else {
+        // IDs are global, an item of another owner must not be overwritten
+        for (const auto &[name, user]: users) {
+            if (name != owner && user.items.count(id)) {
+                LOG_ERROR("MemoryStore: Item ID ", id, " belongs to another user");
+                return false;
+            }
+        }
+    }
+
+    UserData &user = userData(owner);
+    recordItem(owner, id);
+    WishItem &stored = user.items[id];
+    stored = item;
+    stored.setId(id);
+    return changed(owner, OwnerChanges{{id}});
+}
+
+bool MemoryStore::deleteItem(int itemId, const std::string &owner) {
+    std::lock_guard<std::recursive_timed_mutex> lock(mutex);
+    auto user = users.find(owner);
+    if (user == users.end()) {
+        return false;
+    }
+    if (!user->second.items.count(itemId)) {
+        return true; // Like DELETE matching no row
+    }
+
+    recordItem(owner, itemId);
+    user->second.items.erase(itemId);
+    return changed(owner, OwnerChanges{{itemId}});
+}
+
+std::vector<std::unique_ptr<WishItem> > MemoryStore::loadItems(const std::string &owner) {
+    std::vector<std::unique_ptr<WishItem> > items;
+    forEachItem(owner, [&items](const ItemRowView &row) {
+        auto item = std::make_unique<WishItem>();
+        row.copyTo(*item);
+        items.push_back(std::move(item));
+        return true;
+    });
+    return items;
+}
+
+size_t MemoryStore::forEachItem(const std::string &owner, const std::function<bool(const ItemRowView &)> &callback) {
+    std::lock_guard<std::recursive_timed_mutex> lock(mutex);
+    auto user = users.find(owner);
+    if (user == users.end()) return 0;
+
+    size_t visited = 0;
+    for (const auto &[id, item]: user->second.items) {
+        visited++;
+        if (!callback(ItemRowView::of(item))) break;
+    }
+    return visited;
+}
+
+bool MemoryStore::clearAllData(const std::string &owner) {
+    std::lock_guard<std::recursive_timed_mutex> lock(mutex);
+    auto user = users.find(owner);
+    if (user == users.end()) return false;
+
+    OwnerChanges changes;
+    for (const auto &[id, item]: user->second.items) changes.itemIds.insert(id);
+    for (int id: changes.itemIds) recordItem(owner, id);
+    user->second.items.clear();
+    return changed(owner, changes);
+}
+
+int MemoryStore::getGlobalMaxItemId() {
+    std::lock_guard<std::recursive_timed_mutex> lock(mutex);
+    return maxItemId();
+}
+
+size_t MemoryStore::queryItems(const std::string &owner, const ItemQuery &query,
+                               const std::function<bool(const ItemRowView &)> &callback) {
+    std::lock_guard<std::recursive_timed_mutex> lock(mutex);
+    auto user = users.find(owner);
+    if (user == users.end()) return 0;
+
+    std::vector<const WishItem *> matches;
+    for (const auto &[id, item]: user->second.items) {
+        if (query.matches(item)) matches.push_back(&item);
+    }
+    std::stable_sort(matches.begin(), matches.end(), [&query](const WishItem *a, const WishItem *b) {
+        return query.comesBefore(*a, *b);
+    });
+
+    size_t first = std::min(matches.size(), static_cast<size_t>(std::max(query.offset, 0)));
+    size_t last = query.limit < 0 ? matches.size() : std::min(matches.size(), first + query.limit);
+    size_t visited = 0;
+    for (size_t i = first; i < last; ++i) {
+        visited++;
+        if (!callback(ItemRowView::of(*matches[i]))) break;
+    }
+    return visited;
+}
+
+std::vector<std::unique_ptr<WishItem> > MemoryStore::findItems(const std::string &owner, const ItemQuery &query) {
+    std::vector<std::unique_ptr<WishItem> > result;
+    queryItems(owner, query, [&result](const ItemRowView &row) {
+        auto item = std::make_unique<WishItem>();
+        row.copyTo(*item);
+        result.push_back(std::move(item));
+        return true;
+    });
+    return result;
+}
+
+ItemStats MemoryStore::queryStats(const std::string &owner, const ItemQuery &query) {
+    std::lock_guard<std::recursive_timed_mutex> lock(mutex);
+    ItemStats stats;
+    auto user = users.find(owner);
+    if (user == users.end()) return stats;
+
+    for (const auto &[id, item]: user->second.items) {
+        if (query.matches(item)) stats.add(item);
+    }
+    return stats;
+}
+
+std::vector<std::unique_ptr<WishItem> > MemoryStore::searchItems(const std::string &owner, const std::string &query,
+                                                                 int limit) {
+    std::lock_guard<std::recursive_timed_mutex> lock(mutex);
+    std::vector<std::unique_ptr<WishItem> > nameMatches;
+    std::vector<std::unique_ptr<WishItem> > noteMatches;
+    auto terms = searchTerms(query);
+    auto user = users.find(owner);
+    if (terms.empty() || user == users.end()) return nameMatches;
+
+    for (const auto &[id, item]: user->second.items) {
+        std::string name = toLower(item.getName());
+        std::string notes = toLower(item.getNotes());
+        bool all = true;
+        bool allInName = true;
+        for (const auto &term: terms) {
+            bool inName = matchesWordPrefix(name, term);
+            allInName = allInName && inName;
+            all = all && (inName || matchesWordPrefix(notes, term));
+        }
+        if (!all) continue;
+        (allInName ? nameMatches : noteMatches).push_back(copyItem(item));
+    }
+
+    for (auto &item: noteMatches) {
+        nameMatches.push_back(std::move(item));
+    }
+    if (limit >= 0 && nameMatches.size() > static_cast<size_t>(limit)) {
+        nameMatches.resize(limit);
+    }
+    return nameMatches;
+}
+
+bool MemoryStore::saveBudget(const Budget &budget, const std::string &owner) {
+    std::lock_guard<std::recursive_timed_mutex> lock(mutex);
+    UserData &user = userData(owner);
+    if (inTransaction) {
+        UndoEntry entry{owner};
+        entry.previousBudget = user.budget;
+        undoLog.push_back(std::move(entry));
+    }
+    user.budget = budget;
+    OwnerChanges changes;
+    changes.budget = true;
+    return changed(owner, changes);
+}
+
+Budget MemoryStore::loadBudget(const std::string &owner) {
+    std::lock_guard<std::recursive_timed_mutex> lock(mutex);
+    auto user = users.find(owner);
+    return user != users.end() ? user->second.budget : Budget();
+}
+
+bool MemoryStore::beginTransaction() {
+    std::unique_lock<std::recursive_timed_mutex> lock(mutex, std::defer_lock);
+    if (!lock.try_lock_for(WRITER_TIMEOUT)) {
+        LOG_ERROR("MemoryStore: Timed out waiting for another thread's transaction");
+        return false;
+    }
+    // Holding the lock, an open transaction can only be this thread's own
+    if (inTransaction) {
+        LOG_ERROR("MemoryStore: Transaction already open on this thread");
+        return false;
+    }
+    inTransaction = true;
+    lock.release(); // Kept until commit or rollback
+    return true;
+}
+
+bool MemoryStore::commitTransaction() {
+    std::lock_guard<std::recursive_timed_mutex> lock(mutex);
+    if (!inTransaction) return false;
+
+    inTransaction = false;
+    undoLog.clear();
+    bool success = true;
+    for (const auto &[owner, changes]: touchedOwners) {
+        success = persistChanges(owner, changes) && success;
+    }
+    touchedOwners.clear();
+    mutex.unlock(); // Taken by beginTransaction
+    return success;
+}
+
+bool MemoryStore::rollbackTransaction() {
+    std::lock_guard<std::recursive_timed_mutex> lock(mutex);
+    if (!inTransaction) return false;
+
+    // Undo newest first, so each entry sees the state it was recorded against
+    for (auto entry = undoLog.rbegin(); entry != undoLog.rend(); ++entry) {
+        if (entry->createdUser) {
+            users.erase(entry->owner);
+            continue;
+        }
+        UserData &user = users[entry->owner];
+        if (entry->previousBudget) {
+            user.budget = *entry->previousBudget;
+        } else if (entry->previousItem) {
+            user.items[entry->itemId] = *entry->previousItem;
+        } else {
+            user.items.erase(entry->itemId);
+        }
+    }
+
+    undoLog.clear();
+    touchedOwners.clear();
+    inTransaction = false;
+    mutex.unlock(); // Taken by beginTransaction
+    return true;
+}
@@ -0,0 +1,35 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+
+#include "../include/parallel_parser.h"
+
+#include <algorithm>
+
+unsigned ParallelParser::resolveThreads(unsigned requested) {
+    if (requested > 0) return requested;
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+std::vector<std::string_view> ParallelParser::splitChunks(std::string_view text, unsigned maxChunks,
+                                                          size_t minChunkBytes) {
+    std::vector<std::string_view> chunks;
+    if (text.empty()) return chunks;
+
+    size_t chunkCount = std::max<size_t>(1, maxChunks);
+    size_t byCount = (text.size() + chunkCount - 1) / chunkCount;
+    size_t target = std::max<size_t>({byCount, minChunkBytes, 1});
+
+    while (!text.empty()) {
+        if (text.size() <= target) {
+            chunks.push_back(text);
+            break;
+        }
+        // Extend the cut to the end of the line it falls into
+        size_t newline = text.find('\n', target - 1);
+        size_t length = newline == std::string_view::npos ? text.size() : newline + 1;
+        chunks.push_back(text.substr(0, length));
+        text.remove_prefix(length);
+    }
+    return chunks;
+}
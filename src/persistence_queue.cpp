@@ -0,0 +1,227 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+
+#include "../include/persistence_queue.h"
+#include "../include/wishlist_store.h"
+#include "../include/logger.h"
+
+PersistenceQueue::PersistenceQueue(IWishlistStore &store, Options options)
+    : store(store), options(options) {
+    if (this->options.maxPending == 0) this->options.maxPending = 1;
+    if (this->options.batchSize == 0) this->options.batchSize = 1;
+    if (this->options.commitAttempts < 1) this->options.commitAttempts = 1;
+    writer = std::thread(&PersistenceQueue::writerLoop, this);
+    LOG_INFO("PersistenceQueue: Writer started (batch size: ", this->options.batchSize, ", max pending: ",
+             this->options.maxPending, ")");
+}
+
+PersistenceQueue::PersistenceQueue(IWishlistStore &store) : PersistenceQueue(store, Options()) {
+}
+
+PersistenceQueue::~PersistenceQueue() {
+    stop();
+}
+
+std::string PersistenceQueue::itemKey(const std::string &owner, int itemId) {
+    return "item|" + owner + "|" + std::to_string(itemId);
+}
+
+void PersistenceQueue::enqueueSaveItem(const WishItem &item, const std::string &owner) {
+    ChangeRecord record{ChangeType::SAVE_ITEM, owner, item.getId()};
+    record.item = item; // Copy assignment keeps the ID
+
+    if (item.getId() == 0) {
+        // Without an ID the row cannot be coalesced; it is inserted as-is
+        LOG_WARNING("PersistenceQueue: Enqueued item without ID: ", item.getName());
+        enqueue(std::move(record), "");
+        return;
+    }
+    enqueue(std::move(record), itemKey(owner, item.getId()));
+}
+
+void PersistenceQueue::enqueueDeleteItem(int itemId, const std::string &owner) {
+    enqueue(ChangeRecord{ChangeType::DELETE_ITEM, owner, itemId}, itemKey(owner, itemId));
+}
+
+void PersistenceQueue::enqueueSaveBudget(const Budget &budget, const std::string &owner) {
+    ChangeRecord record{ChangeType::SAVE_BUDGET, owner};
+    record.budget = budget;
+    enqueue(std::move(record), "budget|" + owner);
+}
+
+void PersistenceQueue::enqueue(ChangeRecord record, const std::string &key) {
+    std::unique_lock<std::mutex> lock(queueMutex);
+
+    if (stopping) {
+        // Writer is gone, fall back to a synchronous write
+        lock.unlock();
+        if (!applyRecord(record)) {
+            std::lock_guard<std::mutex> relock(queueMutex);
+            failedWrites++;
+        }
+        return;
+    }
+
+    auto existing = key.empty() ? pendingIndex.end() : pendingIndex.find(key);
+    if (existing != pendingIndex.end()) {
+        // Coalesce: the newer change for the same row replaces the older one.
+        // Field by field, as WishItem's move assignment draws a new ID.
+        ChangeRecord &older = pending[existing->second];
+        older.type = record.type;
+        older.itemId = record.itemId;
+        older.item = record.item; // Copy assignment keeps the ID
+        older.budget = record.budget;
+    } else {
+        // Backpressure: block the producer until the writer catches up
+        spaceCv.wait(lock, [this] { return pending.size() < options.maxPending || stopping; });
+        if (!key.empty()) pendingIndex[key] = pending.size();
+        pending.push_back(std::move(record));
+    }
+    enqueuedSeq++;
+
+    if (pending.size() >= options.batchSize) {
+        writerCv.notify_one();
+    }
+}
+
+bool PersistenceQueue::flush() {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    uint64_t target = enqueuedSeq;
+
+    if (committedSeq < target) {
+        flushRequested = true;
+        writerCv.notify_one();
+        doneCv.wait(lock, [this, target] { return committedSeq >= target; });
+    }
+
+    bool success = failedWrites == 0;
+    failedWrites = 0;
+    return success;
+}
+
+void PersistenceQueue::stop() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        if (stopping) return;
+        stopping = true;
+    }
+    writerCv.notify_one();
+    spaceCv.notify_all();
+
+    if (writer.joinable()) {
+        writer.join();
+    }
+    LOG_INFO("PersistenceQueue: Writer stopped");
+}
+
+size_t PersistenceQueue::pendingCount() const {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    return pending.size();
+}
+
+void PersistenceQueue::writerLoop() {
+    std::vector<ChangeRecord> batch;
+    std::unique_lock<std::mutex> lock(queueMutex);
+
+    while (true) {
+        writerCv.wait_for(lock, options.flushInterval, [this] {
+            return stopping || flushRequested || pending.size() >= options.batchSize;
+        });
+
+        if (pending.empty()) {
+            flushRequested = false;
+            if (stopping) break;
+            continue;
+        }
+
+        batch.swap(pending);
+        pendingIndex.clear();
+        uint64_t batchSeq = enqueuedSeq;
+        flushRequested = false;
+        spaceCv.notify_all();
+
+        lock.unlock();
+        bool success = commitBatch(batch);
+        size_t batchCount = batch.size();
+        batch.clear();
+        lock.lock();
+
+        if (!success) {
+            LOG_ERROR("PersistenceQueue: Batch of ", batchCount, " changes had failures");
+        }
+        committedSeq = batchSeq;
+        doneCv.notify_all();
+    }
+
+    committedSeq = enqueuedSeq;
+    doneCv.notify_all();
+}
+
+bool PersistenceQueue::commitBatch(std::vector<ChangeRecord> &batch) {
+    size_t failures = 0;
+    std::chrono::milliseconds delay = options.retryDelay;
+
+    for (int attempt = 1; !tryCommitBatch(batch, failures); ++attempt) {
+        if (attempt >= options.commitAttempts) {
+            // Nothing of the batch reached the store; name what is lost
+            LOG_ERROR("PersistenceQueue: Dropping batch of ", batch.size(), " changes after ", attempt,
+                      " failed commits");
+            for (const auto &record: batch) {
+                if (record.type == ChangeType::SAVE_BUDGET) {
+                    LOG_ERROR("PersistenceQueue: Lost budget change of ", record.owner);
+                } else {
+                    LOG_ERROR("PersistenceQueue: Lost change to item ", record.itemId, " of ", record.owner);
+                }
+            }
+            break;
+        }
+        LOG_WARNING("PersistenceQueue: Commit attempt ", attempt, " failed, retrying in ", delay.count(), " ms");
+        std::this_thread::sleep_for(delay);
+        delay *= 2;
+    }
+
+    LOG_DEBUG("PersistenceQueue: Finished batch of ", batch.size(), " changes");
+
+    if (failures > 0) {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        failedWrites += failures;
+    }
+    return failures == 0;
+}
+
+bool PersistenceQueue::tryCommitBatch(std::vector<ChangeRecord> &batch, size_t &failures) {
+    failures = batch.size();
+    if (!store.beginTransaction()) {
+        return false;
+    }
+
+    // A record the store rejects fails alone; the rest of the batch is still committed
+    failures = 0;
+    for (const auto &record: batch) {
+        if (!applyRecord(record)) {
+            failures++;
+        }
+    }
+
+    if (!store.commitTransaction()) {
+        store.rollbackTransaction();
+        failures = batch.size();
+        return false;
+    }
+    return true;
+}
+
+bool PersistenceQueue::applyRecord(const ChangeRecord &record) {
+    switch (record.type) {
+        case ChangeType::SAVE_ITEM:
+            return store.saveItem(record.item, record.owner);
+        case ChangeType::DELETE_ITEM:
+            // A coalesced save may never have reached the DB, so a missing user is nothing to delete
+            if (!store.userExists(record.owner)) return true;
+            return store.deleteItem(record.itemId, record.owner);
+        case ChangeType::SAVE_BUDGET:
+            return store.saveBudget(record.budget, record.owner);
+    }
+    return false;
+}
@@ -0,0 +1,307 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+
+#include "../include/sharded_store.h"
+#include "../include/database_handler.h"
+#include "../include/logger.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+
+ShardedStore::ShardedStore(const std::string &basePath, int shardCount) : basePath(basePath) {
+    int count = std::clamp(shardCount, 1, MAX_SHARDS);
+    if (count != shardCount) {
+        LOG_WARNING("ShardedStore: Shard count ", shardCount, " out of range, using ", count);
+    }
+    for (int i = 0; i < count; ++i) {
+        shards.push_back(std::make_unique<DatabaseHandler>(shardPath(i)));
+        writers.push_back(std::make_unique<std::recursive_timed_mutex>());
+    }
+}
+
+ShardedStore::~ShardedStore() {
+    if (coordinator) {
+        sqlite3_close(coordinator);
+    }
+}
+
+size_t ShardedStore::shardIndex(const std::string &owner, size_t shardCount) {
+    uint32_t hash = 2166136261u;
+    for (unsigned char c: owner) {
+        hash ^= c;
+        hash *= 16777619u;
+    }
+    return hash % shardCount;
+}
+
+std::string ShardedStore::shardPath(size_t index) const {
+    // wishlist.db -> wishlist.shard0.db
+    std::filesystem::path path(basePath);
+    std::string name = path.stem().string() + ".shard" + std::to_string(index) + path.extension().string();
+    return (path.parent_path() / name).string();
+}
+
+DatabaseHandler &ShardedStore::shardFor(const std::string &owner) {
+    return *shards[shardIndex(owner, shards.size())];
+}
+
+bool ShardedStore::initialize() {
+    std::filesystem::path parent = std::filesystem::path(basePath).parent_path();
+    std::error_code error;
+    if (!parent.empty() && !std::filesystem::create_directories(parent, error) && error) {
+        LOG_ERROR("ShardedStore: Cannot create directory ", parent.string(), ": ", error.message());
+        return false;
+    }
+    for (auto &shard: shards) {
+        if (!shard->initialize()) {
+            LOG_ERROR("ShardedStore: Failed to open shard ", shard->getPath());
+            return false;
+        }
+    }
+    if (!attachShards()) return false;
+
+    nextItemId = getGlobalMaxItemId() + 1;
+    LOG_INFO("ShardedStore: Opened ", shards.size(), " shards at ", basePath);
+    return true;
+}
+
+bool ShardedStore::attachShards() {
+    if (sqlite3_open(":memory:", &coordinator) != SQLITE_OK) {
+        LOG_ERROR("ShardedStore: Failed to open coordinator: ", sqlite3_errmsg(coordinator));
+        return false;
+    }
+    sqlite3_busy_timeout(coordinator, 5000);
+
+    for (size_t i = 0; i < shards.size(); ++i) {
+        std::string schema = "s" + std::to_string(i);
+        sqlite3_stmt *stmt;
+        if (sqlite3_prepare_v2(coordinator, "ATTACH DATABASE ? AS ?;", -1, &stmt, nullptr) != SQLITE_OK) {
+            LOG_ERROR("ShardedStore: Failed to prepare ATTACH: ", sqlite3_errmsg(coordinator));
+            return false;
+        }
+        sqlite3_bind_text(stmt, 1, shards[i]->getPath().c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 2, schema.c_str(), -1, SQLITE_TRANSIENT);
+        int result = sqlite3_step(stmt);
+        sqlite3_finalize(stmt);
+        if (result != SQLITE_DONE) {
+            LOG_ERROR("ShardedStore: Failed to attach shard ", i, ": ", sqlite3_errmsg(coordinator));
+            return false;
+        }
+
+        // Each shard records the shard count it was routed with; reopening with a
+        // different count would send owners to shards that do not hold their data
+        std::string pragma = "PRAGMA " + schema + ".user_version";
+        int recorded = 0;
+        if (sqlite3_prepare_v2(coordinator, (pragma + ";").c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+            LOG_ERROR("ShardedStore: Failed to read shard count: ", sqlite3_errmsg(coordinator));
+            return false;
+        }
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            recorded = sqlite3_column_int(stmt, 0);
+        }
+        sqlite3_finalize(stmt);
+
+        if (recorded == 0) {
+            std::string setCount = pragma + " = " + std::to_string(shards.size()) + ";";
+            if (sqlite3_exec(coordinator, setCount.c_str(), nullptr, nullptr, nullptr) != SQLITE_OK) {
+                LOG_ERROR("ShardedStore: Failed to record shard count: ", sqlite3_errmsg(coordinator));
+                return false;
+            }
+        } else if (recorded != static_cast<int>(shards.size())) {
+            LOG_ERROR("ShardedStore: ", shards[i]->getPath(), " belongs to a store with ", recorded,
+                      " shards, not ", shards.size());
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string ShardedStore::shardUnion(const std::string &selectFromShard) const {
+    // selectFromShard uses "{}" where the shard schema goes, e.g. "SELECT username FROM {}.users"
+    std::string sql;
+    for (size_t i = 0; i < shards.size(); ++i) {
+        if (i > 0) sql += " UNION ALL ";
+        std::string select = selectFromShard;
+        select.replace(select.find("{}"), 2, "s" + std::to_string(i));
+        sql += select;
+    }
+    return sql;
+}
+
+bool ShardedStore::writeShard(size_t index, const std::function<bool(DatabaseHandler &)> &write) {
+    std::unique_lock<std::recursive_timed_mutex> writer(*writers[index], std::defer_lock);
+    if (!writer.try_lock_for(WRITER_TIMEOUT)) {
+        LOG_ERROR("ShardedStore: Timed out waiting for the writer of shard ", index);
+        return false;
+    }
+    return enlist(index) && write(*shards[index]);
+}
+
+bool ShardedStore::enlist(size_t index) {
+    std::lock_guard<std::mutex> lock(transactionMutex);
+    auto transaction = transactions.find(std::this_thread::get_id());
+    if (transaction == transactions.end() || transaction->second[index]) return true;
+    if (!shards[index]->beginTransaction()) return false;
+    writers[index]->lock(); // Already held by this thread; kept until the transaction ends
+    transaction->second[index] = true;
+    return true;
+}
+
+bool ShardedStore::createUser(const std::string &username) {
+    return writeShard(shardIndex(username, shards.size()),
+                      [&username](DatabaseHandler &shard) { return shard.createUser(username); });
+}
+
+bool ShardedStore::userExists(const std::string &username) {
+    return shardFor(username).userExists(username);
+}
+
+std::vector<std::string> ShardedStore::getAllUsers() {
+    std::vector<std::string> users;
+    std::string sql = shardUnion("SELECT username FROM {}.users") + " ORDER BY username;";
+
+    std::lock_guard<std::mutex> lock(coordinatorMutex);
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(coordinator, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        LOG_ERROR("ShardedStore: Failed to list users: ", sqlite3_errmsg(coordinator));
+        return users;
+    }
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        users.emplace_back(reinterpret_cast<const char *>(sqlite3_column_text(stmt, 0)));
+    }
+    sqlite3_finalize(stmt);
+    return users;
+}
+
+bool ShardedStore::saveItem(const WishItem &item, const std::string &owner) {
+    return writeShard(shardIndex(owner, shards.size()), [this, &item, &owner](DatabaseHandler &shard) {
+        if (item.getId() == 0) {
+            // Shard rowids would collide, so new items take their ID from the store-wide counter
+            const_cast<WishItem &>(item).setId(nextItemId++);
+        } else {
+            // The owner's shard refuses IDs of its other users; the remaining shards are asked here
+            if (ownedElsewhere(item.getId(), &shard)) {
+                LOG_ERROR("ShardedStore: Item ID ", item.getId(), " belongs to another user");
+                return false;
+            }
+            int id = nextItemId.load();
+            while (item.getId() >= id && !nextItemId.compare_exchange_weak(id, item.getId() + 1)) {
+            }
+        }
+        return shard.saveItem(item, owner);
+    });
+}
+
+bool ShardedStore::ownedElsewhere(int itemId, const DatabaseHandler *ownShard) {
+    for (auto &shard: shards) {
+        if (shard.get() == ownShard) continue;
+        WishItem existing;
+        std::string owner;
+        if (shard->loadItem(itemId, existing, owner)) return true;
+    }
+    return false;
+}
+
+bool ShardedStore::deleteItem(int itemId, const std::string &owner) {
+    return writeShard(shardIndex(owner, shards.size()),
+                      [itemId, &owner](DatabaseHandler &shard) { return shard.deleteItem(itemId, owner); });
+}
+
+std::vector<std::unique_ptr<WishItem> > ShardedStore::loadItems(const std::string &owner) {
+    return shardFor(owner).loadItems(owner);
+}
+
+size_t ShardedStore::forEachItem(const std::string &owner, const std::function<bool(const ItemRowView &)> &callback) {
+    return shardFor(owner).forEachItem(owner, callback);
+}
+
+bool ShardedStore::clearAllData(const std::string &owner) {
+    return writeShard(shardIndex(owner, shards.size()),
+                      [&owner](DatabaseHandler &shard) { return shard.clearAllData(owner); });
+}
+
+int ShardedStore::getGlobalMaxItemId() {
+    std::string sql = "SELECT MAX(id) FROM (" + shardUnion("SELECT MAX(id) AS id FROM {}.items") + ");";
+
+    std::lock_guard<std::mutex> lock(coordinatorMutex);
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(coordinator, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        LOG_ERROR("ShardedStore: Failed to read max item ID: ", sqlite3_errmsg(coordinator));
+        return 0;
+    }
+    int maxId = 0;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        maxId = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    LOG_DEBUG("ShardedStore: Global max Item ID found: ", maxId);
+    return maxId;
+}
+
+size_t ShardedStore::queryItems(const std::string &owner, const ItemQuery &query,
+                                const std::function<bool(const ItemRowView &)> &callback) {
+    return shardFor(owner).queryItems(owner, query, callback);
+}
+
+std::vector<std::unique_ptr<WishItem> > ShardedStore::findItems(const std::string &owner, const ItemQuery &query) {
+    return shardFor(owner).findItems(owner, query);
+}
+
+ItemStats ShardedStore::queryStats(const std::string &owner, const ItemQuery &query) {
+    return shardFor(owner).queryStats(owner, query);
+}
+
+std::vector<std::unique_ptr<WishItem> > ShardedStore::searchItems(const std::string &owner, const std::string &query,
+                                                                  int limit) {
+    return shardFor(owner).searchItems(owner, query, limit);
+}
+
+bool ShardedStore::saveBudget(const Budget &budget, const std::string &owner) {
+    return writeShard(shardIndex(owner, shards.size()),
+                      [&budget, &owner](DatabaseHandler &shard) { return shard.saveBudget(budget, owner); });
+}
+
+Budget ShardedStore::loadBudget(const std::string &owner) {
+    return shardFor(owner).loadBudget(owner);
+}
+
+bool ShardedStore::beginTransaction() {
+    // Shards join lazily on their first write, so a transaction only locks the shards it touches
+    std::lock_guard<std::mutex> lock(transactionMutex);
+    if (!transactions.emplace(std::this_thread::get_id(), std::vector<bool>(shards.size(), false)).second) {
+        LOG_ERROR("ShardedStore: Transaction already open on this thread");
+        return false;
+    }
+    return true;
+}
+
+bool ShardedStore::commitTransaction() {
+    return endTransaction(true);
+}
+
+bool ShardedStore::rollbackTransaction() {
+    return endTransaction(false);
+}
+
+bool ShardedStore::endTransaction(bool commit) {
+    std::lock_guard<std::mutex> lock(transactionMutex);
+    auto transaction = transactions.find(std::this_thread::get_id());
+    if (transaction == transactions.end()) return true;
+
+    bool success = true;
+    for (size_t i = 0; i < shards.size(); ++i) {
+        if (!transaction->second[i]) continue;
+        if (!commit) {
+            success = shards[i]->rollbackTransaction() && success;
+        } else if (!shards[i]->commitTransaction()) {
+            LOG_ERROR("ShardedStore: Failed to commit shard ", i);
+            shards[i]->rollbackTransaction();
+            success = false;
+        }
+        writers[i]->unlock();
+    }
+    transactions.erase(transaction);
+    return success;
+}
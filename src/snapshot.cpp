@@ -0,0 +1,186 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+
+#include "../include/snapshot.h"
+#include "../include/crc32c.h"
+#include "../include/logger.h"
+
+#include <bit>
+#include <vector>
+
+namespace {
+    constexpr size_t COLUMN_BYTES_PER_ITEM = 4 + 8 + 1 + 1 + 1 + 4 + 4 + 4;
+    constexpr size_t FIXED_HEADER_BYTES = 8 + 2 + 2 + 4 + 8 + 8 + 1 + 3 + 8 + 8 + 4;
+
+    // Little-endian encoding independent of the host's byte order
+    void putUint(std::string &out, uint64_t value, int bytes) {
+        for (int i = 0; i < bytes; ++i) {
+            out.push_back(static_cast<char>(value >> (8 * i) & 0xFF));
+        }
+    }
+
+    uint64_t getUint(const char *in, int bytes) {
+        uint64_t value = 0;
+        for (int i = 0; i < bytes; ++i) {
+            value |= static_cast<uint64_t>(static_cast<unsigned char>(in[i])) << (8 * i);
+        }
+        return value;
+    }
+
+    void putDouble(std::string &out, double value) {
+        putUint(out, std::bit_cast<uint64_t>(value), 8);
+    }
+
+    double getDouble(const char *in) {
+        return std::bit_cast<double>(getUint(in, 8));
+    }
+
+    void putSection(std::string &out, const std::string &section) {
+        out += section;
+        putUint(out, crc32c(section), 4);
+    }
+
+    // Splits the next section and its checksum off data
+    bool takeSection(std::string_view &data, size_t size, std::string_view &section, const char *name) {
+        if (data.size() < size || data.size() - size < 4) {
+            LOG_ERROR("Snapshot: Truncated ", name, " section");
+            return false;
+        }
+        section = data.substr(0, size);
+        if (crc32c(section) != getUint(data.data() + size, 4)) {
+            LOG_ERROR("Snapshot: Checksum mismatch in ", name, " section");
+            return false;
+        }
+        data.remove_prefix(size + 4);
+        return true;
+    }
+}
+
+bool Snapshot::isSnapshot(std::string_view data) {
+    return data.substr(0, MAGIC.size()) == MAGIC;
+}
+
+std::string Snapshot::encode(const WishlistManager &manager) {
+    const auto &items = manager.getItems();
+    const Budget &budget = manager.getBudget();
+
+    std::string columns;
+    std::string blob;
+    columns.reserve(items.size() * COLUMN_BYTES_PER_ITEM);
+    for (const auto &item: items) putUint(columns, static_cast<uint32_t>(item->getId()), 4);
+    for (const auto &item: items) putDouble(columns, item->getPrice());
+    for (const auto &item: items) putUint(columns, item->isPurchased(), 1);
+    for (const auto &item: items) putUint(columns, static_cast<uint8_t>(item->getCategory()), 1);
+    for (const auto &item: items) putUint(columns, static_cast<uint8_t>(item->getPriority()), 1);
+    for (const auto &item: items) putUint(columns, item->getName().size(), 4);
+    for (const auto &item: items) putUint(columns, item->getNotes().size(), 4);
+    for (const auto &item: items) putUint(columns, item->getLink().size(), 4);
+    for (const auto &item: items) {
+        blob += item->getName();
+        blob += item->getNotes();
+        blob += item->getLink();
+    }
+
+    std::string header(MAGIC);
+    putUint(header, VERSION, 2);
+    putUint(header, 0, 2);
+    putUint(header, items.size(), 4);
+    putDouble(header, budget.getMaxBudget());
+    putDouble(header, budget.getSpentAmount());
+    putUint(header, budget.isEnabled(), 1);
+    putUint(header, 0, 3);
+    putUint(header, columns.size(), 8);
+    putUint(header, blob.size(), 8);
+    putUint(header, manager.getOwner().size(), 4);
+    header += manager.getOwner();
+
+    std::string snapshot;
+    snapshot.reserve(header.size() + columns.size() + blob.size() + 12);
+    putSection(snapshot, header);
+    putSection(snapshot, columns);
+    putSection(snapshot, blob);
+    return snapshot;
+}
+
+int Snapshot::decode(std::string_view data, WishlistManager &manager) {
+    if (!isSnapshot(data) || data.size() < FIXED_HEADER_BYTES) {
+        LOG_ERROR("Snapshot: Not a snapshot or truncated header");
+        return -1;
+    }
+    const char *fixed = data.data();
+    uint16_t version = getUint(fixed + 8, 2);
+    if (version != VERSION) {
+        LOG_ERROR("Snapshot: Unsupported version ", version);
+        return -1;
+    }
+    uint32_t itemCount = getUint(fixed + 12, 4);
+    double maxBudget = getDouble(fixed + 16);
+    double spentAmount = getDouble(fixed + 24);
+    bool budgetEnabled = fixed[32] != 0;
+    uint64_t columnsSize = getUint(fixed + 36, 8);
+    uint64_t blobSize = getUint(fixed + 44, 8);
+    uint32_t ownerLength = getUint(fixed + 52, 4);
+
+    std::string_view header;
+    std::string_view columns;
+    std::string_view blob;
+    if (!takeSection(data, FIXED_HEADER_BYTES + ownerLength, header, "header") ||
+        !takeSection(data, columnsSize, columns, "columns") ||
+        !takeSection(data, blobSize, blob, "blob")) {
+        return -1;
+    }
+    if (columnsSize != static_cast<uint64_t>(itemCount) * COLUMN_BYTES_PER_ITEM) {
+        LOG_ERROR("Snapshot: Column section does not match item count ", itemCount);
+        return -1;
+    }
+
+    const char *ids = columns.data();
+    const char *prices = ids + 4 * itemCount;
+    const char *purchased = prices + 8 * itemCount;
+    const char *categories = purchased + itemCount;
+    const char *priorities = categories + itemCount;
+    const char *nameLengths = priorities + itemCount;
+    const char *notesLengths = nameLengths + 4 * itemCount;
+    const char *linkLengths = notesLengths + 4 * itemCount;
+
+    // Everything is checked before the manager is touched
+    std::vector<std::unique_ptr<WishItem> > items;
+    items.reserve(itemCount);
+    uint64_t offset = 0;
+    for (uint32_t i = 0; i < itemCount; ++i) {
+        uint64_t nameLength = getUint(nameLengths + 4 * i, 4);
+        uint64_t notesLength = getUint(notesLengths + 4 * i, 4);
+        uint64_t linkLength = getUint(linkLengths + 4 * i, 4);
+        if (nameLength + notesLength + linkLength > blob.size() - offset) {
+            LOG_ERROR("Snapshot: String lengths of item ", i, " exceed the blob section");
+            return -1;
+        }
+
+        auto item = std::make_unique<WishItem>();
+        item->setId(static_cast<int32_t>(getUint(ids + 4 * i, 4)));
+        item->setPrice(getDouble(prices + 8 * i));
+        item->setPurchased(purchased[i] != 0);
+        item->setCategory(static_cast<Category>(categories[i]));
+        item->setPriority(static_cast<Priority>(priorities[i]));
+        item->setName(std::string(blob.substr(offset, nameLength)));
+        offset += nameLength;
+        item->setNotes(std::string(blob.substr(offset, notesLength)));
+        offset += notesLength;
+        item->setLink(std::string(blob.substr(offset, linkLength)));
+        offset += linkLength;
+        items.push_back(std::move(item));
+    }
+
+    manager.setOwner(std::string(header.substr(FIXED_HEADER_BYTES, ownerLength)));
+    Budget &budget = manager.getBudget();
+    budget.setMaxBudget(maxBudget);
+    budget.setSpentAmount(spentAmount);
+    budgetEnabled ? budget.enable() : budget.disable();
+
+    for (auto &item: items) {
+        WishItem::reserveId(item->getId());
+        manager.addItem(std::move(item));
+    }
+    return static_cast<int>(itemCount);
+}
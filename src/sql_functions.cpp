@@ -0,0 +1,162 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+
+#include "../include/sql_functions.h"
+#include "../include/wishlist.h"
+#include "../include/logger.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace {
+    using Trigrams = std::vector<uint32_t>; // Sorted and unique, three bytes packed per entry
+
+    bool isWordByte(unsigned char c) {
+        return std::isalnum(c) || c >= 0x80; // Multi-byte UTF-8 sequences stay inside words
+    }
+
+    // Trigrams of every word padded with two leading and one trailing space, so
+    // short words and word starts weigh more, as in PostgreSQL's pg_trgm
+    Trigrams trigramsOf(std::string_view text) {
+        std::string folded = SqlFunctions::foldCase(text);
+        Trigrams trigrams;
+        size_t i = 0;
+        while (i < folded.size()) {
+            while (i < folded.size() && !isWordByte(folded[i])) i++;
+            size_t start = i;
+            while (i < folded.size() && isWordByte(folded[i])) i++;
+            if (start == i) break;
+
+            std::string word = "  " + folded.substr(start, i - start) + " ";
+            for (size_t j = 0; j + 3 <= word.size(); ++j) {
+                trigrams.push_back(static_cast<unsigned char>(word[j]) << 16 |
+                                   static_cast<unsigned char>(word[j + 1]) << 8 |
+                                   static_cast<unsigned char>(word[j + 2]));
+            }
+        }
+        std::sort(trigrams.begin(), trigrams.end());
+        trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+        return trigrams;
+    }
+
+    double similarity(const Trigrams &a, const Trigrams &b) {
+        size_t shared = 0;
+        auto x = a.begin();
+        auto y = b.begin();
+        while (x != a.end() && y != b.end()) {
+            if (*x < *y) {
+                ++x;
+            } else if (*y < *x) {
+                ++y;
+            } else {
+                shared++;
+                ++x;
+                ++y;
+            }
+        }
+        size_t total = a.size() + b.size() - shared;
+        return total == 0 ? 0.0 : static_cast<double>(shared) / static_cast<double>(total);
+    }
+
+    std::string_view textArg(sqlite3_value *value) {
+        const char *text = reinterpret_cast<const char *>(sqlite3_value_text(value));
+        return text ? std::string_view(text, sqlite3_value_bytes(value)) : std::string_view();
+    }
+
+    bool anyNull(int argc, sqlite3_value **argv) {
+        for (int i = 0; i < argc; ++i) {
+            if (sqlite3_value_type(argv[i]) == SQLITE_NULL) return true;
+        }
+        return false;
+    }
+
+    void sqlCategoryName(sqlite3_context *context, int argc, sqlite3_value **argv) {
+        if (anyNull(argc, argv)) return sqlite3_result_null(context);
+        std::string name = WishItem::categoryToString(static_cast<Category>(sqlite3_value_int(argv[0])));
+        sqlite3_result_text(context, name.c_str(), static_cast<int>(name.size()), SQLITE_TRANSIENT);
+    }
+
+    void sqlFoldCase(sqlite3_context *context, int argc, sqlite3_value **argv) {
+        if (anyNull(argc, argv)) return sqlite3_result_null(context);
+        std::string folded = SqlFunctions::foldCase(textArg(argv[0]));
+        sqlite3_result_text(context, folded.c_str(), static_cast<int>(folded.size()), SQLITE_TRANSIENT);
+    }
+
+    void sqlTrigramSim(sqlite3_context *context, int argc, sqlite3_value **argv) {
+        if (anyNull(argc, argv)) return sqlite3_result_null(context);
+
+        // The second argument is usually the search term and the same for every row,
+        // so its trigrams are kept with the statement until the argument changes
+        auto *pattern = static_cast<Trigrams *>(sqlite3_get_auxdata(context, 1));
+        if (!pattern) {
+            pattern = new Trigrams(trigramsOf(textArg(argv[1])));
+            sqlite3_set_auxdata(context, 1, pattern, [](void *data) { delete static_cast<Trigrams *>(data); });
+            // SQLite may have freed it already if the argument is not constant
+            pattern = static_cast<Trigrams *>(sqlite3_get_auxdata(context, 1));
+        }
+        Trigrams text = trigramsOf(textArg(argv[0]));
+        sqlite3_result_double(context, pattern ? similarity(text, *pattern)
+                                               : similarity(text, trigramsOf(textArg(argv[1]))));
+    }
+
+    void sqlPriceBucket(sqlite3_context *context, int argc, sqlite3_value **argv) {
+        if (anyNull(argc, argv) || sqlite3_value_double(argv[1]) <= 0.0) return sqlite3_result_null(context);
+        sqlite3_result_double(context, SqlFunctions::priceBucket(sqlite3_value_double(argv[0]),
+                                                                 sqlite3_value_double(argv[1])));
+    }
+}
+
+bool SqlFunctions::registerAll(sqlite3 *db) {
+    struct Function {
+        const char *name;
+        int arguments;
+        void (*implementation)(sqlite3_context *, int, sqlite3_value **);
+    };
+    const Function functions[] = {
+        {"category_name", 1, sqlCategoryName},
+        {"fold_case", 1, sqlFoldCase},
+        {"trigram_sim", 2, sqlTrigramSim},
+        {"price_bucket", 2, sqlPriceBucket},
+    };
+
+    for (const auto &function: functions) {
+        int result = sqlite3_create_function_v2(db, function.name, function.arguments,
+                                                SQLITE_UTF8 | SQLITE_DETERMINISTIC | SQLITE_INNOCUOUS, nullptr,
+                                                function.implementation, nullptr, nullptr, nullptr);
+        if (result != SQLITE_OK) {
+            LOG_ERROR("SqlFunctions: Failed to register ", function.name, ": ", sqlite3_errmsg(db));
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string SqlFunctions::foldCase(std::string_view text) {
+    std::string folded(text);
+    for (size_t i = 0; i < folded.size(); ++i) {
+        unsigned char c = folded[i];
+        if (c >= 'A' && c <= 'Z') {
+            folded[i] = static_cast<char>(c + 32);
+        } else if (c == 0xC3 && i + 1 < folded.size()) {
+            // U+00C0..U+00DE (À..Þ) are encoded as C3 80..C3 9E; lower case is 0x20 higher. U+00D7 is ×
+            unsigned char next = folded[i + 1];
+            if (next >= 0x80 && next <= 0x9E && next != 0x97) {
+                folded[i + 1] = static_cast<char>(next + 0x20);
+            }
+            i++;
+        }
+    }
+    return folded;
+}
+
+double SqlFunctions::trigramSimilarity(std::string_view a, std::string_view b) {
+    return similarity(trigramsOf(a), trigramsOf(b));
+}
+
+double SqlFunctions::priceBucket(double price, double width) {
+    return std::floor(price / width) * width;
+}
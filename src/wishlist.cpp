@@ -9,8 +9,9 @@
 #include "../include/logger.h"
 #include <memory>
 #include <vector>
+#include <charconv>
 
-int WishItem::nextId = 1;
+std::atomic<int> WishItem::nextId{1};
 
 WishItem::WishItem()
     : id(0), name(""), price(0.0), purchased(false), category(Category::OTHER), priority(Priority::MEDIUM),
@@ -76,13 +77,13 @@ WishItem &WishItem::operator=(WishItem &&other) noexcept {
     return *this;
 }
 
-void WishItem::setName(const std::string &name) { this->name = name; }
+void WishItem::setName(std::string name) { this->name = std::move(name); }
 void WishItem::setPrice(double price) { this->price = price; }
 void WishItem::setPurchased(bool purchased) { this->purchased = purchased; }
 void WishItem::setCategory(Category cat) { this->category = cat; }
 void WishItem::setPriority(Priority priority) { this->priority = priority; }
-void WishItem::setNotes(const std::string &notes) { this->notes = notes; }
-void WishItem::setLink(const std::string &link) { this->link = link; }
+void WishItem::setNotes(std::string notes) { this->notes = std::move(notes); }
+void WishItem::setLink(std::string link) { this->link = std::move(link); }
 
 bool WishItem::operator<(const WishItem &other) const {
     if (priority != other.priority) {
@@ -120,49 +121,59 @@ std::string WishItem::serialize() const {
     return ss.str();
 }
 
-std::unique_ptr<WishItem> WishItem::deserialize(const std::string &data) {
-    std::stringstream ss(data);
-    std::string token;
-    std::vector<std::string> tokens;
-
-    while (std::getline(ss, token, '|')) {
-        tokens.push_back(token);
+namespace {
+    template<typename T>
+    bool parseNumber(std::string_view text, T &value) {
+        auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+        return error == std::errc() && end == text.data() + text.size();
     }
+}
 
-    if (tokens.size() < 6) {
-        LOG_ERROR("[WishItem] deserialize: Not enough tokens (", tokens.size() , "), expected at least 6");
+std::unique_ptr<WishItem> WishItem::deserialize(std::string_view data) {
+    auto item = std::make_unique<WishItem>();
+    if (!parse(data, *item)) {
         return nullptr;
     }
 
-    auto item = std::make_unique<WishItem>();
+    reserveId(item->id);
+    return item;
+}
 
-    try {
-        item->id = std::stoi(tokens[0]);
-        item->name = tokens[1];
-        item->price = std::stod(tokens[2]);
-        item->purchased = (tokens[3] == "1");
-        item->category = static_cast<Category>(std::stoi(tokens[4]));
-        item->priority = static_cast<Priority>(std::stoi(tokens[5]));
-
-        if (tokens.size() > 6) {
-            item->notes = tokens[6];
-        }
-        if (tokens.size() > 7) {
-            item->link = tokens[7];
-        }
-
-        if (item->id >= nextId) {
-            nextId = item->id + 1;
-        }
-
-       LOG_DEBUG("[WishItem] Deserialized: ID=" , item->id , ", Name=" , item->name);
-
-    } catch (const std::exception& e) {
-        LOG_ERROR("[WishItem] deserialize error: " , e.what());
-        return nullptr;
+void WishItem::reserveId(int usedId) {
+    int current = nextId.load();
+    while (usedId >= current && !nextId.compare_exchange_weak(current, usedId + 1)) {
     }
+}
 
-    return item;
+bool WishItem::parse(std::string_view data, WishItem &item) {
+    // Fields beyond the link are ignored, like a trailing empty field
+    std::string_view tokens[8];
+    size_t count = 0;
+    while (!data.empty() && count < 8) {
+        size_t separator = data.find('|');
+        tokens[count++] = data.substr(0, separator);
+        data.remove_prefix(separator == std::string_view::npos ? data.size() : separator + 1);
+    }
+
+    if (count < 6) {
+        LOG_ERROR("[WishItem] deserialize: Not enough tokens (", count , "), expected at least 6");
+        return false;
+    }
+
+    int category = 0;
+    int priority = 0;
+    if (!parseNumber(tokens[0], item.id) || !parseNumber(tokens[2], item.price) ||
+        !parseNumber(tokens[4], category) || !parseNumber(tokens[5], priority)) {
+        LOG_ERROR("[WishItem] deserialize error: Invalid number in '", tokens[0], "|", tokens[1], "|...'");
+        return false;
+    }
+    item.name = tokens[1];
+    item.purchased = (tokens[3] == "1");
+    item.category = static_cast<Category>(category);
+    item.priority = static_cast<Priority>(priority);
+    item.notes = count > 6 ? tokens[6] : std::string_view();
+    item.link = count > 7 ? tokens[7] : std::string_view();
+    return true;
 }
 
 std::string WishItem::categoryToString(Category cat) {
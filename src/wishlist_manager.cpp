@@ -4,14 +4,15 @@
 
 #include "../include/wishlist_manager.h"
 #include "../include/logger.h"
-#include "../include/database_handler.h"
+#include "../include/wishlist_store.h"
+#include "../include/persistence_queue.h"
 
 #include <iostream>
 #include <map>
 #include <ostream>
 #include <iomanip>
 
-WishlistManager::WishlistManager(const std::string &owner) : owner(owner), dbHandler(nullptr) {
+WishlistManager::WishlistManager(const std::string &owner) : owner(owner), store(nullptr) {
     LOG_INFO("[WishlistManger] Created for: ", owner);
 }
 
@@ -22,10 +23,12 @@ WishlistManager::~WishlistManager() {
 void WishlistManager::addItem(std::unique_ptr<WishItem> item) {
     if (item) {
         LOG_INFO("[WishlistManager] Adding item: ", item->getName());
-        items.push_back(std::move(item));
-        if (dbHandler) {
-            dbHandler->saveItem(*items.back(), owner);
+        if (persistenceQueue && item->getId() == 0) {
+            // The writer runs later, so the item needs its final ID up front
+            item->setId(WishItem::takeNextId());
         }
+        items.push_back(std::move(item));
+        persistItem(*items.back());
     }
 }
 
@@ -35,7 +38,7 @@ bool WishlistManager::removeItem(int id) {
     });
     if (it != items.end()) {
         LOG_INFO("[WishlistManager] Removing item ID: ", id);
-        if (dbHandler) dbHandler->deleteItem(id, owner);
+        persistDelete(id);
         items.erase(it);
         return true;
     }
@@ -43,6 +46,35 @@ bool WishlistManager::removeItem(int id) {
     return false;
 }
 
+bool WishlistManager::markAsPurchased(int id) {
+    WishItem *item = findById(id);
+    if (!item) {
+        LOG_WARNING("WishlistManager: Item ID ", id, " not found to mark as purchased");
+        return false;
+    }
+
+    item->setPurchased(true);
+    syncBudgetWithPurchases();
+    persistItem(*item);
+    LOG_INFO("WishlistManager: Marked item ID ", id, " as purchased");
+    return true;
+}
+
+bool WishlistManager::updateItem(int id, const std::function<void(WishItem &)> &change) {
+    WishItem *item = findById(id);
+    if (!item) {
+        LOG_WARNING("WishlistManager: Item ID ", id, " not found to update");
+        return false;
+    }
+
+    change(*item);
+    item->setId(id);
+    syncBudgetWithPurchases();
+    persistItem(*item);
+    LOG_INFO("WishlistManager: Updated item ID ", id);
+    return true;
+}
+
 WishItem *WishlistManager::findById(int id) {
     auto it = std::find_if(items.begin(), items.end(), [id](const std::unique_ptr<WishItem> &item) {
         return item->getId() == id;
@@ -82,14 +114,43 @@ std::vector<WishItem *> WishlistManager::filter(std::function<bool(const WishIte
     return result;
 }
 
+std::vector<std::unique_ptr<WishItem> > WishlistManager::findItems(const ItemQuery &query) {
+    if (store) {
+        flushPendingWrites();
+        return store->findItems(owner, query);
+    }
+
+    std::vector<const WishItem *> matches;
+    for (const auto &item: items) {
+        if (query.matches(*item)) matches.push_back(item.get());
+    }
+    std::stable_sort(matches.begin(), matches.end(), [&query](const WishItem *a, const WishItem *b) {
+        return query.comesBefore(*a, *b);
+    });
+
+    std::vector<std::unique_ptr<WishItem> > result;
+    size_t first = std::min(matches.size(), static_cast<size_t>(std::max(query.offset, 0)));
+    size_t last = query.limit < 0 ? matches.size() : std::min(matches.size(), first + query.limit);
+    for (size_t i = first; i < last; ++i) {
+        auto copy = std::make_unique<WishItem>();
+        *copy = *matches[i]; // Copy assignment keeps the ID
+        result.push_back(std::move(copy));
+    }
+    return result;
+}
+
 void WishlistManager::markAllPurchased() {
     for (auto &item: items) {
         item->setPurchased(true);
+        persistItem(*item);
     }
     std::cout << "[WishlistManager] Marked all items as purchased" << std::endl;
 }
 
 void WishlistManager::clearAllPurchased() {
+    for (const auto &item: items) {
+        if (item->isPurchased()) persistDelete(item->getId());
+    }
     auto it = std::remove_if(items.begin(), items.end(), [](const std::unique_ptr<WishItem> &item) {
         return item->isPurchased();
     });
@@ -157,6 +218,23 @@ double WishlistManager::getRemainingValue() const {
     return getTotalValue() - getPurchasedValue();
 }
 
+ItemStats WishlistManager::getStats() {
+    return getStats(ItemQuery());
+}
+
+ItemStats WishlistManager::getStats(const ItemQuery &query) {
+    if (store) {
+        flushPendingWrites();
+        return store->queryStats(owner, query);
+    }
+
+    ItemStats stats;
+    for (const auto &item: items) {
+        if (query.matches(*item)) stats.add(*item);
+    }
+    return stats;
+}
+
 void WishlistManager::displayAll() const {
     if (items.empty()) {
         std::cout << "\n Wishlist is empty!" << std::endl;
@@ -169,21 +247,21 @@ void WishlistManager::displayAll() const {
     }
 }
 
-void WishlistManager::displayPending() const {
+void WishlistManager::displayPending() {
+    ItemQuery pending;
+    pending.purchased = false;
     std::cout << "\n=== PENDING ITEMS ===\n";
-    for (const auto &item: items) {
-        if (!item->isPurchased()) {
-            std::cout << *item << "\n";
-        }
+    for (const auto &item: findItems(pending)) {
+        std::cout << *item << "\n";
     }
 }
 
-void WishlistManager::displayPurchased() const {
+void WishlistManager::displayPurchased() {
+    ItemQuery purchased;
+    purchased.purchased = true;
     std::cout << "\n=== PURCHASED ITEMS ===\n";
-    for (const auto &item: items) {
-        if (item->isPurchased()) {
-            std::cout << *item << "\n";
-        }
+    for (const auto &item: findItems(purchased)) {
+        std::cout << *item << "\n";
     }
 }
 
@@ -203,20 +281,21 @@ void WishlistManager::displayByCategory() const {
     }
 }
 
-void WishlistManager::displayStatistics() const {
+void WishlistManager::displayStatistics() {
+    ItemStats stats = getStats();
     std::cout << "\n=== STATISTICS ===\n";
     std::cout << "Owner: " << owner << "\n";
-    std::cout << "Total Items: " << getTotalItems() << "\n";
-    std::cout << "Purchased: " << getPurchasedCount() << "\n";
-    std::cout << "Pending: " << (getTotalItems() - getPurchasedCount()) << "\n";
-    std::cout << "Total Value: $" << std::fixed << std::setprecision(2) << getTotalValue() << "\n";
-    std::cout << "Purchased Value: $" << getPurchasedValue() << "\n";
-    std::cout << "Remaining Value: $" << getRemainingValue() << "\n";
+    std::cout << "Total Items: " << stats.count << "\n";
+    std::cout << "Purchased: " << stats.purchasedCount << "\n";
+    std::cout << "Pending: " << (stats.count - stats.purchasedCount) << "\n";
+    std::cout << "Total Value: $" << std::fixed << std::setprecision(2) << stats.totalValue << "\n";
+    std::cout << "Purchased Value: $" << stats.purchasedValue << "\n";
+    std::cout << "Remaining Value: $" << (stats.totalValue - stats.purchasedValue) << "\n";
 }
 
 void WishlistManager::setBudget(double amount) {
     budget.setMaxBudget(amount);
-    if (dbHandler) dbHandler->saveBudget(budget, owner);
+    persistBudget();
     syncBudgetWithPurchases();
     LOG_INFO("WishlistManager: Budget set to ", amount, " for user ", owner);
 
@@ -247,6 +326,22 @@ void WishlistManager::resetBudget() {
     LOG_INFO("WishlistManager: Budget reset for user ", owner);
 }
 
+void WishlistManager::configureBudget(std::optional<double> maxBudget, std::optional<bool> enabled) {
+    // setMaxBudget enables the budget, so an explicit enabled flag goes after it
+    if (maxBudget) budget.setMaxBudget(*maxBudget);
+    if (enabled) {
+        if (*enabled) {
+            budget.enable();
+        } else {
+            budget.disable();
+        }
+    }
+    syncBudgetWithPurchases();
+    persistBudget();
+    LOG_INFO("WishlistManager: Budget configured for user ", owner, ", max ", budget.getMaxBudget(),
+             budget.isEnabled() ? ", enabled" : ", disabled");
+}
+
 void WishlistManager::displayBudgetStatus() const {
     if (!budget.isEnabled()) {
         std::cout << "\n📊 Budget tracking is currently disabled.\n";
@@ -341,44 +436,105 @@ void WishlistManager::updateBudgetFromItems() {
     syncBudgetWithPurchases();
 }
 
-void WishlistManager::setDatabaseHandler(DatabaseHandler *handler) {
-    dbHandler = handler;
-    LOG_INFO("WishlistManager: Database handler set for user: ", owner);
+void WishlistManager::setStore(IWishlistStore *store) {
+    this->store = store;
+    LOG_INFO("WishlistManager: Store ", (store ? store->getName() : "cleared"), " set for user: ", owner);
+}
+
+void WishlistManager::setPersistenceQueue(PersistenceQueue *queue) {
+    persistenceQueue = queue;
+    LOG_INFO("WishlistManager: Persistence queue ", (queue ? "set" : "cleared"), " for user: ", owner);
+}
+
+bool WishlistManager::flushPendingWrites() {
+    return persistenceQueue ? persistenceQueue->flush() : true;
+}
+
+void WishlistManager::persistItem(const WishItem &item) {
+    if (persistenceQueue) {
+        persistenceQueue->enqueueSaveItem(item, owner);
+    } else if (store) {
+        store->saveItem(item, owner);
+    }
+}
+
+void WishlistManager::persistDelete(int id) {
+    if (persistenceQueue) {
+        persistenceQueue->enqueueDeleteItem(id, owner);
+    } else if (store) {
+        store->deleteItem(id, owner);
+    }
+}
+
+void WishlistManager::persistBudget() {
+    if (persistenceQueue) {
+        persistenceQueue->enqueueSaveBudget(budget, owner);
+    } else if (store) {
+        store->saveBudget(budget, owner);
+    }
 }
 
-bool WishlistManager::saveToDatabase() {
-    if (!dbHandler) {
-        LOG_ERROR("WishlistManager: No database handler set");
+bool WishlistManager::saveToStore() {
+    if (!store) {
+        LOG_ERROR("WishlistManager: No store set");
         return false;
     }
 
+    if (persistenceQueue) {
+        for (const auto &item: items) {
+            persistenceQueue->enqueueSaveItem(*item, owner);
+        }
+        persistenceQueue->enqueueSaveBudget(budget, owner);
+
+        if (!persistenceQueue->flush()) {
+            LOG_ERROR("WishlistManager: Failed to save pending changes");
+            return false;
+        }
+        LOG_INFO("WishlistManager: Successfully saved all data to ", store->getName(), " store");
+        return true;
+    }
+
+    //One transaction, so file-backed stores write each owner once
+    bool inTransaction = store->beginTransaction();
+
     //Save all items
     for (const auto &item: items) {
-        if (!dbHandler->saveItem(*item, owner)) {
+        if (!store->saveItem(*item, owner)) {
             LOG_ERROR("WishlistManager: Failed to save item: ", item->getName());
+            if (inTransaction) store->rollbackTransaction();
             return false;
         }
     }
 
     //Save budget
-    if (!dbHandler->saveBudget(budget, owner)) {
+    if (!store->saveBudget(budget, owner)) {
         LOG_ERROR("WishlistManager: Failed to save budget");
+        if (inTransaction) store->rollbackTransaction();
         return false;
     }
 
-    LOG_INFO("WishlistManager: Successfully saved all data to database");
+    if (inTransaction && !store->commitTransaction()) {
+        LOG_ERROR("WishlistManager: Failed to commit changes");
+        store->rollbackTransaction();
+        return false;
+    }
+
+    LOG_INFO("WishlistManager: Successfully saved all data to ", store->getName(), " store");
     return true;
 }
 
-bool WishlistManager::loadFromDatabase() {
-    if (!dbHandler) {
-        LOG_ERROR("WishlistManager: No database handler set");
+bool WishlistManager::loadFromStore() {
+    if (!store) {
+        LOG_ERROR("WishlistManager: No store set");
         return false;
     }
 
+    // Make sure queued writes are visible before reading back
+    flushPendingWrites();
+
     items.clear();
 
-    int globalMaxId = dbHandler->getGlobalMaxItemId();
+    int globalMaxId = store->getGlobalMaxItemId();
 
     if (globalMaxId > 0) {
         WishItem::setNextId(globalMaxId + 1);
@@ -388,14 +544,15 @@ bool WishlistManager::loadFromDatabase() {
         LOG_INFO("WishlistManager: No items globally, ID counter set to 1.");
     }
 
-    auto loadedItems = dbHandler->loadItems(owner);
-    for (auto &item: loadedItems) {
-
+    store->forEachItem(owner, [this](const ItemRowView &row) {
+        auto item = std::make_unique<WishItem>();
+        row.copyTo(*item);
         items.push_back(std::move(item));
-    }
+        return true;
+    });
 
-    budget = dbHandler->loadBudget(owner);
+    budget = store->loadBudget(owner);
 
-    LOG_INFO("WishlistManager: Successfully loaded data from database");
+    LOG_INFO("WishlistManager: Successfully loaded data from ", store->getName(), " store");
     return true;
 }
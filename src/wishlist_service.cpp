@@ -0,0 +1,374 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+
+#include "../include/wishlist_service.h"
+#include "../include/wishlist_store.h"
+#include "../include/persistence_queue.h"
+#include "../include/item_cache.h"
+#include "../include/json.h"
+#include "../include/logger.h"
+
+#include <charconv>
+#include <sstream>
+
+namespace {
+    struct JsonField {
+        enum class Type { STRING, NUMBER, BOOLEAN, NULL_VALUE };
+
+        Type type = Type::NULL_VALUE;
+        std::string text;
+        double number = 0.0;
+        bool flag = false;
+    };
+
+    // Collects the members of a flat JSON object; anything nested is rejected
+    class FlatObjectHandler : public JsonHandler {
+    public:
+        std::map<std::string, JsonField> fields;
+
+        bool startObject() override { return ++depth == 1; }
+
+        bool endObject() override {
+            depth--;
+            return true;
+        }
+
+        bool startArray() override { return false; }
+
+        bool key(std::string_view name) override {
+            currentKey = std::string(name);
+            return true;
+        }
+
+        bool string(std::string_view value) override {
+            JsonField field;
+            field.type = JsonField::Type::STRING;
+            field.text = std::string(value);
+            return add(std::move(field));
+        }
+
+        bool number(double value) override {
+            JsonField field;
+            field.type = JsonField::Type::NUMBER;
+            field.number = value;
+            return add(std::move(field));
+        }
+
+        bool boolean(bool value) override {
+            JsonField field;
+            field.type = JsonField::Type::BOOLEAN;
+            field.flag = value;
+            return add(std::move(field));
+        }
+
+        bool null() override { return add(JsonField()); }
+
+    private:
+        int depth = 0;
+        std::string currentKey;
+
+        bool add(JsonField field) {
+            if (depth != 1) return false;
+            fields[currentKey] = std::move(field);
+            return true;
+        }
+    };
+
+    bool parseObject(const std::string &body, std::map<std::string, JsonField> &fields) {
+        FlatObjectHandler handler;
+        JsonParser parser(handler);
+        if (!parser.feed(body) || !parser.finish()) return false;
+        fields = std::move(handler.fields);
+        return true;
+    }
+
+    // Sets the item fields present in fields; error names the first bad one
+    bool applyItemFields(const std::map<std::string, JsonField> &fields, WishItem &item, std::string &error) {
+        using Type = JsonField::Type;
+        for (const auto &[name, field]: fields) {
+            bool isText = field.type == Type::STRING;
+            if (name == "id") continue; // IDs are assigned by the store
+            if (name == "name" && isText && !field.text.empty()) {
+                item.setName(field.text);
+            } else if (name == "price" && field.type == Type::NUMBER && field.number >= 0.0) {
+                item.setPrice(field.number);
+            } else if (name == "category" && isText) {
+                item.setCategory(WishItem::stringToCategory(field.text));
+            } else if (name == "priority" && isText) {
+                item.setPriority(WishItem::stringToPriority(field.text));
+            } else if (name == "notes" && isText) {
+                item.setNotes(field.text);
+            } else if (name == "link" && isText) {
+                item.setLink(field.text);
+            } else if (name == "purchased" && field.type == Type::BOOLEAN) {
+                item.setPurchased(field.flag);
+            } else {
+                error = "Invalid or unknown field '" + name + "'";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void writeItem(JsonWriter &json, const WishItem &item) {
+        json.beginObject()
+                .key("id").value(item.getId())
+                .key("name").value(item.getName())
+                .key("price").value(item.getPrice())
+                .key("purchased").value(item.isPurchased())
+                .key("category").value(WishItem::categoryToString(item.getCategory()))
+                .key("priority").value(WishItem::priorityToString(item.getPriority()))
+                .key("notes").value(item.getNotes())
+                .key("link").value(item.getLink())
+                .endObject();
+    }
+
+    HttpResponse itemResponse(int status, const WishItem &item) {
+        std::ostringstream body;
+        {
+            JsonWriter json(body);
+            writeItem(json, item);
+        }
+        return {status, "application/json", body.str()};
+    }
+
+    HttpResponse itemsResponse(const std::string &user, const std::vector<const WishItem *> &items) {
+        std::ostringstream body;
+        {
+            JsonWriter json(body);
+            json.beginObject().key("user").value(user).key("count").value(static_cast<int>(items.size()));
+            json.key("items").beginArray();
+            for (const WishItem *item: items) {
+                writeItem(json, *item);
+            }
+            json.endArray().endObject();
+        }
+        return {200, "application/json", body.str()};
+    }
+
+    // "/users/Bob/items/7" -> {"users", "Bob", "items", "7"}
+    std::vector<std::string> splitPath(const std::string &path) {
+        std::vector<std::string> segments;
+        size_t start = 1;
+        while (start <= path.size()) {
+            size_t end = path.find('/', start);
+            if (end == std::string::npos) end = path.size();
+            if (end > start) segments.push_back(path.substr(start, end - start));
+            start = end + 1;
+        }
+        return segments;
+    }
+}
+
+WishlistService::WishlistService(IWishlistStore &store, PersistenceQueue &queue, ItemCache *cache)
+    : store(store), queue(queue), cache(cache) {
+}
+
+bool WishlistService::flush() {
+    return queue.flush();
+}
+
+std::shared_ptr<WishlistService::UserSession> WishlistService::findSession(const std::string &user, bool create) {
+    std::lock_guard<std::mutex> lock(sessionsMutex);
+    auto it = sessions.find(user);
+    if (it != sessions.end()) return it->second;
+    if (!create && !store.userExists(user)) return nullptr;
+    return sessions.emplace(user, std::make_shared<UserSession>()).first->second;
+}
+
+void WishlistService::load(const std::string &user, UserSession &session) {
+    store.createUser(user);
+    auto manager = std::make_unique<WishlistManager>(user);
+    manager->setStore(&store);
+    manager->setPersistenceQueue(&queue);
+    std::lock_guard<std::mutex> idLock(idMutex);
+    manager->loadFromStore();
+    session.manager = std::move(manager);
+}
+
+HttpResponse WishlistService::handle(const HttpRequest &request) {
+    std::vector<std::string> segments = splitPath(request.path);
+    const std::string &method = request.method;
+    if (segments.empty() || segments[0] != "users" || segments.size() > 4) {
+        return HttpResponse::error(404, "Unknown path " + request.path);
+    }
+
+    if (segments.size() == 1) {
+        if (method != "GET") return HttpResponse::error(405, "Use GET");
+        std::ostringstream body;
+        {
+            JsonWriter json(body);
+            json.beginObject().key("users").beginArray();
+            for (const auto &user: store.getAllUsers()) {
+                json.value(user);
+            }
+            json.endArray().endObject();
+        }
+        return {200, "application/json", body.str()};
+    }
+
+    const std::string &user = segments[1];
+    std::string resource = segments.size() > 2 ? segments[2] : "";
+    bool isItem = resource == "items" && segments.size() == 4;
+    if ((resource != "items" && resource != "search" && resource != "stats" && resource != "budget") ||
+        (segments.size() == 4 && resource != "items")) {
+        return HttpResponse::error(404, "Unknown path " + request.path);
+    }
+
+    int id = 0;
+    if (isItem) {
+        const std::string &text = segments[3];
+        auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), id);
+        if (error != std::errc() || end != text.data() + text.size()) {
+            return HttpResponse::error(404, "Invalid item ID " + text);
+        }
+    }
+
+    // Only adding an item creates a user; anything else on an unknown user is a 404
+    std::shared_ptr<UserSession> session = findSession(user, method == "POST" && resource == "items" && !isItem);
+    if (!session) return HttpResponse::error(404, "No user " + user);
+    std::lock_guard<std::mutex> lock(session->mutex);
+    if (!session->manager) load(user, *session); // Outside the sessions lock, so other users go on
+    WishlistManager &manager = *session->manager;
+
+    if (resource == "items" && !isItem) {
+        if (method == "GET") return listItems(manager);
+        if (method == "POST") return addItem(manager, request);
+        return HttpResponse::error(405, "Use GET or POST");
+    }
+    if (isItem) {
+        if (method == "PUT") return updateItem(manager, id, request);
+        const WishItem *item = manager.findById(id);
+        if (!item) return HttpResponse::error(404, "No item " + std::to_string(id));
+        if (method == "GET") return itemResponse(200, *item);
+        if (method == "DELETE") {
+            manager.removeItem(id);
+            return {200, "application/json", "{\"deleted\":" + std::to_string(id) + "}"};
+        }
+        return HttpResponse::error(405, "Use GET, PUT or DELETE");
+    }
+    if (resource == "search") {
+        if (method != "GET") return HttpResponse::error(405, "Use GET");
+        auto query = request.query.find("q");
+        if (query == request.query.end()) return HttpResponse::error(400, "Missing query parameter q");
+        manager.flushPendingWrites();
+        auto matches = store.searchItems(user, query->second);
+        std::vector<const WishItem *> items;
+        for (const auto &match: matches) items.push_back(match.get());
+        return itemsResponse(user, items);
+    }
+    if (resource == "stats") {
+        if (method != "GET") return HttpResponse::error(405, "Use GET");
+        return stats(manager);
+    }
+    if (method != "GET" && method != "PUT") return HttpResponse::error(405, "Use GET or PUT");
+    return budget(manager, request);
+}
+
+HttpResponse WishlistService::listItems(WishlistManager &manager) {
+    std::vector<const WishItem *> items;
+    std::vector<WishItem> cached;
+    if (cache) {
+        // The cache follows the store, so queued changes must be committed first
+        manager.flushPendingWrites();
+        cache->forEachItem(manager.getOwner(), [&cached](const WishItem &item) {
+            cached.emplace_back();
+            cached.back() = item; // Copy assignment keeps the ID
+            return true;
+        });
+        for (const auto &item: cached) items.push_back(&item);
+    } else {
+        items.reserve(manager.getItems().size());
+        for (const auto &item: manager.getItems()) items.push_back(item.get());
+    }
+    return itemsResponse(manager.getOwner(), items);
+}
+
+HttpResponse WishlistService::addItem(WishlistManager &manager, const HttpRequest &request) {
+    std::map<std::string, JsonField> fields;
+    if (!parseObject(request.body, fields)) return HttpResponse::error(400, "Body must be a flat JSON object");
+    if (!fields.count("name") || !fields.count("price")) return HttpResponse::error(400, "name and price are required");
+
+    // Default-constructed items have ID 0 and take theirs in addItem, under idMutex
+    auto item = std::make_unique<WishItem>();
+    std::string error;
+    if (!applyItemFields(fields, *item, error)) return HttpResponse::error(400, error);
+    {
+        std::lock_guard<std::mutex> idLock(idMutex);
+        manager.addItem(std::move(item));
+    }
+    if (manager.getItems().back()->isPurchased()) manager.syncBudgetWithPurchases();
+    return itemResponse(201, *manager.getItems().back());
+}
+
+HttpResponse WishlistService::updateItem(WishlistManager &manager, int id, const HttpRequest &request) {
+    std::map<std::string, JsonField> fields;
+    if (!parseObject(request.body, fields)) return HttpResponse::error(400, "Body must be a flat JSON object");
+
+    WishItem *item = manager.findById(id);
+    if (!item) return HttpResponse::error(404, "No item " + std::to_string(id));
+    // Validated on a copy first, so a bad field changes nothing. Assigned rather
+    // than copy-constructed, as the copy constructor draws a new ID.
+    WishItem changed;
+    changed = *item;
+    std::string error;
+    if (!applyItemFields(fields, changed, error)) return HttpResponse::error(400, error);
+    manager.updateItem(id, [&changed](WishItem &target) { target = changed; });
+    return itemResponse(200, *manager.findById(id));
+}
+
+HttpResponse WishlistService::budget(WishlistManager &manager, const HttpRequest &request) {
+    if (request.method == "PUT") {
+        std::map<std::string, JsonField> fields;
+        if (!parseObject(request.body, fields)) return HttpResponse::error(400, "Body must be a flat JSON object");
+        std::optional<double> maxBudget;
+        std::optional<bool> enabled;
+        for (const auto &[name, field]: fields) {
+            if (name == "maxBudget" && field.type == JsonField::Type::NUMBER && field.number >= 0.0) {
+                maxBudget = field.number;
+            } else if (name == "enabled" && field.type == JsonField::Type::BOOLEAN) {
+                enabled = field.flag;
+            } else {
+                return HttpResponse::error(400, "Invalid or unknown field '" + name + "'");
+            }
+        }
+        manager.configureBudget(maxBudget, enabled);
+    }
+
+    const Budget &budget = manager.getBudget();
+    std::ostringstream body;
+    {
+        JsonWriter json(body);
+        json.beginObject()
+                .key("enabled").value(budget.isEnabled())
+                .key("maxBudget").value(budget.getMaxBudget())
+                .key("spentAmount").value(budget.getSpentAmount())
+                .key("remaining").value(budget.getRemaining())
+                .endObject();
+    }
+    return {200, "application/json", body.str()};
+}
+
+HttpResponse WishlistService::stats(WishlistManager &manager) {
+    ItemStats stats;
+    if (cache) {
+        manager.flushPendingWrites();
+        stats = cache->getStats(manager.getOwner());
+    } else {
+        stats = manager.getStats();
+    }
+    std::ostringstream body;
+    {
+        JsonWriter json(body);
+        json.beginObject()
+                .key("user").value(manager.getOwner())
+                .key("items").value(stats.count)
+                .key("purchased").value(stats.purchasedCount)
+                .key("totalValue").value(stats.totalValue)
+                .key("purchasedValue").value(stats.purchasedValue)
+                .key("remainingValue").value(stats.totalValue - stats.purchasedValue)
+                .endObject();
+    }
+    return {200, "application/json", body.str()};
+}
@@ -0,0 +1,35 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+
+#include "../include/wishlist_store.h"
+#include "../include/database_handler.h"
+#include "../include/file_store.h"
+#include "../include/memory_store.h"
+#include "../include/sharded_store.h"
+#include "../include/logger.h"
+
+#include <cstdlib>
+
+std::unique_ptr<IWishlistStore> IWishlistStore::create(const std::string &kind, const std::string &location) {
+    if (kind == "sqlite") {
+        return std::make_unique<DatabaseHandler>(location);
+    }
+    if (kind == "file") {
+        return std::make_unique<FileStore>(location);
+    }
+    if (kind == "file:journal") {
+        FileStore::JournalOptions journal;
+        journal.enabled = true;
+        return std::make_unique<FileStore>(location, journal);
+    }
+    if (kind == "sharded" || kind.rfind("sharded:", 0) == 0) {
+        int shardCount = kind == "sharded" ? 4 : std::atoi(kind.c_str() + 8);
+        return std::make_unique<ShardedStore>(location, shardCount);
+    }
+    if (kind == "memory") {
+        return std::make_unique<MemoryStore>();
+    }
+    LOG_ERROR("IWishlistStore: Unknown store type: ", kind);
+    return nullptr;
+}
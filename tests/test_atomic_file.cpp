@@ -0,0 +1,103 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+#include <gtest/gtest.h>
+#include "../include/atomic_file.h"
+#include "../include/file_handler.h"
+#include "../include/logger.h"
+#include <fstream>
+#include <filesystem>
+#include <thread>
+#include <vector>
+
+class AtomicFileTest : public ::testing::Test {
+protected:
+    std::string directory = "test_atomic_file";
+    std::string path = directory + "/wishlist.dat";
+
+    void SetUp() override {
+        Logger::getInstance().setLogLevel(LogLevel::NONE);
+        std::filesystem::remove_all(directory);
+        std::filesystem::create_directories(directory);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(directory);
+    }
+
+    static std::string read(const std::string &file) {
+        std::ifstream in(file, std::ios::binary);
+        return {std::istreambuf_iterator<char>(in), {}};
+    }
+
+    size_t fileCount() const {
+        return std::distance(std::filesystem::directory_iterator(directory), std::filesystem::directory_iterator());
+    }
+};
+
+TEST_F(AtomicFileTest, ReplacesContentAndKeepsBackup) {
+    ASSERT_TRUE(AtomicFile::write(path, "first", true));
+    EXPECT_EQ(read(path), "first");
+    EXPECT_FALSE(std::filesystem::exists(AtomicFile::backupPath(path)));
+
+    ASSERT_TRUE(AtomicFile::write(path, "second", true));
+    EXPECT_EQ(read(path), "second");
+    EXPECT_EQ(read(AtomicFile::backupPath(path)), "first");
+
+    ASSERT_TRUE(AtomicFile::write(path, "third"));
+    EXPECT_EQ(read(path), "third");
+    EXPECT_EQ(read(AtomicFile::backupPath(path)), "first");
+    EXPECT_EQ(fileCount(), 2u); // No temporary files left behind
+}
+
+TEST_F(AtomicFileTest, FailedWriteLeavesOldContent) {
+    ASSERT_TRUE(AtomicFile::write(path, "original"));
+
+    // A non-empty directory in the way makes the final rename fail
+    std::string blocked = directory + "/blocked";
+    std::filesystem::create_directories(blocked + "/entry");
+    EXPECT_FALSE(AtomicFile::write(blocked, "replacement"));
+    EXPECT_TRUE(std::filesystem::is_directory(blocked + "/entry"));
+    EXPECT_EQ(read(path), "original");
+    EXPECT_EQ(fileCount(), 2u); // The temporary file was removed
+
+    EXPECT_FALSE(AtomicFile::write(directory + "/missing/wishlist.dat", "data"));
+}
+
+TEST_F(AtomicFileTest, ConcurrentWritersDoNotShareTemporaryFiles) {
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 8; ++t) {
+        writers.emplace_back([this, t] {
+            std::string content(64 * 1024, static_cast<char>('a' + t));
+            for (int i = 0; i < 20; ++i) {
+                EXPECT_TRUE(AtomicFile::write(path, content));
+            }
+        });
+    }
+    for (auto &writer: writers) writer.join();
+
+    // The result is one writer's complete content
+    std::string content = read(path);
+    ASSERT_EQ(content.size(), 64u * 1024);
+    EXPECT_EQ(content.find_first_not_of(content[0]), std::string::npos);
+    EXPECT_EQ(fileCount(), 1u);
+}
+
+TEST_F(AtomicFileTest, FileHandlerSavesAtomically) {
+    WishlistManager manager("Alice");
+    manager.addItem(std::make_unique<WishItem>("Kite", 12.0));
+    FileHandler handler(path);
+    handler.setKeepBackup(true);
+    ASSERT_TRUE(handler.save(manager));
+
+    manager.addItem(std::make_unique<WishItem>("Ball", 5.0));
+    ASSERT_TRUE(handler.save(manager));
+
+    WishlistManager previous("Temp");
+    ASSERT_TRUE(FileHandler(AtomicFile::backupPath(path)).load(previous));
+    EXPECT_EQ(previous.getTotalItems(), 1);
+
+    WishlistManager current("Temp");
+    ASSERT_TRUE(handler.load(current));
+    EXPECT_EQ(current.getTotalItems(), 2);
+}
@@ -0,0 +1,151 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+#include <gtest/gtest.h>
+#include "../include/batch_runner.h"
+#include "../include/memory_store.h"
+#include "../include/persistence_queue.h"
+#include "../include/logger.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+class BatchRunnerTest : public ::testing::Test {
+protected:
+    std::string testCsvFile = "test_batch.csv";
+    std::string testScriptFile = "test_batch.script";
+    MemoryStore store;
+    std::ostringstream out;
+
+    void SetUp() override {
+        Logger::getInstance().setLogLevel(LogLevel::NONE);
+        std::filesystem::remove(testCsvFile);
+        std::filesystem::remove(testScriptFile);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove(testCsvFile);
+        std::filesystem::remove(testScriptFile);
+    }
+
+    std::vector<std::string> outputLines() const {
+        std::vector<std::string> lines;
+        std::istringstream in(out.str());
+        for (std::string line; std::getline(in, line);) lines.push_back(line);
+        return lines;
+    }
+
+    static bool contains(const std::string &text, const std::string &part) {
+        return text.find(part) != std::string::npos;
+    }
+};
+
+TEST_F(BatchRunnerTest, Tokenize) {
+    std::vector<std::string> tokens;
+    ASSERT_TRUE(BatchRunner::tokenize(R"(  add "Lego Castle" 49.99 toys "" a\"b # comment)", tokens));
+    EXPECT_EQ(tokens, (std::vector<std::string>{"add", "Lego Castle", "49.99", "toys", "", "a\"b"}));
+
+    ASSERT_TRUE(BatchRunner::tokenize("# only a comment", tokens));
+    EXPECT_TRUE(tokens.empty());
+    EXPECT_FALSE(BatchRunner::tokenize("add \"open", tokens));
+}
+
+TEST_F(BatchRunnerTest, ParseArguments) {
+    std::vector<BatchCommand> commands;
+    std::string error;
+    ASSERT_TRUE(BatchRunner::parseArguments({"--user=Alice", "--add", "Book", "12.5", "--stats"}, commands, error));
+    ASSERT_EQ(commands.size(), 3u);
+    EXPECT_EQ(commands[0].name, "user");
+    EXPECT_EQ(commands[0].args, std::vector<std::string>{"Alice"});
+    EXPECT_EQ(commands[1].args, (std::vector<std::string>{"Book", "12.5"}));
+    EXPECT_TRUE(commands[2].args.empty());
+
+    commands.clear();
+    EXPECT_FALSE(BatchRunner::parseArguments({"--frobnicate"}, commands, error));
+    EXPECT_FALSE(error.empty());
+    EXPECT_FALSE(BatchRunner::parseArguments({"stray"}, commands, error));
+}
+
+TEST_F(BatchRunnerTest, RunsCommandsAndPrintsOneJsonLineEach) {
+    BatchRunner runner(store, nullptr, out);
+    EXPECT_TRUE(runner.run({
+        {"user", {"Alice"}},
+        {"budget", {"50"}},
+        {"add", {"Lego Castle", "49.99", "toys", "high"}},
+        {"purchase", {"1"}},
+        {"add", {"Book", "12", "books"}},
+        {"stats", {}},
+        {"list", {}}
+    }));
+
+    auto lines = outputLines();
+    ASSERT_EQ(lines.size(), 7u);
+    EXPECT_TRUE(contains(lines[0], R"({"command":"user","user":"Alice","items":0,"ok":true,"ms":)"));
+    EXPECT_TRUE(contains(lines[2], R"("id":1,"ok":true)"));
+    EXPECT_TRUE(contains(lines[4], R"("id":2,"overBudget":true,"ok":true)"));
+    EXPECT_TRUE(contains(lines[5], R"("items":2,"purchased":1)"));
+    EXPECT_TRUE(contains(lines[6], R"("count":2,"items":[{"id":1,"name":"Lego Castle")"));
+    EXPECT_EQ(store.loadItems("Alice").size(), 2u);
+    EXPECT_EQ(runner.getFailureCount(), 0u);
+}
+
+TEST_F(BatchRunnerTest, StopsAtFirstFailure) {
+    BatchRunner runner(store, nullptr, out);
+    EXPECT_FALSE(runner.run({
+        {"add", {"Book", "12"}},
+        {"user", {"Bob"}}
+    }));
+    auto lines = outputLines();
+    ASSERT_EQ(lines.size(), 1u);
+    EXPECT_TRUE(contains(lines[0], R"("ok":false,"error":"No user selected)"));
+
+    out.str("");
+    EXPECT_FALSE(runner.run({{"user", {"Bob"}}, {"add", {"Book", "cheap"}}, {"remove", {"99"}}}));
+    EXPECT_EQ(outputLines().size(), 2u);
+    EXPECT_EQ(runner.getFailureCount(), 2u);
+}
+
+TEST_F(BatchRunnerTest, ScriptWithImportAndExport) {
+    std::ofstream(testScriptFile) << "# Round trip through CSV\n"
+            << "user Carol\n"
+            << "add \"Board game, large\" 30 toys\n"
+            << "--add Scarf 15.5 clothing low \"Red, \\\"wool\\\"\"\n"
+            << "\n"
+            << "export " << testCsvFile << "\n"
+            << "user Dave\n"
+            << "import " << testCsvFile << "\n";
+
+    PersistenceQueue queue(store);
+    {
+        BatchRunner runner(store, &queue, out);
+        EXPECT_TRUE(runner.run({"script", {testScriptFile}}));
+        EXPECT_TRUE(runner.finish());
+    }
+
+    auto lines = outputLines();
+    ASSERT_EQ(lines.size(), 7u);
+    EXPECT_TRUE(contains(lines[3], R"("exported":2)"));
+    EXPECT_TRUE(contains(lines[5], R"("imported":2)"));
+    EXPECT_TRUE(contains(lines[6], R"({"command":"script","file":")"));
+    EXPECT_TRUE(contains(lines[6], R"("commands":6,"ok":true)"));
+
+    auto items = store.loadItems("Dave");
+    ASSERT_EQ(items.size(), 2u);
+    EXPECT_EQ(items[1]->getNotes(), "Red, \"wool\"");
+    EXPECT_EQ(store.loadItems("Carol").size(), 2u);
+}
+
+TEST_F(BatchRunnerTest, ScriptReportsBadLines) {
+    BatchRunner::Options options;
+    options.stopOnError = false;
+    BatchRunner runner(store, nullptr, out, options);
+    std::istringstream script("user Erin\nadd \"unterminated 5\nfly away\nadd Kite 8\n");
+    EXPECT_FALSE(runner.runScript(script));
+
+    auto lines = outputLines();
+    ASSERT_EQ(lines.size(), 4u);
+    EXPECT_TRUE(contains(lines[1], "Unterminated quote in line 2"));
+    EXPECT_TRUE(contains(lines[2], R"({"command":"fly","ok":false,"error":"Unknown command")"));
+    EXPECT_TRUE(contains(lines[3], R"("ok":true)"));
+    EXPECT_EQ(runner.getFailureCount(), 2u);
+}
@@ -0,0 +1,110 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+#include <gtest/gtest.h>
+#include "../include/bulk_importer.h"
+#include "../include/memory_store.h"
+#include "../include/file_handler.h"
+#include "../include/logger.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+class BulkImporterTest : public ::testing::Test {
+protected:
+    std::string directory = "test_bulk_import";
+    MemoryStore store;
+
+    void SetUp() override {
+        Logger::getInstance().setLogLevel(LogLevel::NONE);
+        std::filesystem::remove_all(directory);
+        std::filesystem::create_directories(directory);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(directory);
+    }
+
+    std::string pathOf(const std::string &name) const {
+        return (std::filesystem::path(directory) / name).string();
+    }
+
+    static void fill(WishlistManager &manager, int count, const std::string &prefix) {
+        for (int i = 0; i < count; ++i) {
+            manager.addItem(std::make_unique<WishItem>(prefix + std::to_string(i), 10.0 + i, Category::OTHER));
+        }
+    }
+};
+
+TEST_F(BulkImporterTest, ImportsDatAndCsvFilesAndSkipsCorruptOnes) {
+    WishlistManager alice("Alice");
+    fill(alice, 20, "Alice item ");
+    alice.getBudget().setMaxBudget(500.0);
+    ASSERT_TRUE(FileHandler(pathOf("wishlist_Alice.dat")).save(alice));
+
+    WishlistManager bob("Bob");
+    fill(bob, 5, "Bob item ");
+    FileHandler handler;
+    std::ofstream csv(pathOf("wishlist_Bob.csv"), std::ios::binary);
+    ASSERT_TRUE(handler.exportToCSV(bob, csv));
+    csv.close();
+
+    // No wishlist_ prefix: the owner line names the owner
+    WishlistManager carol("Carol");
+    fill(carol, 3, "Carol item ");
+    ASSERT_TRUE(FileHandler(pathOf("team.dat")).save(carol));
+
+    WishlistManager corrupt("Dave");
+    fill(corrupt, 3, "Dave item ");
+    FileHandler snapshot(pathOf("wishlist_Dave.dat"));
+    snapshot.setFormat(FileFormat::BINARY);
+    ASSERT_TRUE(snapshot.save(corrupt));
+    std::filesystem::resize_file(pathOf("wishlist_Dave.dat"), std::filesystem::file_size(pathOf("wishlist_Dave.dat")) - 5);
+
+    std::ofstream(pathOf("notes.txt")) << "not a wishlist";
+
+    BulkImporter::Options options;
+    options.threads = 4;
+    BulkImportReport report = BulkImporter(store, options).importDirectory(directory);
+
+    ASSERT_EQ(report.files.size(), 4u);
+    EXPECT_EQ(report.failedFiles, 1u);
+    EXPECT_EQ(report.totalItems, 28u);
+    EXPECT_EQ(store.loadItems("Alice").size(), 20u);
+    EXPECT_DOUBLE_EQ(store.loadBudget("Alice").getMaxBudget(), 500.0);
+    EXPECT_EQ(store.loadItems("Bob").size(), 5u);
+    EXPECT_EQ(store.loadItems("Carol").size(), 3u);
+    EXPECT_FALSE(store.userExists("Dave"));
+
+    for (const auto &file: report.files) {
+        bool isDave = file.path.find("Dave") != std::string::npos;
+        EXPECT_EQ(file.success, !isDave) << file.path;
+        EXPECT_EQ(file.error.empty(), !isDave) << file.path;
+    }
+
+    std::ostringstream printed;
+    report.print(printed);
+    EXPECT_NE(printed.str().find("FAILED"), std::string::npos);
+    EXPECT_NE(printed.str().find("28 item(s) imported, 1 failed"), std::string::npos);
+}
+
+TEST_F(BulkImporterTest, SameOwnerFromSeveralFilesGetsDistinctIds) {
+    WishlistManager first("Erin");
+    fill(first, 4, "First ");
+    ASSERT_TRUE(FileHandler(pathOf("wishlist_Erin.dat")).save(first));
+    FileHandler handler;
+    std::ofstream csv(pathOf("wishlist_Erin.csv"), std::ios::binary);
+    ASSERT_TRUE(handler.exportToCSV(first, csv));
+    csv.close();
+
+    BulkImportReport report = BulkImporter(store).importDirectory(directory);
+    EXPECT_EQ(report.failedFiles, 0u);
+    EXPECT_EQ(store.loadItems("Erin").size(), 8u);
+}
+
+TEST_F(BulkImporterTest, OwnerFromFileName) {
+    EXPECT_EQ(BulkImporter::ownerFromFileName("dir/wishlist_Frank.dat"), "Frank");
+    EXPECT_EQ(BulkImporter::ownerFromFileName("wishlist_Grace.csv"), "Grace");
+    EXPECT_EQ(BulkImporter::ownerFromFileName("team.dat"), "");
+    EXPECT_EQ(BulkImporter::ownerFromFileName("wishlist_.dat"), "");
+}
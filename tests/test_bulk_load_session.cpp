@@ -0,0 +1,150 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+#include <gtest/gtest.h>
+#include "../include/bulk_load_session.h"
+#include "../include/database_handler.h"
+#include "../include/logger.h"
+#include <filesystem>
+
+class BulkLoadSessionTest : public ::testing::Test {
+protected:
+    std::string testDb = "test_bulk_load.db";
+    std::unique_ptr<DatabaseHandler> db;
+
+    void SetUp() override {
+        Logger::getInstance().setLogLevel(LogLevel::NONE);
+        std::filesystem::remove(testDb);
+        db = std::make_unique<DatabaseHandler>(testDb);
+        ASSERT_TRUE(db->initialize());
+    }
+
+    void TearDown() override {
+        db.reset();
+        std::filesystem::remove(testDb);
+        std::filesystem::remove(testDb + ".bulk");
+    }
+
+    static WishItem makeItem(int n) {
+        WishItem item("Item " + std::to_string(n), 1.0 + n % 50, static_cast<Category>(n % 5));
+        item.setPurchased(n % 3 == 0);
+        item.setNotes("bulk note " + std::to_string(n));
+        return item;
+    }
+
+    // Counts schema objects on the items table through a separate connection
+    int countSchemaObjects(const std::string &type) {
+        sqlite3 *conn;
+        sqlite3_open(testDb.c_str(), &conn);
+        sqlite3_stmt *stmt;
+        std::string sql = "SELECT COUNT(*) FROM sqlite_master WHERE tbl_name = 'items' AND type = '" + type + "';";
+        sqlite3_prepare_v2(conn, sql.c_str(), -1, &stmt, nullptr);
+        int count = sqlite3_step(stmt) == SQLITE_ROW ? sqlite3_column_int(stmt, 0) : -1;
+        sqlite3_finalize(stmt);
+        sqlite3_close(conn);
+        return count;
+    }
+};
+
+TEST_F(BulkLoadSessionTest, LoadsRowsAcrossFullAndPartialBatches) {
+    BulkLoadSession session(*db, BulkLoadSession::Options{64, false});
+    ASSERT_TRUE(session.begin());
+
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT_TRUE(session.addItem(makeItem(i), i % 2 ? "Alice" : "Bob"));
+    }
+    ASSERT_TRUE(session.commit());
+
+    EXPECT_FALSE(session.isActive());
+    EXPECT_EQ(session.getStagedCount(), 1000u);
+    EXPECT_EQ(db->getTotalItemsCount("Alice"), 500);
+    EXPECT_EQ(db->getTotalItemsCount("Bob"), 500);
+    EXPECT_FALSE(std::filesystem::exists(testDb + ".bulk"));
+}
+
+TEST_F(BulkLoadSessionTest, DerivedDataAndIndexesAreRebuilt) {
+    int indexes = countSchemaObjects("index");
+    int triggers = countSchemaObjects("trigger");
+    db->saveItem(WishItem("Existing Drone", 80.0, Category::ELECTRONICS), "Alice");
+
+    BulkLoadSession session(*db);
+    ASSERT_TRUE(session.begin());
+    for (int i = 0; i < 250; ++i) {
+        ASSERT_TRUE(session.addItem(makeItem(i), "Alice"));
+    }
+    ASSERT_TRUE(session.commit());
+
+    EXPECT_EQ(countSchemaObjects("index"), indexes);
+    EXPECT_EQ(countSchemaObjects("trigger"), triggers);
+    EXPECT_TRUE(db->checkStatsConsistency().empty());
+    EXPECT_EQ(db->getUserStats("Alice").count, 251);
+
+    if (db->isFullTextSearchAvailable()) {
+        EXPECT_EQ(db->searchItems("Alice", "drone").size(), 1u);
+        EXPECT_EQ(db->searchItems("Alice", "\"bulk note 42\"").size(), 1u);
+    }
+
+    // Triggers are live again for ordinary writes
+    WishItem later("Later Kite", 5.0, Category::TOYS);
+    ASSERT_TRUE(db->saveItem(later, "Alice"));
+    EXPECT_EQ(db->getUserStats("Alice").count, 252);
+}
+
+TEST_F(BulkLoadSessionTest, AbortLeavesMainDatabaseUntouched) {
+    db->saveItem(WishItem("Existing", 10.0, Category::BOOKS), "Alice");
+
+    {
+        BulkLoadSession session(*db);
+        ASSERT_TRUE(session.begin());
+        for (int i = 0; i < 150; ++i) {
+            ASSERT_TRUE(session.addItem(makeItem(i), "Alice"));
+        }
+        session.abort();
+        EXPECT_FALSE(session.isActive());
+    }
+
+    {
+        // Destroying an uncommitted session discards it as well
+        BulkLoadSession session(*db);
+        ASSERT_TRUE(session.begin());
+        ASSERT_TRUE(session.addItem(makeItem(1), "Carol"));
+    }
+
+    EXPECT_EQ(db->getTotalItemsCount("Alice"), 1);
+    EXPECT_FALSE(db->userExists("Carol"));
+    EXPECT_FALSE(std::filesystem::exists(testDb + ".bulk"));
+}
+
+TEST_F(BulkLoadSessionTest, FailedCommitRollsBackEverything) {
+    WishItem existing("Existing", 10.0, Category::BOOKS);
+    ASSERT_TRUE(db->saveItem(existing, "Alice"));
+    int indexes = countSchemaObjects("index");
+
+    BulkLoadSession session(*db, BulkLoadSession::Options{10, true});
+    ASSERT_TRUE(session.begin());
+    for (int i = 0; i < 20; ++i) {
+        ASSERT_TRUE(session.addItem(makeItem(i), "Bob"));
+    }
+    // Duplicate primary key makes the copy into main fail
+    ASSERT_TRUE(session.addItem(existing, "Bob"));
+    EXPECT_FALSE(session.commit());
+
+    EXPECT_FALSE(db->userExists("Bob"));
+    EXPECT_EQ(db->getTotalItemsCount("Alice"), 1);
+    EXPECT_EQ(countSchemaObjects("index"), indexes);
+    EXPECT_TRUE(db->checkStatsConsistency().empty());
+}
+
+TEST_F(BulkLoadSessionTest, KeepIdsPreservesItemIds) {
+    WishItem item("Kept", 12.0, Category::SPORTS);
+    int originalId = item.getId();
+
+    BulkLoadSession session(*db, BulkLoadSession::Options{100, true});
+    ASSERT_TRUE(session.begin());
+    ASSERT_TRUE(session.addItem(item, "Alice"));
+    ASSERT_TRUE(session.commit());
+
+    auto items = db->loadItems("Alice");
+    ASSERT_EQ(items.size(), 1u);
+    EXPECT_EQ(items[0]->getId(), originalId);
+}
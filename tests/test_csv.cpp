@@ -0,0 +1,166 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+#include <gtest/gtest.h>
+#include "../include/csv.h"
+#include "../include/file_handler.h"
+#include "../include/parallel_parser.h"
+#include "../include/logger.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <random>
+
+class CsvTest : public ::testing::Test {
+protected:
+    std::string testCsvFile = "test_csv_engine.csv";
+
+    void SetUp() override {
+        Logger::getInstance().setLogLevel(LogLevel::NONE);
+        std::filesystem::remove(testCsvFile);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove(testCsvFile);
+    }
+
+    static std::vector<std::vector<std::string> > readAll(std::string_view text, char delimiter = ',') {
+        CsvReader reader(text, delimiter);
+        std::vector<std::vector<std::string> > records;
+        std::vector<std::string> fields;
+        while (reader.next(fields)) records.push_back(fields);
+        return records;
+    }
+};
+
+TEST_F(CsvTest, VectorScanMatchesScalar) {
+    std::mt19937 random(42);
+    std::string text(300, 'x');
+    const std::array<char, 4> needles{',', '"', '\n', '\r'};
+    for (int round = 0; round < 200; ++round) {
+        std::fill(text.begin(), text.end(), 'x');
+        text[random() % text.size()] = needles[random() % 4];
+        size_t offset = random() % 40;
+        std::string_view view = std::string_view(text).substr(offset, random() % (text.size() - offset));
+        EXPECT_EQ(Csv::findFirstOf(view, needles), Csv::findFirstOfScalar(view, needles));
+    }
+    EXPECT_EQ(Csv::findFirstOf(std::string(100, 'x'), needles), 100u);
+}
+
+TEST_F(CsvTest, ReadsQuotedFieldsAndLineEndings) {
+    auto records = readAll("\xEF\xBB\xBF" "a,\"b,c\",\"say \"\"hi\"\"\"\r\n"
+                           "\"multi\nline\",,end,\n"
+                           "last");
+    ASSERT_EQ(records.size(), 3u);
+    EXPECT_EQ(records[0], (std::vector<std::string>{"a", "b,c", "say \"hi\""}));
+    EXPECT_EQ(records[1], (std::vector<std::string>{"multi\nline", "", "end", ""}));
+    EXPECT_EQ(records[2], (std::vector<std::string>{"last"}));
+}
+
+TEST_F(CsvTest, ReadsCustomDelimiterAndMalformedInput) {
+    auto records = readAll("a;b,c;d\"e\n\"open;never closed", ';');
+    ASSERT_EQ(records.size(), 2u);
+    EXPECT_EQ(records[0], (std::vector<std::string>{"a", "b,c", "d\"e"}));
+    EXPECT_EQ(records[1], (std::vector<std::string>{"open;never closed"}));
+}
+
+TEST_F(CsvTest, WriterQuotesOnlyWhereNeeded) {
+    std::ostringstream out;
+    {
+        CsvOptions options;
+        options.writeBom = true;
+        options.crlf = false;
+        CsvWriter writer(out, options);
+        writer.field("plain").field("with,comma").field("with \"quote\"").field(19.99).field(7);
+        writer.endRecord();
+        writer.field("line\nbreak");
+        writer.endRecord();
+    }
+    EXPECT_EQ(out.str(), "\xEF\xBB\xBF" "plain,\"with,comma\",\"with \"\"quote\"\"\",19.99,7\n\"line\nbreak\"\n");
+}
+
+TEST_F(CsvTest, SplitRecordsKeepsQuotedLineBreaksTogether) {
+    std::string text;
+    for (int i = 0; i < 1000; ++i) {
+        text += std::to_string(i) + ",\"note\nwith break\"\n";
+    }
+    auto chunks = Csv::splitRecords(text, 8, 64);
+    ASSERT_GT(chunks.size(), 1u);
+    size_t records = 0;
+    for (auto chunk: chunks) {
+        for (const auto &record: readAll(chunk)) {
+            ASSERT_EQ(record.size(), 2u);
+            EXPECT_EQ(record[1], "note\nwith break");
+            records++;
+        }
+    }
+    EXPECT_EQ(records, 1000u);
+}
+
+TEST_F(CsvTest, SplitRecordsMatchesSingleChunkWithStrayQuotes) {
+    // Quotes inside unquoted fields are plain text and must not flip the
+    // splitter's quote state
+    std::string text;
+    for (int i = 0; i < 500; ++i) {
+        text += std::to_string(i) + ";24\" monitor;\"a;\"\"b\"\"\nc\"\r\n";
+        text += "x\"y;\"\";z\"\n";
+        text += "cr only;\"\"\r";
+    }
+    auto whole = readAll(text, ';');
+    ASSERT_EQ(whole.size(), 1500u);
+    EXPECT_EQ(whole[0][1], "24\" monitor");
+    EXPECT_EQ(whole[0][2], "a;\"b\"\nc");
+
+    for (unsigned threads: {2u, 4u, 8u}) {
+        auto chunks = Csv::splitRecords(text, threads, 16, ';');
+        ASSERT_GT(chunks.size(), 1u);
+        auto batches = ParallelParser::parseChunks<std::vector<std::vector<std::string> > >(
+            chunks, [](std::string_view chunk) { return readAll(chunk, ';'); });
+        std::vector<std::vector<std::string> > merged;
+        for (auto &batch: batches) merged.insert(merged.end(), batch.begin(), batch.end());
+        EXPECT_EQ(merged, whole) << threads << " threads";
+    }
+}
+
+TEST_F(CsvTest, FileHandlerRoundTripsSpecialCharacters) {
+    WishlistManager original("Alice");
+    auto item = std::make_unique<WishItem>("Lego, large", 0.1 + 0.2, Category::TOYS);
+    item->setNotes("He said \"get it\"\nSecond line");
+    item->setLink("https://example.com/?a=1,2");
+    original.addItem(std::move(item));
+
+    CsvOptions options;
+    options.delimiter = ';';
+    FileHandler handler;
+    ASSERT_TRUE(handler.exportToCSV(original, testCsvFile, options));
+
+    WishlistManager imported("Alice");
+    ASSERT_TRUE(FileHandler::importFromCSV(imported, testCsvFile, 1, options));
+    ASSERT_EQ(imported.getTotalItems(), 1);
+    const WishItem &loaded = *imported.getItems()[0];
+    EXPECT_EQ(loaded.getName(), "Lego, large");
+    EXPECT_EQ(loaded.getPrice(), 0.1 + 0.2); // Shortest round-trip formatting
+    EXPECT_EQ(loaded.getNotes(), "He said \"get it\"\nSecond line");
+    EXPECT_EQ(loaded.getLink(), "https://example.com/?a=1,2");
+    EXPECT_EQ(loaded.getCategory(), Category::TOYS);
+}
+
+TEST_F(CsvTest, ParallelImportOfLargeFile) {
+    WishlistManager original("Alice");
+    for (int i = 0; i < 30000; ++i) {
+        auto item = std::make_unique<WishItem>("Item " + std::to_string(i), i, Category::OTHER);
+        item->setNotes("Notes, \"quoted\"\nand " + std::string(40, 'n'));
+        original.addItem(std::move(item));
+    }
+    FileHandler handler;
+    ASSERT_TRUE(handler.exportToCSV(original, testCsvFile));
+    ASSERT_GT(std::filesystem::file_size(testCsvFile), 2 * ParallelParser::MIN_CHUNK_BYTES);
+
+    WishlistManager imported("Alice");
+    ASSERT_TRUE(FileHandler::importFromCSV(imported, testCsvFile, 4));
+    ASSERT_EQ(imported.getTotalItems(), 30000);
+    for (int i: {0, 12345, 29999}) {
+        EXPECT_EQ(imported.getItems()[i]->getName(), "Item " + std::to_string(i));
+        EXPECT_EQ(imported.getItems()[i]->getNotes(), original.getItems()[i]->getNotes());
+    }
+}
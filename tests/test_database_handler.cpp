@@ -0,0 +1,503 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+#include <gtest/gtest.h>
+#include "../include/database_handler.h"
+#include "../include/logger.h"
+#include <filesystem>
+#include <map>
+
+class DatabaseHandlerTest : public ::testing::Test {
+protected:
+    std::string testDb = "test_database_handler.db";
+    std::unique_ptr<DatabaseHandler> db;
+
+    void SetUp() override {
+        Logger::getInstance().setLogLevel(LogLevel::NONE);
+        std::filesystem::remove(testDb);
+        db = std::make_unique<DatabaseHandler>(testDb);
+        ASSERT_TRUE(db->initialize());
+    }
+
+    void TearDown() override {
+        db.reset();
+        std::filesystem::remove(testDb);
+    }
+
+    void saveItem(const std::string &owner, const std::string &name, double price, Category category,
+                  bool purchased) {
+        WishItem item(name, price, category);
+        item.setPurchased(purchased);
+        ASSERT_TRUE(db->saveItem(item, owner));
+    }
+
+    void saveDiverseItems(const std::string &owner) {
+        saveItem(owner, "Toy Car", 19.99, Category::TOYS, false);
+        saveItem(owner, "Novel", 14.99, Category::BOOKS, true);
+        saveItem(owner, "Laptop", 999.99, Category::ELECTRONICS, false);
+        saveItem(owner, "T-Shirt", 29.99, Category::CLOTHING, true);
+        saveItem(owner, "Soccer Ball", 24.99, Category::SPORTS, false);
+    }
+
+    static std::vector<std::string> drainNames(ItemCursor cursor) {
+        std::vector<std::string> names;
+        WishItem item;
+        while (cursor.next(item)) {
+            names.push_back(item.getName());
+        }
+        return names;
+    }
+};
+
+// ==================== Query Push-Down Tests ====================
+
+TEST_F(DatabaseHandlerTest, QueryAllItemsOrderedById) {
+    saveDiverseItems("Alice");
+    saveDiverseItems("Bob");
+
+    auto names = drainNames(db->queryItems("Alice", ItemQuery()));
+
+    ASSERT_EQ(names.size(), 5u);
+    EXPECT_EQ(names.front(), "Toy Car");
+    EXPECT_EQ(names.back(), "Soccer Ball");
+}
+
+TEST_F(DatabaseHandlerTest, QueryFiltersByCategoryAndPurchased) {
+    saveDiverseItems("Alice");
+
+    ItemQuery byCategory;
+    byCategory.category = Category::ELECTRONICS;
+    EXPECT_EQ(drainNames(db->queryItems("Alice", byCategory)), std::vector<std::string>{"Laptop"});
+
+    ItemQuery purchased;
+    purchased.purchased = true;
+    purchased.order = SortOrder::BY_NAME;
+    EXPECT_EQ(drainNames(db->queryItems("Alice", purchased)), (std::vector<std::string>{"Novel", "T-Shirt"}));
+}
+
+TEST_F(DatabaseHandlerTest, QueryFiltersByPriceRangeAndName) {
+    saveDiverseItems("Alice");
+
+    ItemQuery range;
+    range.minPrice = 20.0;
+    range.maxPrice = 30.0;
+    range.order = SortOrder::BY_PRICE_ASC;
+    EXPECT_EQ(drainNames(db->queryItems("Alice", range)), (std::vector<std::string>{"Soccer Ball", "T-Shirt"}));
+
+    ItemQuery name;
+    name.nameContains = "shirt";
+    EXPECT_EQ(drainNames(db->queryItems("Alice", name)), std::vector<std::string>{"T-Shirt"});
+
+    ItemQuery wildcard;
+    wildcard.nameContains = "%";
+    EXPECT_TRUE(drainNames(db->queryItems("Alice", wildcard)).empty());
+}
+
+TEST_F(DatabaseHandlerTest, QueryLimitAndOffsetPage) {
+    saveDiverseItems("Alice");
+
+    ItemQuery page;
+    page.limit = 2;
+    page.offset = 2;
+    EXPECT_EQ(drainNames(db->queryItems("Alice", page)), (std::vector<std::string>{"Laptop", "T-Shirt"}));
+}
+
+TEST_F(DatabaseHandlerTest, QueryUnknownUserYieldsEmptyCursor) {
+    ItemCursor cursor = db->queryItems("Nobody", ItemQuery());
+    WishItem item;
+    EXPECT_FALSE(cursor.isValid());
+    EXPECT_FALSE(cursor.next(item));
+}
+
+TEST_F(DatabaseHandlerTest, StatsAggregateInDatabase) {
+    saveDiverseItems("Alice");
+
+    ItemStats stats = db->queryStats("Alice");
+
+    EXPECT_EQ(stats.count, 5);
+    EXPECT_EQ(stats.purchasedCount, 2);
+    EXPECT_NEAR(stats.totalValue, 19.99 + 14.99 + 999.99 + 29.99 + 24.99, 1e-9);
+    EXPECT_NEAR(stats.purchasedValue, 14.99 + 29.99, 1e-9);
+    EXPECT_EQ(stats.byCategory.size(), 5u);
+    EXPECT_NEAR(stats.byCategory[Category::BOOKS].purchasedValue, 14.99, 1e-9);
+    EXPECT_EQ(db->getTotalItemsCount("Alice"), stats.count);
+    EXPECT_NEAR(db->getTotalValue("Alice"), stats.totalValue, 1e-9);
+}
+
+TEST_F(DatabaseHandlerTest, StatsRespectFilters) {
+    saveDiverseItems("Alice");
+
+    ItemQuery cheap;
+    cheap.maxPrice = 25.0;
+    ItemStats stats = db->queryStats("Alice", cheap);
+
+    EXPECT_EQ(stats.count, 3);
+    EXPECT_EQ(stats.purchasedCount, 1);
+}
+
+// ==================== Streaming Cursor Tests ====================
+
+TEST_F(DatabaseHandlerTest, CursorIteratesRowViews) {
+    saveDiverseItems("Alice");
+
+    ItemCursor cursor = db->queryItems("Alice", ItemQuery());
+    double total = 0.0;
+    size_t rows = 0;
+    for (const ItemRowView &row: cursor) {
+        total += row.price;
+        rows++;
+    }
+
+    EXPECT_EQ(rows, 5u);
+    EXPECT_NEAR(total, 19.99 + 14.99 + 999.99 + 29.99 + 24.99, 1e-9);
+    EXPECT_FALSE(cursor.isValid());
+}
+
+TEST_F(DatabaseHandlerTest, ForEachItemStopsEarly) {
+    saveDiverseItems("Alice");
+
+    std::vector<std::string> names;
+    size_t visited = db->forEachItem("Alice", [&names](const ItemRowView &row) {
+        names.emplace_back(row.name);
+        return names.size() < 2;
+    });
+
+    EXPECT_EQ(visited, 2u);
+    EXPECT_EQ(names, (std::vector<std::string>{"Toy Car", "Novel"}));
+}
+
+TEST_F(DatabaseHandlerTest, RowViewCopiesAllFields) {
+    WishItem original("Headphones", 79.5, Category::ELECTRONICS);
+    original.setPriority(Priority::HIGH);
+    original.setNotes("Noise cancelling");
+    original.setLink("https://example.com/hp");
+    ASSERT_TRUE(db->saveItem(original, "Alice"));
+
+    auto loaded = db->loadItems("Alice");
+
+    ASSERT_EQ(loaded.size(), 1u);
+    EXPECT_EQ(loaded[0]->getId(), original.getId());
+    EXPECT_EQ(loaded[0]->getName(), "Headphones");
+    EXPECT_DOUBLE_EQ(loaded[0]->getPrice(), 79.5);
+    EXPECT_EQ(loaded[0]->getPriority(), Priority::HIGH);
+    EXPECT_EQ(loaded[0]->getNotes(), "Noise cancelling");
+    EXPECT_EQ(loaded[0]->getLink(), "https://example.com/hp");
+}
+
+// ==================== Full-Text Search Tests ====================
+
+TEST_F(DatabaseHandlerTest, FtsQueryBuilderQuotesTerms) {
+    EXPECT_EQ(DatabaseHandler::buildFtsQuery("play station"), "\"play\"* \"station\"*");
+    EXPECT_EQ(DatabaseHandler::buildFtsQuery("\"soccer ball\" red"), "\"soccer ball\" \"red\"*");
+    EXPECT_EQ(DatabaseHandler::buildFtsQuery("  NOT  "), "\"NOT\"*");
+    EXPECT_EQ(DatabaseHandler::buildFtsQuery(""), "");
+}
+
+TEST_F(DatabaseHandlerTest, SearchMatchesPrefixesCaseInsensitively) {
+    ASSERT_TRUE(db->isFullTextSearchAvailable());
+    saveItem("Alice", "PlayStation 5", 499.99, Category::ELECTRONICS, false);
+    saveItem("Alice", "PlayStation Controller", 59.99, Category::ELECTRONICS, false);
+    saveItem("Alice", "Book", 29.99, Category::BOOKS, false);
+    saveItem("Bob", "PlayStation 4", 199.99, Category::ELECTRONICS, false);
+
+    auto results = db->searchItems("Alice", "playst");
+
+    ASSERT_EQ(results.size(), 2u);
+    for (const auto &item: results) {
+        EXPECT_NE(item->getName().find("PlayStation"), std::string::npos);
+    }
+}
+
+TEST_F(DatabaseHandlerTest, SearchSupportsPhrasesAndNotes) {
+    WishItem ball("Ball", 24.99, Category::SPORTS);
+    ball.setNotes("official match size soccer ball");
+    ASSERT_TRUE(db->saveItem(ball, "Alice"));
+    WishItem other("Other Ball", 9.99, Category::SPORTS);
+    other.setNotes("ball for soccer practice");
+    ASSERT_TRUE(db->saveItem(other, "Alice"));
+
+    auto phrase = db->searchItems("Alice", "\"soccer ball\"");
+    ASSERT_EQ(phrase.size(), 1u);
+    EXPECT_EQ(phrase[0]->getName(), "Ball");
+
+    EXPECT_EQ(db->searchItems("Alice", "soccer").size(), 2u);
+}
+
+TEST_F(DatabaseHandlerTest, SearchRanksNameMatchesFirst) {
+    WishItem noteMatch("Gift Card", 50.0);
+    noteMatch.setNotes("for the lego store");
+    ASSERT_TRUE(db->saveItem(noteMatch, "Alice"));
+    saveItem("Alice", "Lego Castle", 89.99, Category::TOYS, false);
+
+    auto results = db->searchItems("Alice", "lego");
+
+    ASSERT_EQ(results.size(), 2u);
+    EXPECT_EQ(results[0]->getName(), "Lego Castle");
+}
+
+TEST_F(DatabaseHandlerTest, SearchIndexFollowsUpdatesAndDeletes) {
+    WishItem item("Drone", 299.0, Category::ELECTRONICS);
+    ASSERT_TRUE(db->saveItem(item, "Alice"));
+    EXPECT_EQ(db->searchItems("Alice", "drone").size(), 1u);
+
+    item.setName("Quadcopter");
+    ASSERT_TRUE(db->updateItem(item, "Alice"));
+    EXPECT_TRUE(db->searchItems("Alice", "drone").empty());
+    EXPECT_EQ(db->searchItems("Alice", "quad").size(), 1u);
+
+    ASSERT_TRUE(db->deleteItem(item.getId(), "Alice"));
+    EXPECT_TRUE(db->searchItems("Alice", "quad").empty());
+}
+
+TEST_F(DatabaseHandlerTest, SearchRespectsLimit) {
+    for (int i = 0; i < 10; ++i) {
+        saveItem("Alice", "Card " + std::to_string(i), 1.0, Category::OTHER, false);
+    }
+
+    EXPECT_EQ(db->searchItems("Alice", "card", 3).size(), 3u);
+}
+
+// ==================== Price History Tests ====================
+
+TEST_F(DatabaseHandlerTest, PriceChangesAreRecorded) {
+    WishItem item("Bike", 500.0, Category::SPORTS);
+    ASSERT_TRUE(db->saveItem(item, "Alice"));
+    item.setPrice(450.0);
+    ASSERT_TRUE(db->saveItem(item, "Alice"));
+    item.setNotes("Same price, no new sample");
+    ASSERT_TRUE(db->saveItem(item, "Alice"));
+
+    PriceSummary summary = db->getPriceSummary(item.getId());
+
+    EXPECT_EQ(summary.samples, 2);
+    EXPECT_DOUBLE_EQ(summary.minPrice, 450.0);
+    EXPECT_DOUBLE_EQ(summary.maxPrice, 500.0);
+    EXPECT_DOUBLE_EQ(summary.latestPrice, 450.0);
+}
+
+TEST_F(DatabaseHandlerTest, PriceSeriesIsDownsampled) {
+    WishItem item("Camera", 300.0, Category::ELECTRONICS);
+    ASSERT_TRUE(db->saveItem(item, "Alice"));
+
+    const std::time_t base = 1700000000;
+    const double prices[] = {300.0, 280.0, 290.0, 250.0, 260.0, 240.0};
+    for (int i = 0; i < 6; ++i) {
+        ASSERT_TRUE(db->recordPrice(item.getId(), prices[i], base + i * 3600));
+    }
+
+    // Three two-hour buckets, the last window bound is exclusive
+    auto series = db->getPriceSeries(item.getId(), base, base + 6 * 3600, 2 * 3600);
+
+    ASSERT_EQ(series.size(), 3u);
+    EXPECT_EQ(series[0].start, base);
+    EXPECT_DOUBLE_EQ(series[0].minPrice, 280.0);
+    EXPECT_DOUBLE_EQ(series[0].maxPrice, 300.0);
+    EXPECT_DOUBLE_EQ(series[0].avgPrice, 290.0);
+    EXPECT_DOUBLE_EQ(series[1].lastPrice, 250.0);
+    EXPECT_EQ(series[2].samples, 2);
+    EXPECT_DOUBLE_EQ(series[2].minPrice, 240.0);
+}
+
+TEST_F(DatabaseHandlerTest, PriceDropsFoundInOnePass) {
+    WishItem tv("TV", 1000.0, Category::ELECTRONICS);
+    WishItem book("Book", 20.0, Category::BOOKS);
+    ASSERT_TRUE(db->saveItem(tv, "Alice"));
+    ASSERT_TRUE(db->saveItem(book, "Alice"));
+
+    tv.setPrice(700.0);
+    book.setPrice(19.0);
+    ASSERT_TRUE(db->saveItem(tv, "Alice"));
+    ASSERT_TRUE(db->saveItem(book, "Alice"));
+
+    auto drops = db->findPriceDrops("Alice", 0, 10.0);
+
+    ASSERT_EQ(drops.size(), 1u);
+    EXPECT_EQ(drops[0].itemId, tv.getId());
+    EXPECT_DOUBLE_EQ(drops[0].peakPrice, 1000.0);
+    EXPECT_DOUBLE_EQ(drops[0].currentPrice, 700.0);
+    EXPECT_NEAR(drops[0].dropPercent, 30.0, 1e-9);
+}
+
+TEST_F(DatabaseHandlerTest, CompactionKeepsNewestSamplePerBucket) {
+    WishItem item("Watch", 200.0, Category::OTHER);
+    ASSERT_TRUE(db->saveItem(item, "Alice"));
+
+    const std::time_t day = 86400;
+    const std::time_t base = 1700006400; // Midnight UTC
+    for (int i = 0; i < 48; ++i) {
+        ASSERT_TRUE(db->recordPrice(item.getId(), 200.0 - i, base + i * 3600));
+    }
+
+    // Two old days collapse to one sample each; the live sample from saveItem is newer than the cutoff
+    int removed = db->compactPriceHistory(base + 2 * day, day);
+    EXPECT_EQ(removed, 46);
+
+    auto series = db->getPriceSeries(item.getId(), base, base + 2 * day, day);
+    ASSERT_EQ(series.size(), 2u);
+    EXPECT_EQ(series[0].samples, 1);
+    EXPECT_DOUBLE_EQ(series[0].lastPrice, 200.0 - 23);
+    EXPECT_DOUBLE_EQ(series[1].lastPrice, 200.0 - 47);
+}
+
+TEST_F(DatabaseHandlerTest, DeletingItemRemovesHistory) {
+    WishItem item("Lamp", 40.0);
+    ASSERT_TRUE(db->saveItem(item, "Alice"));
+    ASSERT_TRUE(db->deleteItem(item.getId(), "Alice"));
+
+    EXPECT_EQ(db->getPriceSummary(item.getId()).samples, 0);
+}
+
+// ==================== Materialized Statistics Tests ====================
+
+TEST_F(DatabaseHandlerTest, UserStatsFollowInsertUpdateDelete) {
+    WishItem a("A", 10.0, Category::TOYS);
+    WishItem b("B", 20.0, Category::BOOKS);
+    ASSERT_TRUE(db->saveItem(a, "Alice"));
+    ASSERT_TRUE(db->saveItem(b, "Alice"));
+
+    b.setPurchased(true);
+    b.setCategory(Category::TOYS);
+    b.setPrice(25.0);
+    ASSERT_TRUE(db->saveItem(b, "Alice"));
+
+    ItemStats stats = db->getUserStats("Alice");
+    EXPECT_EQ(stats.count, 2);
+    EXPECT_DOUBLE_EQ(stats.totalValue, 35.0);
+    EXPECT_EQ(stats.purchasedCount, 1);
+    EXPECT_DOUBLE_EQ(stats.purchasedValue, 25.0);
+    ASSERT_EQ(stats.byCategory.size(), 1u);
+    EXPECT_EQ(stats.byCategory[Category::TOYS].count, 2);
+
+    ASSERT_TRUE(db->deleteItem(a.getId(), "Alice"));
+    stats = db->getUserStats("Alice");
+    EXPECT_EQ(stats.count, 1);
+    EXPECT_DOUBLE_EQ(stats.totalValue, 25.0);
+    EXPECT_EQ(db->getTotalItemsCount("Alice"), 1);
+    EXPECT_DOUBLE_EQ(db->getTotalValue("Alice"), 25.0);
+}
+
+TEST_F(DatabaseHandlerTest, UserStatsMatchRecomputedStats) {
+    saveDiverseItems("Alice");
+    saveDiverseItems("Bob");
+    ASSERT_TRUE(db->clearAllData("Bob"));
+
+    EXPECT_TRUE(db->checkStatsConsistency().empty());
+    EXPECT_EQ(db->getUserStats("Bob").count, 0);
+    EXPECT_EQ(db->getUserStats("Alice").count, 5);
+}
+
+TEST_F(DatabaseHandlerTest, ConsistencyCheckReportsDriftAndRebuildFixesIt) {
+    saveDiverseItems("Alice");
+
+    sqlite3 *raw;
+    ASSERT_EQ(sqlite3_open(testDb.c_str(), &raw), SQLITE_OK);
+    ASSERT_EQ(sqlite3_exec(raw, "UPDATE user_stats SET item_count = 42;", nullptr, nullptr, nullptr), SQLITE_OK);
+    sqlite3_close(raw);
+
+    auto drifts = db->checkStatsConsistency();
+    ASSERT_EQ(drifts.size(), 1u);
+    EXPECT_EQ(drifts[0].username, "Alice");
+    EXPECT_EQ(drifts[0].field, "item_count");
+    EXPECT_DOUBLE_EQ(drifts[0].stored, 42.0);
+    EXPECT_DOUBLE_EQ(drifts[0].actual, 5.0);
+
+    ASSERT_TRUE(db->rebuildUserStats());
+    EXPECT_TRUE(db->checkStatsConsistency().empty());
+}
+
+TEST_F(DatabaseHandlerTest, ConsistencyCheckCoversCategories) {
+    saveDiverseItems("Alice");
+
+    // One category row lost, one left over without items, one off by a purchase
+    sqlite3 *raw;
+    ASSERT_EQ(sqlite3_open(testDb.c_str(), &raw), SQLITE_OK);
+    std::string sql = "DELETE FROM user_category_stats WHERE category = " +
+                      std::to_string(static_cast<int>(Category::TOYS)) + "; "
+                      "INSERT INTO user_category_stats (user_id, category, item_count, total_value, purchased_value) "
+                      "SELECT user_id, " + std::to_string(static_cast<int>(Category::OTHER)) +
+                      ", 1, 5.0, 0.0 FROM user_stats; "
+                      "UPDATE user_category_stats SET purchased_value = 0 WHERE category = " +
+                      std::to_string(static_cast<int>(Category::BOOKS)) + ";";
+    ASSERT_EQ(sqlite3_exec(raw, sql.c_str(), nullptr, nullptr, nullptr), SQLITE_OK);
+    sqlite3_close(raw);
+
+    std::map<std::string, StatsDrift> byField;
+    for (const auto &drift: db->checkStatsConsistency()) {
+        EXPECT_EQ(drift.username, "Alice");
+        byField[drift.category + "." + drift.field] = drift;
+    }
+    std::string toys = WishItem::categoryToString(Category::TOYS);
+    std::string other = WishItem::categoryToString(Category::OTHER);
+    std::string books = WishItem::categoryToString(Category::BOOKS);
+    EXPECT_EQ(byField.size(), 5u);
+    EXPECT_DOUBLE_EQ(byField[toys + ".item_count"].actual, 1.0);
+    EXPECT_DOUBLE_EQ(byField[toys + ".total_value"].stored, 0.0);
+    EXPECT_DOUBLE_EQ(byField[other + ".item_count"].stored, 1.0);
+    EXPECT_DOUBLE_EQ(byField[other + ".total_value"].actual, 0.0);
+    EXPECT_DOUBLE_EQ(byField[books + ".purchased_value"].actual, 14.99);
+
+    ASSERT_TRUE(db->rebuildUserStats());
+    EXPECT_TRUE(db->checkStatsConsistency().empty());
+}
+
+TEST_F(DatabaseHandlerTest, BudgetSpentComesFromUserStats) {
+    saveDiverseItems("Alice");
+    Budget budget(500.0);
+    budget.setSpentAmount(1.0); // Stale; the stored value is not what loads
+    ASSERT_TRUE(db->saveBudget(budget, "Alice"));
+
+    EXPECT_DOUBLE_EQ(db->loadBudget("Alice").getSpentAmount(), 14.99 + 29.99);
+
+    saveItem("Alice", "Puzzle", 10.0, Category::TOYS, true);
+    EXPECT_DOUBLE_EQ(db->loadBudget("Alice").getSpentAmount(), 14.99 + 29.99 + 10.0);
+}
+
+// ==================== Backup Tests ====================
+
+TEST_F(DatabaseHandlerTest, BackupStepsIncrementallyAndRestores) {
+    std::string backupPath = "test_database_handler_backup.db";
+    std::filesystem::remove(backupPath);
+    for (int i = 0; i < 200; ++i) {
+        WishItem item("Padding item " + std::to_string(i), i, Category::OTHER);
+        item.setNotes(std::string(500, 'x'));
+        ASSERT_TRUE(db->saveItem(item, "Alice"));
+    }
+
+    int steps = 0;
+    int lastRemaining = -1;
+    ASSERT_TRUE(db->backupTo(backupPath, 4, [&](int remaining, int total) {
+        steps++;
+        EXPECT_LE(remaining, total);
+        lastRemaining = remaining;
+        return true;
+    }, std::chrono::milliseconds(0)));
+    EXPECT_GT(steps, 1);
+    EXPECT_EQ(lastRemaining, 0);
+    EXPECT_FALSE(std::filesystem::exists(backupPath + ".partial"));
+
+    ASSERT_TRUE(db->clearAllData("Alice"));
+    saveItem("Bob", "Added after backup", 5.0, Category::TOYS, false);
+
+    ASSERT_TRUE(db->restoreFrom(backupPath));
+    EXPECT_EQ(db->getTotalItemsCount("Alice"), 200);
+    EXPECT_FALSE(db->userExists("Bob"));
+    EXPECT_TRUE(db->checkStatsConsistency().empty());
+
+    std::filesystem::remove(backupPath);
+}
+
+TEST_F(DatabaseHandlerTest, CancelledBackupLeavesNoFile) {
+    std::string backupPath = "test_database_handler_cancelled.db";
+    saveDiverseItems("Alice");
+
+    EXPECT_FALSE(db->backupTo(backupPath, 1, [](int, int) { return false; }));
+    EXPECT_FALSE(std::filesystem::exists(backupPath));
+    EXPECT_FALSE(std::filesystem::exists(backupPath + ".partial"));
+}
+
+TEST_F(DatabaseHandlerTest, RestoreFromMissingFileFails) {
+    saveDiverseItems("Alice");
+
+    EXPECT_FALSE(db->restoreFrom("does_not_exist.db"));
+    EXPECT_EQ(db->getTotalItemsCount("Alice"), 5);
+}
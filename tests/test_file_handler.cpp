@@ -5,8 +5,10 @@
 #include "../include/file_handler.h"
 #include "../include/wishlist_manager.h"
 #include "../include/logger.h"
+#include "../include/parallel_parser.h"
 #include <fstream>
 #include <filesystem>
+#include <sstream>
 
 class FileHandlerTest : public ::testing::Test {
 protected:
@@ -62,6 +64,77 @@ TEST_F(FileHandlerTest, LoadNonExistentFile) {
     EXPECT_FALSE(handler.load(manager));
 }
 
+TEST_F(FileHandlerTest, LoadHandlesCrlfBudgetAndMissingFinalNewline) {
+    {
+        std::ofstream file(testFile, std::ios::binary);
+        file << "\r\nAlice\r\nBUDGET:100.00|15.00|1\r\n7|Scarf|15|1|3|1|Wool|\r\n\r\n9|Kite|12.5|0|4|2||http://kite";
+    }
+    WishlistManager manager("Temp");
+    FileHandler handler(testFile);
+    ASSERT_TRUE(handler.load(manager));
+
+    EXPECT_EQ(manager.getOwner(), "Alice");
+    EXPECT_TRUE(manager.getBudget().isEnabled());
+    ASSERT_EQ(manager.getTotalItems(), 2);
+    EXPECT_EQ(manager.getItems()[0]->getNotes(), "Wool");
+    EXPECT_EQ(manager.getItems()[0]->getLink(), "");
+    EXPECT_EQ(manager.getItems()[1]->getLink(), "http://kite");
+    EXPECT_DOUBLE_EQ(manager.getItems()[1]->getPrice(), 12.5);
+}
+
+TEST_F(FileHandlerTest, LoadOldFormatAndSkipsMalformedLines) {
+    {
+        std::ofstream file(testFile);
+        file << "1|Ball|5|0|4|1\nnot an item\nx|Broken|1|0|0|0\n2|Book|8|0|1|1\n";
+    }
+    WishlistManager manager("Keep");
+    FileHandler handler(testFile);
+    ASSERT_TRUE(handler.load(manager));
+
+    EXPECT_EQ(manager.getOwner(), "Keep");
+    ASSERT_EQ(manager.getTotalItems(), 2);
+    EXPECT_EQ(manager.getItems()[1]->getName(), "Book");
+}
+
+TEST_F(FileHandlerTest, LoadEmptyFile) {
+    std::ofstream(testFile).close();
+    WishlistManager manager("TestUser");
+    FileHandler handler(testFile);
+
+    EXPECT_FALSE(handler.load(manager));
+}
+
+TEST_F(FileHandlerTest, ParallelLoadMatchesSingleThreadedLoad) {
+    // Large enough to be split into several chunks
+    WishlistManager saveManager("Bulk");
+    saveManager.getBudget().setMaxBudget(500.0);
+    for (int i = 0; i < 40000; ++i) {
+        auto item = std::make_unique<WishItem>("Item " + std::to_string(i), i % 97, Category::TOYS);
+        item->setNotes(std::string(40, 'n'));
+        saveManager.addItem(std::move(item));
+    }
+    FileHandler handler(testFile);
+    ASSERT_TRUE(handler.save(saveManager));
+    ASSERT_GT(std::filesystem::file_size(testFile), 2 * ParallelParser::MIN_CHUNK_BYTES);
+
+    WishlistManager serial("Temp");
+    handler.setParseThreads(1);
+    ASSERT_TRUE(handler.load(serial));
+
+    WishlistManager parallel("Temp");
+    handler.setParseThreads(4);
+    ASSERT_TRUE(handler.load(parallel));
+
+    EXPECT_EQ(parallel.getOwner(), "Bulk");
+    EXPECT_DOUBLE_EQ(parallel.getBudget().getMaxBudget(), 500.0);
+    ASSERT_EQ(parallel.getTotalItems(), serial.getTotalItems());
+    for (size_t i = 0; i < serial.getItems().size(); ++i) {
+        ASSERT_EQ(parallel.getItems()[i]->getId(), serial.getItems()[i]->getId());
+        ASSERT_EQ(parallel.getItems()[i]->getName(), serial.getItems()[i]->getName());
+    }
+    EXPECT_GT(WishItem::getNextId(), parallel.getItems().back()->getId());
+}
+
 /*TEST_F(FileHandlerTest, SaveAndLoadWithSpecialCharacters) {
     WishlistManager saveManager("User|With|Pipes");
     auto item = std::make_unique<WishItem>("Item | with | pipes", 99.99);
@@ -109,3 +182,61 @@ TEST_F(FileHandlerTest, ImportNonExistentCSV) {
 
     EXPECT_FALSE(handler.importFromCSV(manager, "nonexistent.csv"));
 }
+
+// ==================== Stream Tests ====================
+
+TEST_F(FileHandlerTest, SaveAndLoadThroughStreams) {
+    WishlistManager original("StreamUser");
+    original.getBudget().setMaxBudget(120.0);
+    original.addItem(std::make_unique<WishItem>("Stream Item", 30.0, Category::BOOKS));
+
+    for (FileFormat format: {FileFormat::TEXT, FileFormat::BINARY}) {
+        FileHandler handler("unused.dat");
+        handler.setFormat(format);
+        std::stringstream buffer;
+        ASSERT_TRUE(handler.save(original, buffer));
+
+        WishlistManager loaded("Temp");
+        ASSERT_TRUE(handler.load(loaded, buffer));
+        EXPECT_EQ(loaded.getOwner(), "StreamUser");
+        EXPECT_DOUBLE_EQ(loaded.getBudget().getMaxBudget(), 120.0);
+        ASSERT_EQ(loaded.getTotalItems(), 1);
+        EXPECT_EQ(loaded.getItems()[0]->getName(), "Stream Item");
+    }
+    EXPECT_FALSE(std::filesystem::exists("unused.dat"));
+}
+
+TEST_F(FileHandlerTest, CsvAndJsonThroughStreams) {
+    WishlistManager original("StreamUser");
+    auto item = std::make_unique<WishItem>("Comma, \"quoted\"", 12.5, Category::TOYS);
+    item->setNotes("Two\nlines");
+    original.addItem(std::move(item));
+    FileHandler handler;
+
+    std::stringstream csv;
+    ASSERT_TRUE(handler.exportToCSV(original, csv));
+    WishlistManager fromCsv("StreamUser");
+    ASSERT_TRUE(FileHandler::importFromCSV(fromCsv, csv));
+    ASSERT_EQ(fromCsv.getTotalItems(), 1);
+    EXPECT_EQ(fromCsv.getItems()[0]->getName(), "Comma, \"quoted\"");
+    EXPECT_EQ(fromCsv.getItems()[0]->getNotes(), "Two\nlines");
+
+    std::stringstream json;
+    ASSERT_TRUE(handler.exportToJSON(original, json));
+    WishlistManager fromJson("StreamUser");
+    ASSERT_TRUE(FileHandler::importFromJSON(fromJson, json));
+    ASSERT_EQ(fromJson.getTotalItems(), 1);
+    EXPECT_EQ(fromJson.getItems()[0]->getNotes(), "Two\nlines");
+}
+
+TEST_F(FileHandlerTest, DashReadsStandardInput) {
+    std::istringstream input("ID,Name,Price,Purchased\n1,Piped,3.5,No\n");
+    std::streambuf *console = std::cin.rdbuf(input.rdbuf());
+    WishlistManager manager("TestUser");
+    bool imported = FileHandler::importFromCSV(manager, FileHandler::STANDARD_STREAM);
+    std::cin.rdbuf(console);
+
+    ASSERT_TRUE(imported);
+    ASSERT_EQ(manager.getTotalItems(), 1);
+    EXPECT_EQ(manager.getItems()[0]->getName(), "Piped");
+}
@@ -0,0 +1,226 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+#include <gtest/gtest.h>
+#include "../include/http_server.h"
+#include "../include/wishlist_service.h"
+#include "../include/memory_store.h"
+#include "../include/database_handler.h"
+#include "../include/item_cache.h"
+#include "../include/persistence_queue.h"
+#include "../include/logger.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <filesystem>
+
+class HttpServerTest : public ::testing::Test {
+protected:
+    MemoryStore store;
+
+    void SetUp() override {
+        Logger::getInstance().setLogLevel(LogLevel::NONE);
+    }
+
+    static HttpRequest request(const std::string &method, const std::string &path, const std::string &body = "") {
+        HttpRequest request;
+        request.method = method;
+        request.path = path;
+        request.body = body;
+        return request;
+    }
+
+    static bool contains(const std::string &text, const std::string &part) {
+        return text.find(part) != std::string::npos;
+    }
+
+    // Sends text over a fresh loopback connection and reads until the server closes it
+    static std::string exchange(uint16_t port, const std::string &text) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+        if (connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0) {
+            close(fd);
+            return "";
+        }
+        send(fd, text.data(), text.size(), MSG_NOSIGNAL);
+        std::string received;
+        char chunk[4096];
+        for (ssize_t n; (n = recv(fd, chunk, sizeof(chunk), 0)) > 0;) {
+            received.append(chunk, static_cast<size_t>(n));
+        }
+        close(fd);
+        return received;
+    }
+};
+
+TEST_F(HttpServerTest, ParseRequest) {
+    std::string data = "GET /users/J%C3%BCrgen/search?q=lego+set&x HTTP/1.1\r\nHost: a\r\nX-Test:  value \r\n\r\n"
+                       "POST /users/Bob/items HTTP/1.1\r\nContent-Length: 4\r\n\r\n{}\r\n";
+    HttpRequest request;
+    size_t consumed = 0;
+    ASSERT_EQ(HttpServer::parseRequest(data, 1024, request, consumed), HttpParseResult::COMPLETE);
+    EXPECT_EQ(request.method, "GET");
+    EXPECT_EQ(request.path, "/users/J\xC3\xBCrgen/search");
+    EXPECT_EQ(request.query["q"], "lego set");
+    EXPECT_EQ(request.query.count("x"), 1u);
+    EXPECT_EQ(request.header("x-test"), "value");
+    EXPECT_TRUE(request.keepAlive);
+
+    std::string_view rest = std::string_view(data).substr(consumed);
+    ASSERT_EQ(HttpServer::parseRequest(rest, 1024, request, consumed), HttpParseResult::COMPLETE);
+    EXPECT_EQ(request.body, "{}\r\n");
+    EXPECT_EQ(consumed, rest.size());
+
+    EXPECT_EQ(HttpServer::parseRequest(rest.substr(0, rest.size() - 1), 1024, request, consumed),
+              HttpParseResult::INCOMPLETE);
+    EXPECT_EQ(HttpServer::parseRequest(rest, 3, request, consumed), HttpParseResult::TOO_LARGE);
+    EXPECT_EQ(HttpServer::parseRequest("GET / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n", 1024, request, consumed),
+              HttpParseResult::LENGTH_REQUIRED);
+    EXPECT_EQ(HttpServer::parseRequest("GET /\r\n\r\n", 1024, request, consumed), HttpParseResult::INVALID);
+
+    ASSERT_EQ(HttpServer::parseRequest("GET / HTTP/1.0\r\n\r\n", 1024, request, consumed), HttpParseResult::COMPLETE);
+    EXPECT_FALSE(request.keepAlive);
+}
+
+TEST_F(HttpServerTest, ServiceRoutes) {
+    PersistenceQueue queue(store);
+    WishlistService service(store, queue);
+
+    EXPECT_EQ(service.handle(request("GET", "/users/Alice/items")).status, 404);
+
+    HttpResponse added = service.handle(request("POST", "/users/Alice/items",
+                                                R"({"name": "Lego", "price": 49.5, "category": "toys"})"));
+    ASSERT_EQ(added.status, 201) << added.body;
+    EXPECT_TRUE(contains(added.body, R"("name":"Lego","price":49.5)"));
+    ASSERT_TRUE(service.flush());
+    int id = store.getGlobalMaxItemId();
+    service.handle(request("POST", "/users/Alice/items", R"({"name": "Book", "price": 10})"));
+    std::string itemPath = "/users/Alice/items/" + std::to_string(id);
+
+    HttpResponse updated = service.handle(request("PUT", itemPath, R"({"purchased": true, "notes": "gift"})"));
+    ASSERT_EQ(updated.status, 200) << updated.body;
+    EXPECT_TRUE(contains(updated.body, R"("purchased":true)"));
+    EXPECT_EQ(service.handle(request("PUT", itemPath, R"({"price": "free"})")).status, 400);
+    EXPECT_EQ(service.handle(request("POST", "/users/Alice/items", R"({"name": "x"})")).status, 400);
+    EXPECT_EQ(service.handle(request("POST", "/users/Alice/items", R"({"name": ["x"]})")).status, 400);
+
+    HttpResponse stats = service.handle(request("GET", "/users/Alice/stats"));
+    EXPECT_TRUE(contains(stats.body, R"("items":2,"purchased":1,"totalValue":59.5)")) << stats.body;
+
+    HttpResponse budget = service.handle(request("PUT", "/users/Alice/budget", R"({"maxBudget": 100, "enabled": true})"));
+    EXPECT_TRUE(contains(budget.body, R"({"enabled":true,"maxBudget":100,"spentAmount":49.5)")) << budget.body;
+    budget = service.handle(request("PUT", "/users/Alice/budget", R"({"enabled": false})"));
+    EXPECT_TRUE(contains(budget.body, R"({"enabled":false,"maxBudget":100,)")) << budget.body;
+
+    HttpRequest search = request("GET", "/users/Alice/search");
+    search.query["q"] = "Book";
+    EXPECT_TRUE(contains(service.handle(search).body, R"("count":1)"));
+
+    EXPECT_EQ(service.handle(request("DELETE", itemPath)).status, 200);
+    EXPECT_EQ(service.handle(request("GET", itemPath)).status, 404);
+    EXPECT_EQ(service.handle(request("PATCH", "/users/Alice/items")).status, 405);
+    EXPECT_EQ(service.handle(request("GET", "/nothing")).status, 404);
+    EXPECT_EQ(service.handle(request("DELETE", "/users/Nobody/items/1")).status, 404);
+    EXPECT_EQ(service.handle(request("PUT", "/users/Nobody/budget", R"({"maxBudget": 5})")).status, 404);
+    EXPECT_FALSE(store.userExists("Nobody"));
+
+    ASSERT_TRUE(service.flush());
+    EXPECT_EQ(store.loadItems("Alice").size(), 1u);
+    EXPECT_DOUBLE_EQ(store.loadBudget("Alice").getMaxBudget(), 100.0);
+    EXPECT_FALSE(store.loadBudget("Alice").isEnabled());
+}
+
+TEST_F(HttpServerTest, ServiceReadsThroughItemCache) {
+    std::string testDb = "test_service_cache.db";
+    std::filesystem::remove(testDb);
+    {
+        DatabaseHandler db(testDb);
+        ASSERT_TRUE(db.initialize());
+        PersistenceQueue queue(db);
+        ItemCache cache(db);
+        WishlistService service(db, queue, &cache);
+
+        ASSERT_EQ(service.handle(request("POST", "/users/Alice/items", R"({"name": "Lego", "price": 49.5})")).status,
+                  201);
+        HttpResponse stats = service.handle(request("GET", "/users/Alice/stats"));
+        EXPECT_TRUE(contains(stats.body, R"("items":1,"purchased":0,"totalValue":49.5)")) << stats.body;
+
+        // A write that bypasses the service still shows up, patched into the cache
+        WishItem direct("Book", 10.0, Category::BOOKS);
+        ASSERT_TRUE(db.saveItem(direct, "Alice"));
+        HttpResponse list = service.handle(request("GET", "/users/Alice/items"));
+        EXPECT_TRUE(contains(list.body, R"("count":2)")) << list.body;
+        stats = service.handle(request("GET", "/users/Alice/stats"));
+        EXPECT_TRUE(contains(stats.body, R"("items":2,"purchased":0,"totalValue":59.5)")) << stats.body;
+
+        EXPECT_EQ(cache.getCounters().loads, 1u);
+        EXPECT_GE(cache.getCounters().patchedRows, 1u);
+    }
+    std::filesystem::remove(testDb);
+    std::filesystem::remove(testDb + "-wal");
+    std::filesystem::remove(testDb + "-shm");
+}
+
+TEST_F(HttpServerTest, ServesPipelinedKeepAliveRequests) {
+    PersistenceQueue queue(store);
+    WishlistService service(store, queue);
+    HttpServer::Options options;
+    options.port = 0;
+    options.threads = 2;
+    HttpServer server([&service](const HttpRequest &request) { return service.handle(request); }, options);
+    ASSERT_TRUE(server.start());
+    ASSERT_NE(server.getPort(), 0);
+
+    std::string body = R"({"name":"Kite","price":8})";
+    std::string response = exchange(server.getPort(),
+                                     "POST /users/Bob/items HTTP/1.1\r\nContent-Length: " +
+                                     std::to_string(body.size()) + "\r\n\r\n" + body +
+                                     "GET /users/Bob/items HTTP/1.1\r\n\r\n"
+                                     "GET /users/Bob/stats HTTP/1.1\r\nConnection: close\r\n\r\n");
+
+    size_t first = response.find("HTTP/1.1 201 Created");
+    size_t second = response.find("HTTP/1.1 200 OK", first);
+    size_t third = response.find("HTTP/1.1 200 OK", second + 1);
+    ASSERT_NE(first, std::string::npos) << response;
+    ASSERT_NE(second, std::string::npos) << response;
+    ASSERT_NE(third, std::string::npos) << response;
+    EXPECT_TRUE(contains(response, R"("count":1,"items":[{"id":)"));
+    EXPECT_TRUE(contains(response.substr(third), "Connection: close"));
+    EXPECT_EQ(server.getRequestCount(), 3u);
+
+    std::string malformed = exchange(server.getPort(), "NONSENSE\r\n\r\n");
+    EXPECT_TRUE(contains(malformed, "HTTP/1.1 400 Bad Request")) << malformed;
+    server.stop();
+}
+
+TEST_F(HttpServerTest, ClosesIdleAndOversizedConnections) {
+    PersistenceQueue queue(store);
+    WishlistService service(store, queue);
+    HttpServer::Options options;
+    options.port = 0;
+    options.threads = 2;
+    options.maxBodyBytes = 1024;
+    options.idleTimeout = std::chrono::milliseconds(100);
+    HttpServer server([&service](const HttpRequest &request) { return service.handle(request); }, options);
+    ASSERT_TRUE(server.start());
+
+    // exchange() reads until the server closes, which for keep-alive
+    // connections now happens once they sit idle
+    auto started = std::chrono::steady_clock::now();
+    std::string answered = exchange(server.getPort(), "GET /users HTTP/1.1\r\n\r\n");
+    EXPECT_TRUE(contains(answered, "HTTP/1.1 200 OK")) << answered;
+    EXPECT_TRUE(exchange(server.getPort(), "").empty());
+    EXPECT_LT(std::chrono::steady_clock::now() - started, std::chrono::seconds(5));
+
+    std::string endless = "GET /users HTTP/1.1\r\n";
+    while (endless.size() < 4 * HttpServer::MAX_HEADER_BYTES) endless += "X-Padding: 0123456789abcdef\r\n";
+    std::string rejected = exchange(server.getPort(), endless);
+    EXPECT_TRUE(contains(rejected, "HTTP/1.1 413")) << rejected;
+    EXPECT_EQ(server.getRequestCount(), 1u);
+    server.stop();
+}
@@ -0,0 +1,129 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+#include <gtest/gtest.h>
+#include "../include/item_cache.h"
+#include "../include/database_handler.h"
+#include "../include/persistence_queue.h"
+#include "../include/logger.h"
+#include <filesystem>
+
+class ItemCacheTest : public ::testing::Test {
+protected:
+    std::string testDb = "test_item_cache.db";
+    std::unique_ptr<DatabaseHandler> db;
+
+    void SetUp() override {
+        Logger::getInstance().setLogLevel(LogLevel::NONE);
+        std::filesystem::remove(testDb);
+        db = std::make_unique<DatabaseHandler>(testDb);
+        ASSERT_TRUE(db->initialize());
+    }
+
+    void TearDown() override {
+        db.reset();
+        std::filesystem::remove(testDb);
+    }
+
+    WishItem saveItem(const std::string &owner, const std::string &name, double price, Category category) {
+        WishItem item(name, price, category);
+        EXPECT_TRUE(db->saveItem(item, owner));
+        return item;
+    }
+
+    static void expectSameStats(const ItemStats &cached, const ItemStats &actual) {
+        EXPECT_EQ(cached.count, actual.count);
+        EXPECT_NEAR(cached.totalValue, actual.totalValue, 1e-9);
+        EXPECT_EQ(cached.purchasedCount, actual.purchasedCount);
+        EXPECT_NEAR(cached.purchasedValue, actual.purchasedValue, 1e-9);
+        EXPECT_EQ(cached.byCategory.size(), actual.byCategory.size());
+    }
+};
+
+TEST_F(ItemCacheTest, DirectWritesPatchCachedItems) {
+    ItemCache cache(*db);
+    WishItem car = saveItem("Alice", "Toy Car", 19.99, Category::TOYS);
+    saveItem("Alice", "Novel", 14.99, Category::BOOKS);
+    EXPECT_EQ(cache.getStats("Alice").count, 2);
+
+    // Written through the handler, bypassing any manager
+    car.setPurchased(true);
+    car.setPrice(17.99);
+    ASSERT_TRUE(db->updateItem(car, "Alice"));
+
+    WishItem cached;
+    ASSERT_TRUE(cache.getItem(car.getId(), cached));
+    EXPECT_TRUE(cached.isPurchased());
+    EXPECT_DOUBLE_EQ(cached.getPrice(), 17.99);
+
+    ItemCache::Counters counters = cache.getCounters();
+    EXPECT_EQ(counters.loads, 1u);
+    EXPECT_EQ(counters.patchedRows, 1u);
+}
+
+TEST_F(ItemCacheTest, StatsFollowInsertsAndDeletesIncrementally) {
+    ItemCache cache(*db);
+    saveItem("Alice", "Lego", 80.0, Category::TOYS);
+    cache.getStats("Alice");
+
+    WishItem book = saveItem("Alice", "Novel", 14.99, Category::BOOKS);
+    saveItem("Alice", "Ball", 24.99, Category::SPORTS);
+    saveItem("Bob", "Elsewhere", 5.0, Category::OTHER);
+    ASSERT_TRUE(db->deleteItem(book.getId(), "Alice"));
+
+    expectSameStats(cache.getStats("Alice"), db->queryStats("Alice"));
+    EXPECT_FALSE(cache.isCached("Bob"));
+    EXPECT_EQ(cache.getCounters().loads, 1u);
+
+    std::vector<std::string> names;
+    cache.forEachItem("Alice", [&names](const WishItem &item) {
+        names.push_back(item.getName());
+        return true;
+    });
+    EXPECT_EQ(names, (std::vector<std::string>{"Lego", "Ball"}));
+}
+
+TEST_F(ItemCacheTest, RolledBackChangesAreNotPublished) {
+    ItemCache cache(*db);
+    saveItem("Alice", "Lego", 80.0, Category::TOYS);
+    cache.getStats("Alice");
+
+    ASSERT_TRUE(db->beginTransaction());
+    saveItem("Alice", "Never committed", 1.0, Category::OTHER);
+    ASSERT_TRUE(db->rollbackTransaction());
+
+    EXPECT_EQ(cache.getStats("Alice").count, 1);
+    EXPECT_EQ(cache.getCounters().patchedRows, 0u);
+}
+
+TEST_F(ItemCacheTest, ClearAndBackgroundWritesStayCoherent) {
+    ItemCache cache(*db);
+    for (int i = 0; i < 20; ++i) {
+        saveItem("Alice", "Item " + std::to_string(i), i, Category::OTHER);
+    }
+    EXPECT_EQ(cache.getStats("Alice").count, 20);
+
+    {
+        PersistenceQueue queue(*db);
+        WishItem queued("Queued", 3.0, Category::BOOKS);
+        queue.enqueueSaveItem(queued, "Alice");
+        ASSERT_TRUE(queue.flush());
+    }
+    EXPECT_EQ(cache.getStats("Alice").count, 21);
+
+    ASSERT_TRUE(db->clearAllData("Alice"));
+    ItemStats stats = cache.getStats("Alice");
+    EXPECT_EQ(stats.count, 0);
+    EXPECT_TRUE(stats.byCategory.empty());
+    EXPECT_EQ(cache.getCounters().loads, 1u);
+}
+
+TEST_F(ItemCacheTest, ListenerIsRemovedWithCache) {
+    {
+        ItemCache cache(*db);
+        cache.getStats("Alice");
+    }
+    // Would call into the destroyed cache if the listener were still registered
+    saveItem("Alice", "After", 1.0, Category::OTHER);
+    EXPECT_EQ(db->getTotalItemsCount("Alice"), 1);
+}
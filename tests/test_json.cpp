@@ -0,0 +1,132 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+#include <gtest/gtest.h>
+#include "../include/json.h"
+#include "../include/file_handler.h"
+#include "../include/logger.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace {
+    // Records the events as text, e.g. "{ k:name s:Bob }"
+    class RecordingHandler : public JsonHandler {
+    public:
+        std::string events;
+
+        bool startObject() override { return add("{"); }
+        bool endObject() override { return add("}"); }
+        bool startArray() override { return add("["); }
+        bool endArray() override { return add("]"); }
+        bool key(std::string_view name) override { return add("k:" + std::string(name)); }
+        bool string(std::string_view value) override { return add("s:" + std::string(value)); }
+
+        bool number(double value) override {
+            std::ostringstream text;
+            text << "n:" << value;
+            return add(text.str());
+        }
+
+        bool boolean(bool value) override { return add(value ? "true" : "false"); }
+        bool null() override { return add("null"); }
+
+    private:
+        bool add(const std::string &event) {
+            if (!events.empty()) events += ' ';
+            events += event;
+            return true;
+        }
+    };
+}
+
+class JsonTest : public ::testing::Test {
+protected:
+    std::string testJsonFile = "test_json_engine.json";
+
+    void SetUp() override {
+        Logger::getInstance().setLogLevel(LogLevel::NONE);
+        std::filesystem::remove(testJsonFile);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove(testJsonFile);
+    }
+};
+
+TEST_F(JsonTest, WriterEscapesAndSeparates) {
+    std::ostringstream out;
+    {
+        JsonWriter writer(out);
+        writer.beginObject()
+                .key("text").value("say \"hi\"\\\n\x01")
+                .key("list").beginArray().value(1).value(2.5).value(true).null().endArray()
+                .key("empty").beginObject().endObject()
+                .endObject();
+    }
+    EXPECT_EQ(out.str(), R"({"text":"say \"hi\"\\\n\u0001","list":[1,2.5,true,null],"empty":{}})");
+}
+
+TEST_F(JsonTest, ParserHandlesChunksSplitAnywhere) {
+    std::string document = R"( {"name": "Caf\u00e9 \"A\"", "n": [-12.5e1, 0, true, false, null],)"
+                           R"( "emoji": "\ud83c\udf84", "nested": {"a": []}} )";
+    std::string expected = "{ k:name s:Caf\xC3\xA9 \"A\" k:n [ n:-125 n:0 true false null ] "
+                           "k:emoji s:\xF0\x9F\x8E\x84 k:nested { k:a [ ] } }";
+
+    for (size_t chunkSize: {size_t(1), size_t(3), size_t(7), document.size()}) {
+        RecordingHandler handler;
+        JsonParser parser(handler);
+        for (size_t i = 0; i < document.size(); i += chunkSize) {
+            ASSERT_TRUE(parser.feed(std::string_view(document).substr(i, chunkSize))) << parser.getError();
+        }
+        ASSERT_TRUE(parser.finish()) << parser.getError();
+        EXPECT_EQ(handler.events, expected) << "chunk size " << chunkSize;
+    }
+}
+
+TEST_F(JsonTest, ParserRejectsMalformedInput) {
+    for (std::string document: {"{\"a\" 1}", "[1,]", "[1 2]", "{\"a\":tru}", "[\"open", "{} {}", "[1", "{\"a\":1]"}) {
+        RecordingHandler handler;
+        JsonParser parser(handler);
+        bool accepted = parser.feed(document) && parser.finish();
+        EXPECT_FALSE(accepted) << document;
+        EXPECT_FALSE(parser.getError().empty()) << document;
+    }
+}
+
+TEST_F(JsonTest, FileHandlerRoundTrip) {
+    WishlistManager original("Alice");
+    auto item = std::make_unique<WishItem>("Lego \"Castle\"", 0.1 + 0.2, Category::TOYS);
+    item->setNotes("Line one\nLine two, with comma");
+    item->setPriority(Priority::HIGH);
+    item->setPurchased(true);
+    original.addItem(std::move(item));
+    original.addItem(std::make_unique<WishItem>("Book", 12.0, Category::BOOKS));
+
+    FileHandler handler;
+    ASSERT_TRUE(handler.exportToJSON(original, testJsonFile));
+
+    WishlistManager imported("Alice");
+    ASSERT_TRUE(FileHandler::importFromJSON(imported, testJsonFile));
+    ASSERT_EQ(imported.getTotalItems(), 2);
+    const WishItem &loaded = *imported.getItems()[0];
+    EXPECT_EQ(loaded.getName(), "Lego \"Castle\"");
+    EXPECT_EQ(loaded.getPrice(), 0.1 + 0.2);
+    EXPECT_EQ(loaded.getNotes(), "Line one\nLine two, with comma");
+    EXPECT_EQ(loaded.getCategory(), Category::TOYS);
+    EXPECT_EQ(loaded.getPriority(), Priority::HIGH);
+    EXPECT_TRUE(loaded.isPurchased());
+    EXPECT_EQ(imported.getItems()[1]->getName(), "Book");
+}
+
+TEST_F(JsonTest, ImportRejectsTruncatedFile) {
+    WishlistManager original("Alice");
+    original.addItem(std::make_unique<WishItem>("Book", 12.0, Category::BOOKS));
+    FileHandler handler;
+    ASSERT_TRUE(handler.exportToJSON(original, testJsonFile));
+    std::filesystem::resize_file(testJsonFile, std::filesystem::file_size(testJsonFile) - 3);
+
+    WishlistManager imported("Alice");
+    EXPECT_FALSE(FileHandler::importFromJSON(imported, testJsonFile));
+    EXPECT_FALSE(FileHandler::importFromJSON(imported, "nonexistent.json"));
+}
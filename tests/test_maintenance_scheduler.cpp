@@ -0,0 +1,159 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+#include <gtest/gtest.h>
+#include "../include/maintenance_scheduler.h"
+#include "../include/database_handler.h"
+#include "../include/logger.h"
+#include <filesystem>
+
+class MaintenanceSchedulerTest : public ::testing::Test {
+protected:
+    std::string testDb = "test_maintenance.db";
+    std::unique_ptr<DatabaseHandler> db;
+
+    void SetUp() override {
+        Logger::getInstance().setLogLevel(LogLevel::NONE);
+        std::filesystem::remove(testDb);
+        db = std::make_unique<DatabaseHandler>(testDb);
+        ASSERT_TRUE(db->initialize());
+    }
+
+    void TearDown() override {
+        db.reset();
+        std::filesystem::remove(testDb);
+    }
+
+    static MaintenanceScheduler::Options immediateOptions() {
+        MaintenanceScheduler::Options options;
+        options.idleAfter = std::chrono::milliseconds(0);
+        options.analyzeAfterChanges = 100;
+        options.checkpointPages = 50;
+        return options;
+    }
+
+    void addBulkyItems(int count) {
+        db->beginTransaction();
+        for (int i = 0; i < count; ++i) {
+            WishItem item("Bulky " + std::to_string(i), i, Category::OTHER);
+            item.setNotes(std::string(2000, 'n'));
+            ASSERT_TRUE(db->saveItem(item, "Alice"));
+        }
+        db->commitTransaction();
+    }
+
+    int queryInt(const std::string &sql) {
+        sqlite3 *conn;
+        sqlite3_open(testDb.c_str(), &conn);
+        sqlite3_stmt *stmt;
+        sqlite3_prepare_v2(conn, sql.c_str(), -1, &stmt, nullptr);
+        int value = sqlite3_step(stmt) == SQLITE_ROW ? sqlite3_column_int(stmt, 0) : -1;
+        sqlite3_finalize(stmt);
+        sqlite3_close(conn);
+        return value;
+    }
+};
+
+TEST_F(MaintenanceSchedulerTest, NewDatabaseUsesIncrementalVacuumAndWal) {
+    EXPECT_EQ(queryInt("PRAGMA auto_vacuum;"), 2);
+    sqlite3 *conn;
+    sqlite3_open(testDb.c_str(), &conn);
+    sqlite3_stmt *stmt;
+    sqlite3_prepare_v2(conn, "PRAGMA journal_mode;", -1, &stmt, nullptr);
+    ASSERT_EQ(sqlite3_step(stmt), SQLITE_ROW);
+    EXPECT_STREQ(reinterpret_cast<const char *>(sqlite3_column_text(stmt, 0)), "wal");
+    sqlite3_finalize(stmt);
+    sqlite3_close(conn);
+}
+
+TEST_F(MaintenanceSchedulerTest, IdleVacuumReclaimsFreePagesInSlices) {
+    addBulkyItems(200);
+    ASSERT_TRUE(db->clearAllData("Alice"));
+
+    auto options = immediateOptions();
+    options.vacuumPagesPerSlice = 8;
+    options.maxSlicesPerRun = 1000;
+    MaintenanceScheduler scheduler(*db, options);
+    int freeBefore = scheduler.getFreePageCount();
+    ASSERT_GT(freeBefore, 8);
+
+    scheduler.runOnce();
+
+    MaintenanceStats stats = scheduler.getStats();
+    EXPECT_GT(stats.vacuumSlices, 1);
+    EXPECT_EQ(stats.pagesReclaimed, freeBefore);
+    EXPECT_EQ(scheduler.getFreePageCount(), 0);
+}
+
+TEST_F(MaintenanceSchedulerTest, VacuumWaitsForIdleTime) {
+    addBulkyItems(50);
+    ASSERT_TRUE(db->clearAllData("Alice"));
+
+    auto options = immediateOptions();
+    options.idleAfter = std::chrono::hours(1);
+    MaintenanceScheduler scheduler(*db, options);
+
+    scheduler.runOnce();
+    EXPECT_EQ(scheduler.getStats().vacuumSlices, 0);
+    EXPECT_GT(scheduler.getFreePageCount(), 0);
+}
+
+TEST_F(MaintenanceSchedulerTest, AnalyzeRunsAfterWriteBurstSettles) {
+    MaintenanceScheduler scheduler(*db, immediateOptions());
+    addBulkyItems(150);
+
+    scheduler.runOnce(); // Burst just happened
+    EXPECT_EQ(scheduler.getStats().analyzeRuns, 0);
+
+    scheduler.runOnce();
+    EXPECT_EQ(scheduler.getStats().analyzeRuns, 1);
+    EXPECT_GT(queryInt("SELECT COUNT(*) FROM sqlite_stat1;"), 0);
+
+    scheduler.runOnce(); // No new changes, nothing to do
+    EXPECT_EQ(scheduler.getStats().analyzeRuns, 1);
+}
+
+TEST_F(MaintenanceSchedulerTest, CheckpointReplacesAutoCheckpoint) {
+    MaintenanceScheduler scheduler(*db, immediateOptions());
+    addBulkyItems(100);
+    ASSERT_GE(scheduler.getWalPageCount(), 50);
+
+    scheduler.runOnce();
+
+    EXPECT_EQ(scheduler.getStats().checkpoints, 1);
+    EXPECT_EQ(scheduler.getWalPageCount(), 0);
+}
+
+TEST_F(MaintenanceSchedulerTest, BackgroundThreadRunsTasks) {
+    auto options = immediateOptions();
+    options.pollInterval = std::chrono::milliseconds(10);
+    MaintenanceScheduler scheduler(*db, options);
+    addBulkyItems(100);
+    ASSERT_TRUE(db->clearAllData("Alice"));
+
+    ASSERT_TRUE(scheduler.start());
+    for (int i = 0; i < 200 && scheduler.getFreePageCount() > 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    scheduler.stop();
+
+    EXPECT_EQ(scheduler.getFreePageCount(), 0);
+    EXPECT_GE(scheduler.getStats().checkpoints, 1);
+}
+
+TEST_F(MaintenanceSchedulerTest, FullVacuumConvertsLegacyDatabase) {
+    db.reset();
+    std::filesystem::remove(testDb);
+    sqlite3 *conn;
+    sqlite3_open(testDb.c_str(), &conn);
+    sqlite3_exec(conn, "CREATE TABLE legacy(x);", nullptr, nullptr, nullptr);
+    sqlite3_close(conn);
+    ASSERT_EQ(queryInt("PRAGMA auto_vacuum;"), 0);
+
+    db = std::make_unique<DatabaseHandler>(testDb);
+    ASSERT_TRUE(db->initialize());
+    EXPECT_EQ(queryInt("PRAGMA auto_vacuum;"), 0);
+
+    ASSERT_TRUE(db->vacuum());
+    EXPECT_EQ(queryInt("PRAGMA auto_vacuum;"), 2);
+}
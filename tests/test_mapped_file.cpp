@@ -0,0 +1,59 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+#include <gtest/gtest.h>
+#include "../include/mapped_file.h"
+#include "../include/logger.h"
+#include <fstream>
+#include <filesystem>
+
+class MappedFileTest : public ::testing::Test {
+protected:
+    std::string testFile = "test_mapped_file.dat";
+
+    void SetUp() override {
+        Logger::getInstance().setLogLevel(LogLevel::NONE);
+        std::filesystem::remove(testFile);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove(testFile);
+    }
+
+    static std::vector<std::string> linesOf(std::string_view text) {
+        std::vector<std::string> lines;
+        LineReader reader(text);
+        std::string_view line;
+        while (reader.next(line)) lines.emplace_back(line);
+        return lines;
+    }
+};
+
+TEST_F(MappedFileTest, MapsWholeFile) {
+    std::string content(100000, 'x');
+    content += "\nend";
+    std::ofstream(testFile, std::ios::binary) << content;
+
+    MappedFile file;
+    ASSERT_TRUE(file.open(testFile));
+    EXPECT_TRUE(file.isMapped());
+    EXPECT_EQ(file.view(), content);
+
+    MappedFile moved(std::move(file));
+    EXPECT_EQ(moved.size(), content.size());
+    EXPECT_TRUE(file.empty());
+}
+
+TEST_F(MappedFileTest, EmptyAndMissingFiles) {
+    std::ofstream(testFile).close();
+    MappedFile file;
+    EXPECT_TRUE(file.open(testFile));
+    EXPECT_TRUE(file.empty());
+    EXPECT_FALSE(file.open("does_not_exist.dat"));
+}
+
+TEST_F(MappedFileTest, LineReaderSplitsLines) {
+    EXPECT_EQ(linesOf("a\nb\r\n\nc"), (std::vector<std::string>{"a", "b", "", "c"}));
+    EXPECT_EQ(linesOf("a\n"), (std::vector<std::string>{"a"}));
+    EXPECT_TRUE(linesOf("").empty());
+}
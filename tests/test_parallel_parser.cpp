@@ -0,0 +1,54 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+#include <gtest/gtest.h>
+#include "../include/parallel_parser.h"
+#include <string>
+
+TEST(ParallelParserTest, ChunksEndAtLineBreaksAndCoverInput) {
+    std::string text;
+    for (int i = 0; i < 1000; ++i) text += "line " + std::to_string(i) + "\n";
+    text += "last line without break";
+
+    auto chunks = ParallelParser::splitChunks(text, 4, 1);
+    EXPECT_LE(chunks.size(), 4u);
+    EXPECT_GT(chunks.size(), 1u);
+
+    std::string joined;
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        if (i + 1 < chunks.size()) {
+            EXPECT_EQ(chunks[i].back(), '\n');
+        }
+        joined += chunks[i];
+    }
+    EXPECT_EQ(joined, text);
+}
+
+TEST(ParallelParserTest, SmallInputStaysInOneChunk) {
+    EXPECT_EQ(ParallelParser::splitChunks("a\nb\nc\n", 8).size(), 1u);
+    EXPECT_TRUE(ParallelParser::splitChunks("", 8).empty());
+    EXPECT_GE(ParallelParser::resolveThreads(0), 1u);
+}
+
+TEST(ParallelParserTest, BatchesComeBackInChunkOrder) {
+    std::string text;
+    for (int i = 0; i < 5000; ++i) text += std::to_string(i) + "\n";
+
+    auto batches = ParallelParser::parseChunks<std::vector<int> >(text, 6, [](std::string_view chunk) {
+        std::vector<int> numbers;
+        size_t start = 0;
+        while (start < chunk.size()) {
+            size_t end = chunk.find('\n', start);
+            numbers.push_back(std::stoi(std::string(chunk.substr(start, end - start))));
+            start = end + 1;
+        }
+        return numbers;
+    }, 64);
+
+    EXPECT_EQ(batches.size(), 6u);
+    int expected = 0;
+    for (const auto &batch: batches) {
+        for (int number: batch) EXPECT_EQ(number, expected++);
+    }
+    EXPECT_EQ(expected, 5000);
+}
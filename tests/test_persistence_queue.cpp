@@ -0,0 +1,222 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+#include <gtest/gtest.h>
+#include "../include/persistence_queue.h"
+#include "../include/database_handler.h"
+#include "../include/memory_store.h"
+#include "../include/wishlist_manager.h"
+#include "../include/logger.h"
+#include <filesystem>
+
+class PersistenceQueueTest : public ::testing::Test {
+protected:
+    std::string testDb = "test_persistence.db";
+
+    void SetUp() override {
+        Logger::getInstance().setLogLevel(LogLevel::NONE);
+        std::filesystem::remove(testDb);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove(testDb);
+    }
+
+    static PersistenceQueue::Options idleWriter() {
+        // Writer only runs on flush, so pending state can be inspected
+        PersistenceQueue::Options options;
+        options.batchSize = 100000;
+        options.maxPending = 100000;
+        options.flushInterval = std::chrono::milliseconds(60000);
+        return options;
+    }
+};
+
+// Fails the next failCommits commits, leaving the transaction to be rolled back
+class FlakyStore : public MemoryStore {
+public:
+    int failCommits = 0;
+
+    bool commitTransaction() override {
+        if (failCommits > 0) {
+            failCommits--;
+            return false;
+        }
+        return MemoryStore::commitTransaction();
+    }
+};
+
+TEST_F(PersistenceQueueTest, FlushMakesChangesVisible) {
+    DatabaseHandler db(testDb);
+    ASSERT_TRUE(db.initialize());
+    PersistenceQueue queue(db);
+
+    WishlistManager manager("QueueUser");
+    manager.setStore(&db);
+    manager.setPersistenceQueue(&queue);
+
+    manager.addItem(std::make_unique<WishItem>("Item1", 10.0));
+    manager.addItem(std::make_unique<WishItem>("Item2", 20.0));
+
+    EXPECT_TRUE(queue.flush());
+    EXPECT_EQ(db.loadItems("QueueUser").size(), 2u);
+}
+
+TEST_F(PersistenceQueueTest, NewItemsGetIdsBeforeWrite) {
+    DatabaseHandler db(testDb);
+    ASSERT_TRUE(db.initialize());
+    PersistenceQueue queue(db);
+
+    WishlistManager manager("QueueUser");
+    manager.setStore(&db);
+    manager.setPersistenceQueue(&queue);
+
+    auto item = std::make_unique<WishItem>();
+    item->setName("No ID yet");
+    manager.addItem(std::move(item));
+
+    int id = manager.getItems().back()->getId();
+    EXPECT_NE(id, 0);
+
+    ASSERT_TRUE(queue.flush());
+    auto loaded = db.loadItems("QueueUser");
+    ASSERT_EQ(loaded.size(), 1u);
+    EXPECT_EQ(loaded[0]->getId(), id);
+}
+
+TEST_F(PersistenceQueueTest, CoalescesRepeatedUpdates) {
+    DatabaseHandler db(testDb);
+    ASSERT_TRUE(db.initialize());
+    PersistenceQueue queue(db, idleWriter());
+
+    WishItem item("Coalesced", 1.0);
+    for (int i = 1; i <= 50; ++i) {
+        item.setPrice(i);
+        queue.enqueueSaveItem(item, "QueueUser");
+    }
+
+    EXPECT_EQ(queue.pendingCount(), 1u);
+    ASSERT_TRUE(queue.flush());
+
+    auto loaded = db.loadItems("QueueUser");
+    ASSERT_EQ(loaded.size(), 1u);
+    EXPECT_DOUBLE_EQ(loaded[0]->getPrice(), 50.0);
+    EXPECT_EQ(loaded[0]->getId(), item.getId());
+
+    // Deleting by the item's ID must hit the coalesced row
+    queue.enqueueDeleteItem(item.getId(), "QueueUser");
+    ASSERT_TRUE(queue.flush());
+    EXPECT_TRUE(db.loadItems("QueueUser").empty());
+}
+
+TEST_F(PersistenceQueueTest, DeleteReplacesPendingSave) {
+    DatabaseHandler db(testDb);
+    ASSERT_TRUE(db.initialize());
+    PersistenceQueue queue(db, idleWriter());
+
+    WishItem item("Short lived", 5.0);
+    queue.enqueueSaveItem(item, "QueueUser");
+    queue.enqueueDeleteItem(item.getId(), "QueueUser");
+
+    EXPECT_EQ(queue.pendingCount(), 1u);
+    ASSERT_TRUE(queue.flush());
+    EXPECT_TRUE(db.loadItems("QueueUser").empty());
+}
+
+TEST_F(PersistenceQueueTest, BackpressureBoundsQueue) {
+    DatabaseHandler db(testDb);
+    ASSERT_TRUE(db.initialize());
+
+    PersistenceQueue::Options options;
+    options.maxPending = 4;
+    options.batchSize = 1000;
+    options.flushInterval = std::chrono::milliseconds(1);
+    PersistenceQueue queue(db, options);
+
+    for (int i = 0; i < 40; ++i) {
+        queue.enqueueSaveItem(WishItem("Item " + std::to_string(i), i), "QueueUser");
+        EXPECT_LE(queue.pendingCount(), 4u);
+    }
+
+    ASSERT_TRUE(queue.flush());
+    EXPECT_EQ(db.loadItems("QueueUser").size(), 40u);
+}
+
+TEST_F(PersistenceQueueTest, BudgetIsWrittenBehind) {
+    DatabaseHandler db(testDb);
+    ASSERT_TRUE(db.initialize());
+    PersistenceQueue queue(db);
+
+    WishlistManager manager("QueueUser");
+    manager.setStore(&db);
+    manager.setPersistenceQueue(&queue);
+    manager.setBudget(250.0);
+
+    ASSERT_TRUE(manager.flushPendingWrites());
+    EXPECT_DOUBLE_EQ(db.loadBudget("QueueUser").getMaxBudget(), 250.0);
+}
+
+TEST_F(PersistenceQueueTest, StopCommitsRemainingChanges) {
+    DatabaseHandler db(testDb);
+    ASSERT_TRUE(db.initialize());
+    {
+        PersistenceQueue queue(db, idleWriter());
+        queue.enqueueSaveItem(WishItem("Written on stop", 3.0), "QueueUser");
+    }
+
+    EXPECT_EQ(db.loadItems("QueueUser").size(), 1u);
+}
+
+TEST_F(PersistenceQueueTest, MarkAsPurchasedIsPersisted) {
+    DatabaseHandler db(testDb);
+    ASSERT_TRUE(db.initialize());
+    PersistenceQueue queue(db);
+
+    WishlistManager manager("QueueUser");
+    manager.setStore(&db);
+    manager.setPersistenceQueue(&queue);
+    manager.addItem(std::make_unique<WishItem>("Gift", 15.0));
+    int id = manager.getItems().back()->getId();
+
+    EXPECT_TRUE(manager.markAsPurchased(id));
+    EXPECT_FALSE(manager.markAsPurchased(-1));
+    ASSERT_TRUE(queue.flush());
+
+    auto loaded = db.loadItems("QueueUser");
+    ASSERT_EQ(loaded.size(), 1u);
+    EXPECT_TRUE(loaded[0]->isPurchased());
+}
+
+TEST_F(PersistenceQueueTest, FailedCommitIsRetried) {
+    FlakyStore store;
+    store.failCommits = 1;
+    PersistenceQueue::Options options = idleWriter();
+    options.retryDelay = std::chrono::milliseconds(1);
+    PersistenceQueue queue(store, options);
+
+    queue.enqueueSaveItem(WishItem("Retried", 5.0), "QueueUser");
+    queue.enqueueSaveBudget(Budget(), "QueueUser");
+
+    EXPECT_TRUE(queue.flush());
+    EXPECT_EQ(store.failCommits, 0);
+    EXPECT_EQ(store.loadItems("QueueUser").size(), 1u);
+}
+
+TEST_F(PersistenceQueueTest, DroppedBatchIsReportedToFlush) {
+    FlakyStore store;
+    store.failCommits = 2;
+    PersistenceQueue::Options options = idleWriter();
+    options.commitAttempts = 2;
+    options.retryDelay = std::chrono::milliseconds(1);
+    PersistenceQueue queue(store, options);
+
+    queue.enqueueSaveItem(WishItem("Lost", 5.0), "QueueUser");
+
+    EXPECT_FALSE(queue.flush());
+    EXPECT_FALSE(store.userExists("QueueUser"));
+
+    // The failure is reported once; later batches start clean
+    queue.enqueueSaveItem(WishItem("Kept", 6.0), "QueueUser");
+    EXPECT_TRUE(queue.flush());
+    EXPECT_EQ(store.loadItems("QueueUser").size(), 1u);
+}
@@ -0,0 +1,64 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+#include <gtest/gtest.h>
+#include "../include/database_handler.h"
+#include "../include/logger.h"
+#include <filesystem>
+#include <set>
+
+// Runs EXPLAIN QUERY PLAN for every statement in DatabaseHandler::statementCatalog()
+// and fails on full table scans. Scans of a covering index are allowed, since only
+// listing all users needs one and it never touches the table itself. FTS5 lookups
+// show up as a scan of the virtual table with an index constraint and are fine too.
+// Maintenance statements listed in allowedScans intentionally visit every row.
+class QueryPlanTest : public ::testing::Test {
+protected:
+    std::string testDb = "test_query_plan.db";
+    std::unique_ptr<DatabaseHandler> db;
+
+    void SetUp() override {
+        Logger::getInstance().setLogLevel(LogLevel::NONE);
+        std::filesystem::remove(testDb);
+        db = std::make_unique<DatabaseHandler>(testDb);
+        ASSERT_TRUE(db->initialize());
+    }
+
+    void TearDown() override {
+        db.reset();
+        std::filesystem::remove(testDb);
+    }
+
+    const std::set<std::string> allowedScans = {"COMPACT_PRICE_HISTORY", "CHECK_USER_STATS",
+                                                  "CHECK_CATEGORY_STATS"};
+
+    static bool isFullScan(const std::string &detail) {
+        if (detail.rfind("SCAN ", 0) != 0) return false;
+        return detail.find("COVERING INDEX") == std::string::npos &&
+               detail.find("VIRTUAL TABLE INDEX") == std::string::npos;
+    }
+};
+
+TEST_F(QueryPlanTest, CatalogIsNotEmpty) {
+    EXPECT_GT(DatabaseHandler::statementCatalog().size(), 10u);
+}
+
+TEST_F(QueryPlanTest, NoStatementDoesFullTableScan) {
+    for (const auto &[name, sql]: DatabaseHandler::statementCatalog()) {
+        if (allowedScans.count(name)) continue;
+
+        std::vector<std::string> plan;
+        ASSERT_TRUE(db->explainQueryPlan(sql, plan)) << name << " could not be explained: " << sql;
+
+        for (const auto &detail: plan) {
+            EXPECT_FALSE(isFullScan(detail)) << name << " does a full scan (" << detail << "): " << sql;
+        }
+    }
+}
+
+TEST_F(QueryPlanTest, StatisticsUseCoveringIndex) {
+    std::vector<std::string> plan;
+    ASSERT_TRUE(db->explainQueryPlan(DatabaseHandler::buildStatsSql(ItemQuery()), plan));
+    ASSERT_FALSE(plan.empty());
+    EXPECT_NE(plan[0].find("COVERING INDEX idx_items_user_category"), std::string::npos) << plan[0];
+}
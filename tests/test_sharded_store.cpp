@@ -0,0 +1,181 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+#include <gtest/gtest.h>
+#include "../include/sharded_store.h"
+#include "../include/database_handler.h"
+#include "../include/logger.h"
+#include <filesystem>
+#include <set>
+#include <thread>
+
+class ShardedStoreTest : public ::testing::Test {
+protected:
+    std::string directory = "test_sharded_store";
+    std::string basePath = directory + "/wishlist.db";
+
+    void SetUp() override {
+        Logger::getInstance().setLogLevel(LogLevel::NONE);
+        std::filesystem::remove_all(directory);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(directory);
+    }
+
+    static int save(ShardedStore &store, const std::string &owner, const std::string &name, double price) {
+        WishItem item(name, price, Category::OTHER);
+        EXPECT_TRUE(store.saveItem(item, owner));
+        return item.getId();
+    }
+};
+
+TEST_F(ShardedStoreTest, OwnersStayOnTheirShard) {
+    EXPECT_EQ(ShardedStore::shardIndex("Alice", 4), ShardedStore::shardIndex("Alice", 4));
+
+    ShardedStore store(basePath, 4);
+    ASSERT_TRUE(store.initialize());
+    ASSERT_EQ(store.getShardCount(), 4u);
+    EXPECT_EQ(store.shardPath(2), (std::filesystem::path(directory) / "wishlist.shard2.db").string());
+
+    std::vector<std::string> owners = {"Alice", "Bob", "Carol", "Dave", "Eve", "Frank", "Grace", "Heidi"};
+    for (const auto &owner: owners) {
+        save(store, owner, "Gift for " + owner, 10.0);
+    }
+
+    std::set<size_t> usedShards;
+    for (const auto &owner: owners) {
+        size_t home = ShardedStore::shardIndex(owner, 4);
+        usedShards.insert(home);
+        for (size_t i = 0; i < store.getShardCount(); ++i) {
+            EXPECT_EQ(store.getShard(i).userExists(owner), i == home) << owner << " on shard " << i;
+        }
+        EXPECT_EQ(store.loadItems(owner).size(), 1u);
+    }
+    EXPECT_GT(usedShards.size(), 1u);
+}
+
+TEST_F(ShardedStoreTest, CrossShardQueriesSeeAllShards) {
+    std::set<int> ids;
+    {
+        ShardedStore store(basePath, 3);
+        ASSERT_TRUE(store.initialize());
+        for (const std::string owner: {"Zoe", "Alice", "Mallory", "Bob"}) {
+            ids.insert(save(store, owner, "First", 1.0));
+            ids.insert(save(store, owner, "Second", 2.0));
+        }
+        EXPECT_EQ(store.getAllUsers(), (std::vector<std::string>{"Alice", "Bob", "Mallory", "Zoe"}));
+        EXPECT_EQ(ids.size(), 8u); // No ID is handed out twice across shards
+        EXPECT_EQ(store.getGlobalMaxItemId(), *ids.rbegin());
+    }
+
+    // The ID counter resumes after the largest ID of any shard
+    ShardedStore reopened(basePath, 3);
+    ASSERT_TRUE(reopened.initialize());
+    EXPECT_GT(save(reopened, "Alice", "Third", 3.0), *ids.rbegin());
+}
+
+TEST_F(ShardedStoreTest, RejectsDifferentShardCount) {
+    {
+        ShardedStore store(basePath, 4);
+        ASSERT_TRUE(store.initialize());
+        save(store, "Alice", "Gift", 1.0);
+    }
+    ShardedStore resharded(basePath, 2);
+    EXPECT_FALSE(resharded.initialize());
+}
+
+TEST_F(ShardedStoreTest, RollbackUndoesEveryTouchedShard) {
+    ShardedStore store(basePath, 4);
+    ASSERT_TRUE(store.initialize());
+    save(store, "Alice", "Kept", 1.0);
+
+    ASSERT_TRUE(store.beginTransaction());
+    save(store, "Alice", "Dropped", 2.0);
+    save(store, "Bob", "Dropped", 2.0);
+    save(store, "Carol", "Dropped", 2.0);
+    ASSERT_TRUE(store.rollbackTransaction());
+
+    EXPECT_EQ(store.loadItems("Alice").size(), 1u);
+    EXPECT_TRUE(store.loadItems("Bob").empty());
+    EXPECT_TRUE(store.loadItems("Carol").empty());
+
+    ASSERT_TRUE(store.beginTransaction());
+    save(store, "Bob", "Committed", 3.0);
+    ASSERT_TRUE(store.commitTransaction());
+    EXPECT_EQ(store.loadItems("Bob").size(), 1u);
+}
+
+TEST_F(ShardedStoreTest, ConcurrentWritersOfDifferentOwners) {
+    ShardedStore store(basePath, 4);
+    ASSERT_TRUE(store.initialize());
+
+    const int itemsPerOwner = 50;
+    std::vector<std::string> owners = {"Alice", "Bob", "Carol", "Dave"};
+    std::vector<std::thread> writers;
+    for (const auto &owner: owners) {
+        writers.emplace_back([&store, owner, itemsPerOwner] {
+            for (int i = 0; i < itemsPerOwner; ++i) {
+                // ID 0, so the store assigns it
+                WishItem item;
+                item.setName("Item " + std::to_string(i));
+                item.setPrice(i);
+                EXPECT_TRUE(store.saveItem(item, owner));
+                EXPECT_NE(item.getId(), 0);
+            }
+        });
+    }
+    for (auto &writer: writers) writer.join();
+
+    std::set<int> ids;
+    for (const auto &owner: owners) {
+        auto items = store.loadItems(owner);
+        EXPECT_EQ(items.size(), static_cast<size_t>(itemsPerOwner));
+        for (const auto &item: items) ids.insert(item->getId());
+    }
+    EXPECT_EQ(ids.size(), owners.size() * itemsPerOwner);
+    EXPECT_EQ(store.getGlobalMaxItemId(), *ids.rbegin());
+}
+
+TEST_F(ShardedStoreTest, TransactionsBelongToTheirThread) {
+    ShardedStore store(basePath, 2);
+    ASSERT_TRUE(store.initialize());
+    std::string neighbour = "Bob";
+    for (int i = 0; ShardedStore::shardIndex(neighbour, 2) != ShardedStore::shardIndex("Alice", 2); ++i) {
+        neighbour = "Bob" + std::to_string(i);
+    }
+
+    ASSERT_TRUE(store.beginTransaction());
+    save(store, "Alice", "Dropped", 1.0);
+
+    // Another thread's transaction is its own; its write to the same shard
+    // waits for the first transaction instead of joining it
+    std::thread other([&store, &neighbour] {
+        EXPECT_TRUE(store.beginTransaction());
+        save(store, neighbour, "Kept", 2.0);
+        EXPECT_TRUE(store.commitTransaction());
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_TRUE(store.loadItems(neighbour).empty());
+    ASSERT_TRUE(store.rollbackTransaction());
+    other.join();
+
+    EXPECT_TRUE(store.loadItems("Alice").empty());
+    EXPECT_EQ(store.loadItems(neighbour).size(), 1u);
+}
+
+TEST_F(ShardedStoreTest, IdOfAnotherShardIsRejected) {
+    ShardedStore store(basePath, 4);
+    ASSERT_TRUE(store.initialize());
+    std::string elsewhere = "Bob";
+    for (int i = 0; ShardedStore::shardIndex(elsewhere, 4) == ShardedStore::shardIndex("Alice", 4); ++i) {
+        elsewhere = "Bob" + std::to_string(i);
+    }
+    int aliceId = save(store, "Alice", "Alice's", 1.0);
+
+    WishItem copy("Copy", 2.0, Category::OTHER);
+    copy.setId(aliceId);
+    EXPECT_FALSE(store.saveItem(copy, elsewhere));
+    EXPECT_TRUE(store.loadItems(elsewhere).empty());
+    EXPECT_EQ(store.loadItems("Alice").size(), 1u);
+}
@@ -0,0 +1,122 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+#include <gtest/gtest.h>
+#include "../include/snapshot.h"
+#include "../include/crc32c.h"
+#include "../include/file_handler.h"
+#include "../include/logger.h"
+#include <fstream>
+#include <filesystem>
+
+class SnapshotTest : public ::testing::Test {
+protected:
+    std::string testFile = "test_snapshot.dat";
+
+    void SetUp() override {
+        Logger::getInstance().setLogLevel(LogLevel::NONE);
+        std::filesystem::remove(testFile);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove(testFile);
+    }
+
+    static void fillSample(WishlistManager &manager) {
+        manager.setOwner("Owner | with\nbreak");
+        manager.getBudget().setMaxBudget(250.0);
+        auto item = std::make_unique<WishItem>("Name | with | pipes", 19.99, Category::BOOKS);
+        item->setNotes("Line one\nLine two");
+        item->setPriority(Priority::URGENT);
+        manager.addItem(std::move(item));
+        auto second = std::make_unique<WishItem>("Bike", 399.0, Category::SPORTS);
+        second->setPurchased(true);
+        second->setLink("https://example.com/bike");
+        manager.addItem(std::move(second));
+    }
+};
+
+TEST_F(SnapshotTest, Crc32cKnownValues) {
+    EXPECT_EQ(crc32c("123456789"), 0xE3069283u);
+    EXPECT_EQ(crc32c(""), 0u);
+    // Checksumming in pieces gives the same result
+    EXPECT_EQ(crc32c("6789", crc32c("12345")), 0xE3069283u);
+    std::string longText(1000, 'a');
+    EXPECT_EQ(crc32c(std::string_view(longText).substr(3)), crc32c(longText.substr(3)));
+}
+
+TEST_F(SnapshotTest, RoundTripKeepsSeparatorsAndLineBreaks) {
+    WishlistManager original("Temp");
+    fillSample(original);
+    std::string snapshot = Snapshot::encode(original);
+    EXPECT_TRUE(Snapshot::isSnapshot(snapshot));
+
+    WishlistManager loaded("Temp");
+    ASSERT_EQ(Snapshot::decode(snapshot, loaded), 2);
+    EXPECT_EQ(loaded.getOwner(), original.getOwner());
+    EXPECT_DOUBLE_EQ(loaded.getBudget().getMaxBudget(), 250.0);
+    EXPECT_TRUE(loaded.getBudget().isEnabled());
+
+    for (size_t i = 0; i < 2; ++i) {
+        const WishItem &a = *original.getItems()[i];
+        const WishItem &b = *loaded.getItems()[i];
+        EXPECT_EQ(b.getId(), a.getId());
+        EXPECT_EQ(b.getName(), a.getName());
+        EXPECT_DOUBLE_EQ(b.getPrice(), a.getPrice());
+        EXPECT_EQ(b.isPurchased(), a.isPurchased());
+        EXPECT_EQ(b.getCategory(), a.getCategory());
+        EXPECT_EQ(b.getPriority(), a.getPriority());
+        EXPECT_EQ(b.getNotes(), a.getNotes());
+        EXPECT_EQ(b.getLink(), a.getLink());
+    }
+}
+
+TEST_F(SnapshotTest, RejectsCorruptionAndTruncation) {
+    WishlistManager original("Temp");
+    fillSample(original);
+    std::string snapshot = Snapshot::encode(original);
+
+    for (size_t position: {size_t(9), size_t(60), snapshot.size() / 2, snapshot.size() - 6}) {
+        std::string corrupt = snapshot;
+        corrupt[position] ^= 0x40;
+        WishlistManager manager("Untouched");
+        EXPECT_EQ(Snapshot::decode(corrupt, manager), -1) << "flipped byte " << position;
+        EXPECT_EQ(manager.getOwner(), "Untouched");
+        EXPECT_EQ(manager.getTotalItems(), 0);
+    }
+    for (size_t length: {size_t(4), size_t(40), snapshot.size() - 1}) {
+        WishlistManager manager("Untouched");
+        EXPECT_EQ(Snapshot::decode(std::string_view(snapshot).substr(0, length), manager), -1);
+    }
+}
+
+TEST_F(SnapshotTest, FileHandlerDetectsFormat) {
+    WishlistManager original("Temp");
+    fillSample(original);
+    FileHandler handler(testFile);
+    handler.setFormat(FileFormat::BINARY);
+    ASSERT_TRUE(handler.save(original));
+
+    // A handler set to text still reads the snapshot
+    WishlistManager loaded("Temp");
+    ASSERT_TRUE(FileHandler(testFile).load(loaded));
+    EXPECT_EQ(loaded.getTotalItems(), 2);
+    EXPECT_EQ(loaded.getItems()[0]->getNotes(), "Line one\nLine two");
+
+    loaded.setOwner("Alice");
+    ASSERT_TRUE(FileHandler(testFile).save(loaded));
+    WishlistManager reloaded("Temp");
+    ASSERT_TRUE(handler.load(reloaded));
+    EXPECT_EQ(reloaded.getOwner(), "Alice");
+
+    std::string corrupt;
+    {
+        handler.save(original);
+        std::ifstream in(testFile, std::ios::binary);
+        corrupt.assign(std::istreambuf_iterator<char>(in), {});
+    }
+    corrupt[corrupt.size() - 1] ^= 1;
+    std::ofstream(testFile, std::ios::binary) << corrupt;
+    WishlistManager rejected("Temp");
+    EXPECT_FALSE(handler.load(rejected));
+}
@@ -0,0 +1,98 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+#include <gtest/gtest.h>
+#include "../include/sql_functions.h"
+#include "../include/database_handler.h"
+#include "../include/logger.h"
+#include <filesystem>
+
+// Evaluates SQL on a bare connection with the functions registered
+class SqlFunctionsTest : public ::testing::Test {
+protected:
+    sqlite3 *db = nullptr;
+
+    void SetUp() override {
+        Logger::getInstance().setLogLevel(LogLevel::NONE);
+        ASSERT_EQ(sqlite3_open(":memory:", &db), SQLITE_OK);
+        ASSERT_TRUE(SqlFunctions::registerAll(db));
+    }
+
+    void TearDown() override {
+        sqlite3_close(db);
+    }
+
+    std::string text(const std::string &sql, int column = 0) {
+        sqlite3_stmt *stmt;
+        EXPECT_EQ(sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr), SQLITE_OK) << sqlite3_errmsg(db);
+        std::string result = "<none>";
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            const unsigned char *value = sqlite3_column_text(stmt, column);
+            result = value ? reinterpret_cast<const char *>(value) : "NULL";
+        }
+        sqlite3_finalize(stmt);
+        return result;
+    }
+};
+
+TEST_F(SqlFunctionsTest, ScalarResults) {
+    EXPECT_EQ(text("SELECT category_name(1);"), WishItem::categoryToString(static_cast<Category>(1)));
+    EXPECT_EQ(text("SELECT category_name(NULL);"), "NULL");
+    EXPECT_EQ(text("SELECT fold_case('LEGO Star Wars ÄÖÜ');"), "lego star wars äöü");
+    EXPECT_EQ(text("SELECT price_bucket(24.99, 10);"), "20.0");
+    EXPECT_EQ(text("SELECT price_bucket(24.99, 0);"), "NULL");
+    EXPECT_EQ(text("SELECT trigram_sim('Lego', 'lego');"), "1.0");
+    EXPECT_EQ(text("SELECT trigram_sim('Lego', 'Puzzle');"), "0.0");
+}
+
+TEST_F(SqlFunctionsTest, TrigramSimilarityToleratesTyposAndWordOrder) {
+    double typo = SqlFunctions::trigramSimilarity("Nintendo Switch", "nintedo swich");
+    double unrelated = SqlFunctions::trigramSimilarity("Nintendo Switch", "Coffee Grinder");
+    EXPECT_GT(typo, 0.3);
+    EXPECT_LT(unrelated, 0.1);
+    EXPECT_DOUBLE_EQ(SqlFunctions::trigramSimilarity("red bike", "bike red"), 1.0);
+    EXPECT_DOUBLE_EQ(SqlFunctions::trigramSimilarity("", ""), 0.0);
+}
+
+TEST_F(SqlFunctionsTest, UsableInExpressionIndexes) {
+    ASSERT_EQ(sqlite3_exec(db, "CREATE TABLE t (name TEXT);"
+                           "CREATE INDEX idx_t_folded ON t (fold_case(name));"
+                           "INSERT INTO t VALUES ('Board Game'), ('BOARD GAME'), ('Kite');",
+                           nullptr, nullptr, nullptr), SQLITE_OK) << sqlite3_errmsg(db);
+    EXPECT_EQ(text("SELECT COUNT(*) FROM t WHERE fold_case(name) = 'board game';"), "2");
+    EXPECT_NE(text("EXPLAIN QUERY PLAN SELECT * FROM t WHERE fold_case(name) = 'x';", 3).find("idx_t_folded"),
+              std::string::npos);
+}
+
+TEST(DatabaseHandlerSqlFunctionsTest, FuzzySearchAndHistogram) {
+    Logger::getInstance().setLogLevel(LogLevel::NONE);
+    std::string testDb = "test_sql_functions.db";
+    std::filesystem::remove(testDb);
+    {
+        DatabaseHandler db(testDb);
+        ASSERT_TRUE(db.initialize());
+        for (const auto &[name, price]: std::vector<std::pair<std::string, double> >{
+                 {"Nintendo Switch", 299.0}, {"Switch Case", 19.0}, {"Lego Castle", 89.0}, {"Socks", 5.0}}) {
+            WishItem item(name, price, Category::OTHER);
+            ASSERT_TRUE(db.saveItem(item, "Alice"));
+        }
+
+        auto found = db.fuzzySearchItems("Alice", "nintedo swich");
+        ASSERT_FALSE(found.empty());
+        EXPECT_EQ(found[0]->getName(), "Nintendo Switch");
+        for (const auto &item: found) {
+            EXPECT_NE(item->getName(), "Socks");
+        }
+        EXPECT_TRUE(db.fuzzySearchItems("Bob", "switch").empty());
+
+        auto bins = db.getPriceHistogram("Alice", 50.0);
+        ASSERT_EQ(bins.size(), 3u);
+        EXPECT_DOUBLE_EQ(bins[0].lowerBound, 0.0);
+        EXPECT_EQ(bins[0].count, 2);
+        EXPECT_DOUBLE_EQ(bins[0].totalValue, 24.0);
+        EXPECT_DOUBLE_EQ(bins[1].lowerBound, 50.0);
+        EXPECT_DOUBLE_EQ(bins[2].lowerBound, 250.0);
+        EXPECT_TRUE(db.getPriceHistogram("Alice", 0.0).empty());
+    }
+    std::filesystem::remove(testDb);
+}
@@ -5,6 +5,9 @@
 #include <gtest/gtest.h>
 #include "../include/wishlist.h"
 #include "../include/logger.h"
+#include <set>
+#include <thread>
+#include <vector>
 
 class WishItemTest : public ::testing::Test {
 protected:
@@ -294,4 +297,35 @@ TEST_F(WishItemTest, VeryLongName) {
 TEST_F(WishItemTest, SpecialCharactersInName) {
     WishItem item("Item with | pipe & special <> chars", 10.0);
     EXPECT_EQ(item.getName(), "Item with | pipe & special <> chars");
-}
\ No newline at end of file
+}
+
+TEST_F(WishItemTest, IdsStayUniqueAcrossThreads) {
+    // Loads on other threads raise the counter while items are created
+    int base = WishItem::getNextId();
+    std::vector<std::vector<int> > ids(4);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < ids.size(); ++t) {
+        threads.emplace_back([&ids, t, base] {
+            for (int i = 0; i < 2000; ++i) {
+                WishItem::reserveId(base + 3 * i);
+                ids[t].push_back(WishItem("Threaded", 1.0).getId());
+            }
+        });
+    }
+    for (auto &thread: threads) {
+        thread.join();
+    }
+
+    std::set<int> unique;
+    for (const auto &list: ids) {
+        unique.insert(list.begin(), list.end());
+    }
+    EXPECT_EQ(unique.size(), 4u * 2000u);
+    EXPECT_GT(WishItem::getNextId(), base + 3 * 1999);
+    EXPECT_GT(WishItem::getNextId(), *unique.rbegin());
+
+    // Never lowers the counter
+    int next = WishItem::getNextId();
+    WishItem::reserveId(base);
+    EXPECT_EQ(WishItem::getNextId(), next);
+}
@@ -3,6 +3,7 @@
 //
 #include <gtest/gtest.h>
 #include "../include/wishlist_manager.h"
+#include "../include/item_query.h"
 #include "../include/logger.h"
 
 class WishlistManagerTest : public ::testing::Test {
@@ -74,6 +75,22 @@ TEST_F(WishlistManagerTest, RemoveNonExistentItem) {
     EXPECT_EQ(manager.getTotalItems(), 1);
 }
 
+TEST_F(WishlistManagerTest, UpdateItemKeepsId) {
+    WishlistManager manager("TestUser");
+
+    auto item = std::make_unique<WishItem>("Test", 10.0);
+    int id = item->getId();
+    manager.addItem(std::move(item));
+
+    EXPECT_TRUE(manager.updateItem(id, [](WishItem &changed) {
+        changed.setName("Renamed");
+        changed.setId(0);
+    }));
+    ASSERT_NE(manager.findById(id), nullptr);
+    EXPECT_EQ(manager.findById(id)->getName(), "Renamed");
+    EXPECT_FALSE(manager.updateItem(9999, [](WishItem &) {}));
+}
+
 // ==================== Find Tests ====================
 
 TEST_F(WishlistManagerTest, FindByIdExists) {
@@ -228,6 +245,32 @@ TEST_F(WishlistManagerTest, GetRemainingValue) {
     EXPECT_DOUBLE_EQ(manager.getRemainingValue(), 20.0);
 }
 
+TEST_F(WishlistManagerTest, StatsAndQueriesWithoutStore) {
+    WishlistManager manager("TestUser");
+
+    auto item1 = std::make_unique<WishItem>("Item1", 10.0, Category::BOOKS);
+    auto item2 = std::make_unique<WishItem>("Item2", 30.0, Category::TOYS);
+    auto item3 = std::make_unique<WishItem>("Item3", 20.0, Category::TOYS);
+    item1->setPurchased(true);
+    manager.addItem(std::move(item1));
+    manager.addItem(std::move(item2));
+    manager.addItem(std::move(item3));
+
+    ItemStats stats = manager.getStats();
+    EXPECT_EQ(stats.count, 3);
+    EXPECT_EQ(stats.purchasedCount, 1);
+    EXPECT_DOUBLE_EQ(stats.totalValue, 60.0);
+
+    ItemQuery query;
+    query.category = Category::TOYS;
+    query.order = SortOrder::BY_PRICE_ASC;
+    auto toys = manager.findItems(query);
+    ASSERT_EQ(toys.size(), 2u);
+    EXPECT_EQ(toys[0]->getName(), "Item3");
+    EXPECT_EQ(toys[1]->getName(), "Item2");
+    EXPECT_EQ(manager.getStats(query).count, 2);
+}
+
 // ==================== Sort Tests ====================
 
 TEST_F(WishlistManagerTest, SortByPrice) {
@@ -0,0 +1,521 @@
+//
+// Created by Fabian Kopf on 18.10.26.
+//
+#include <gtest/gtest.h>
+#include "../include/wishlist_store.h"
+#include "../include/file_store.h"
+#include "../include/persistence_queue.h"
+#include "../include/logger.h"
+#include <filesystem>
+#include <fstream>
+#include <algorithm>
+#include <thread>
+
+// Runs the same workload against every backend
+class WishlistStoreTest : public ::testing::TestWithParam<std::string> {
+protected:
+    std::string location;
+    std::unique_ptr<IWishlistStore> store;
+
+    void SetUp() override {
+        Logger::getInstance().setLogLevel(LogLevel::NONE);
+        if (GetParam() == "sqlite") {
+            location = "test_store.db";
+        } else if (GetParam() == "sharded") {
+            location = "test_store_shards/wishlist.db";
+        } else {
+            location = "test_store_files";
+        }
+        removeData();
+        store = IWishlistStore::create(GetParam(), location);
+        ASSERT_NE(store, nullptr);
+        ASSERT_TRUE(store->initialize());
+    }
+
+    void TearDown() override {
+        store.reset();
+        removeData();
+    }
+
+    void removeData() {
+        std::filesystem::path path(location);
+        std::filesystem::remove_all(GetParam() == "sharded" ? path.parent_path() : path);
+    }
+
+    // Saves and returns the stored item's ID
+    int save(const std::string &owner, const std::string &name, double price, Category category,
+             bool purchased = false) {
+        WishItem item(name, price, category);
+        item.setPurchased(purchased);
+        EXPECT_TRUE(store->saveItem(item, owner));
+        return item.getId();
+    }
+
+    void saveDiverseItems(const std::string &owner) {
+        save(owner, "Toy Car", 19.99, Category::TOYS);
+        save(owner, "Novel", 14.99, Category::BOOKS, true);
+        save(owner, "Laptop", 999.99, Category::ELECTRONICS);
+        save(owner, "T-Shirt", 29.99, Category::CLOTHING, true);
+        save(owner, "Soccer Ball", 24.99, Category::SPORTS);
+    }
+
+    static std::vector<std::string> names(const std::vector<std::unique_ptr<WishItem> > &items) {
+        std::vector<std::string> result;
+        for (const auto &item: items) result.push_back(item->getName());
+        return result;
+    }
+};
+
+TEST_P(WishlistStoreTest, SaveUpsertsAndLoadsInIdOrder) {
+    int carId = save("Alice", "Toy Car", 19.99, Category::TOYS);
+    save("Alice", "Novel", 14.99, Category::BOOKS);
+
+    WishItem update("Race Car", 24.99, Category::TOYS);
+    update.setId(carId);
+    ASSERT_TRUE(store->saveItem(update, "Alice"));
+
+    auto items = store->loadItems("Alice");
+    ASSERT_EQ(items.size(), 2u);
+    EXPECT_EQ(items[0]->getId(), carId);
+    EXPECT_EQ(items[0]->getName(), "Race Car");
+    EXPECT_DOUBLE_EQ(items[0]->getPrice(), 24.99);
+    EXPECT_TRUE(store->userExists("Alice"));
+    EXPECT_GE(store->getGlobalMaxItemId(), carId);
+}
+
+TEST_P(WishlistStoreTest, NewItemsReportTheirAssignedId) {
+    WishItem first;
+    first.setName("First");
+    WishItem second;
+    second.setName("Second");
+    ASSERT_TRUE(store->saveItem(first, "Alice"));
+    ASSERT_TRUE(store->saveItem(second, "Alice"));
+    EXPECT_NE(first.getId(), 0);
+    EXPECT_NE(second.getId(), first.getId());
+
+    auto items = store->loadItems("Alice");
+    ASSERT_EQ(items.size(), 2u);
+    EXPECT_EQ(items[0]->getId(), first.getId());
+    EXPECT_EQ(items[1]->getId(), second.getId());
+
+    // Saving again updates the row instead of adding one
+    second.setPrice(5.0);
+    ASSERT_TRUE(store->saveItem(second, "Alice"));
+    EXPECT_EQ(store->loadItems("Alice").size(), 2u);
+}
+
+TEST_P(WishlistStoreTest, SaveRejectsIdOfAnotherOwner) {
+    int aliceId = save("Alice", "Alice's", 1.0, Category::OTHER);
+
+    WishItem taken("Bob's", 2.0, Category::OTHER);
+    taken.setId(aliceId);
+    EXPECT_FALSE(store->saveItem(taken, "Bob"));
+
+    auto items = store->loadItems("Alice");
+    ASSERT_EQ(items.size(), 1u);
+    EXPECT_EQ(items[0]->getName(), "Alice's");
+    EXPECT_TRUE(store->loadItems("Bob").empty());
+}
+
+TEST_P(WishlistStoreTest, DeleteAndClearAreScopedToOwner) {
+    int aliceId = save("Alice", "Shared Name", 1.0, Category::OTHER);
+    save("Bob", "Shared Name", 2.0, Category::OTHER);
+
+    EXPECT_FALSE(store->deleteItem(aliceId, "Nobody"));
+    EXPECT_TRUE(store->deleteItem(aliceId, "Bob")); // Matches nothing
+    EXPECT_EQ(store->loadItems("Alice").size(), 1u);
+    EXPECT_TRUE(store->deleteItem(aliceId, "Alice"));
+    EXPECT_TRUE(store->loadItems("Alice").empty());
+
+    ASSERT_TRUE(store->clearAllData("Bob"));
+    EXPECT_TRUE(store->loadItems("Bob").empty());
+    EXPECT_TRUE(store->userExists("Bob"));
+}
+
+TEST_P(WishlistStoreTest, FindItemsFiltersSortsAndPages) {
+    saveDiverseItems("Alice");
+    saveDiverseItems("Bob");
+
+    ItemQuery query;
+    query.purchased = false;
+    query.order = SortOrder::BY_PRICE_DESC;
+    EXPECT_EQ(names(store->findItems("Alice", query)),
+              (std::vector<std::string>{"Laptop", "Soccer Ball", "Toy Car"}));
+
+    query = ItemQuery();
+    query.nameContains = "o";
+    query.order = SortOrder::BY_NAME;
+    query.offset = 1;
+    query.limit = 2;
+    EXPECT_EQ(names(store->findItems("Alice", query)), (std::vector<std::string>{"Novel", "Soccer Ball"}));
+}
+
+TEST_P(WishlistStoreTest, QueryItemsStreamsMatchesInOrder) {
+    saveDiverseItems("Alice");
+
+    ItemQuery query;
+    query.order = SortOrder::BY_PRICE_ASC;
+    query.maxPrice = 30.0;
+    std::vector<std::string> visited;
+    size_t rows = store->queryItems("Alice", query, [&visited](const ItemRowView &row) {
+        visited.emplace_back(row.name);
+        return visited.size() < 3;
+    });
+
+    EXPECT_EQ(rows, 3u);
+    EXPECT_EQ(visited, (std::vector<std::string>{"Novel", "Toy Car", "Soccer Ball"}));
+    EXPECT_EQ(store->queryItems("Nobody", query, [](const ItemRowView &) { return true; }), 0u);
+}
+
+TEST_P(WishlistStoreTest, ManagerQueriesGoToTheStore) {
+    saveDiverseItems("Alice");
+
+    // Nothing loaded into the manager; the answers come from the store
+    WishlistManager manager("Alice");
+    manager.setStore(store.get());
+    ASSERT_TRUE(manager.getItems().empty());
+
+    ItemStats stats = manager.getStats();
+    EXPECT_EQ(stats.count, 5);
+    EXPECT_EQ(stats.purchasedCount, 2);
+
+    ItemQuery query;
+    query.purchased = true;
+    query.order = SortOrder::BY_NAME;
+    EXPECT_EQ(names(manager.findItems(query)), (std::vector<std::string>{"Novel", "T-Shirt"}));
+}
+
+TEST_P(WishlistStoreTest, StatsMatchAcrossBackends) {
+    saveDiverseItems("Alice");
+
+    ItemStats stats = store->queryStats("Alice");
+    EXPECT_EQ(stats.count, 5);
+    EXPECT_NEAR(stats.totalValue, 1089.95, 1e-9);
+    EXPECT_EQ(stats.purchasedCount, 2);
+    EXPECT_NEAR(stats.purchasedValue, 44.98, 1e-9);
+    EXPECT_EQ(stats.byCategory.size(), 5u);
+
+    ItemQuery query;
+    query.maxPrice = 25.0;
+    EXPECT_EQ(store->queryStats("Alice", query).count, 3);
+}
+
+TEST_P(WishlistStoreTest, SearchMatchesWordPrefixes) {
+    save("Alice", "PlayStation 5", 499.0, Category::ELECTRONICS);
+    WishItem ball("Ball", 10.0, Category::SPORTS);
+    ball.setNotes("Playground size");
+    ASSERT_TRUE(store->saveItem(ball, "Alice"));
+    save("Alice", "Lego Set", 80.0, Category::TOYS);
+
+    auto results = store->searchItems("Alice", "play");
+    ASSERT_EQ(results.size(), 2u);
+    EXPECT_EQ(results[0]->getName(), "PlayStation 5"); // Name matches rank first
+    EXPECT_TRUE(store->searchItems("Alice", "station").empty()); // Prefixes only, not infixes
+}
+
+TEST_P(WishlistStoreTest, BudgetRoundTrips) {
+    store->createUser("Alice");
+    Budget budget;
+    budget.setMaxBudget(250.0);
+    ASSERT_TRUE(store->saveBudget(budget, "Alice"));
+
+    EXPECT_DOUBLE_EQ(store->loadBudget("Alice").getMaxBudget(), 250.0);
+}
+
+TEST_P(WishlistStoreTest, RollbackDiscardsChanges) {
+    int keptId = save("Alice", "Kept", 5.0, Category::OTHER);
+
+    ASSERT_TRUE(store->beginTransaction());
+    save("Alice", "Discarded", 7.0, Category::OTHER);
+    ASSERT_TRUE(store->deleteItem(keptId, "Alice"));
+    save("Carol", "Discarded too", 1.0, Category::OTHER);
+    ASSERT_TRUE(store->rollbackTransaction());
+
+    EXPECT_EQ(names(store->loadItems("Alice")), (std::vector<std::string>{"Kept"}));
+    EXPECT_FALSE(store->userExists("Carol"));
+}
+
+TEST_P(WishlistStoreTest, TransactionsBelongToTheirThread) {
+    ASSERT_TRUE(store->beginTransaction());
+    save("Alice", "Discarded", 7.0, Category::OTHER);
+
+    // Neither a plain write nor a transaction of another thread lands in the
+    // open one; both wait for it to end
+    std::thread other([this] {
+        save("Bob", "Kept", 2.0, Category::OTHER);
+        EXPECT_TRUE(store->beginTransaction());
+        save("Bob", "Kept too", 3.0, Category::OTHER);
+        EXPECT_TRUE(store->commitTransaction());
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ASSERT_TRUE(store->rollbackTransaction());
+    other.join();
+
+    EXPECT_TRUE(store->loadItems("Alice").empty());
+    EXPECT_EQ(names(store->loadItems("Bob")), (std::vector<std::string>{"Kept", "Kept too"}));
+}
+
+TEST_P(WishlistStoreTest, PersistenceQueueWritesThroughInterface) {
+    PersistenceQueue queue(*store);
+    WishItem item("Queued", 12.0, Category::BOOKS);
+    queue.enqueueSaveItem(item, "Alice");
+    ASSERT_TRUE(queue.flush());
+
+    auto items = store->loadItems("Alice");
+    ASSERT_EQ(items.size(), 1u);
+    EXPECT_EQ(items[0]->getId(), item.getId());
+}
+
+INSTANTIATE_TEST_SUITE_P(Backends, WishlistStoreTest,
+                         ::testing::Values("sqlite", "sharded", "file", "file:journal", "memory"),
+                         [](const ::testing::TestParamInfo<std::string> &info) {
+                             std::string name = info.param;
+                             std::replace(name.begin(), name.end(), ':', '_');
+                             return name;
+                         });
+
+// ==================== FileStore specifics ====================
+
+TEST(FileStoreTest, ChangesSurviveReopen) {
+    Logger::getInstance().setLogLevel(LogLevel::NONE);
+    std::string directory = "test_file_store_reopen";
+    std::filesystem::remove_all(directory);
+
+    int id;
+    {
+        FileStore store(directory);
+        ASSERT_TRUE(store.initialize());
+        WishItem item("Persisted", 42.0, Category::OTHER);
+        id = item.getId();
+        ASSERT_TRUE(store.saveItem(item, "Alice"));
+        Budget budget;
+        budget.setMaxBudget(100.0);
+        ASSERT_TRUE(store.saveBudget(budget, "Alice"));
+        EXPECT_TRUE(std::filesystem::exists(store.pathFor("Alice")));
+    }
+
+    FileStore reopened(directory);
+    ASSERT_TRUE(reopened.initialize());
+    auto items = reopened.loadItems("Alice");
+    ASSERT_EQ(items.size(), 1u);
+    EXPECT_EQ(items[0]->getId(), id);
+    EXPECT_EQ(items[0]->getName(), "Persisted");
+    EXPECT_DOUBLE_EQ(reopened.loadBudget("Alice").getMaxBudget(), 100.0);
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST(FileStoreTest, DamagedFileFailsInitialize) {
+    Logger::getInstance().setLogLevel(LogLevel::NONE);
+    std::string directory = "test_file_store_damaged";
+    std::filesystem::remove_all(directory);
+
+    std::string path;
+    {
+        FileStore store(directory);
+        ASSERT_TRUE(store.initialize());
+        ASSERT_TRUE(store.createUser("Empty"));
+        ASSERT_TRUE(store.saveItem(WishItem("First", 1.0, Category::OTHER), "Alice"));
+        ASSERT_TRUE(store.saveItem(WishItem("Second", 2.0, Category::OTHER), "Alice"));
+        path = store.pathFor("Alice");
+    }
+    {
+        // An intact list without items loads
+        FileStore reopened(directory);
+        ASSERT_TRUE(reopened.initialize());
+        EXPECT_TRUE(reopened.userExists("Empty"));
+    }
+
+    // Cut the last item line short, as a torn copy would
+    size_t size = std::filesystem::file_size(path);
+    std::filesystem::resize_file(path, size - 6);
+    {
+        FileStore damaged(directory);
+        EXPECT_FALSE(damaged.initialize());
+    }
+    EXPECT_EQ(std::filesystem::file_size(path), size - 6);
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST(FileStoreTest, CorruptSnapshotFailsInitialize) {
+    Logger::getInstance().setLogLevel(LogLevel::NONE);
+    std::string directory = "test_file_store_corrupt";
+    std::filesystem::remove_all(directory);
+
+    FileStore::JournalOptions options;
+    options.enabled = true;
+    options.minCompactBytes = SIZE_MAX;
+    std::string path;
+    {
+        FileStore store(directory, options);
+        ASSERT_TRUE(store.initialize());
+        ASSERT_TRUE(store.saveItem(WishItem("Snapshotted", 1.0, Category::OTHER), "Alice"));
+        ASSERT_TRUE(store.compact("Alice"));
+        path = store.pathFor("Alice");
+    }
+
+    std::string content;
+    {
+        std::ifstream in(path, std::ios::binary);
+        content.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    ASSERT_FALSE(content.empty());
+    content[content.size() / 2] ^= 0x5A;
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << content;
+    }
+
+    FileStore damaged(directory, options);
+    EXPECT_FALSE(damaged.initialize());
+    std::filesystem::remove_all(directory);
+}
+
+// ==================== FileStore journal mode ====================
+
+class FileStoreJournalTest : public ::testing::Test {
+protected:
+    std::string directory = "test_file_store_journal";
+    FileStore::JournalOptions options;
+
+    void SetUp() override {
+        Logger::getInstance().setLogLevel(LogLevel::NONE);
+        std::filesystem::remove_all(directory);
+        options.enabled = true;
+        options.minCompactBytes = SIZE_MAX; // Tests compact explicitly unless they lower this
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(directory);
+    }
+
+    static size_t sizeOf(const std::string &path) {
+        return std::filesystem::exists(path) ? std::filesystem::file_size(path) : 0;
+    }
+};
+
+TEST_F(FileStoreJournalTest, AppendCostFollowsTheChange) {
+    FileStore store(directory, options);
+    ASSERT_TRUE(store.initialize());
+    ASSERT_TRUE(store.createUser("Alice"));
+    size_t snapshot = sizeOf(store.pathFor("Alice"));
+    ASSERT_GT(snapshot, 0u);
+
+    ASSERT_TRUE(store.beginTransaction());
+    for (int i = 0; i < 500; ++i) {
+        WishItem item("Item " + std::to_string(i), i, Category::OTHER);
+        ASSERT_TRUE(store.saveItem(item, "Alice"));
+    }
+    ASSERT_TRUE(store.commitTransaction());
+
+    // The snapshot is left alone; each later change adds about one record
+    EXPECT_EQ(sizeOf(store.pathFor("Alice")), snapshot);
+    size_t before = sizeOf(store.journalPathFor("Alice"));
+    auto items = store.loadItems("Alice");
+    items[0]->setPrice(99.0);
+    ASSERT_TRUE(store.saveItem(*items[0], "Alice"));
+    size_t grown = sizeOf(store.journalPathFor("Alice")) - before;
+    EXPECT_GT(grown, 0u);
+    EXPECT_LT(grown, 64u);
+}
+
+TEST_F(FileStoreJournalTest, ReopenReplaysJournal) {
+    int keptId;
+    {
+        FileStore store(directory, options);
+        ASSERT_TRUE(store.initialize());
+        WishItem kept("Kept | with pipe", 10.0, Category::BOOKS);
+        kept.setNotes("Line one\nLine two");
+        keptId = kept.getId();
+        WishItem removed("Removed", 20.0, Category::OTHER);
+        ASSERT_TRUE(store.saveItem(kept, "Alice"));
+        ASSERT_TRUE(store.saveItem(removed, "Alice"));
+        ASSERT_TRUE(store.deleteItem(removed.getId(), "Alice"));
+        Budget budget;
+        budget.setMaxBudget(300.0);
+        ASSERT_TRUE(store.saveBudget(budget, "Alice"));
+        EXPECT_GT(sizeOf(store.journalPathFor("Alice")), 0u);
+    }
+
+    FileStore reopened(directory, options);
+    ASSERT_TRUE(reopened.initialize());
+    auto items = reopened.loadItems("Alice");
+    ASSERT_EQ(items.size(), 1u);
+    EXPECT_EQ(items[0]->getId(), keptId);
+    EXPECT_EQ(items[0]->getName(), "Kept | with pipe");
+    EXPECT_EQ(items[0]->getNotes(), "Line one\nLine two");
+    EXPECT_DOUBLE_EQ(reopened.loadBudget("Alice").getMaxBudget(), 300.0);
+}
+
+TEST_F(FileStoreJournalTest, TornTailIsDropped) {
+    std::string journalPath;
+    size_t intact;
+    {
+        FileStore store(directory, options);
+        ASSERT_TRUE(store.initialize());
+        ASSERT_TRUE(store.saveItem(WishItem("First", 1.0, Category::OTHER), "Alice"));
+        journalPath = store.journalPathFor("Alice");
+        intact = sizeOf(journalPath);
+        ASSERT_TRUE(store.saveItem(WishItem("Second", 2.0, Category::OTHER), "Alice"));
+    }
+    // Cut the last frame in half, as a crash during the append would
+    std::filesystem::resize_file(journalPath, intact + (sizeOf(journalPath) - intact) / 2);
+
+    FileStore reopened(directory, options);
+    ASSERT_TRUE(reopened.initialize());
+    auto items = reopened.loadItems("Alice");
+    ASSERT_EQ(items.size(), 1u);
+    EXPECT_EQ(items[0]->getName(), "First");
+    EXPECT_EQ(sizeOf(journalPath), intact);
+
+    // Appends continue behind the intact frames
+    ASSERT_TRUE(reopened.saveItem(WishItem("Third", 3.0, Category::OTHER), "Alice"));
+    FileStore again(directory, options);
+    ASSERT_TRUE(again.initialize());
+    EXPECT_EQ(again.loadItems("Alice").size(), 2u);
+}
+
+TEST_F(FileStoreJournalTest, CompactionFoldsJournalIntoSnapshot) {
+    options.minCompactBytes = 1024;
+    options.compactRatio = 0.5;
+    {
+        FileStore store(directory, options);
+        ASSERT_TRUE(store.initialize());
+        for (int i = 0; i < 200 && store.getCompactionCount() == 0; ++i) {
+            ASSERT_TRUE(store.saveItem(WishItem("Item " + std::to_string(i), i, Category::OTHER), "Alice"));
+        }
+        for (int wait = 0; wait < 200 && store.getCompactionCount() == 0; ++wait) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        EXPECT_GT(store.getCompactionCount(), 0);
+
+        ASSERT_TRUE(store.saveItem(WishItem("After", 1.0, Category::OTHER), "Alice"));
+        ASSERT_TRUE(store.compact("Alice"));
+        EXPECT_FALSE(std::filesystem::exists(store.journalPathFor("Alice")));
+    }
+
+    FileStore reopened(directory, options);
+    ASSERT_TRUE(reopened.initialize());
+    auto items = reopened.loadItems("Alice");
+    ASSERT_FALSE(items.empty());
+    EXPECT_EQ(items.back()->getName(), "After");
+}
+
+TEST_F(FileStoreJournalTest, PlainModeFoldsLeftoverJournal) {
+    {
+        FileStore store(directory, options);
+        ASSERT_TRUE(store.initialize());
+        ASSERT_TRUE(store.saveItem(WishItem("Journaled", 5.0, Category::OTHER), "Alice"));
+    }
+
+    FileStore plain(directory);
+    ASSERT_TRUE(plain.initialize());
+    EXPECT_EQ(plain.loadItems("Alice").size(), 1u);
+    EXPECT_FALSE(std::filesystem::exists(plain.journalPathFor("Alice")));
+    ASSERT_TRUE(plain.saveItem(WishItem("Plain", 6.0, Category::OTHER), "Alice"));
+
+    FileStore reopened(directory, options);
+    ASSERT_TRUE(reopened.initialize());
+    EXPECT_EQ(reopened.loadItems("Alice").size(), 2u);
+}